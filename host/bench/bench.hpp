@@ -0,0 +1,85 @@
+/*
+  bench.hpp - timing for the host benchmarks of the Grbl core
+  Part of Grbl
+
+  Grbl is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Grbl is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Grbl.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef bench_h
+#define bench_h
+
+/*
+  Each benchmark is a program of its own, linked with the Grbl core and the simulated board, and
+  run by make -C host bench. Results go to stderr, one line per case. bench_boot() sends Grbl's
+  own output to /dev/null, which keeps the cost of writing it small.
+
+  The times are host times, not ESP8266 ones. They compare implementations on the same host, and
+  the cycles are host CPU cycles, where the host has a cycle counter.
+*/
+
+#include <stdio.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+  #include <x86intrin.h>
+#endif
+#include <host.hpp>
+#include "grbl.hpp"
+
+typedef struct {
+  const char *name;
+  uint64_t start_ns;
+  uint64_t start_cycles;
+} bench_t;
+
+static inline uint64_t bench_ns()
+{
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return((uint64_t)now.tv_sec*1000000000ULL + now.tv_nsec);
+}
+
+static inline uint64_t bench_cycles()
+{
+  #if defined(__x86_64__) || defined(__i386__)
+    return(__rdtsc());
+  #else
+    return(0);
+  #endif
+}
+
+// Boots Grbl with host_boot(), with its output sent to /dev/null.
+static inline void bench_boot()
+{
+  if (!freopen("/dev/null", "w", stdout)) { perror("/dev/null"); }
+  host_boot();
+}
+
+static inline void bench_start(bench_t *bench, const char *name)
+{
+  bench->name = name;
+  bench->start_cycles = bench_cycles();
+  bench->start_ns = bench_ns();
+}
+
+// Prints the rate of the operations since bench_start(), and the cycles each took.
+static inline void bench_stop(bench_t *bench, uint32_t count, const char *unit)
+{
+  uint64_t ns = bench_ns() - bench->start_ns;
+  uint64_t cycles = bench_cycles() - bench->start_cycles;
+  fprintf(stderr, "%-28s %10.0f %s/s", bench->name, count*1e9/ns, unit);
+  if (cycles) { fprintf(stderr, "  %8.0f cycles/%s", (double)cycles/count, unit); }
+  fprintf(stderr, "\n");
+}
+
+#endif
@@ -0,0 +1,90 @@
+/*
+  bench_gcode_fast_path.cpp - CAM lines parsed per second, on the g-code fast path and without it
+  Part of Grbl
+
+  Grbl is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Grbl is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Grbl.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*
+  Built twice by make -C host bench: as bench_gcode_fast_path, with the fast path of config.hpp,
+  and as bench_gcode_full_parser, from a copy of the core with ENABLE_GCODE_FAST_PATH commented
+  out. Both parse the same lines in check mode, so the planner isn't part of the time.
+*/
+
+#include "bench.hpp"
+
+#define BENCH_PASSES 20
+#define BENCH_LINES 20000 // Per pass.
+
+#ifdef ENABLE_GCODE_FAST_PATH
+  #define BENCH_NAME "g-code, fast path"
+#else
+  #define BENCH_NAME "g-code, full parser"
+#endif
+
+static char lines[BENCH_LINES][LINE_BUFFER_SIZE];
+
+
+// Writes the lines of a CAM contour, filtered as the protocol hands them to the parser: mostly
+// feed moves of only axis words, with a feed rate change, a line number, and a retract, rapid and
+// plunge now and then.
+static void program_lines()
+{
+  for (uint32_t idx=0; idx<BENCH_LINES; idx++) {
+    float angle = idx*0.01;
+    float x = 20.0*cos(angle) + 0.013*idx, y = 15.0*sin(angle);
+    char *line = lines[idx];
+    switch (idx % 200) {
+      case 0: strcpy(line, "G0Z2."); break;
+      case 1: snprintf(line, LINE_BUFFER_SIZE, "G0X%.3fY%.3f", x, y); break;
+      case 2: strcpy(line, "G1Z-0.5F300"); break;
+      case 3: snprintf(line, LINE_BUFFER_SIZE, "G1X%.3fY%.3fF%u", x, y, 800+(idx/200 % 5)*100); break;
+      default:
+        if ((idx % 25) == 0) { snprintf(line, LINE_BUFFER_SIZE, "N%uX%.3fY%.3f", idx, x, y); }
+        else { snprintf(line, LINE_BUFFER_SIZE, "X%.3fY%.3f", x, y); }
+        break;
+    }
+  }
+}
+
+
+// Parses the lines, from the parser state of a reset. Returns the lines that failed.
+static uint32_t parse_lines()
+{
+  char line[LINE_BUFFER_SIZE];
+  uint32_t failed = 0;
+  gc_init();
+  for (uint32_t idx=0; idx<BENCH_LINES; idx++) {
+    strcpy(line, lines[idx]); // As the protocol hands over its own buffer.
+    if (gc_execute_line(line, CLIENT_SERIAL) != STATUS_OK) { failed++; }
+  }
+  return(failed);
+}
+
+
+int main()
+{
+  bench_t bench;
+  uint32_t failed;
+  bench_boot();
+  program_lines();
+  sys.state = STATE_CHECK_MODE;
+  failed = parse_lines(); // Warm up.
+
+  bench_start(&bench, BENCH_NAME);
+  for (uint16_t pass=0; pass<BENCH_PASSES; pass++) { failed += parse_lines(); }
+  bench_stop(&bench, BENCH_PASSES*BENCH_LINES, "line");
+  if (failed) { fprintf(stderr, "%u lines failed\n", failed); }
+  return(0);
+}
@@ -0,0 +1,68 @@
+/*
+  bench_planner.cpp - blocks planned per second
+  Part of Grbl
+
+  Grbl is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Grbl is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Grbl.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "bench.hpp"
+
+#define BENCH_PASSES 50
+#define BENCH_SEGMENTS 2000 // Per pass.
+
+
+// Plans the moves of a CAM contour: short arc segments at a varying feed, a plunge and a rapid
+// back. The tail block is discarded whenever the buffer is full, as if the steppers ran it.
+static uint32_t plan_contour()
+{
+  plan_line_data_t pl_data;
+  float target[N_AXIS];
+  uint32_t blocks = 0;
+  memset(&pl_data, 0, sizeof(pl_data));
+  memset(target, 0, sizeof(target));
+  for (uint16_t idx=0; idx<BENCH_SEGMENTS; idx++) {
+    if (plan_check_full_buffer()) { plan_discard_current_block(); }
+    if ((idx % 200) == 0) { // Rapid to the next pass and plunge.
+      pl_data.condition = PL_COND_FLAG_RAPID_MOTION;
+      target[X_AXIS] = 0.0;
+      target[Y_AXIS] = 0.0;
+      target[Z_AXIS] = -0.5*(idx/200);
+    } else {
+      float angle = idx*0.02;
+      pl_data.condition = 0;
+      pl_data.feed_rate = 800.0 + 400.0*sin(angle*0.37);
+      target[X_AXIS] = 20.0*cos(angle) + 0.013*idx;
+      target[Y_AXIS] = 15.0*sin(angle);
+    }
+    if (plan_buffer_line(target, &pl_data) == PLAN_OK) { blocks++; }
+  }
+  return(blocks);
+}
+
+
+int main()
+{
+  bench_t bench;
+  uint32_t blocks = 0;
+  bench_boot();
+  plan_contour(); // Warm up.
+
+  bench_start(&bench, "planner");
+  for (uint16_t pass=0; pass<BENCH_PASSES; pass++) {
+    plan_reset();
+    blocks += plan_contour();
+  }
+  bench_stop(&bench, blocks, "block");
+  return(0);
+}
@@ -0,0 +1,66 @@
+/*
+  bench_report.cpp - status reports built per second, and the cycles each takes
+  Part of Grbl
+
+  Grbl is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Grbl is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Grbl.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "bench.hpp"
+
+#define BENCH_REPORTS 200000
+
+
+// The position part of a report formatted with sprintf() and strcat(), the way the reports were
+// built before the print buffer. For scale.
+static void report_sprintf(float *position)
+{
+  char report[320], temp[20];
+  strcpy(report, "<Run|MPos:");
+  for (uint8_t idx=0; idx<N_AXIS; idx++) {
+    sprintf(temp, "%4.3f", position[idx]);
+    strcat(report, temp);
+    if (idx < (N_AXIS-1)) { strcat(report, ","); }
+  }
+  strcat(report, "|FS:1500,12000>\r\n");
+  grbl_send(CLIENT_SERIAL, report);
+}
+
+
+int main()
+{
+  bench_t bench;
+  uint32_t count;
+  bench_boot();
+
+  bench_start(&bench, "status report, idle");
+  for (count=0; count<BENCH_REPORTS; count++) { report_realtime_status(CLIENT_SERIAL); }
+  bench_stop(&bench, count, "report");
+
+  // Off-zero positions with all decimals, spindle and coolant on, as during a job.
+  for (uint8_t idx=0; idx<N_AXIS; idx++) { sys_position[idx] = 123457*(idx+1); }
+  sys.state = STATE_CYCLE;
+  sys.spindle_speed = 12000;
+  spindle_set_state(SPINDLE_ENABLE_CW, 12000);
+  coolant_set_state(COOLANT_FLOOD_ENABLE);
+  bench_start(&bench, "status report, run");
+  for (count=0; count<BENCH_REPORTS; count++) { report_realtime_status(CLIENT_SERIAL); }
+  bench_stop(&bench, count, "report");
+
+  float position[N_AXIS];
+  system_convert_array_steps_to_mpos(position, sys_position);
+  bench_start(&bench, "sprintf position, reference");
+  for (count=0; count<BENCH_REPORTS; count++) { report_sprintf(position); }
+  bench_stop(&bench, count, "report");
+  return(0);
+}
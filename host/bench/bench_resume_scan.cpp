@@ -0,0 +1,103 @@
+/*
+  bench_resume_scan.cpp - lines per second a $FR resume scans through, from the text and the cache
+  Part of Grbl
+
+  Grbl is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Grbl is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Grbl.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*
+  Uploads a CAM program of a million lines and resumes it at its last line, as $FR=1000000:SCAN.NC
+  does. The job starts in check mode, so the resume ends with its report, and the time is that of
+  the scan alone.
+*/
+
+#include <unistd.h>
+#include "bench.hpp"
+
+#define BENCH_LINES 1000000
+#define BENCH_NAME "SCAN.NC"
+#define BENCH_PIECE 4096 // Of the upload, as the web server hands them over.
+
+
+// Appends a line of a CAM contour: mostly short feed moves, with a rapid, a plunge and an arc
+// every few hundred lines.
+static void program_line(char *text, uint32_t idx)
+{
+  float angle = idx*0.002;
+  int16_t x = (idx/400) % 40, y = (idx/400) % 30; // Of the pass the lines start.
+  switch (idx % 400) {
+    case 0: sprintf(text, "G0 Z2\n"); break;
+    case 1: sprintf(text, "G0 X%d Y%d\n", x, y); break;
+    case 2: sprintf(text, "G1 Z-0.5 F300\n"); break;
+    case 3: sprintf(text, "G2 X%d Y%d I1.5 J0 F800\n", x+3, y); break;
+    default: sprintf(text, "G1 X%.3f Y%.3f F%u\n", 20.0*cos(angle), 15.0*sin(angle), 800+(idx % 7)*50); break;
+  }
+}
+
+
+static void upload_program()
+{
+  char piece[BENCH_PIECE+64];
+  size_t length = 0;
+  job_upload_begin(BENCH_NAME);
+  for (uint32_t idx=0; idx<BENCH_LINES; idx++) {
+    program_line(&piece[length], idx);
+    length += strlen(&piece[length]);
+    if ((length >= BENCH_PIECE) || (idx == BENCH_LINES-1)) {
+      job_upload_write((uint8_t*)piece, length);
+      length = 0;
+    }
+  }
+  job_upload_end();
+  if (job_upload_result() != STATUS_OK) { fprintf(stderr, "upload of %s failed\n", BENCH_NAME); }
+}
+
+
+// Resumes the job at its last line, and returns the lines scanned on the way.
+static uint32_t scan()
+{
+  if (job_start(BENCH_NAME, BENCH_LINES, CLIENT_SERIAL) != STATUS_OK) { return(0); }
+  while (job_scanning()) { job_execute(); }
+  if (!job_active()) { // Failed on a line, instead of resuming.
+    fprintf(stderr, "scan of %s failed\n", BENCH_NAME);
+    return(0);
+  }
+  job_reset();
+  return(BENCH_LINES-1);
+}
+
+
+int main()
+{
+  bench_t bench;
+  uint32_t lines;
+  bench_boot();
+  upload_program();
+  sys.state = STATE_CHECK_MODE;
+
+  bench_start(&bench, "resume scan, text");
+  lines = scan();
+  bench_stop(&bench, lines, "line");
+
+  #ifdef ENABLE_JOB_CACHE
+    // Compiles the job, a line per pass of the idle main loop, and scans its cache.
+    char path[64];
+    snprintf(path, sizeof(path), "fs/cache/%s", BENCH_NAME);
+    for (uint32_t pass=0; (pass < 4*BENCH_LINES) && (access(path, F_OK) != 0); pass++) { job_execute(); }
+    bench_start(&bench, "resume scan, cache");
+    lines = scan();
+    bench_stop(&bench, lines, "line");
+  #endif
+  return(0);
+}
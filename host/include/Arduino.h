@@ -0,0 +1,187 @@
+/*
+  Arduino.h - ESP8266 Arduino core subset for the host build
+  Part of Grbl
+
+  Grbl is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Grbl is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Grbl.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef Arduino_h
+#define Arduino_h
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector> // Ahead of the min and max macros, which break these.
+
+#include "host.hpp"
+
+#ifndef F_CPU
+  #define F_CPU 80000000L
+#endif
+
+#define ICACHE_RAM_ATTR
+#define IRAM_ATTR
+#define PROGMEM
+#define F(string) (string)
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0x00
+#define OUTPUT 0x01
+#define INPUT_PULLUP 0x02
+#define RISING 0x01
+#define FALLING 0x02
+#define CHANGE 0x03
+
+// The same bodies as nuts_bolts.hpp, so redefining them there is not a warning.
+#define max(a,b) (((a) > (b)) ? (a) : (b))
+#define min(a,b) (((a) < (b)) ? (a) : (b))
+
+typedef uint8_t byte;
+typedef bool boolean;
+typedef uint8_t uint8;
+typedef int8_t sint8;
+typedef uint16_t uint16;
+typedef int16_t sint16;
+typedef uint32_t uint32;
+typedef int32_t sint32;
+
+// Time. See host.hpp for the virtual clock.
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+unsigned long millis();
+unsigned long micros();
+void yield();
+
+// Interrupt masking. Interrupts are only delivered while enabled.
+void cli();
+void sei();
+#define noInterrupts() cli()
+#define interrupts() sei()
+uint32_t xt_rsil(uint32_t level);
+void xt_wsr_ps(uint32_t state);
+
+// GPIO. Outputs go nowhere. Inputs read low and never raise a pin change interrupt.
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+void analogWrite(uint8_t pin, int value);
+void analogWriteRange(uint32_t range);
+void analogWriteFreq(uint32_t freq);
+void attachInterrupt(uint8_t pin, void (*isr)(void), int mode);
+void detachInterrupt(uint8_t pin);
+#define digitalPinToInterrupt(pin) (pin)
+
+// NodeMCU pin names.
+enum { D0=16, D1=5, D2=4, D3=0, D4=2, D5=14, D6=12, D7=13, D8=15 };
+
+extern volatile uint32_t host_gpio_in;
+#define GPIP(pin) ((host_gpio_in >> (pin)) & 1)
+
+// timer0: Fires when the cycle counter reaches the written value.
+void timer0_isr_init();
+void timer0_attachInterrupt(void (*isr)(void));
+void timer0_detachInterrupt();
+void timer0_write(uint32_t count);
+
+// timer1: Counts down from the loaded value at F_CPU divided by the prescaler.
+#define TIM_DIV1   0
+#define TIM_DIV16  1
+#define TIM_DIV256 3
+#define TIM_EDGE   0
+#define TIM_LEVEL  1
+#define TIM_SINGLE 0
+#define TIM_LOOP   1
+#define TCPD 2 // Prescaler divider
+#define TCAR 6 // Auto reload
+#define TCTE 7 // Timer enable
+#define TCIT 0 // Interrupt type
+extern volatile uint32_t T1C; // Control
+extern volatile uint32_t T1L; // Load value
+extern volatile uint32_t T1I; // Interrupt clear
+void timer1_isr_init();
+void timer1_attachInterrupt(void (*isr)(void));
+void timer1_detachInterrupt();
+void timer1_enable(uint8_t divider, uint8_t int_type, uint8_t reload);
+void timer1_disable();
+void timer1_write(uint32_t ticks);
+
+// UART0 receive interrupt registers, as used by the Grbl serial module.
+uint32_t host_uart_status();
+uint8_t host_uart_fifo_read();
+void host_uart_attach(void (*isr)(void *), void *arg);
+void host_uart_enable(bool enable);
+extern volatile uint32_t host_uart_reg;
+#define USS(uart) host_uart_status()
+#define USF(uart) host_uart_fifo_read()
+#define USIS(uart) host_uart_reg
+#define USIC(uart) host_uart_reg
+#define USIE(uart) host_uart_reg
+#define USC1(uart) host_uart_reg
+#define USRXC 0
+#define UCFFT 0
+#define UCTOT 24
+#define UCTOE 31
+#define UIFF 0
+#define UIOF 4
+#define UITO 8
+#define ETS_UART_INTR_ATTACH(isr, arg) host_uart_attach(isr, arg)
+#define ETS_UART_INTR_ENABLE() host_uart_enable(true)
+#define ETS_UART_INTR_DISABLE() host_uart_enable(false)
+
+class String {
+  public:
+  String(const char *text = "") : _text(text) {}
+  String &operator+=(char c) { _text += c; return(*this); }
+  String &operator+=(const char *text) { _text += text; return(*this); }
+  const char *c_str() const { return(_text.c_str()); }
+  size_t length() const { return(_text.length()); }
+
+  private:
+  std::string _text;
+};
+
+#include "Print.h"
+
+class HardwareSerial : public Print {
+  public:
+  void begin(unsigned long baud);
+  void setDebugOutput(bool enable) {}
+  int available();
+  int read();
+  size_t write(uint8_t c);
+  size_t write(const uint8_t *buffer, size_t size);
+  using Print::write;
+};
+extern HardwareSerial Serial;
+
+class EspClass {
+  public:
+  void wdtFeed() {}
+  void wdt_reset() {}
+  uint32_t getCycleCount() { return((uint32_t)host_cycles()); }
+  uint32_t getFreeHeap() { return(40000); }
+  uint8_t getCpuFreqMHz() { return(F_CPU/1000000L); }
+  void restart() { exit(0); }
+};
+extern EspClass ESP;
+
+#endif
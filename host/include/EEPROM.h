@@ -0,0 +1,36 @@
+/*
+  EEPROM.h - ESP8266 EEPROM emulation subset for the host build
+  Part of Grbl
+
+  Grbl is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Grbl is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Grbl.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef EEPROM_h
+#define EEPROM_h
+
+#include <Arduino.h>
+
+// RAM backed, erased to 0xFF. Kept in a file with host_eeprom_open().
+class EEPROMClass {
+  public:
+  void begin(size_t size);
+  uint8_t read(int address);
+  void write(int address, uint8_t value);
+  bool commit();
+  void end();
+  uint8_t *getDataPtr();
+};
+extern EEPROMClass EEPROM;
+
+#endif
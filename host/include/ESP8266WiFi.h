@@ -0,0 +1,42 @@
+/*
+  ESP8266WiFi.h - WiFi subset for the host build. Always connected, never reachable.
+  Part of Grbl
+
+  Grbl is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Grbl is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Grbl.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef ESP8266WiFi_h
+#define ESP8266WiFi_h
+
+#include <Arduino.h>
+
+#define WIFI_STA 1
+#define WL_CONNECTED 3
+
+class IPAddress : public Printable {
+  public:
+  size_t printTo(Print &p) const { return(p.print("127.0.0.1")); }
+};
+
+class WiFiClass {
+  public:
+  void mode(int mode) {}
+  void hostname(const char *name) {}
+  void begin(const char *ssid, const char *password) {}
+  int status() { return(WL_CONNECTED); }
+  IPAddress localIP() { return(IPAddress()); }
+};
+extern WiFiClass WiFi;
+
+#endif
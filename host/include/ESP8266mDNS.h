@@ -0,0 +1,30 @@
+/*
+  ESP8266mDNS.h - mDNS subset for the host build. Does nothing.
+  Part of Grbl
+
+  Grbl is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Grbl is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Grbl.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef ESP8266mDNS_h
+#define ESP8266mDNS_h
+
+class MDNSResponder {
+  public:
+  bool begin(const char *hostname) { return(true); }
+  void addService(const char *service, const char *protocol, int port) {}
+  void update() {}
+};
+extern MDNSResponder MDNS;
+
+#endif
@@ -0,0 +1,77 @@
+/*
+  ESPAsyncWebServer.h - Async web server subset for the host build. Serves nobody. The websocket
+  has a client only while a test hooks its binary messages, see host_websocket_set_hook(), and
+  its text output is dropped.
+  Part of Grbl
+
+  Grbl is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Grbl is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Grbl.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef ESPAsyncWebServer_h
+#define ESPAsyncWebServer_h
+
+#include <Arduino.h>
+#include <host.hpp>
+
+#define HTTP_GET 0x01
+#define HTTP_POST 0x02
+
+typedef enum { WS_EVT_CONNECT, WS_EVT_DISCONNECT, WS_EVT_PONG, WS_EVT_ERROR, WS_EVT_DATA } AwsEventType;
+
+typedef struct {
+  uint8_t message_opcode;
+  uint32_t num;
+  uint8_t final;
+  uint8_t masked;
+  uint8_t opcode;
+  uint64_t len;
+  uint8_t mask[4];
+  uint64_t index;
+} AwsFrameInfo;
+
+class AsyncWebSocketClient {
+  public:
+  uint32_t id() { return(0); }
+};
+
+class AsyncWebSocket;
+typedef void (*AwsEventHandler)(AsyncWebSocket *server, AsyncWebSocketClient *client, AwsEventType type, void *arg, uint8_t *data, size_t len);
+
+class AsyncWebSocket {
+  public:
+  AsyncWebSocket(const char *url) {}
+  void onEvent(AwsEventHandler handler) {}
+  size_t count() const { return(host_websocket_clients()); }
+  void textAll(const char *message, size_t length) {}
+  void textAll(const uint8_t *message, size_t length) {}
+  void binaryAll(const uint8_t *message, size_t length) { host_websocket_binary(message, length); }
+};
+
+class AsyncWebServerRequest {
+  public:
+  void send(int code, const char *content_type, const char *content) {}
+};
+typedef void (*ArRequestHandlerFunction)(AsyncWebServerRequest *request);
+typedef void (*ArUploadHandlerFunction)(AsyncWebServerRequest *request, const String &filename, size_t index, uint8_t *data, size_t len, bool final);
+
+class AsyncWebServer {
+  public:
+  AsyncWebServer(uint16_t port) {}
+  void addHandler(AsyncWebSocket *handler) {}
+  void on(const char *uri, int method, ArRequestHandlerFunction handler) {}
+  void on(const char *uri, int method, ArRequestHandlerFunction handler, ArUploadHandlerFunction upload) {}
+  void begin() {}
+};
+
+#endif
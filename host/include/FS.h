@@ -0,0 +1,74 @@
+/*
+  FS.h - ESP8266 file system subset for the host build
+  Part of Grbl
+
+  Grbl is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Grbl is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Grbl.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef FS_h
+#define FS_h
+
+#include <stdio.h>
+#include <memory>
+#include <string>
+#include <vector>
+#include <Arduino.h>
+
+// Open file. Copies share it, as on the ESP8266, and the last one closes it.
+class File {
+  public:
+  File() : _size(0) {}
+  File(FILE *file, const char *name);
+  operator bool() const { return(_file != nullptr); }
+  size_t read(uint8_t *buffer, size_t size);
+  size_t write(const uint8_t *buffer, size_t size);
+  size_t size() const { return(_size); }
+  size_t position() const;
+  bool seek(uint32_t position);
+  const char *name() const { return(_name.c_str()); }
+  void close() { _file.reset(); }
+
+  private:
+  std::shared_ptr<FILE> _file;
+  std::string _name;
+  size_t _size;
+};
+
+// Snapshot of the files in a directory, taken when opened.
+class Dir {
+  public:
+  bool next() { return(++_index < (int)_names.size()); }
+  String fileName() const { return(String(_names[_index].c_str())); }
+  size_t fileSize() const { return(_sizes[_index]); }
+
+  private:
+  friend class FS;
+  std::vector<std::string> _names;
+  std::vector<size_t> _sizes;
+  int _index = -1;
+};
+
+// Maps the paths to a directory of the host. See host_fs_open().
+class FS {
+  public:
+  bool begin();
+  void end() {}
+  File open(const char *path, const char *mode);
+  bool exists(const char *path);
+  bool remove(const char *path);
+  bool rename(const char *path_from, const char *path_to);
+  Dir openDir(const char *path);
+};
+
+#endif
@@ -0,0 +1,67 @@
+/*
+  Print.h - Arduino Print subset for the host build
+  Part of Grbl
+
+  Grbl is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Grbl is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Grbl.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef Print_h
+#define Print_h
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+
+class Print;
+
+class Printable {
+  public:
+  virtual ~Printable() {}
+  virtual size_t printTo(Print &p) const = 0;
+};
+
+class Print {
+  public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t c) = 0;
+  virtual size_t write(const uint8_t *buffer, size_t size)
+  {
+    size_t n = 0;
+    while (size--) { n += write(*buffer++); }
+    return(n);
+  }
+  size_t write(const char *text) { return(write((const uint8_t *)text, strlen(text))); }
+
+  size_t print(const char *text) { return(write(text)); }
+  size_t print(const Printable &value) { return(value.printTo(*this)); }
+  size_t print(long value) { return(printf("%ld", value)); }
+  size_t println() { return(write("\r\n")); }
+  template <typename T> size_t println(const T &value) { return(print(value) + println()); }
+
+  size_t printf(const char *format, ...)
+  {
+    char temp[256];
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(temp, sizeof(temp), format, args);
+    va_end(args);
+    if (length < 0) { return(0); }
+    if (length >= (int)sizeof(temp)) { length = sizeof(temp)-1; }
+    return(write((const uint8_t *)temp, length));
+  }
+};
+
+#endif
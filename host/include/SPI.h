@@ -0,0 +1,41 @@
+/*
+  SPI.h - ESP8266 SPI subset for the host build. Drives the simulated shift register chain.
+  Part of Grbl
+
+  Grbl is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Grbl is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Grbl.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SPI_h
+#define SPI_h
+
+#include <Arduino.h>
+
+#define SPI_MODE0 0x00
+#define LSBFIRST 0
+#define MSBFIRST 1
+
+class SPIClass {
+  public:
+  void begin() {}
+  void end() {}
+  void setHwCs(bool use) {}
+  void setFrequency(uint32_t freq) {}
+  void setDataMode(uint8_t mode) {}
+  void setBitOrder(uint8_t order) {}
+  void write(uint8_t data);
+  void write32(uint32_t data);
+};
+extern SPIClass SPI;
+
+#endif
@@ -0,0 +1,36 @@
+/*
+  Ticker.h - ESP8266 Ticker subset for the host build. Runs on the virtual clock.
+  Part of Grbl
+
+  Grbl is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Grbl is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Grbl.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef Ticker_h
+#define Ticker_h
+
+#include <Arduino.h>
+
+class Ticker {
+  public:
+  typedef void (*callback_t)(void);
+  ~Ticker() { detach(); }
+  void attach_ms(uint32_t milliseconds, callback_t callback) { _attach(milliseconds, callback, true); }
+  void once_ms(uint32_t milliseconds, callback_t callback) { _attach(milliseconds, callback, false); }
+  void detach();
+
+  private:
+  void _attach(uint32_t milliseconds, callback_t callback, bool repeat);
+};
+
+#endif
@@ -0,0 +1,116 @@
+/*
+  host.hpp - simulated ESP8266 board for running the Grbl core on a Linux host
+  Part of Grbl
+
+  Grbl is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Grbl is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Grbl.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef host_h
+#define host_h
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+  The board runs on a virtual clock counting CPU cycles at F_CPU. It only advances, when the
+  firmware waits, i.e. in delay(), delayMicroseconds() and the delay(0) yields of the main program.
+  A yield skips ahead to the next due event, so the firmware's own computing takes no virtual
+  time. This makes runs deterministic and independent of the host's speed. Interrupts are only
+  delivered at these points, in order of their due time:
+
+    - timer0 and timer1 with the ESP8266 semantics Grbl relies on. Drive the stepper ISRs.
+    - Ticker callbacks. Drive the serial poll task.
+    - The UART receive interrupt, as bytes arrive on the serial port.
+
+  Pin change interrupts are never raised, so limit and control inputs read as inactive.
+
+  The stepper board is a chain of four 8-bit shift registers. SPI.write32() shifts in a full
+  32-bit frame, SPI.write() only 8 bits, and the chain latches at the end of every transfer:
+
+    bits 0-7   : step outputs      bits 16-23 : misc outputs, spindle and coolant
+    bits 8-15  : direction outputs bits 24-31 : limit input scan
+*/
+
+// Called with every latched shift register frame and its virtual time in CPU cycles.
+typedef void (*host_spi_hook_t)(uint64_t cycles, uint32_t frame);
+
+// Called with every binary websocket message.
+typedef void (*host_websocket_hook_t)(const uint8_t *message, size_t length);
+
+// Called with the path and mode of every LittleFS file, before it is opened.
+typedef void (*host_fs_hook_t)(const char *path, const char *mode);
+
+// Powers up Grbl with setup() and resets it like loop() does, short of entering the main loop.
+// Tests and benchmarks boot with it.
+void host_boot();
+
+// Virtual time in CPU cycles since power-up.
+uint64_t host_cycles();
+
+// Advances the virtual clock, delivering all interrupts due on the way.
+void host_advance(uint64_t cycles);
+
+// Advances the virtual clock to the next due event and delivers it.
+void host_yield();
+
+// Keeps the virtual clock from running ahead of the wall clock. For interactive use.
+void host_set_realtime(bool realtime);
+
+// Returns the latched shift register outputs.
+uint32_t host_spi_frame();
+
+// Installs a hook called with every latched shift register frame. NULL to remove.
+void host_spi_set_hook(host_spi_hook_t hook);
+
+// Connects a websocket client, which receives the binary messages through the hook. NULL
+// disconnects it.
+void host_websocket_set_hook(host_websocket_hook_t hook);
+
+// Used by the websocket. The number of clients, and sends a binary message to them.
+size_t host_websocket_clients();
+void host_websocket_binary(const uint8_t *message, size_t length);
+
+// Records every latched shift register frame with its virtual time to the file. Installs the frame
+// hook. See tools/step_trace.py for the format.
+void host_capture_open(const char *path);
+
+// Uses the file as EEPROM backing store, loaded now and saved on every commit.
+void host_eeprom_open(const char *path);
+
+// Keeps the LittleFS files in the host directory, "fs" unless given. Created on mount.
+void host_fs_open(const char *path);
+
+// Installs a hook called whenever a LittleFS file is opened. NULL to remove.
+void host_fs_set_hook(host_fs_hook_t hook);
+
+// Connects the serial port to a new pseudo terminal. Returns the slave device name.
+const char *host_serial_open_pty();
+
+// Connects the serial port to stdin and stdout.
+void host_serial_open_stdio();
+
+// Puts the bytes into the UART receive FIFO, as if they had just arrived. The receive interrupt
+// takes them with the next host_yield() or host_advance().
+void host_uart_receive(const uint8_t *data, uint16_t size);
+
+// Streams a g-code file through the serial port, sending each line after the previous one was
+// answered with ok or error. Output goes to stdout. The program exits, once the file is done and
+// the machine is idle.
+void host_serial_stream(const char *path);
+
+// Streams a g-code file like host_serial_stream(), without printing Grbl's output. Prints the
+// cycle time estimate instead, once the job is done. See host_estimate.cpp.
+void host_serial_estimate(const char *path);
+
+#endif
@@ -0,0 +1,390 @@
+/*
+  host_board.cpp - virtual clock, interrupts, timers and peripherals of the simulated board
+  Part of Grbl
+
+  Grbl is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Grbl is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Grbl.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <time.h>
+#include <Arduino.h>
+#include <SPI.h>
+#include <Ticker.h>
+#include <EEPROM.h>
+#include <ESP8266WiFi.h>
+#include <ESP8266mDNS.h>
+
+#define HOST_CYCLES_PER_MS (F_CPU/1000L)
+#define HOST_CYCLES_PER_US (F_CPU/1000000L)
+#define HOST_NEVER UINT64_MAX
+#define HOST_TICKER_COUNT 4
+#define HOST_EEPROM_SIZE 4096
+
+HardwareSerial Serial;
+EspClass ESP;
+SPIClass SPI;
+EEPROMClass EEPROM;
+WiFiClass WiFi;
+MDNSResponder MDNS;
+
+volatile uint32_t host_gpio_in;
+volatile uint32_t T1C;
+volatile uint32_t T1L;
+volatile uint32_t T1I;
+
+// Implemented by the serial port. Receives the bytes arrived on the line by the next event time.
+uint64_t host_uart_next_event();
+void host_uart_service();
+
+// Implemented by main.cpp.
+void setup(void);
+void grbl_reinit(void);
+
+static uint64_t host_clock;
+static bool host_interrupts_enabled = true;
+static bool host_in_interrupt;
+static bool host_realtime;
+static uint64_t host_wall_start; // (ns)
+
+static void (*timer0_isr)(void);
+static uint64_t timer0_due = HOST_NEVER;
+
+static void (*timer1_isr)(void);
+static uint64_t timer1_due = HOST_NEVER;
+static bool timer1_running;
+
+typedef struct {
+  Ticker *owner;
+  Ticker::callback_t callback;
+  uint64_t period;
+  uint64_t due;
+  bool repeat;
+} host_ticker_t;
+static host_ticker_t host_tickers[HOST_TICKER_COUNT];
+
+static uint32_t host_spi_chain;
+static host_spi_hook_t host_spi_hook;
+static host_websocket_hook_t host_websocket_hook;
+
+static uint8_t host_eeprom[HOST_EEPROM_SIZE];
+static size_t host_eeprom_size;
+static const char *host_eeprom_path;
+
+
+// Virtual clock
+
+static uint64_t host_wall_ns()
+{
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return((uint64_t)now.tv_sec*1000000000ULL + now.tv_nsec);
+}
+
+
+void host_boot()
+{
+  setup();
+  grbl_reinit();
+}
+
+
+uint64_t host_cycles() { return(host_clock); }
+
+
+void host_set_realtime(bool realtime)
+{
+  host_realtime = realtime;
+  host_wall_start = host_wall_ns() - host_clock*1000/HOST_CYCLES_PER_US;
+}
+
+
+// Moves the clock forward. Sleeps first, if running in real time and ahead of the wall clock.
+static void host_clock_set(uint64_t cycles)
+{
+  if (cycles <= host_clock) { return; }
+  if (host_realtime) {
+    uint64_t target_ns = host_wall_start + cycles*1000/HOST_CYCLES_PER_US;
+    uint64_t now_ns = host_wall_ns();
+    if (target_ns > now_ns + 1000000) { // Don't bother for less than a millisecond.
+      struct timespec wait = { (time_t)((target_ns-now_ns)/1000000000ULL), (long)((target_ns-now_ns)%1000000000ULL) };
+      nanosleep(&wait, NULL);
+    }
+  }
+  host_clock = cycles;
+}
+
+
+// Cycles between timer1 interrupts, from the load value and the prescaler.
+static uint64_t timer1_period()
+{
+  uint8_t divider = (T1C >> TCPD) & 0x03;
+  uint64_t period = (uint64_t)T1L * ((divider == 0) ? 1 : ((divider == 1) ? 16 : 256));
+  return((period > 0) ? period : 1);
+}
+
+
+// Returns the time of the next event able to fire, and its source.
+#define HOST_EVENT_TIMER0 0
+#define HOST_EVENT_TIMER1 1
+#define HOST_EVENT_UART   2
+#define HOST_EVENT_TICKER 3 // Plus ticker index.
+
+static uint64_t host_next_event(uint8_t *source)
+{
+  uint64_t due = HOST_NEVER;
+  if (!host_interrupts_enabled || host_in_interrupt) { return(due); }
+
+  // A timer1 enabled by writing T1C directly starts counting from the load value.
+  bool timer1_enabled = T1C & (1 << TCTE);
+  if (timer1_enabled && !timer1_running) { timer1_due = host_clock + timer1_period(); }
+  timer1_running = timer1_enabled;
+
+  if (timer0_isr && (timer0_due < due)) { due = timer0_due; *source = HOST_EVENT_TIMER0; }
+  if (timer1_isr && timer1_running && (timer1_due < due)) { due = timer1_due; *source = HOST_EVENT_TIMER1; }
+  uint64_t uart_due = host_uart_next_event();
+  if (uart_due < due) { due = uart_due; *source = HOST_EVENT_UART; }
+  for (uint8_t idx=0; idx<HOST_TICKER_COUNT; idx++) {
+    if (host_tickers[idx].callback && (host_tickers[idx].due < due)) {
+      due = host_tickers[idx].due;
+      *source = HOST_EVENT_TICKER+idx;
+    }
+  }
+  return(due);
+}
+
+
+static void host_fire(uint8_t source)
+{
+  host_in_interrupt = true;
+  if (source == HOST_EVENT_TIMER0) {
+    timer0_due = HOST_NEVER; // Until rewritten, which the ISR does.
+    timer0_isr();
+  } else if (source == HOST_EVENT_TIMER1) {
+    timer1_due += timer1_period();
+    timer1_isr(); // May reload the timer, which moves the due time again.
+  } else if (source == HOST_EVENT_UART) {
+    host_uart_service();
+  } else {
+    host_ticker_t *ticker = &host_tickers[source-HOST_EVENT_TICKER];
+    Ticker::callback_t callback = ticker->callback;
+    if (ticker->repeat) { ticker->due += ticker->period; }
+    else { ticker->callback = NULL; }
+    callback();
+  }
+  host_in_interrupt = false;
+  host_interrupts_enabled = true; // Interrupt handlers return with interrupts enabled.
+}
+
+
+void host_advance(uint64_t cycles)
+{
+  uint64_t target = host_clock + cycles;
+  if (host_in_interrupt) { host_clock = target; return; } // Busy waiting in an ISR. Nothing fires.
+  for (;;) {
+    uint8_t source = 0;
+    uint64_t due = host_next_event(&source);
+    if (due > target) { break; }
+    host_clock_set(due);
+    host_fire(source);
+  }
+  host_clock_set(target);
+}
+
+
+void host_yield()
+{
+  if (host_in_interrupt) { return; }
+  uint8_t source = 0;
+  uint64_t due = host_next_event(&source);
+  if (due == HOST_NEVER) { return; }
+  host_clock_set(due);
+  host_fire(source);
+}
+
+
+// Arduino time and interrupts
+
+void delay(unsigned long ms)
+{
+  if (ms == 0) { host_yield(); }
+  else { host_advance((uint64_t)ms*HOST_CYCLES_PER_MS); }
+}
+
+void delayMicroseconds(unsigned int us) { host_advance((uint64_t)us*HOST_CYCLES_PER_US); }
+unsigned long millis() { return((unsigned long)(host_clock/HOST_CYCLES_PER_MS)); }
+unsigned long micros() { return((unsigned long)(host_clock/HOST_CYCLES_PER_US)); }
+void yield() { host_yield(); }
+
+void cli() { host_interrupts_enabled = false; }
+void sei() { host_interrupts_enabled = true; }
+
+uint32_t xt_rsil(uint32_t level)
+{
+  uint32_t state = host_interrupts_enabled;
+  host_interrupts_enabled = false;
+  return(state);
+}
+
+void xt_wsr_ps(uint32_t state) { host_interrupts_enabled = state; }
+
+
+// GPIO
+
+void pinMode(uint8_t pin, uint8_t mode) {}
+void digitalWrite(uint8_t pin, uint8_t value) {}
+int digitalRead(uint8_t pin) { return(GPIP(pin)); }
+void analogWrite(uint8_t pin, int value) {}
+void analogWriteRange(uint32_t range) {}
+void analogWriteFreq(uint32_t freq) {}
+void attachInterrupt(uint8_t pin, void (*isr)(void), int mode) {}
+void detachInterrupt(uint8_t pin) {}
+
+
+// Timers
+
+void timer0_isr_init() {}
+void timer0_attachInterrupt(void (*isr)(void)) { timer0_isr = isr; }
+void timer0_detachInterrupt() { timer0_isr = NULL; }
+
+void timer0_write(uint32_t count)
+{
+  // Due when the 32-bit cycle counter next equals count. A count just passed is due after the
+  // counter wraps, some 53 seconds later, as on the chip.
+  uint64_t delta = (uint32_t)(count - (uint32_t)host_clock);
+  timer0_due = host_clock + ((delta) ? delta : (1ULL << 32));
+}
+
+void timer1_isr_init() {}
+void timer1_attachInterrupt(void (*isr)(void)) { timer1_isr = isr; }
+void timer1_detachInterrupt() { timer1_isr = NULL; }
+
+void timer1_enable(uint8_t divider, uint8_t int_type, uint8_t reload)
+{
+  T1C = (1 << TCTE) | ((divider & 0x03) << TCPD) | ((int_type & 1) << TCIT) | ((reload & 1) << TCAR);
+}
+
+void timer1_disable()
+{
+  T1C = 0;
+  timer1_running = false;
+}
+
+void timer1_write(uint32_t ticks)
+{
+  T1L = ticks & 0x7FFFFF; // 23-bit counter.
+  timer1_due = host_clock + timer1_period();
+  timer1_running = T1C & (1 << TCTE);
+}
+
+
+// Ticker
+
+void Ticker::_attach(uint32_t milliseconds, callback_t callback, bool repeat)
+{
+  detach();
+  for (uint8_t idx=0; idx<HOST_TICKER_COUNT; idx++) {
+    if (host_tickers[idx].callback == NULL) {
+      host_tickers[idx].owner = this;
+      host_tickers[idx].callback = callback;
+      host_tickers[idx].period = (uint64_t)milliseconds*HOST_CYCLES_PER_MS;
+      host_tickers[idx].due = host_clock + host_tickers[idx].period;
+      host_tickers[idx].repeat = repeat;
+      return;
+    }
+  }
+  fprintf(stderr, "host: out of tickers\n");
+  exit(1);
+}
+
+void Ticker::detach()
+{
+  for (uint8_t idx=0; idx<HOST_TICKER_COUNT; idx++) {
+    if (host_tickers[idx].owner == this) { host_tickers[idx].callback = NULL; host_tickers[idx].owner = NULL; }
+  }
+}
+
+
+// Shift register chain
+
+void SPIClass::write(uint8_t data)
+{
+  host_spi_chain = (host_spi_chain << 8) | data;
+  if (host_spi_hook) { host_spi_hook(host_clock, host_spi_chain); }
+}
+
+void SPIClass::write32(uint32_t data)
+{
+  host_spi_chain = data;
+  if (host_spi_hook) { host_spi_hook(host_clock, host_spi_chain); }
+}
+
+uint32_t host_spi_frame() { return(host_spi_chain); }
+void host_spi_set_hook(host_spi_hook_t hook) { host_spi_hook = hook; }
+
+
+// Websocket
+
+void host_websocket_set_hook(host_websocket_hook_t hook) { host_websocket_hook = hook; }
+size_t host_websocket_clients() { return(host_websocket_hook ? 1 : 0); }
+
+void host_websocket_binary(const uint8_t *message, size_t length)
+{
+  if (host_websocket_hook) { host_websocket_hook(message, length); }
+}
+
+
+// EEPROM
+
+void host_eeprom_open(const char *path)
+{
+  host_eeprom_path = path;
+  memset(host_eeprom, 0xFF, sizeof(host_eeprom));
+  FILE *file = fopen(path, "rb");
+  if (file) {
+    if (fread(host_eeprom, 1, sizeof(host_eeprom), file) == 0) { memset(host_eeprom, 0xFF, sizeof(host_eeprom)); }
+    fclose(file);
+  }
+}
+
+void EEPROMClass::begin(size_t size)
+{
+  if (size > HOST_EEPROM_SIZE) { size = HOST_EEPROM_SIZE; }
+  if (!host_eeprom_path) { memset(host_eeprom, 0xFF, sizeof(host_eeprom)); }
+  host_eeprom_size = size;
+}
+
+uint8_t EEPROMClass::read(int address)
+{
+  if ((address < 0) || ((size_t)address >= host_eeprom_size)) { return(0); }
+  return(host_eeprom[address]);
+}
+
+void EEPROMClass::write(int address, uint8_t value)
+{
+  if ((address < 0) || ((size_t)address >= host_eeprom_size)) { return; }
+  host_eeprom[address] = value;
+}
+
+bool EEPROMClass::commit()
+{
+  if (!host_eeprom_path) { return(true); }
+  FILE *file = fopen(host_eeprom_path, "wb");
+  if (!file) { return(false); }
+  bool ok = (fwrite(host_eeprom, 1, host_eeprom_size, file) == host_eeprom_size);
+  fclose(file);
+  return(ok);
+}
+
+void EEPROMClass::end() { host_eeprom_size = 0; } // The contents stay, as in the flash.
+
+uint8_t *EEPROMClass::getDataPtr() { return(host_eeprom); }
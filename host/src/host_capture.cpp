@@ -0,0 +1,58 @@
+/*
+  host_capture.cpp - records the shift register frames of the simulated board to a file
+  Part of Grbl
+
+  Grbl is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Grbl is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Grbl.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <Arduino.h>
+
+static FILE *capture_file;
+static uint64_t capture_last_cycles;
+
+
+// Appends the frame as the cycles since the previous one, LEB128 coded, and the 32-bit frame,
+// little endian. Most frames are a few hundred cycles apart, so a frame takes 6 to 7 bytes.
+static void host_capture_frame(uint64_t cycles, uint32_t frame)
+{
+  uint8_t record[16];
+  uint8_t length = 0;
+  uint64_t delta = cycles - capture_last_cycles;
+  capture_last_cycles = cycles;
+  do {
+    record[length] = delta & 0x7F;
+    delta >>= 7;
+    if (delta) { record[length] |= 0x80; }
+    length++;
+  } while (delta);
+  for (uint8_t idx=0; idx<4; idx++) { record[length++] = (frame >> (8*idx)) & 0xFF; }
+  fwrite(record, 1, length, capture_file);
+}
+
+
+void host_capture_open(const char *path)
+{
+  capture_file = fopen(path, "wb");
+  if (!capture_file) {
+    perror(path);
+    exit(1);
+  }
+  // Header: magic, format version and the clock of the cycle counts, little endian.
+  uint32_t clock = F_CPU;
+  uint8_t header[9] = { 'G', 'S', 'T', 'C', 1,
+    (uint8_t)clock, (uint8_t)(clock >> 8), (uint8_t)(clock >> 16), (uint8_t)(clock >> 24) };
+  fwrite(header, 1, sizeof(header), capture_file);
+  capture_last_cycles = 0;
+  host_spi_set_hook(host_capture_frame); // The file is flushed by exit().
+}
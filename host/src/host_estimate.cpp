@@ -0,0 +1,172 @@
+/*
+  host_estimate.cpp - cycle time estimator, running a job through the Grbl core in virtual time
+  Part of Grbl
+
+  Grbl is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Grbl is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Grbl.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*
+  The job runs on the simulated board exactly as sent by a g-code sender, with the settings in the
+  EEPROM file, so the parser, planner and segment generator are the firmware's own. Only what the
+  operator would do is changed: A T word selecting another tool first waits for the motion to
+  complete, to account the time from there on to the new tool. M0 pauses are replaced by a buffer
+  sync, so the machine stops as it would, but does not wait. The time the operator takes is not
+  part of the estimate.
+*/
+
+#include <time.h>
+#include <Arduino.h>
+#include "grbl.hpp"
+#include "host_estimate.hpp"
+
+#define ESTIMATE_TOOL_COUNT 32
+
+typedef struct {
+  uint32_t tool;
+  uint64_t cycles;
+} estimate_tool_t;
+
+static estimate_tool_t estimate_tools[ESTIMATE_TOOL_COUNT];
+static uint8_t estimate_tool_count;
+static uint32_t estimate_tool;         // Tool in the spindle.
+static uint32_t estimate_tool_next;    // Tool selected by the line waiting for the sync.
+static uint64_t estimate_tool_start;   // Time the tool went in.
+static uint64_t estimate_start;
+static struct timespec estimate_wall_start;
+
+
+// Adds the time since the tool went in to its total.
+static void estimate_close_tool()
+{
+  uint64_t now = host_cycles();
+  uint8_t idx;
+  for (idx=0; idx<estimate_tool_count; idx++) {
+    if (estimate_tools[idx].tool == estimate_tool) { break; }
+  }
+  if (idx == estimate_tool_count) {
+    if (estimate_tool_count == ESTIMATE_TOOL_COUNT) { idx--; } // Lumps the last ones together.
+    else { estimate_tools[estimate_tool_count++].tool = estimate_tool; }
+  }
+  estimate_tools[idx].cycles += now - estimate_tool_start;
+  estimate_tool_start = now;
+}
+
+
+// Returns the value of the word at line[*idx], and moves past it. Grbl ignores spaces within words.
+static float estimate_word_value(const char *line, uint16_t *idx, bool *is_integer)
+{
+  float value = 0.0;
+  float scale = 0.0; // Set once past the decimal point.
+  *is_integer = true;
+  for (;; (*idx)++) {
+    char c = line[*idx];
+    if (c == ' ') { continue; }
+    if (c == '.') { *is_integer = false; scale = 1.0; continue; }
+    if ((c < '0') || (c > '9')) { break; }
+    if (scale == 0.0) { value = 10.0*value + (c-'0'); }
+    else { scale *= 0.1; value += scale*(c-'0'); }
+  }
+  return(value);
+}
+
+
+uint8_t host_estimate_line(char *line, uint32_t number)
+{
+  if (number == 1) {
+    estimate_start = host_cycles();
+    estimate_tool_start = estimate_start;
+    clock_gettime(CLOCK_MONOTONIC, &estimate_wall_start);
+  }
+
+  uint8_t flags = 0;
+  uint16_t idx = 0;
+  while (line[idx]) {
+    char letter = line[idx];
+    if (letter == ';') { break; } // Comment to the end of the line.
+    if (letter == '(') { // Comment to the closing parenthesis.
+      while (line[idx] && (line[idx] != ')')) { idx++; }
+      if (line[idx]) { idx++; }
+      continue;
+    }
+    if (letter >= 'a' && letter <= 'z') { letter -= 'a'-'A'; }
+    uint16_t word_start = idx++;
+    if ((letter != 'M') && (letter != 'T')) { continue; }
+
+    bool is_integer;
+    float value = estimate_word_value(line, &idx, &is_integer);
+    if (idx == word_start+1) { continue; } // No value. Left for the parser to reject.
+    if (letter == 'T') {
+      if ((uint32_t)value != estimate_tool) {
+        estimate_tool_next = value;
+        flags |= HOST_ESTIMATE_SYNC_BEFORE;
+      }
+    } else if (is_integer && (value == 0)) {
+      memset(&line[word_start], ' ', idx-word_start); // Program pause. Would wait for the operator.
+      flags |= HOST_ESTIMATE_SYNC_AFTER;
+    }
+  }
+  return(flags);
+}
+
+
+void host_estimate_synced()
+{
+  estimate_close_tool();
+  estimate_tool = estimate_tool_next;
+}
+
+
+void host_estimate_error(uint32_t number, const char *reply)
+{
+  fprintf(stderr, "line %u: %s\n", number, reply);
+}
+
+
+static void estimate_print_time(const char *label, double seconds)
+{
+  uint32_t minutes = seconds/60;
+  printf("%-12s %u:%02u:%06.3f (%.3f s)\n", label, minutes/60, minutes%60, seconds-60.0*minutes, seconds);
+}
+
+
+void host_estimate_finish(uint32_t lines, uint32_t errors)
+{
+  estimate_close_tool();
+  double total = (double)(host_cycles()-estimate_start)/F_CPU;
+
+  estimate_print_time("cycle time", total);
+  printf("%-12s %u, %u errors\n", "lines", lines, errors);
+  #ifdef ENABLE_CYCLE_ESTIMATE
+    double accel, cruise, decel;
+    st_get_ramp_time(&accel, &cruise, &decel);
+    double motion = 60.0*(accel+cruise+decel); // Converted to (s)
+    double accel_limited = 60.0*(accel+decel);
+    if (motion > 0.0) {
+      printf("%-12s %.3f s, %.1f%% feed limited, %.1f%% acceleration limited\n", "motion", motion,
+        100.0*(motion-accel_limited)/motion, 100.0*accel_limited/motion);
+    }
+  #endif
+  for (uint8_t idx=0; idx<estimate_tool_count; idx++) {
+    char label[16];
+    snprintf(label, sizeof(label), "tool T%u", estimate_tools[idx].tool);
+    estimate_print_time(label, (double)estimate_tools[idx].cycles/F_CPU);
+  }
+
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  double wall = (now.tv_sec-estimate_wall_start.tv_sec) + 1e-9*(now.tv_nsec-estimate_wall_start.tv_nsec);
+  if (wall > 0.0) { printf("%-12s %.3f s, %.0fx real time\n", "estimated in", wall, total/wall); }
+  fflush(stdout);
+  exit((errors) ? 1 : 0);
+}
@@ -0,0 +1,40 @@
+/*
+  host_estimate.hpp - cycle time estimator hooks of the g-code streamer
+  Part of Grbl
+
+  Grbl is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Grbl is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Grbl.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef host_estimate_h
+#define host_estimate_h
+
+#include <stdint.h>
+
+// Actions the streamer takes for a line, returned by host_estimate_line().
+#define HOST_ESTIMATE_SYNC_BEFORE (1 << 0) // Sync the planner buffer before sending the line.
+#define HOST_ESTIMATE_SYNC_AFTER  (1 << 1) // Sync the planner buffer once the line is answered.
+
+// Inspects and edits the next line before it is sent. Returns its actions.
+uint8_t host_estimate_line(char *line, uint32_t number);
+
+// Called once the sync requested before a line completed, right before the line is sent.
+void host_estimate_synced();
+
+// Called with every error reply.
+void host_estimate_error(uint32_t number, const char *reply);
+
+// Called once the motion of the last line completed. Prints the estimate and exits.
+void host_estimate_finish(uint32_t lines, uint32_t errors);
+
+#endif
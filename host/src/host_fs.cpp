@@ -0,0 +1,145 @@
+/*
+  host_fs.cpp - LittleFS of the simulated board, kept in a directory of the host
+  Part of Grbl
+
+  Grbl is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Grbl is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Grbl.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <dirent.h>
+#include <errno.h>
+#include <sys/stat.h>
+#include <Arduino.h>
+#include <LittleFS.h>
+
+FS LittleFS;
+
+static std::string fs_root = "fs";
+static host_fs_hook_t fs_hook;
+
+
+void host_fs_open(const char *path) { fs_root = path; }
+
+void host_fs_set_hook(host_fs_hook_t hook) { fs_hook = hook; }
+
+
+// Returns the host path of a file system path. These always start with '/'.
+static std::string fs_path(const char *path)
+{
+  if (path[0] != '/') { return(fs_root + "/" + path); }
+  return(fs_root + path);
+}
+
+
+// Creates the directories leading to the host path, like LittleFS does when writing a file.
+static void fs_make_parents(const std::string &path)
+{
+  for (size_t idx = path.find('/', fs_root.length()+1); idx != std::string::npos; idx = path.find('/', idx+1)) {
+    mkdir(path.substr(0, idx).c_str(), 0755);
+  }
+}
+
+
+File::File(FILE *file, const char *name) : _file(file, fclose), _name(name), _size(0)
+{
+  struct stat info;
+  if (fstat(fileno(file), &info) == 0) { _size = info.st_size; }
+}
+
+size_t File::read(uint8_t *buffer, size_t size)
+{
+  if (!_file) { return(0); }
+  return(fread(buffer, 1, size, _file.get()));
+}
+
+size_t File::write(const uint8_t *buffer, size_t size)
+{
+  if (!_file) { return(0); }
+  size_t written = fwrite(buffer, 1, size, _file.get());
+  size_t end = position();
+  if (end > _size) { _size = end; }
+  return(written);
+}
+
+size_t File::position() const
+{
+  if (!_file) { return(0); }
+  long position = ftell(_file.get());
+  return((position < 0) ? 0 : position);
+}
+
+bool File::seek(uint32_t position)
+{
+  if (!_file) { return(false); }
+  return(fseek(_file.get(), position, SEEK_SET) == 0);
+}
+
+
+bool FS::begin()
+{
+  if ((mkdir(fs_root.c_str(), 0755) != 0) && (errno != EEXIST)) {
+    perror(fs_root.c_str());
+    return(false);
+  }
+  return(true);
+}
+
+File FS::open(const char *path, const char *mode)
+{
+  if (fs_hook) { fs_hook(path, mode); }
+  std::string host_path = fs_path(path);
+  if (mode[0] != 'r') { fs_make_parents(host_path); }
+  const char *host_mode = (mode[0] == 'r') ? "rb" : ((mode[0] == 'a') ? "ab" : "wb");
+  FILE *file = fopen(host_path.c_str(), host_mode);
+  if (!file) { return(File()); }
+  const char *name = strrchr(path, '/');
+  return(File(file, (name) ? name+1 : path));
+}
+
+bool FS::exists(const char *path)
+{
+  struct stat info;
+  return(stat(fs_path(path).c_str(), &info) == 0);
+}
+
+bool FS::remove(const char *path) { return(::remove(fs_path(path).c_str()) == 0); }
+
+bool FS::rename(const char *path_from, const char *path_to)
+{
+  std::string host_path_to = fs_path(path_to);
+  fs_make_parents(host_path_to);
+  return(::rename(fs_path(path_from).c_str(), host_path_to.c_str()) == 0);
+}
+
+Dir FS::openDir(const char *path)
+{
+  Dir dir;
+  std::string host_path = fs_path(path);
+  DIR *entries = opendir(host_path.c_str());
+  if (!entries) { return(dir); }
+  std::vector<std::string> names;
+  struct dirent *entry;
+  while ((entry = readdir(entries)) != NULL) {
+    if (entry->d_name[0] != '.') { names.push_back(entry->d_name); }
+  }
+  closedir(entries);
+  std::sort(names.begin(), names.end()); // Same order on every host.
+  for (const std::string &name : names) {
+    struct stat info;
+    if ((stat((host_path + "/" + name).c_str(), &info) == 0) && S_ISREG(info.st_mode)) {
+      dir._names.push_back(name);
+      dir._sizes.push_back(info.st_size);
+    }
+  }
+  return(dir);
+}
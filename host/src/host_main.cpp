@@ -0,0 +1,80 @@
+/*
+  host_main.cpp - entry point of the host build, running the Grbl setup() and loop()
+  Part of Grbl
+
+  Grbl is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Grbl is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Grbl.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <Arduino.h>
+
+void setup(void);
+void loop(void);
+
+
+static void host_usage(const char *name)
+{
+  fprintf(stderr,
+    "usage: %s [--pty | --stdio | --stream FILE | --estimate FILE] [--realtime | --fast] [--eeprom FILE] [--fs DIR] [--capture FILE]\n"
+    "  --pty           Serial port on a new pseudo terminal for a g-code sender. Default.\n"
+    "  --stdio         Serial port on stdin and stdout.\n"
+    "  --stream FILE   Send FILE line by line, then exit when done. 1 on any error or alarm.\n"
+    "  --estimate FILE Run FILE like --stream and print its cycle time instead of the output.\n"
+    "  --realtime      Keep machine time in step with the wall clock. Default, unless streaming.\n"
+    "  --fast          Run as fast as the host allows.\n"
+    "  --eeprom FILE   Keep the settings in FILE across runs.\n"
+    "  --fs DIR        Keep the LittleFS files in DIR. Default ./fs.\n"
+    "  --capture FILE  Record the shift register frames to FILE, for tools/step_trace.py.\n", name);
+  exit(2);
+}
+
+
+int main(int argc, char *argv[])
+{
+  const char *stream_path = NULL;
+  bool estimate = false;
+  const char *eeprom_path = NULL;
+  const char *capture_path = NULL;
+  bool use_stdio = false;
+  int realtime = -1; // Depends on the mode, unless given.
+
+  for (int idx=1; idx<argc; idx++) {
+    if (strcmp(argv[idx], "--pty") == 0) { use_stdio = false; stream_path = NULL; }
+    else if (strcmp(argv[idx], "--stdio") == 0) { use_stdio = true; stream_path = NULL; }
+    else if ((strcmp(argv[idx], "--stream") == 0) && (idx+1 < argc)) { stream_path = argv[++idx]; estimate = false; }
+    else if ((strcmp(argv[idx], "--estimate") == 0) && (idx+1 < argc)) { stream_path = argv[++idx]; estimate = true; }
+    else if (strcmp(argv[idx], "--realtime") == 0) { realtime = 1; }
+    else if (strcmp(argv[idx], "--fast") == 0) { realtime = 0; }
+    else if ((strcmp(argv[idx], "--eeprom") == 0) && (idx+1 < argc)) { eeprom_path = argv[++idx]; }
+    else if ((strcmp(argv[idx], "--fs") == 0) && (idx+1 < argc)) { host_fs_open(argv[++idx]); }
+    else if ((strcmp(argv[idx], "--capture") == 0) && (idx+1 < argc)) { capture_path = argv[++idx]; }
+    else { host_usage(argv[0]); }
+  }
+
+  if (eeprom_path) { host_eeprom_open(eeprom_path); }
+  if (capture_path) { host_capture_open(capture_path); }
+  if (stream_path) {
+    if (estimate) { host_serial_estimate(stream_path); }
+    else { host_serial_stream(stream_path); }
+    if (realtime < 0) { realtime = 0; }
+  } else if (use_stdio) {
+    host_serial_open_stdio();
+  } else {
+    fprintf(stderr, "host: serial port on %s\n", host_serial_open_pty());
+  }
+  host_set_realtime(realtime != 0);
+
+  setup();
+  for (;;) { loop(); } // Grbl's loop() only returns on a reset.
+  return(0);
+}
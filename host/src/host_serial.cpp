@@ -0,0 +1,318 @@
+/*
+  host_serial.cpp - UART0 of the simulated board, connected to a pty, stdio or a g-code streamer
+  Part of Grbl
+
+  Grbl is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Grbl is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Grbl.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <fcntl.h>
+#include <termios.h>
+#include <unistd.h>
+#include <Arduino.h>
+#include "host_estimate.hpp"
+
+#define HOST_UART_FIFO_SIZE 128
+#define HOST_UART_POLL_MS 1 // Idle line polling interval.
+#define HOST_STREAM_LINE_SIZE 256
+
+#define HOST_SERIAL_NONE   0 // Output to stdout. No input.
+#define HOST_SERIAL_FD     1 // pty or stdio.
+#define HOST_SERIAL_STREAM 2
+
+volatile uint32_t host_uart_reg;
+
+static uint8_t serial_mode;
+static int serial_in_fd = -1;
+static int serial_out_fd = STDOUT_FILENO;
+static unsigned long serial_baud = 115200;
+static uint64_t serial_next_poll;
+
+static uint8_t uart_fifo[HOST_UART_FIFO_SIZE];
+static uint8_t uart_fifo_head;
+static uint8_t uart_fifo_count;
+static void (*uart_isr)(void *);
+static void *uart_isr_arg;
+static bool uart_isr_enabled;
+
+// Send-response streamer state.
+static FILE *stream_file;
+static char stream_line[HOST_STREAM_LINE_SIZE+1]; // Plus the newline.
+static uint16_t stream_line_length;
+static uint16_t stream_line_sent;
+static bool stream_ready;     // Waiting for the banner first. Grbl clears its input on start up.
+static bool stream_waiting;   // Line sent and not yet answered.
+static bool stream_finishing; // Final buffer sync sent.
+static uint32_t stream_lines;
+static uint32_t stream_errors;
+static char stream_reply[HOST_STREAM_LINE_SIZE];
+static uint16_t stream_reply_length;
+
+// Cycle time estimator state. See host_estimate.cpp.
+static bool stream_estimate;
+static uint8_t stream_flags;  // Estimator actions for the line sent.
+static bool stream_syncing;   // Syncing the planner buffer between lines.
+static bool stream_holding;   // Sending the held line, once synced.
+static char stream_held[HOST_STREAM_LINE_SIZE];
+
+
+static uint64_t serial_byte_cycles() { return((uint64_t)F_CPU*10/serial_baud); }
+
+
+static void serial_fifo_put(uint8_t data)
+{
+  uart_fifo[(uart_fifo_head + uart_fifo_count) % HOST_UART_FIFO_SIZE] = data;
+  uart_fifo_count++;
+}
+
+
+// Returns the next byte the line delivers, or -1 if there is none right now.
+static int serial_line_read()
+{
+  if (serial_mode == HOST_SERIAL_FD) {
+    uint8_t data;
+    if (read(serial_in_fd, &data, 1) == 1) { return(data); }
+    return(-1);
+  }
+  if ((serial_mode == HOST_SERIAL_STREAM) && stream_waiting && (stream_line_sent < stream_line_length)) {
+    return((uint8_t)stream_line[stream_line_sent++]);
+  }
+  return(-1);
+}
+
+
+uint64_t host_uart_next_event()
+{
+  if ((serial_mode == HOST_SERIAL_NONE) && !uart_fifo_count) { return(UINT64_MAX); }
+  if ((serial_mode == HOST_SERIAL_STREAM) && !(stream_waiting && (stream_line_sent < stream_line_length))) {
+    return(UINT64_MAX); // Nothing to send until Grbl answers.
+  }
+  return(serial_next_poll);
+}
+
+
+// Moves the bytes arrived since the last call into the FIFO and raises the receive interrupt.
+void host_uart_service()
+{
+  uint8_t count = 0;
+  int data;
+  while ((uart_fifo_count < HOST_UART_FIFO_SIZE) && ((data = serial_line_read()) >= 0)) {
+    serial_fifo_put(data);
+    count++;
+  }
+  // The line is busy for as long as it took to send the bytes.
+  if (count) { serial_next_poll = host_cycles() + count*serial_byte_cycles(); }
+  else { serial_next_poll = host_cycles() + (uint64_t)HOST_UART_POLL_MS*(F_CPU/1000L); }
+  if (uart_fifo_count && uart_isr && uart_isr_enabled) { uart_isr(uart_isr_arg); }
+}
+
+
+uint32_t host_uart_status() { return(uart_fifo_count << USRXC); }
+
+uint8_t host_uart_fifo_read()
+{
+  if (uart_fifo_count == 0) { return(0); }
+  uint8_t data = uart_fifo[uart_fifo_head];
+  uart_fifo_head = (uart_fifo_head+1) % HOST_UART_FIFO_SIZE;
+  uart_fifo_count--;
+  return(data);
+}
+
+void host_uart_receive(const uint8_t *data, uint16_t size)
+{
+  while (size-- && (uart_fifo_count < HOST_UART_FIFO_SIZE)) { serial_fifo_put(*(data++)); }
+  serial_next_poll = host_cycles();
+}
+
+void host_uart_attach(void (*isr)(void *), void *arg) { uart_isr = isr; uart_isr_arg = arg; }
+void host_uart_enable(bool enable) { uart_isr_enabled = enable; }
+
+
+static void stream_send(const char *line)
+{
+  strcpy(stream_line, line);
+  stream_line_length = strlen(line);
+  stream_line[stream_line_length++] = '\n';
+  stream_line_sent = 0;
+  stream_waiting = true;
+  serial_next_poll = host_cycles();
+}
+
+
+// Sends the next line of the file, or the final sync at its end.
+static void stream_next()
+{
+  char line[HOST_STREAM_LINE_SIZE];
+  if (!stream_file || !fgets(line, sizeof(line), stream_file)) {
+    // Wait for the motion to complete. A dwell syncs the planner buffer before it answers.
+    stream_finishing = true;
+    stream_send("G4P0");
+    return;
+  }
+  line[strcspn(line, "\r\n")] = 0;
+  stream_lines++;
+  if (stream_estimate) {
+    stream_flags = host_estimate_line(line, stream_lines);
+    if (stream_flags & HOST_ESTIMATE_SYNC_BEFORE) {
+      strcpy(stream_held, line);
+      stream_holding = true;
+      stream_syncing = true;
+      stream_send("G4P0");
+      return;
+    }
+  }
+  stream_send(line);
+}
+
+
+static void stream_finish()
+{
+  if (stream_estimate) { host_estimate_finish(stream_lines, stream_errors); }
+  fprintf(stderr, "host: %u lines, %u errors, %.3f s machine time\n", stream_lines, stream_errors,
+    (double)host_cycles()/F_CPU);
+  exit((stream_errors) ? 1 : 0);
+}
+
+
+// Follows Grbl's replies to pace the streamer.
+static void stream_reply_line()
+{
+  stream_reply[stream_reply_length] = 0;
+  if (!stream_ready) {
+    if (strncmp(stream_reply, "Grbl ", 5) != 0) { return; }
+    stream_ready = true;
+    stream_next();
+  } else if ((strcmp(stream_reply, "ok") == 0) || (strncmp(stream_reply, "error:", 6) == 0)) {
+    if (stream_reply[0] == 'e') {
+      stream_errors++;
+      if (stream_estimate) { host_estimate_error(stream_lines, stream_reply); }
+    }
+    stream_waiting = false;
+    if (stream_finishing) { stream_finish(); }
+    if (stream_syncing) {
+      stream_syncing = false;
+      if (stream_holding) { // Send the held line.
+        stream_holding = false;
+        host_estimate_synced();
+        stream_send(stream_held);
+        return;
+      }
+    } else if (stream_flags & HOST_ESTIMATE_SYNC_AFTER) {
+      stream_flags = 0;
+      stream_syncing = true;
+      stream_send("G4P0");
+      return;
+    }
+    stream_flags = 0;
+    stream_next();
+  } else if (strncmp(stream_reply, "ALARM:", 6) == 0) {
+    stream_errors++;
+    if (stream_estimate) { // Nothing runs after an alarm.
+      fprintf(stderr, "host: %s at line %u\n", stream_reply, stream_lines);
+      exit(1);
+    }
+  }
+}
+
+
+void HardwareSerial::begin(unsigned long baud) { serial_baud = baud; }
+
+int HardwareSerial::available()
+{
+  if (!uart_isr) { host_uart_service(); } // Polled by the serial poll task instead.
+  return(uart_fifo_count);
+}
+
+int HardwareSerial::read()
+{
+  if (uart_fifo_count == 0) { return(-1); }
+  return(host_uart_fifo_read());
+}
+
+size_t HardwareSerial::write(uint8_t c) { return(write(&c, 1)); }
+
+size_t HardwareSerial::write(const uint8_t *buffer, size_t size)
+{
+  if (serial_mode == HOST_SERIAL_STREAM) {
+    for (size_t idx=0; idx<size; idx++) {
+      if (buffer[idx] == '\n') {
+        if (stream_reply_length && (stream_reply[stream_reply_length-1] == '\r')) { stream_reply_length--; }
+        stream_reply_line();
+        stream_reply_length = 0;
+      } else if (stream_reply_length < HOST_STREAM_LINE_SIZE-1) {
+        stream_reply[stream_reply_length++] = buffer[idx];
+      }
+    }
+  }
+  if (serial_out_fd >= 0) {
+    // Drops output nobody reads, like a UART does.
+    if (::write(serial_out_fd, buffer, size) < 0) { return(size); }
+  }
+  return(size);
+}
+
+
+static void serial_set_raw(int fd)
+{
+  struct termios attributes;
+  if (tcgetattr(fd, &attributes) == 0) {
+    cfmakeraw(&attributes);
+    tcsetattr(fd, TCSANOW, &attributes);
+  }
+}
+
+
+const char *host_serial_open_pty()
+{
+  int fd = posix_openpt(O_RDWR | O_NOCTTY);
+  if ((fd < 0) || (grantpt(fd) != 0) || (unlockpt(fd) != 0)) {
+    perror("host: pty");
+    exit(1);
+  }
+  serial_set_raw(fd);
+  fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+  serial_mode = HOST_SERIAL_FD;
+  serial_in_fd = fd;
+  serial_out_fd = fd;
+  return(ptsname(fd));
+}
+
+
+void host_serial_open_stdio()
+{
+  fcntl(STDIN_FILENO, F_SETFL, fcntl(STDIN_FILENO, F_GETFL) | O_NONBLOCK);
+  if (isatty(STDIN_FILENO)) { serial_set_raw(STDIN_FILENO); }
+  serial_mode = HOST_SERIAL_FD;
+  serial_in_fd = STDIN_FILENO;
+  serial_out_fd = STDOUT_FILENO;
+}
+
+
+void host_serial_stream(const char *path)
+{
+  stream_file = fopen(path, "r");
+  if (!stream_file) {
+    perror(path);
+    exit(1);
+  }
+  serial_mode = HOST_SERIAL_STREAM;
+  serial_out_fd = STDOUT_FILENO;
+}
+
+
+void host_serial_estimate(const char *path)
+{
+  host_serial_stream(path);
+  stream_estimate = true;
+  serial_out_fd = -1; // Only the estimate is printed.
+}
@@ -0,0 +1,23 @@
+(Arcs in all three planes, full circles and a helix)
+$100=80
+$101=80
+$102=400
+$110=3000
+$111=3000
+$112=600
+$120=200
+$121=200
+$122=50
+G21G90G17
+G0X10Y10
+G2X20Y10I5J0F1500
+G3X10Y10I-5J0
+G2X10Y10I0J4F2000
+G3X14Y14R4
+G2X18Y10R-4
+G18G0Z0
+G2X22Z4I2K2F600
+G19G3Y14Z0J2K-2
+G17G0X10Y10Z0
+G3X10Y10I3J0Z-2F800
+G0Z0X0Y0
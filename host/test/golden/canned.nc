@@ -0,0 +1,22 @@
+(Canned drilling cycles with both retract modes, repeats and incremental positions)
+$100=80
+$101=80
+$102=400
+$110=3000
+$111=3000
+$112=600
+$120=200
+$121=200
+$122=50
+G21G90G17
+G0X0Y0Z5
+G98G81X5Y5Z-2R1F300
+X10
+G99G82X15Y5Z-1.5R1P0.2
+G83X20Y5Z-4R1Q1.5
+G73X25Y5Z-3R1Q1
+G80
+G0Z5
+G91G99G81X2Y0Z-3R-4L4F400
+G80
+G90G0X0Y0Z0
@@ -0,0 +1,33 @@
+(Straight moves: rapids, feeds, junctions of every angle and short segments)
+$100=80
+$101=80
+$102=400
+$110=3000
+$111=3000
+$112=600
+$120=200
+$121=200
+$122=50
+G21G90G17G94
+G0X10Y5
+G1X20F1200
+G1Y15
+G1X10Y20F2000
+G1X5Y10
+G1X10Y5
+G0Z2
+G1Z-1F200
+G1X10.5Y5.2F1500
+G1X11Y5.1
+G1X11.5Y5.4
+G1X12Y5.2
+G1X12.5Y5.6
+G1X13Y5.3
+G1X13.5Y5.8
+G1X14Y5.4
+G1X30Y5F3000
+G1X30.2Y25
+G1X0Y0Z0F800
+G0X15Y15
+G1X15.01Y15.01F100
+G0X0Y0
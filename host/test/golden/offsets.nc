@@ -0,0 +1,30 @@
+(Work offsets, inches, incremental distances, machine coordinates and G28)
+$100=80
+$101=80
+$102=400
+$110=3000
+$111=3000
+$112=600
+$120=200
+$121=200
+$122=50
+G21G90
+G10L2P1X5Y5
+G10L2P2X-3Y2Z-1
+G54G0X0Y0
+G1X10F1500
+G55G1X0Y0
+G1Z1F300
+G10L20P1X0Y0
+G54G1X2Y2F1000
+G92X0Y0
+G1X3Y1
+G92.1
+G20G1X0.25Y0.5F40
+G91G1X-0.1Y-0.1
+G90G21
+G53G0X1Y1
+G28.1
+G0X20Y20
+G28
+G54G0X0Y0Z0
@@ -0,0 +1,108 @@
+/*
+  test.hpp - checks for the host tests of the Grbl core
+  Part of Grbl
+
+  Grbl is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Grbl is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Grbl.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef test_h
+#define test_h
+
+/*
+  Each test is a program of its own, linked with the Grbl core and the simulated board, and run by
+  make -C host test in a scratch directory. Grbl's output goes to stdout, the failed checks to
+  stderr. The exit status is 1, if any check failed.
+*/
+
+#include <stdio.h>
+#include <math.h>
+#include <unistd.h>
+#include <string>
+#include <host.hpp>
+#include "grbl.hpp"
+
+static int test_failures;
+
+#define TEST_CHECK(condition) test_check((condition), #condition, __FILE__, __LINE__)
+#define TEST_EQUAL(actual, expected) test_equal((long long)(actual), (long long)(expected), #actual, __FILE__, __LINE__)
+#define TEST_NEAR(actual, expected, tolerance) \
+  test_near((double)(actual), (double)(expected), (tolerance), #actual, __FILE__, __LINE__)
+
+static inline bool test_check(bool condition, const char *text, const char *file, int line)
+{
+  if (!condition) {
+    fprintf(stderr, "%s:%d: check failed: %s\n", file, line, text);
+    test_failures++;
+  }
+  return(condition);
+}
+
+static inline bool test_equal(long long actual, long long expected, const char *text, const char *file, int line)
+{
+  if (actual != expected) {
+    fprintf(stderr, "%s:%d: %s is %lld, expected %lld\n", file, line, text, actual, expected);
+    test_failures++;
+  }
+  return(actual == expected);
+}
+
+static inline bool test_near(double actual, double expected, double tolerance, const char *text,
+                             const char *file, int line)
+{
+  if (!(fabs(actual - expected) <= tolerance)) {
+    fprintf(stderr, "%s:%d: %s is %.9g, expected %.9g\n", file, line, text, actual, expected);
+    test_failures++;
+    return(false);
+  }
+  return(true);
+}
+
+// Boots Grbl with host_boot(). The settings are the defaults, unless the scratch directory holds
+// saved ones.
+static inline void test_boot() { host_boot(); }
+
+// Collects Grbl's output, written to stdout, until test_capture_end().
+static int test_capture_fd = -1;
+static FILE *test_capture_file;
+
+static inline void test_capture_begin()
+{
+  fflush(stdout);
+  test_capture_file = tmpfile();
+  test_capture_fd = dup(STDOUT_FILENO);
+  dup2(fileno(test_capture_file), STDOUT_FILENO);
+}
+
+static inline std::string test_capture_end()
+{
+  std::string output;
+  char buffer[256];
+  size_t length;
+  fflush(stdout);
+  dup2(test_capture_fd, STDOUT_FILENO);
+  close(test_capture_fd);
+  rewind(test_capture_file);
+  while ((length = fread(buffer, 1, sizeof(buffer), test_capture_file)) > 0) { output.append(buffer, length); }
+  fclose(test_capture_file);
+  return(output);
+}
+
+// Returns the exit status of the test.
+static inline int test_done(const char *name)
+{
+  if (test_failures) { fprintf(stderr, "%s: %d checks failed\n", name, test_failures); }
+  return((test_failures) ? 1 : 0);
+}
+
+#endif
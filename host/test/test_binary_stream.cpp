@@ -0,0 +1,309 @@
+/*
+  test_binary_stream.cpp - framing, CRC and varint decoding of the binary streaming protocol
+  Part of Grbl
+
+  Grbl is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Grbl is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Grbl.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <string>
+#include <vector>
+#include <Ticker.h>
+#include "test.hpp"
+
+#define CLIENT CLIENT_SERIAL
+
+// Bytes as the sender puts them on the wire.
+typedef std::vector<uint8_t> bytes_t;
+
+static std::string rx_text;       // Bytes the receive filter passed on for realtime filtering.
+static std::vector<uint8_t> rx_status; // Statuses of the frames decoded.
+
+
+// CRC-8, poly 0x07, bit by bit. The reference the firmware is checked against.
+static uint8_t crc8(const uint8_t *data, size_t size)
+{
+  uint8_t crc = 0;
+  while (size--) {
+    crc ^= *(data++);
+    for (int bit=0; bit<8; bit++) { crc = (crc & 0x80) ? (crc << 1) ^ 0x07 : (crc << 1); }
+  }
+  return(crc);
+}
+
+
+static void put_varint(bytes_t &payload, int32_t value)
+{
+  uint32_t raw = ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+  do {
+    uint8_t data = raw & 0x7F;
+    raw >>= 7;
+    payload.push_back(data | ((raw) ? 0x80 : 0));
+  } while (raw);
+}
+
+static void put_command(bytes_t &payload, char letter, uint16_t value_x10)
+{
+  payload.push_back((BS_TOKEN_COMMAND << 5) | (letter-'A'));
+  payload.push_back(value_x10 & 0xFF);
+  payload.push_back(value_x10 >> 8);
+}
+
+static void put_value(bytes_t &payload, uint8_t token, char letter, int32_t fixed)
+{
+  payload.push_back((token << 5) | (letter-'A'));
+  put_varint(payload, fixed);
+}
+
+static bytes_t frame(const bytes_t &payload)
+{
+  bytes_t wire = { BS_FRAME_START, (uint8_t)payload.size() };
+  wire.insert(wire.end(), payload.begin(), payload.end());
+  wire.push_back(crc8(&wire[1], wire.size()-1));
+  return(wire);
+}
+
+
+// Passes the bytes through the receive filter as the serial receive interrupt does, then through
+// the decoder as the protocol does, in check mode.
+static void receive(const bytes_t &wire)
+{
+  bytes_t buffered;
+  for (uint8_t data : wire) {
+    uint8_t kind, pad;
+    while ((kind = bs_rx_filter(CLIENT, data, &pad)) == BS_RX_PAD) { buffered.push_back(pad); }
+    if (kind == BS_RX_FRAME) { buffered.push_back(data); }
+    else { rx_text += (char)data; }
+  }
+  for (uint8_t data : buffered) {
+    if ((data != BS_FRAME_START) && !bs_frame_active(CLIENT)) { continue; }
+    uint8_t status = bs_frame_read(CLIENT, data);
+    if (status == BS_FRAME_PENDING) { continue; }
+    if (status == STATUS_OK) { status = bs_frame_execute(CLIENT); }
+    rx_status.push_back(status);
+  }
+}
+
+static uint8_t receive_frame(const bytes_t &wire)
+{
+  rx_status.clear();
+  receive(wire);
+  return((rx_status.size() == 1) ? rx_status[0] : 0xFE);
+}
+
+
+static void test_crc()
+{
+  const char *check = "123456789";
+  TEST_EQUAL(crc8((const uint8_t*)check, 9), 0xF4); // CRC-8/SMBUS check value.
+
+  bytes_t payload;
+  put_command(payload, 'G', 0);
+  put_value(payload, BS_TOKEN_ABSOLUTE, 'X', 10000);
+  bytes_t wire = frame(payload);
+  for (size_t idx=1; idx<wire.size(); idx++) {
+    for (int bit=0; bit<8; bit++) {
+      bytes_t damaged = wire;
+      damaged[idx] ^= 1 << bit;
+      if ((idx == 1) && ((damaged[1] == 0) || (damaged[1] > BS_FRAME_MAX_PAYLOAD))) { continue; }
+      if ((idx == 1) && (damaged[1] > wire[1])) { continue; } // Would wait for more payload.
+      receive_frame(damaged);
+      TEST_CHECK((rx_status.size() >= 1) && (rx_status[0] != STATUS_OK));
+      bs_reset(CLIENT);
+    }
+  }
+  TEST_EQUAL(receive_frame(wire), STATUS_OK);
+}
+
+
+static void test_values()
+{
+  bytes_t payload;
+  put_command(payload, 'G', 10);
+  put_value(payload, BS_TOKEN_ABSOLUTE, 'X', 123456);   // 12.3456
+  put_value(payload, BS_TOKEN_ABSOLUTE, 'Y', -5000);    // -0.5
+  put_value(payload, BS_TOKEN_ABSOLUTE, 'Z', 0);
+  put_value(payload, BS_TOKEN_ABSOLUTE, 'F', 10000000); // 1000, a four byte varint
+  TEST_EQUAL(receive_frame(frame(payload)), STATUS_OK);
+  TEST_NEAR(gc_state.position[X_AXIS], 12.3456, 1e-4);
+  TEST_NEAR(gc_state.position[Y_AXIS], -0.5, 1e-6);
+  TEST_NEAR(gc_state.feed_rate, 1000.0, 1e-3);
+
+  // Deltas add to the last value of the letter, including negative and multi-byte ones.
+  payload.clear();
+  put_value(payload, BS_TOKEN_DELTA, 'X', 10000);
+  put_value(payload, BS_TOKEN_DELTA, 'Y', -1500000);
+  TEST_EQUAL(receive_frame(frame(payload)), STATUS_OK);
+  TEST_NEAR(gc_state.position[X_AXIS], 13.3456, 1e-4);
+  TEST_NEAR(gc_state.position[Y_AXIS], -150.5, 1e-4);
+
+  // The largest values of a 32-bit varint decode without overflow. Grbl rejects them as targets.
+  payload.clear();
+  put_command(payload, 'G', 40);
+  put_value(payload, BS_TOKEN_ABSOLUTE, 'P', 2147483647);
+  TEST_EQUAL(receive_frame(frame(payload)), STATUS_OK);
+
+  // A new start after a reset, which clears the delta history.
+  bs_reset(CLIENT);
+  payload.clear();
+  put_value(payload, BS_TOKEN_DELTA, 'X', 20000);
+  TEST_EQUAL(receive_frame(frame(payload)), STATUS_OK);
+  TEST_NEAR(gc_state.position[X_AXIS], 2.0, 1e-6);
+}
+
+
+static void test_invalid()
+{
+  bytes_t payload;
+
+  // A varint cut off by the end of the payload, one longer than 32 bits, and one past 32 bits in its
+  // fifth byte.
+  payload = { (BS_TOKEN_ABSOLUTE << 5) | ('X'-'A'), 0x80 };
+  TEST_EQUAL(receive_frame(frame(payload)), STATUS_BINARY_FRAME_INVALID);
+  payload = { (BS_TOKEN_ABSOLUTE << 5) | ('X'-'A'), 0x80, 0x80, 0x80, 0x80, 0x80, 0x01 };
+  TEST_EQUAL(receive_frame(frame(payload)), STATUS_BINARY_FRAME_INVALID);
+  payload = { (BS_TOKEN_ABSOLUTE << 5) | ('X'-'A'), 0x80, 0x80, 0x80, 0x80, 0x10 }; // 2^32
+  TEST_EQUAL(receive_frame(frame(payload)), STATUS_BINARY_FRAME_INVALID);
+
+  // A command without its two value bytes, an unknown encoding and a letter past Z.
+  payload = { (BS_TOKEN_COMMAND << 5) | ('G'-'A'), 10 };
+  TEST_EQUAL(receive_frame(frame(payload)), STATUS_BINARY_FRAME_INVALID);
+  payload = { (3 << 5) | ('X'-'A'), 0 };
+  TEST_EQUAL(receive_frame(frame(payload)), STATUS_BINARY_FRAME_INVALID);
+  payload = { (BS_TOKEN_ABSOLUTE << 5) | 26, 0 };
+  TEST_EQUAL(receive_frame(frame(payload)), STATUS_BINARY_FRAME_INVALID);
+
+  // An invalid frame doesn't touch the delta history.
+  payload.clear();
+  put_value(payload, BS_TOKEN_ABSOLUTE, 'X', 50000);
+  TEST_EQUAL(receive_frame(frame(payload)), STATUS_OK);
+  payload.clear();
+  put_value(payload, BS_TOKEN_DELTA, 'X', 10000);
+  payload.push_back((3 << 5) | ('Y'-'A'));
+  TEST_EQUAL(receive_frame(frame(payload)), STATUS_BINARY_FRAME_INVALID);
+  payload.pop_back();
+  TEST_EQUAL(receive_frame(frame(payload)), STATUS_OK);
+  TEST_NEAR(gc_state.position[X_AXIS], 6.0, 1e-6);
+
+  // Invalid lengths end the frame at once. The next bytes are text again.
+  rx_text.clear();
+  TEST_EQUAL(receive_frame({ BS_FRAME_START, 0, '!' }), STATUS_BINARY_FRAME_INVALID);
+  TEST_EQUAL(receive_frame({ BS_FRAME_START, BS_FRAME_MAX_PAYLOAD+1, '~' }), STATUS_BINARY_FRAME_INVALID);
+  TEST_CHECK(rx_text == "!~");
+}
+
+
+static void test_realtime_bytes()
+{
+  // Realtime command characters within a frame are frame data.
+  bytes_t payload;
+  put_command(payload, 'F', '!' | ('?' << 8));
+  put_command(payload, 'S', 0x18 | ('~' << 8));
+  rx_text.clear();
+  TEST_EQUAL(receive_frame(frame(payload)), STATUS_OK);
+  TEST_CHECK(rx_text.empty());
+
+  // After a reset mid-frame, they are realtime commands again.
+  rx_status.clear();
+  receive({ BS_FRAME_START, 5, 0x21 });
+  bs_reset(CLIENT_ALL);
+  receive({ '!', 0x18 });
+  TEST_CHECK(rx_text == std::string("!\x18"));
+  TEST_CHECK(rx_status.empty());
+  TEST_CHECK(!bs_frame_active(CLIENT));
+}
+
+
+static void test_timeout()
+{
+  const uint64_t timeout = (uint64_t)BS_FRAME_TIMEOUT*(F_CPU/1000);
+  bytes_t payload;
+  put_command(payload, 'G', 10);
+  put_value(payload, BS_TOKEN_ABSOLUTE, 'X', 70000);
+  bytes_t wire = frame(payload);
+
+  // Slow bytes, within the timeout, make up a frame.
+  rx_status.clear();
+  for (uint8_t data : wire) {
+    receive({ data });
+    host_advance(timeout/2);
+  }
+  TEST_EQUAL(rx_status.size(), 1);
+  TEST_EQUAL(rx_status[0], STATUS_OK);
+  TEST_NEAR(gc_state.position[X_AXIS], 7.0, 1e-6);
+
+  // A sender stopping mid-frame. The frame fails and the next byte is a realtime command.
+  for (size_t cut = 1; cut < wire.size(); cut++) {
+    rx_status.clear();
+    rx_text.clear();
+    receive(bytes_t(wire.begin(), wire.begin()+cut));
+    host_advance(timeout+1);
+    receive({ '!' });
+    TEST_CHECK(rx_text == "!");
+    TEST_EQUAL(rx_status.size(), 1);
+    TEST_CHECK(rx_status.size() && (rx_status[0] == ((cut == 1) ? STATUS_BINARY_FRAME_INVALID : STATUS_BINARY_FRAME_CHECKSUM)));
+    TEST_CHECK(!bs_frame_active(CLIENT));
+  }
+  TEST_NEAR(gc_state.position[X_AXIS], 7.0, 1e-6);
+
+  // Then the stream goes on.
+  TEST_EQUAL(receive_frame(wire), STATUS_OK);
+}
+
+
+static void stop_main_loop() { mc_reset_request(); }
+
+// Frames through the UART and the main loop, as a sender streams them. All byte values reach the
+// decoder, 0xFF too, which the loop once took for an empty buffer.
+static void test_protocol()
+{
+  bytes_t payload, wire, next;
+  put_command(payload, 'G', 0);
+  put_value(payload, BS_TOKEN_ABSOLUTE, 'X', -128); // Varint ff 01.
+  wire = frame(payload);
+  payload.clear();
+  put_value(payload, BS_TOKEN_ABSOLUTE, 'Y', 5000);
+  next = frame(payload);
+  wire.insert(wire.end(), next.begin(), next.end());
+  for (char c : std::string("G0Z1\n")) { wire.push_back(c); }
+
+  bs_reset(CLIENT_ALL);
+  sys.state = STATE_IDLE;
+  test_capture_begin();
+  host_uart_receive(wire.data(), wire.size());
+  Ticker stop;
+  stop.once_ms(2000, stop_main_loop);
+  protocol_main_loop(); // Until the reset.
+  std::string output = test_capture_end();
+  size_t start = 0;
+  while (output.compare(start, 1, ">") == 0) { start = output.find('\n', start)+1; } // Startup lines.
+  TEST_CHECK(output.compare(start, 12, "ok\r\nok\r\nok\r\n") == 0);
+  if (test_failures) { fprintf(stderr, "output: %s\n", output.c_str()); }
+  TEST_NEAR(gc_state.position[X_AXIS], -0.0128, 1e-6);
+  TEST_NEAR(gc_state.position[Y_AXIS], 0.5, 1e-6);
+  TEST_NEAR(gc_state.position[Z_AXIS], 1.0, 1e-6);
+}
+
+
+int main()
+{
+  test_boot();
+  sys.state = STATE_CHECK_MODE; // Parse only.
+  test_crc();
+  test_values();
+  test_invalid();
+  test_realtime_bytes();
+  test_timeout();
+  test_protocol();
+  return(test_done("test_binary_stream"));
+}
@@ -0,0 +1,120 @@
+/*
+  test_canned_cycles.cpp - hole counts and L word checks of the G81 family of canned cycles
+  Part of Grbl
+
+  Grbl is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Grbl is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Grbl.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <unistd.h>
+#include "test.hpp"
+
+// Lines as the protocol passes them on, without spaces.
+static uint8_t execute(const char *line)
+{
+  char buffer[LINE_BUFFER_SIZE];
+  strcpy(buffer, line);
+  return(gc_execute_line(buffer, CLIENT_SERIAL));
+}
+
+
+// Incremental repeats step from the start to the last hole. The position ends at the last one.
+static void test_repeats()
+{
+  TEST_EQUAL(execute("G91G81X2Y1Z-1R1L3F100"), STATUS_OK);
+  TEST_NEAR(gc_state.position[X_AXIS], 6.0, 1e-5);
+  TEST_NEAR(gc_state.position[Y_AXIS], 3.0, 1e-5);
+  TEST_NEAR(gc_state.position[Z_AXIS], 1.0, 1e-5); // G98 retracts to the R level above the start.
+  TEST_EQUAL(execute("G80"), STATUS_OK);
+
+  // The largest count. The loop must end.
+  TEST_EQUAL(execute("G91G81X1Y0Z-1R0L255"), STATUS_OK);
+  TEST_NEAR(gc_state.position[X_AXIS], 261.0, 1e-3);
+  TEST_EQUAL(execute("G80"), STATUS_OK);
+}
+
+
+// L values which don't fit the uint8_t count are rejected, instead of wrapping around.
+static void test_invalid_counts()
+{
+  float x = gc_state.position[X_AXIS];
+  TEST_EQUAL(execute("G91G81X1Y0Z-1R0L256"), STATUS_GCODE_MAX_VALUE_EXCEEDED);
+  TEST_EQUAL(execute("G91G81X1Y0Z-1R0L1000"), STATUS_GCODE_MAX_VALUE_EXCEEDED);
+  TEST_EQUAL(execute("G91G81X1Y0Z-1R0L-1"), STATUS_NEGATIVE_VALUE);
+  TEST_EQUAL(execute("G91G81X1Y0Z-1R0L0"), STATUS_GCODE_UNSUPPORTED_COMMAND);
+  TEST_NEAR(gc_state.position[X_AXIS], x, 1e-5);
+
+  // G10 shares the L word. Its axis words need a motion mode other than G80.
+  TEST_EQUAL(execute("G0"), STATUS_OK);
+  TEST_EQUAL(execute("G10L258P1X0"), STATUS_GCODE_MAX_VALUE_EXCEEDED);
+  TEST_EQUAL(execute("G10L2P1X0"), STATUS_OK);
+}
+
+
+// A Q too small for the depth is rejected, instead of pecking forever. The float depth stepped by
+// 0.000001 from 100 below the R level would never change.
+static void test_tiny_pecks()
+{
+  TEST_EQUAL(execute("G90G0X0Y0Z5"), STATUS_OK);
+  TEST_EQUAL(execute("G83X1Y1Z-100R1Q0.000001F100"), STATUS_GCODE_MAX_VALUE_EXCEEDED);
+  TEST_EQUAL(execute("G73X1Y1Z-100R1Q0.000001F100"), STATUS_GCODE_MAX_VALUE_EXCEEDED);
+  TEST_EQUAL(execute("G83X1Y1Z-10R0Q0.009"), STATUS_GCODE_MAX_VALUE_EXCEEDED); // 1112 pecks.
+  TEST_NEAR(gc_state.position[Z_AXIS], 5.0, 1e-5);
+  TEST_EQUAL(execute("G83X1Y1Z-10R0Q0.01"), STATUS_OK); // CANNED_CYCLE_MAX_PECKS
+  TEST_NEAR(gc_state.position[Z_AXIS], 5.0, 1e-5); // G98 back at the start.
+  TEST_EQUAL(execute("G80"), STATUS_OK);
+}
+
+
+// The same, running. The pecks reach the bottom and end there.
+static void test_pecks_running()
+{
+  sys.state = STATE_IDLE;
+  TEST_EQUAL(execute("G90G0X0Y0Z1"), STATUS_OK);
+  TEST_EQUAL(execute("G73X1Y1Z-100R1Q0.000001F100"), STATUS_GCODE_MAX_VALUE_EXCEEDED);
+  TEST_EQUAL(execute("G99G73X1Y1Z-2R0Q0.002F6000"), STATUS_OK); // 1000 chip breaking pecks.
+  protocol_buffer_synchronize();
+  TEST_EQUAL(sys.state, STATE_IDLE);
+  TEST_EQUAL(sys_position[X_AXIS], DEFAULT_X_STEPS_PER_MM);
+  TEST_EQUAL(sys_position[Z_AXIS], 0); // G99 retracts to the R level.
+  TEST_EQUAL(execute("G80"), STATUS_OK);
+  sys.state = STATE_CHECK_MODE;
+}
+
+
+// $G reports the retract mode after the feed rate mode.
+static void test_modes_report()
+{
+  TEST_EQUAL(execute("G99"), STATUS_OK);
+  test_capture_begin();
+  report_gcode_modes(CLIENT_SERIAL);
+  TEST_CHECK(test_capture_end().find(" G94 G99 M") != std::string::npos);
+  TEST_EQUAL(execute("G98"), STATUS_OK);
+  test_capture_begin();
+  report_gcode_modes(CLIENT_SERIAL);
+  TEST_CHECK(test_capture_end().find(" G94 G98 M") != std::string::npos);
+}
+
+
+int main()
+{
+  alarm(10); // A count that never ends fails the test, instead of hanging it.
+  test_boot();
+  sys.state = STATE_CHECK_MODE; // Parse only.
+  test_repeats();
+  test_invalid_counts();
+  test_tiny_pecks();
+  test_pecks_running();
+  test_modes_report();
+  return(test_done("test_canned_cycles"));
+}
@@ -0,0 +1,161 @@
+/*
+  test_dryplan.cpp - run time estimate of the $CP check mode
+  Part of Grbl
+
+  Grbl is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Grbl is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Grbl.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "test.hpp"
+
+#define DWELL 1.5 // (s)
+
+static const char *const job[] = {
+  "G21G90G17",
+  "G1X20Y10F900",
+  "G1X40Y-5",
+  "G0Z5",
+  "G4P1.5", // DWELL
+  "G2X20Y-5I-10J0F600",
+  "G1X0Y0F1500",
+  "G0Z0",
+  NULL
+};
+
+// The fields of a $CP report, as documented in dryplan.hpp.
+typedef struct {
+  double run_time;
+  uint32_t blocks;
+  double peak_rate;
+  uint32_t plan_us;
+  uint32_t plan_max_us;
+} estimate_t;
+
+static uint8_t execute(const char *line)
+{
+  char buffer[LINE_BUFFER_SIZE];
+  strcpy(buffer, line);
+  if (line[0] == '$') { return(system_execute_line(buffer, CLIENT_SERIAL)); }
+  return(gc_execute_line(buffer, CLIENT_SERIAL));
+}
+
+// Streams the job in the check mode entered with the command, with its dwell or a G4P0 in its
+// place, and leaves it with $C. Returns the output of leaving.
+static std::string check(const char *command, bool dwell)
+{
+  test_capture_begin();
+  TEST_EQUAL(execute(command), STATUS_OK);
+  std::string output = test_capture_end();
+  TEST_CHECK(output == "[MSG:Enabled]\r\n");
+  TEST_EQUAL(sys.state, STATE_CHECK_MODE);
+  for (uint8_t idx = 0; job[idx]; idx++) {
+    const char *line = job[idx];
+    if (!dwell && (strncmp(line, "G4", 2) == 0)) { line = "G4P0"; } // Stops all the same.
+    TEST_EQUAL(execute(line), STATUS_OK);
+    TEST_EQUAL(sys_position[X_AXIS], 0); // Nothing moves.
+    TEST_EQUAL(st_get_realtime_rate(), 0);
+    if (strcmp(command, "$C") == 0) { TEST_EQUAL(plan_get_block_buffer_count(), 0); } // Nor plans.
+  }
+  test_capture_begin();
+  TEST_EQUAL(execute("$C"), STATUS_OK);
+  output = test_capture_end();
+
+  // Leaving check mode resets, as it always did.
+  protocol_execute_realtime();
+  TEST_CHECK(sys.abort);
+  test_boot();
+  TEST_EQUAL(sys.state, STATE_IDLE);
+  return(output);
+}
+
+static estimate_t estimate(bool dwell)
+{
+  estimate_t estimate;
+  std::string output = check("$CP", dwell);
+  int length = 0;
+  if (!TEST_EQUAL(sscanf(output.c_str(), "[CP:Rt:%lf|Bl:%u|Pk:%lf|Pl:%u,%u]\r\n%n", &estimate.run_time,
+                         &estimate.blocks, &estimate.peak_rate, &estimate.plan_us, &estimate.plan_max_us,
+                         &length), 5) || !length) {
+    fprintf(stderr, "output: %s\n", output.c_str());
+    memset(&estimate, 0, sizeof(estimate));
+    return(estimate);
+  }
+  TEST_CHECK(output.compare(length, std::string::npos, "[MSG:Disabled]\r\n") == 0);
+  return(estimate);
+}
+
+// Returns the cycle time of the job as estimated by build/program --estimate.
+static double program_estimate()
+{
+  const char *program = getenv("PROGRAM");
+  if (!TEST_CHECK(program != NULL)) { return(0.0); } // Set by make -C host test.
+  FILE *file = fopen("job.nc", "w");
+  for (uint8_t idx = 0; job[idx]; idx++) { fprintf(file, "%s\n", job[idx]); }
+  fclose(file);
+
+  char command[512];
+  snprintf(command, sizeof(command), "%s --estimate job.nc --fs estimate", program);
+  FILE *output = popen(command, "r");
+  if (!TEST_CHECK(output != NULL)) { return(0.0); }
+  char line[256];
+  double seconds = 0.0;
+  while (fgets(line, sizeof(line), output)) {
+    if (strncmp(line, "cycle time", 10) == 0) { TEST_CHECK(sscanf(strchr(line, '('), "(%lf s)", &seconds) == 1); }
+  }
+  TEST_EQUAL(pclose(output), 0);
+  return(seconds);
+}
+
+
+// $CP plans the job and estimates the time the program's full simulation measures.
+static void test_estimate()
+{
+  estimate_t planned = estimate(true);
+  TEST_CHECK(planned.blocks > 5); // The lines and the arc segments.
+  TEST_CHECK(planned.peak_rate > 0.0);
+  TEST_CHECK(planned.plan_max_us >= planned.plan_us);
+
+  double simulated = program_estimate();
+  TEST_CHECK(simulated > DWELL);
+  TEST_NEAR(planned.run_time, simulated, 0.01*simulated);
+}
+
+
+// A dwell adds its time to the estimate.
+static void test_dwell()
+{
+  estimate_t with_dwell = estimate(true);
+  estimate_t without_dwell = estimate(false);
+  TEST_EQUAL(with_dwell.blocks, without_dwell.blocks);
+  TEST_NEAR(with_dwell.run_time-without_dwell.run_time, DWELL, 0.001);
+}
+
+
+// $C checks the job as before: no planning and no estimate.
+static void test_plain_check()
+{
+  std::string output = check("$C", true);
+  TEST_CHECK(output == "[MSG:Disabled]\r\n");
+  TEST_EQUAL(execute("$CX"), STATUS_INVALID_STATEMENT);
+  TEST_EQUAL(execute("$CPX"), STATUS_INVALID_STATEMENT);
+}
+
+
+int main()
+{
+  test_boot();
+  test_estimate();
+  test_dwell();
+  test_plain_check();
+  return(test_done("test_dryplan"));
+}
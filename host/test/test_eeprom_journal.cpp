@@ -0,0 +1,235 @@
+/*
+  test_eeprom_journal.cpp - settings image, idle commits, slot rotation and recovery
+  Part of Grbl
+
+  Grbl is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Grbl is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Grbl.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <sys/stat.h>
+#include <EEPROM.h>
+#include "test.hpp"
+
+#define SLOT_PATH "fs" EEPROM_JOURNAL_DIR "/"
+#define SETTLED (((uint64_t)EEPROM_COMMIT_DELAY+1)*(F_CPU/1000))
+#define SLOT_PATH_SIZE (sizeof(SLOT_PATH)+1) // One digit, as there are at most 10 slots.
+#define TEST_ADDR 2000 // Past the settings records.
+
+// Builds the path of a slot file as eeprom.cpp does.
+static void slot_path(char *path, uint8_t slot)
+{
+  strcpy(path, SLOT_PATH "0");
+  path[strlen(path)-1] += slot;
+}
+
+static bool slot_exists(uint8_t slot)
+{
+  char path[SLOT_PATH_SIZE];
+  struct stat info;
+  slot_path(path, slot);
+  return(stat(path, &info) == 0);
+}
+
+static uint8_t slot_count()
+{
+  uint8_t count = 0;
+  for (uint8_t slot=0; slot<10; slot++) { count += slot_exists(slot); }
+  return(count);
+}
+
+// Flips a byte of the image in the slot file, as a commit cut short by a power loss might leave it.
+static void slot_damage(uint8_t slot)
+{
+  char path[SLOT_PATH_SIZE];
+  slot_path(path, slot);
+  FILE *file = fopen(path, "r+b");
+  TEST_CHECK(file != NULL);
+  if (!file) { return; }
+  fseek(file, 12+TEST_ADDR, SEEK_SET); // Past the header.
+  fputc(0x5A, file);
+  fclose(file);
+}
+
+// Returns the slot with the highest commit sequence.
+static uint8_t slot_newest()
+{
+  uint8_t newest = 0;
+  uint32_t newest_sequence = 0;
+  for (uint8_t slot=0; slot<EEPROM_JOURNAL_SLOTS; slot++) {
+    char path[SLOT_PATH_SIZE];
+    uint32_t header[2]; // Magic and sequence.
+    slot_path(path, slot);
+    FILE *file = fopen(path, "rb");
+    if (!TEST_CHECK(file != NULL)) { continue; }
+    TEST_EQUAL(fread(header, sizeof(header), 1, file), 1);
+    fclose(file);
+    if (header[1] > newest_sequence) { newest = slot; newest_sequence = header[1]; }
+  }
+  return(newest);
+}
+
+static uint16_t reread_failures; // Bit mask of the slots to damage when opened a second time.
+static uint8_t slot_opens[10];
+
+// Damages the slots of reread_failures between their check and their load by eeprom_load(), as a
+// flash read error would.
+static void slot_open(const char *path, const char *mode)
+{
+  if ((mode[0] != 'r') || (strncmp(path, EEPROM_JOURNAL_DIR "/", sizeof(EEPROM_JOURNAL_DIR)) != 0)) { return; }
+  uint8_t slot = path[sizeof(EEPROM_JOURNAL_DIR)]-'0';
+  if ((++slot_opens[slot] == 2) && (reread_failures & bit(slot))) { slot_damage(slot); }
+}
+
+// Starts up with the slots of the mask failing when loaded.
+static void init_failing(uint16_t mask)
+{
+  reread_failures = mask;
+  memset(slot_opens, 0, sizeof(slot_opens));
+  host_fs_set_hook(slot_open);
+  eeprom_init();
+  host_fs_set_hook(NULL);
+}
+
+static void store(uint8_t value)
+{
+  eeprom_put_char(TEST_ADDR, value);
+  host_advance(SETTLED);
+  eeprom_commit_idle();
+}
+
+
+// Settings of Grbl 1.1 with their old checksums, in the EEPROM sector, are taken over on the first
+// start, and their checksums replaced.
+static void test_upgrade()
+{
+  settings_t old_settings = settings;
+  old_settings.steps_per_mm[X_AXIS] = 123.0;
+
+  EEPROM.begin(EEPROM_SIZE);
+  EEPROM.write(0, 10);
+  unsigned char legacy = 0;
+  for (unsigned int idx=0; idx<sizeof(settings_t); idx++) {
+    unsigned char data = ((unsigned char*)&old_settings)[idx];
+    EEPROM.write(EEPROM_ADDR_GLOBAL+idx, data);
+    legacy = (((legacy << 1) != 0) || ((legacy >> 7) != 0)) + data;
+  }
+  EEPROM.write(EEPROM_ADDR_GLOBAL+sizeof(settings_t), legacy);
+  EEPROM.commit();
+  EEPROM.end();
+
+  TEST_EQUAL(slot_count(), 0);
+  eeprom_init();
+  settings_init();
+  TEST_EQUAL(settings.steps_per_mm[X_AXIS], 123);
+  TEST_EQUAL(eeprom_get_char(0), SETTINGS_VERSION);
+  TEST_CHECK(memcpy_from_eeprom_with_checksum((char*)&old_settings, EEPROM_ADDR_GLOBAL, sizeof(settings_t)));
+
+  // A damaged old record isn't taken over.
+  eeprom_put_char(0, 10);
+  eeprom_put_char(EEPROM_ADDR_GLOBAL+sizeof(settings_t), legacy+1);
+  TEST_CHECK(!eeprom_upgrade_checksum(EEPROM_ADDR_GLOBAL, sizeof(settings_t)));
+  eeprom_put_char(EEPROM_ADDR_GLOBAL+sizeof(settings_t), legacy);
+  TEST_CHECK(eeprom_upgrade_checksum(EEPROM_ADDR_GLOBAL, sizeof(settings_t)));
+  eeprom_put_char(0, SETTINGS_VERSION);
+}
+
+
+// Changes are committed once idle and settled, as a single write.
+static void test_idle_commit()
+{
+  eeprom_put_char(TEST_ADDR, 1);
+  eeprom_commit_idle();
+  TEST_EQUAL(slot_count(), 0); // Not settled.
+
+  sys.state = STATE_CYCLE;
+  host_advance(SETTLED);
+  eeprom_commit_idle();
+  TEST_EQUAL(slot_count(), 0); // Busy.
+
+  sys.state = STATE_IDLE;
+  eeprom_commit_idle();
+  TEST_EQUAL(slot_count(), 1);
+  eeprom_commit_idle();
+  TEST_EQUAL(slot_count(), 1);
+
+  // Lost at a power loss before the commit.
+  eeprom_put_char(TEST_ADDR, 2);
+  eeprom_init();
+  TEST_EQUAL(eeprom_get_char(TEST_ADDR), 1);
+  TEST_EQUAL(eeprom_get_char(EEPROM_ADDR_GLOBAL+sizeof(settings_t)+1), 0xFF); // Rest as imported.
+}
+
+
+// Commits rotate over the slots. A damaged newest slot falls back to the one before.
+static void test_slots()
+{
+  for (uint8_t value=10; value<20; value++) { store(value); }
+  TEST_EQUAL(slot_count(), EEPROM_JOURNAL_SLOTS);
+  eeprom_init();
+  TEST_EQUAL(eeprom_get_char(TEST_ADDR), 19);
+
+  // Eleven commits in all, so the newest is in slot 11 % EEPROM_JOURNAL_SLOTS.
+  slot_damage(11 % EEPROM_JOURNAL_SLOTS);
+  eeprom_init();
+  TEST_EQUAL(eeprom_get_char(TEST_ADDR), 18);
+
+  // The next commit goes after the newest valid one, over the damaged slot.
+  store(30);
+  eeprom_init();
+  TEST_EQUAL(eeprom_get_char(TEST_ADDR), 30);
+  TEST_CHECK(settings.steps_per_mm[X_AXIS] == 123);
+}
+
+
+// A newest slot that checks out, but fails when loaded, falls back through the older slots before
+// the EEPROM sector is imported.
+static void test_reread_failure()
+{
+  for (uint8_t value=40; value<40+EEPROM_JOURNAL_SLOTS; value++) { store(value); }
+  uint8_t newest = slot_newest();
+  init_failing(bit(newest));
+  TEST_EQUAL(eeprom_get_char(TEST_ADDR), 40+EEPROM_JOURNAL_SLOTS-2);
+  TEST_EQUAL(slot_opens[newest], 2);
+  TEST_CHECK(settings.steps_per_mm[X_AXIS] == 123);
+
+  // The next commit goes over the failed slot.
+  store(50);
+  eeprom_init();
+  TEST_EQUAL(eeprom_get_char(TEST_ADDR), 50);
+
+  // Down to the oldest slot.
+  newest = slot_newest();
+  uint16_t failing = 0;
+  for (uint8_t idx=0; idx<EEPROM_JOURNAL_SLOTS-1; idx++) { failing |= bit((newest+EEPROM_JOURNAL_SLOTS-idx) % EEPROM_JOURNAL_SLOTS); }
+  init_failing(failing);
+  TEST_EQUAL(eeprom_get_char(TEST_ADDR), 40); // Slots of 40, 41, 42 and 50.
+  for (uint8_t slot=0; slot<EEPROM_JOURNAL_SLOTS; slot++) { TEST_EQUAL(slot_opens[slot], 2); }
+
+  // With none left, the EEPROM sector is imported, as on the first start.
+  store(60);
+  init_failing((1 << EEPROM_JOURNAL_SLOTS)-1);
+  TEST_EQUAL(eeprom_get_char(TEST_ADDR), 0xFF);
+  TEST_EQUAL(eeprom_get_char(0), 10); // The version of the old settings left in the sector.
+}
+
+
+int main()
+{
+  host_eeprom_open("eeprom"); // Keeps the sector contents over EEPROM.begin(), as the flash does.
+  test_boot(); // With an erased EEPROM sector and no slots, so nothing to commit but the defaults.
+  test_upgrade();
+  test_idle_commit();
+  test_slots();
+  test_reread_failure();
+  return(test_done("test_eeprom_journal"));
+}
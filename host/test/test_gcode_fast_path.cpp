@@ -0,0 +1,163 @@
+/*
+  test_gcode_fast_path.cpp - plain G0/G1 blocks give the same results on the fast path as on the
+  full parser
+  Part of Grbl
+
+  Grbl is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Grbl is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Grbl.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <string>
+#include <vector>
+#include "test.hpp"
+
+#define LINES 20000
+
+// What a block left behind: its status, the parser state and the block it planned, if any.
+typedef struct {
+  uint8_t status;
+  parser_state_t state;
+  bool planned;
+  plan_block_t block;
+} result_t;
+
+typedef struct {
+  std::string text;
+  bool motion;      // Of the kind the fast path takes, if the modes and values allow.
+} line_t;
+
+static uint32_t random_state = 2463534242UL;
+
+static uint32_t random_next()
+{
+  random_state ^= random_state << 13;
+  random_state ^= random_state >> 17;
+  random_state ^= random_state << 5;
+  return(random_state);
+}
+
+// A value as CAM programs and people write them, with the odd form the parser also takes.
+static std::string random_value(bool negative)
+{
+  char text[24];
+  int32_t value = random_next() % 2000000;
+  if (negative && (random_next() & 1)) { value = -value; }
+  switch (random_next() % 8) {
+    case 0: snprintf(text, sizeof(text), "%d", value/10000); break;
+    case 1: snprintf(text, sizeof(text), "%d.", value/10000); break;
+    case 2: snprintf(text, sizeof(text), "%s.%02u", (value < 0) ? "-" : "", (unsigned)(abs(value) % 100)); break;
+    case 3: snprintf(text, sizeof(text), "%07.3f", value/10000.0); break;
+    default: snprintf(text, sizeof(text), "%.4f", value/10000.0); break;
+  }
+  return(text);
+}
+
+// Mostly blocks for the fast path, some it hands to the full parser, and the mode changes that
+// decide how their words convert.
+static line_t random_line()
+{
+  static const char *modes[] = {
+    "G90", "G91", "G20", "G21", "G54", "G55", "G92.1", "G49", "M3S1000", "M5", "M8", "M9", "G93", "G94",
+    "G17", "G18"
+  };
+  static const char *axes = "XYZ";
+  std::string line;
+  uint32_t kind = random_next() % 16;
+  if (kind == 0) { return(line_t{ modes[random_next() % (sizeof(modes)/sizeof(modes[0]))], false }); }
+  if (kind == 1) { return(line_t{ "G92X" + random_value(true) + "Y" + random_value(true), false }); }
+  if (kind == 2) { return(line_t{ "G43.1Z" + random_value(true), false }); }
+
+  if (random_next() % 4 == 0) { line += "N" + std::to_string(random_next() % 100000); }
+  switch (random_next() % 6) {
+    case 0: line += "G0"; break;
+    case 1: line += "G1"; break;
+    case 2: line += "G01"; break;
+  }
+  uint8_t axis_words = random_next() % 8;
+  for (uint8_t idx=0; idx<3; idx++) {
+    if (axis_words & bit(idx)) { line += axes[idx] + random_value(true); }
+  }
+  switch (random_next() % 8) {
+    case 0: line += "F" + random_value(false); break;
+    case 1: line += "F0"; break;
+    case 2: line += "F-100"; break;
+    case 3: line += "X1"; break; // Repeated word, if X is there already.
+  }
+  return(line_t{ line, true });
+}
+
+
+// Runs the lines from a reset. With full set, every motion block in G94 mode gets a G94 word, which
+// changes nothing but makes the fast path hand it to the full parser.
+static void run(const std::vector<line_t> &lines, bool full, std::vector<result_t> &results)
+{
+  char line[LINE_BUFFER_SIZE+8];
+  gc_init();
+  plan_reset();
+  plan_sync_position();
+  gc_sync_position();
+  results.clear();
+  for (const line_t &text : lines) {
+    snprintf(line, sizeof(line), "%s", text.text.c_str());
+    if (full && text.motion && (gc_state.modal.feed_rate == FEED_RATE_MODE_UNITS_PER_MIN)) {
+      strncat(line, "G94", sizeof(line)-strlen(line)-1);
+    }
+    result_t result;
+    memset(&result, 0, sizeof(result_t));
+    result.status = gc_execute_line(line, CLIENT_SERIAL);
+    result.state = gc_state;
+    plan_block_t *block = plan_get_current_block();
+    result.planned = (block != NULL);
+    if (block) { result.block = *block; }
+    plan_reset_buffer(); // One block at a time. The junction with the one before is still planned.
+    results.push_back(result);
+  }
+}
+
+
+static void test_equivalence()
+{
+  std::vector<line_t> lines = {
+    { "G10L2P1X1.5Y-2Z0.25", false }, { "G10L2P2X-10Y20Z-3", false }, { "G21G90G54G94", false }
+  };
+  while (lines.size() < LINES) { lines.push_back(random_line()); }
+
+  std::vector<result_t> fast, full;
+  run(lines, false, fast);
+  run(lines, true, full);
+  TEST_EQUAL(fast.size(), lines.size());
+  TEST_EQUAL(full.size(), lines.size());
+
+  uint32_t planned = 0, differ = 0;
+  for (size_t idx=0; idx<lines.size() && idx<fast.size() && idx<full.size(); idx++) {
+    const result_t &a = fast[idx], &b = full[idx];
+    bool same = (a.status == b.status) && (a.planned == b.planned) &&
+                (memcmp(&a.state, &b.state, sizeof(parser_state_t)) == 0) &&
+                (!a.planned || (memcmp(&a.block, &b.block, sizeof(plan_block_t)) == 0));
+    planned += a.planned;
+    if (!same && (differ++ < 10)) {
+      fprintf(stderr, "line %u, %s: status %u and %u, planned %u and %u\n", (unsigned)idx,
+              lines[idx].text.c_str(), a.status, b.status, a.planned, b.planned);
+    }
+  }
+  TEST_EQUAL(differ, 0);
+  TEST_CHECK(planned > LINES/4); // Enough of the lines moved, in the modes the run went through.
+}
+
+
+int main()
+{
+  test_boot();
+  test_equivalence();
+  return(test_done("test_gcode_fast_path"));
+}
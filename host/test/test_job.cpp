@@ -0,0 +1,458 @@
+/*
+  test_job.cpp - stored jobs, uploaded and run from the file system
+  Part of Grbl
+
+  Grbl is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Grbl is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Grbl.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <unistd.h>
+#include <string>
+#include "test.hpp"
+
+#define CLIENT CLIENT_SERIAL
+#define JOB_TIMEOUT ((uint64_t)600*1000*(F_CPU/1000)) // 10 minutes of machine time.
+
+// A square of 10mm, with the comments, blank lines and lower case a CAM program may have.
+static const char *square =
+  "(square)\n"
+  "g21 g90 g94\n"
+  "\n"
+  "G0 Z2 ; clear\n"
+  "G1 Z-1 F300\n"
+  "X10 F600\n"
+  "Y10\n"
+  "X0\n"
+  "Y0\n"
+  "G0 Z2\n";
+
+// Most kinds of lines, in a job of its own, to run from its text and its cache alike.
+static const char *mixed =
+  "; mixed\n"
+  "G21 G90 G17 G94\n"
+  "G0 X0 Y0 Z1\n"
+  "N10 G1 Z-0.5 F200\n"
+  "G2 X10 Y0 I5 J0 F500 (arc)\n"
+  "G3 X0 Y0 I-5 J0\n"
+  "G91 G1 X1.25 Y-0.75\n"
+  "x.5 y.5 z0.25\n"
+  "\n"
+  "G90 G20 G1 X0.5 Y0.25 F20\n"
+  "G21\n"
+  "$G\n"
+  "G4 P0.05\n"
+  "M3 S1000\n"
+  "G1 X3 Y3 F800\n"
+  "M5\n"
+  "G0 Z5\n";
+
+static uint32_t trace_hash; // Of the changes of the outputs, i.e. the steps taken.
+static uint32_t trace_frame;
+static int capture_fd = -1;
+static FILE *capture_file;
+
+// Collects Grbl's output, written to stdout, until capture_end().
+static void capture_begin()
+{
+  fflush(stdout);
+  capture_file = tmpfile();
+  capture_fd = dup(STDOUT_FILENO);
+  dup2(fileno(capture_file), STDOUT_FILENO);
+}
+
+static std::string capture_end()
+{
+  std::string output;
+  char buffer[256];
+  size_t length;
+  fflush(stdout);
+  dup2(capture_fd, STDOUT_FILENO);
+  close(capture_fd);
+  rewind(capture_file);
+  while ((length = fread(buffer, 1, sizeof(buffer), capture_file)) > 0) { output.append(buffer, length); }
+  fclose(capture_file);
+  return(output);
+}
+
+
+static void trace_frame_hook(uint64_t, uint32_t frame)
+{
+  frame &= 0x00FFFFFF; // Not the limit inputs.
+  if (frame == trace_frame) { return; }
+  trace_frame = frame;
+  trace_hash = (trace_hash ^ frame)*16777619UL;
+}
+
+
+// Uploads the text in pieces of the size, as the web server hands them over.
+static uint8_t upload(const char *name, const char *text, size_t piece)
+{
+  size_t length = strlen(text);
+  job_upload_begin(name);
+  for (size_t offset = 0; offset < length; offset += piece) {
+    job_upload_write((const uint8_t*)&text[offset], min(piece, length-offset));
+  }
+  job_upload_end();
+  return(job_upload_result());
+}
+
+
+// Runs the main loop, short of the clients, until the running job ends. Returns Grbl's output.
+static std::string run_on()
+{
+  capture_begin();
+  uint64_t deadline = host_cycles()+JOB_TIMEOUT;
+  while (job_active() && (host_cycles() < deadline)) {
+    job_execute();
+    protocol_auto_cycle_start();
+    protocol_execute_realtime();
+    host_yield();
+  }
+  protocol_buffer_synchronize(); // The motions of the lines before a failing one.
+  std::string output = capture_end();
+  TEST_CHECK(!job_active());
+  return(output);
+}
+
+// Returns to the machine zero, with the parser as after a reset.
+static void start_over()
+{
+  memset(sys_position, 0, sizeof(sys_position));
+  trace_hash = 2166136261UL;
+  gc_init();
+  plan_reset();
+  st_reset();
+  plan_sync_position();
+  gc_sync_position();
+}
+
+// Compiles the queued job into its cache, a line per pass of the idle main loop.
+static void compile()
+{
+  for (int pass=0; pass<10000; pass++) { job_execute(); }
+}
+
+// Returns the list entry of the job.
+static std::string listed(const char *name)
+{
+  capture_begin();
+  job_list(CLIENT);
+  std::string output = capture_end();
+  size_t start = output.find(std::string("[FILE:")+name+"|");
+  if (start == std::string::npos) { return(""); }
+  return(output.substr(start, output.find(']', start)-start+1));
+}
+
+// Starts the job at the line, and runs it to the end.
+static std::string run(const char *name, uint32_t line)
+{
+  TEST_EQUAL(job_start(name, line, CLIENT), STATUS_OK);
+  return(run_on());
+}
+
+static bool contains(const std::string &output, const char *text)
+{
+  if (output.find(text) != std::string::npos) { return(true); }
+  fprintf(stderr, "missing %s in:\n%s", text, output.c_str());
+  return(false);
+}
+
+static void check_position(float x, float y, float z)
+{
+  float position[N_AXIS];
+  system_convert_array_steps_to_mpos(position, sys_position);
+  TEST_NEAR(position[X_AXIS], x, 1e-3);
+  TEST_NEAR(position[Y_AXIS], y, 1e-3);
+  TEST_NEAR(position[Z_AXIS], z, 1e-3);
+  TEST_NEAR(gc_state.position[X_AXIS], x, 1e-3);
+  TEST_NEAR(gc_state.position[Y_AXIS], y, 1e-3);
+  TEST_NEAR(gc_state.position[Z_AXIS], z, 1e-3);
+}
+
+
+// An upload in pieces, listed, run with the motions executed, and deleted.
+static void test_upload_run_delete()
+{
+  TEST_EQUAL(upload("square.nc", square, 7), STATUS_OK);
+  capture_begin();
+  job_list(CLIENT);
+  std::string output = capture_end();
+  char listed[48];
+  snprintf(listed, sizeof(listed), "[FILE:SQUARE.NC|SIZE:%u", (unsigned)strlen(square));
+  TEST_CHECK(contains(output, listed));
+
+  gc_execute_line((char*)"G0X5Y5Z5", CLIENT); // Where the job doesn't start.
+  protocol_buffer_synchronize();
+  output = run("SQUARE.NC", 0);
+  TEST_CHECK(contains(output, "[JOB:SQUARE.NC|Done|Ln:10|Rt:"));
+  check_position(0.0, 0.0, 2.0);
+  TEST_EQUAL(sys.state, STATE_IDLE);
+
+  // A line failing stops the job there.
+  TEST_EQUAL(upload("bad.nc", "G1 X1 F100\nG1 X2\nG5 X3\nG1 X4\n", 64), STATUS_OK);
+  output = run("BAD.NC", 0);
+  TEST_CHECK(contains(output, "[JOB:BAD.NC|Error:20|Ln:3]"));
+  check_position(2.0, 0.0, 2.0);
+
+  TEST_EQUAL(job_delete("BAD.NC"), STATUS_OK);
+  TEST_EQUAL(job_delete("BAD.NC"), STATUS_JOB_FILE);
+  TEST_EQUAL(job_start("BAD.NC", 0, CLIENT), STATUS_JOB_FILE);
+  capture_begin();
+  job_list(CLIENT);
+  output = capture_end();
+  TEST_CHECK(output.find("BAD.NC") == std::string::npos);
+
+  // Names that can't be files, and an upload while a job runs.
+  TEST_EQUAL(upload("", square, 64), STATUS_JOB_FILE);
+  TEST_EQUAL(upload(".hidden", square, 64), STATUS_JOB_FILE);
+  TEST_EQUAL(upload("a(b", square, 64), STATUS_JOB_FILE);
+  TEST_EQUAL(job_start("SQUARE.NC", 0, CLIENT), STATUS_OK);
+  TEST_EQUAL(upload("other.nc", square, 64), STATUS_JOB_ACTIVE);
+  TEST_EQUAL(job_start("SQUARE.NC", 0, CLIENT), STATUS_JOB_ACTIVE);
+  TEST_EQUAL(job_delete("SQUARE.NC"), STATUS_JOB_ACTIVE);
+  capture_begin();
+  job_reset();
+  output = capture_end();
+  TEST_CHECK(contains(output, "[JOB:SQUARE.NC|Aborted|Ln:0]"));
+  TEST_CHECK(!job_active());
+
+  // An upload while the machine moves, from its start or part way through, keeps the old file.
+  sys.state = STATE_JOG;
+  TEST_EQUAL(upload("square.nc", "G0 X1\n", 64), STATUS_IDLE_ERROR);
+  sys.state = STATE_IDLE;
+  job_upload_begin("square.nc");
+  job_upload_write((const uint8_t*)"G0 X1\n", 6);
+  sys.state = STATE_CYCLE;
+  job_upload_write((const uint8_t*)"G0 X2\n", 6);
+  sys.state = STATE_IDLE;
+  job_upload_end();
+  TEST_EQUAL(job_upload_result(), STATUS_IDLE_ERROR);
+  capture_begin();
+  job_list(CLIENT);
+  output = capture_end();
+  TEST_CHECK(contains(output, listed));
+  sys.state = STATE_ALARM; // Nothing moves.
+  TEST_EQUAL(upload("other.nc", square, 64), STATUS_OK);
+  sys.state = STATE_IDLE;
+  TEST_EQUAL(job_delete("OTHER.NC"), STATUS_OK);
+}
+
+
+// A run from the cache ends like the run from the text, with the same parser state, position and
+// messages. An upload replacing the source drops its cache.
+static void test_cache()
+{
+  TEST_EQUAL(upload("mixed.nc", mixed, 100), STATUS_OK);
+  TEST_CHECK(listed("MIXED.NC").find("|CACHED") == std::string::npos);
+
+  start_over();
+  std::string text_output = run("MIXED.NC", 0);
+  parser_state_t text_state = gc_state;
+  int32_t text_position[N_AXIS];
+  memcpy(text_position, sys_position, sizeof(text_position));
+  uint32_t text_trace = trace_hash;
+  TEST_CHECK(contains(text_output, "[JOB:MIXED.NC|Done|Ln:17|"));
+  TEST_CHECK(contains(text_output, "[GC:G1 G54 G17 G21 G90 G94"));
+
+  compile();
+  TEST_CHECK(contains(listed("MIXED.NC"), "|CACHED]"));
+  start_over();
+  std::string cache_output = run("MIXED.NC", 0);
+  TEST_CHECK(memcmp(&gc_state, &text_state, sizeof(parser_state_t)) == 0);
+  TEST_CHECK(memcmp(sys_position, text_position, sizeof(text_position)) == 0);
+  TEST_EQUAL(trace_hash, text_trace); // The same steps on the way.
+  // The same messages, up to the run time.
+  TEST_CHECK(cache_output.substr(0, cache_output.find("|Rt:")) == text_output.substr(0, text_output.find("|Rt:")));
+
+  // The same size, another program, uploaded. The cache of the old one is dropped right away.
+  std::string changed = mixed;
+  changed.replace(changed.find("X3 Y3"), 5, "X4 Y2");
+  TEST_EQUAL(upload("mixed.nc", changed.c_str(), 100), STATUS_OK);
+  TEST_CHECK(listed("MIXED.NC").find("|CACHED") == std::string::npos);
+  start_over();
+  run("MIXED.NC", 0);
+  TEST_NEAR(gc_state.position[X_AXIS], 4.0, 1e-4);
+  TEST_NEAR(gc_state.position[Y_AXIS], 2.0, 1e-4);
+  compile();
+  start_over();
+  run("MIXED.NC", 0);
+  TEST_NEAR(gc_state.position[X_AXIS], 4.0, 1e-4);
+  TEST_NEAR(gc_state.position[Y_AXIS], 2.0, 1e-4);
+
+  // An upload drops the cache, and compiles the job again.
+  TEST_EQUAL(upload("mixed.nc", mixed, 100), STATUS_OK);
+  TEST_CHECK(listed("MIXED.NC").find("|CACHED") == std::string::npos);
+  compile();
+  TEST_CHECK(contains(listed("MIXED.NC"), "|CACHED]"));
+}
+
+
+// With the planner full, a pass of the main loop returns at once, instead of starting the cycle
+// and waiting for a block to finish. The clients are served meanwhile.
+static void test_planner_full()
+{
+  std::string zigzag;
+  for (int idx=0; idx<100; idx++) { zigzag += (idx & 1) ? "G1 X0 Y" : "G1 X1 Y"; zigzag += std::to_string(idx*0.1) + " F1000\n"; }
+  TEST_EQUAL(upload("zigzag.nc", zigzag.c_str(), 256), STATUS_OK);
+  start_over();
+  alarm(10); // A main loop waiting on the planner never returns here.
+  capture_begin();
+  TEST_EQUAL(job_start("ZIGZAG.NC", 0, CLIENT), STATUS_OK);
+  for (int pass=0; pass<2*BLOCK_BUFFER_SIZE; pass++) { job_execute(); }
+  TEST_CHECK(plan_check_full_buffer());
+  TEST_EQUAL(sys.state, STATE_IDLE); // Nothing started the cycle and waited for it.
+  TEST_CHECK(job_active());
+  report_realtime_status(CLIENT);
+  std::string output = capture_end();
+  alarm(0);
+  TEST_CHECK(contains(output, "<Idle|"));
+  TEST_CHECK(contains(output, ",ZIGZAG.NC"));
+
+  output = run_on();
+  TEST_CHECK(contains(output, "[JOB:ZIGZAG.NC|Done|Ln:100|"));
+  check_position(0.0, 9.9, 0.0);
+}
+
+
+static bool resume_over;          // Over the resume position at X5 once.
+static bool resume_plunged_early; // Below the work before.
+
+static void resume_frame_hook(uint64_t, uint32_t)
+{
+  if (sys_position[X_AXIS] >= lround(5.0*settings.steps_per_mm[X_AXIS])) { resume_over = true; }
+  if ((sys_position[Z_AXIS] < 0) && !resume_over) { resume_plunged_early = true; }
+}
+
+// A resumed job scans the lines before the resume line without moving, approaches the position
+// reached there from above, and runs on to the same end as a full run.
+static void test_resume()
+{
+  const char *resume =
+    "G21 G90 G94\n"
+    "G0 Z2\n"
+    "G1 Z-1 F300\n"
+    "G91\n"
+    "G1 X5 F600\n"
+    "G1 Y5\n"
+    "G1 X-2\n"
+    "G90 G0 Z2\n";
+  TEST_EQUAL(upload("resume.nc", resume, 64), STATUS_OK);
+  start_over();
+  std::string output = run("RESUME.NC", 0);
+  TEST_CHECK(contains(output, "[JOB:RESUME.NC|Done|Ln:8|"));
+  check_position(3.0, 5.0, 2.0);
+
+  start_over();
+  resume_over = false;
+  resume_plunged_early = false;
+  host_spi_set_hook(resume_frame_hook);
+  TEST_EQUAL(job_start("RESUME.NC", 6, CLIENT), STATUS_OK);
+  TEST_CHECK(job_scanning());
+  TEST_EQUAL(sys.state, STATE_CHECK_MODE);
+  output = run_on();
+  host_spi_set_hook(trace_frame_hook);
+  TEST_CHECK(contains(output, "[JOB:RESUME.NC|Resume|Ln:6]"));
+  TEST_CHECK(contains(output, "[JOB:RESUME.NC|Done|Ln:8|"));
+  TEST_CHECK(resume_over && !resume_plunged_early);
+  check_position(3.0, 5.0, 2.0);
+  TEST_EQUAL(sys.state, STATE_IDLE);
+
+  // Past the end. The parser is left as after a reset, not in the G91 of the scan.
+  start_over();
+  output = run("RESUME.NC", 20);
+  TEST_CHECK(contains(output, "[JOB:RESUME.NC|Error:44|Ln:8]"));
+  TEST_EQUAL(gc_state.modal.distance, DISTANCE_MODE_ABSOLUTE);
+  TEST_EQUAL(sys.state, STATE_IDLE);
+  check_position(0.0, 0.0, 0.0);
+
+  // Started in check mode, it stays there and nothing moves.
+  start_over();
+  sys.state = STATE_CHECK_MODE;
+  output = run("RESUME.NC", 6);
+  TEST_CHECK(contains(output, "[JOB:RESUME.NC|Resume|Ln:6]"));
+  TEST_CHECK(contains(output, "[JOB:RESUME.NC|Done|Ln:8|"));
+  TEST_EQUAL(sys.state, STATE_CHECK_MODE);
+  TEST_EQUAL(sys_position[X_AXIS], 0);
+  sys.state = STATE_IDLE;
+}
+
+
+// Subroutines, nested loops and calls, from the text and the cache, and resumed in a loop.
+static void test_ocodes()
+{
+  const char *ocodes =
+    "G21 G90 G94 G1 F1000\n"
+    "O100 SUB\n"
+    "  G91 G1 X1\n"
+    "  O110 REPEAT [2]\n"
+    "    Y1\n"
+    "  O110 ENDREPEAT\n"
+    "  G90\n"
+    "O100 ENDSUB\n"
+    "O100 CALL\n"
+    "o100 call\n"
+    "O200 REPEAT [3]\n"
+    "  G91 Z-0.5\n"
+    "  O100 CALL\n"
+    "O200 ENDREPEAT\n"
+    "O300 REPEAT [0]\n"
+    "  G91 X100\n"
+    "O300 ENDREPEAT\n"
+    "G90 G0 Z0\n";
+  TEST_EQUAL(upload("ocodes.nc", ocodes, 64), STATUS_OK);
+  start_over();
+  std::string output = run("OCODES.NC", 0);
+  TEST_CHECK(contains(output, "[JOB:OCODES.NC|Done|Ln:18|"));
+  check_position(5.0, 10.0, 0.0);
+  uint32_t text_trace = trace_hash;
+
+  compile();
+  TEST_CHECK(contains(listed("OCODES.NC"), "|CACHED]"));
+  start_over();
+  output = run("OCODES.NC", 0);
+  TEST_CHECK(contains(output, "[JOB:OCODES.NC|Done|Ln:18|"));
+  check_position(5.0, 10.0, 0.0);
+  TEST_EQUAL(trace_hash, text_trace);
+
+  // In the body of the loop, it resumes at the first pass.
+  start_over();
+  output = run("OCODES.NC", 12);
+  TEST_CHECK(contains(output, "[JOB:OCODES.NC|Resume|Ln:12]"));
+  TEST_CHECK(contains(output, "[JOB:OCODES.NC|Done|Ln:18|"));
+  check_position(5.0, 10.0, 0.0);
+
+  // An undefined subroutine, a loop never ended and an end without its start.
+  TEST_EQUAL(upload("undefined.nc", "G21\nO100 CALL\nG0 X1\n", 64), STATUS_OK);
+  start_over();
+  TEST_CHECK(contains(run("UNDEFINED.NC", 0), "[JOB:UNDEFINED.NC|Error:45|Ln:2]"));
+  check_position(0.0, 0.0, 0.0);
+  TEST_EQUAL(upload("unended.nc", "O1 REPEAT [2]\nG0 X1\n", 64), STATUS_OK);
+  start_over();
+  TEST_CHECK(contains(run("UNENDED.NC", 0), "[JOB:UNENDED.NC|Error:45|Ln:2]"));
+  TEST_EQUAL(upload("unstarted.nc", "G0 X1\nO1 ENDSUB\n", 64), STATUS_OK);
+  start_over();
+  TEST_CHECK(contains(run("UNSTARTED.NC", 0), "[JOB:UNSTARTED.NC|Error:45|Ln:2]"));
+}
+
+
+int main()
+{
+  test_boot();
+  host_spi_set_hook(trace_frame_hook);
+  test_upload_run_delete();
+  test_cache();
+  test_planner_full();
+  test_resume();
+  test_ocodes();
+  return(test_done("test_job"));
+}
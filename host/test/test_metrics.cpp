@@ -0,0 +1,189 @@
+/*
+  test_metrics.cpp - pipeline health counters, as reported by $PM
+  Part of Grbl
+
+  Grbl is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Grbl is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Grbl.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "test.hpp"
+
+#define HOST_CYCLES_MS (F_CPU/1000)
+
+// The fields of a $PM report, as documented in metrics.hpp.
+typedef struct {
+  uint32_t lines;
+  uint32_t planner_fill[BLOCK_BUFFER_SIZE];
+  uint32_t underruns;
+  uint32_t timer_us[METRICS_TIMER_COUNT];
+  uint32_t timer_max_us[METRICS_TIMER_COUNT];
+  uint32_t rx_bytes[CLIENT_COUNT];
+  uint32_t tx_flushes;
+  uint32_t tx_wait_avg;
+  uint32_t tx_wait_max;
+} report_t;
+
+static report_t report;
+
+static uint8_t execute(const char *line)
+{
+  char buffer[LINE_BUFFER_SIZE];
+  strcpy(buffer, line);
+  return(system_execute_line(buffer, CLIENT_SERIAL));
+}
+
+// Sends $PM and parses the report into report. Returns whether the line has the documented format.
+static bool report_metrics()
+{
+  test_capture_begin();
+  TEST_EQUAL(execute("$PM"), STATUS_OK);
+  std::string output = test_capture_end();
+
+  memset(&report, 0xFF, sizeof(report));
+  const char *p = output.c_str();
+  int length = 0;
+  bool valid = (sscanf(p, "[PM:Ln:%u|Pl:%n", &report.lines, &length) == 1) && length;
+  for (uint8_t idx = 0; valid && (idx < BLOCK_BUFFER_SIZE); idx++) {
+    p += length;
+    length = 0;
+    valid = (sscanf(p, (idx == 0) ? "%u%n" : ",%u%n", &report.planner_fill[idx], &length) == 1);
+  }
+  p += length;
+  length = 0;
+  valid = valid && (sscanf(p, "|Ur:%u|Pr:%u,%u|Sp:%u,%u|Rx:%n", &report.underruns,
+                           &report.timer_us[METRICS_TIMER_PLANNER], &report.timer_max_us[METRICS_TIMER_PLANNER],
+                           &report.timer_us[METRICS_TIMER_PREP], &report.timer_max_us[METRICS_TIMER_PREP], &length) == 5) && length;
+  for (uint8_t idx = 0; valid && (idx < CLIENT_COUNT); idx++) {
+    p += length;
+    length = 0;
+    valid = (sscanf(p, (idx == 0) ? "%u%n" : ",%u%n", &report.rx_bytes[idx], &length) == 1);
+  }
+  p += length;
+  length = 0;
+  valid = valid && (sscanf(p, "|Tx:%u,%u,%u]\r\n%n", &report.tx_flushes, &report.tx_wait_avg, &report.tx_wait_max,
+                           &length) == 3) && length && (p[length] == 0);
+  if (!TEST_CHECK(valid)) { fprintf(stderr, "report: %s\n", output.c_str()); }
+  return(valid);
+}
+
+static uint32_t planner_fill_ms()
+{
+  uint32_t total = 0;
+  for (uint8_t idx = 0; idx < BLOCK_BUFFER_SIZE; idx++) { total += report.planner_fill[idx]; }
+  return(total);
+}
+
+
+// Everything starts at zero.
+static void test_format()
+{
+  TEST_CHECK(report_metrics());
+  TEST_EQUAL(report.lines, 0);
+  TEST_EQUAL(planner_fill_ms(), 0);
+  TEST_EQUAL(report.underruns, 0);
+  TEST_EQUAL(report.timer_max_us[METRICS_TIMER_PLANNER], 0);
+  TEST_EQUAL(report.rx_bytes[CLIENT_SERIAL-1], 0);
+  TEST_EQUAL(report.tx_flushes, 0);
+
+  TEST_EQUAL(execute("$PM=1"), STATUS_INVALID_STATEMENT);
+  TEST_EQUAL(execute("$PMX"), STATUS_INVALID_STATEMENT);
+}
+
+
+// The rates are the counts of the previous whole second. The others accumulate.
+static void test_counters()
+{
+  metrics_poll(); // Starts a second.
+  for (uint8_t idx = 0; idx < 5; idx++) { metrics_count_line(); }
+  const uint8_t line[] = "G0X1\n";
+  host_uart_receive(line, sizeof(line)-1); // Counted by the receive interrupt.
+  host_advance(HOST_CYCLES_MS);
+  serial_reset_read_buffer(CLIENT_ALL);
+  metrics_count_rx(CLIENT_WEBSOCKET);
+  metrics_count_underrun();
+  metrics_count_underrun();
+  metrics_timer_add(METRICS_TIMER_PLANNER, ESP.getCycleCount()-250*(F_CPU/1000000L)); // 250us.
+  metrics_tx_flush(4);
+  metrics_tx_flush(10);
+
+  host_advance(998*HOST_CYCLES_MS);
+  metrics_poll();
+  TEST_CHECK(report_metrics());
+  TEST_EQUAL(report.lines, 0); // The second isn't over.
+  TEST_EQUAL(report.rx_bytes[CLIENT_SERIAL-1], 0);
+  TEST_EQUAL(report.timer_us[METRICS_TIMER_PLANNER], 0);
+  TEST_EQUAL(report.underruns, 2);
+  TEST_EQUAL(report.timer_max_us[METRICS_TIMER_PLANNER], 250);
+  TEST_EQUAL(report.tx_flushes, 2);
+  TEST_EQUAL(report.tx_wait_avg, 7);
+  TEST_EQUAL(report.tx_wait_max, 10);
+
+  host_advance(HOST_CYCLES_MS);
+  metrics_poll();
+  TEST_CHECK(report_metrics());
+  TEST_EQUAL(report.lines, 5);
+  TEST_EQUAL(report.rx_bytes[CLIENT_SERIAL-1], sizeof(line)-1);
+  TEST_EQUAL(report.rx_bytes[CLIENT_WEBSOCKET-1], 1);
+  TEST_EQUAL(report.timer_us[METRICS_TIMER_PLANNER], 250);
+  TEST_EQUAL(report.timer_max_us[METRICS_TIMER_PLANNER], 250);
+
+  host_advance(1000*HOST_CYCLES_MS);
+  metrics_poll();
+  TEST_CHECK(report_metrics());
+  TEST_EQUAL(report.lines, 0);
+  TEST_EQUAL(report.rx_bytes[CLIENT_SERIAL-1], 0);
+  TEST_EQUAL(report.timer_us[METRICS_TIMER_PLANNER], 0);
+  TEST_EQUAL(report.timer_max_us[METRICS_TIMER_PLANNER], 250);
+  TEST_EQUAL(report.underruns, 2);
+}
+
+
+// A cycle fills the planner histogram, one sample per millisecond. $PM=0 clears the histogram,
+// counts and maximums.
+static void test_cycle_and_reset()
+{
+  char line[LINE_BUFFER_SIZE];
+  for (uint8_t idx = 1; idx <= 4; idx++) {
+    snprintf(line, sizeof(line), "G1X%dF1200", 5*idx);
+    TEST_EQUAL(gc_execute_line(line, CLIENT_SERIAL), STATUS_OK);
+  }
+  uint32_t start = millis();
+  protocol_buffer_synchronize();
+  uint32_t cycle_ms = millis()-start;
+  TEST_CHECK(report_metrics());
+  TEST_CHECK(planner_fill_ms() > 0);
+  TEST_CHECK(planner_fill_ms() <= cycle_ms+1);
+  TEST_CHECK(planner_fill_ms() >= cycle_ms*9/10);
+  TEST_CHECK(report.planner_fill[1] > 0); // The last block.
+  TEST_EQUAL(report.planner_fill[BLOCK_BUFFER_SIZE-1], 0);
+
+  TEST_EQUAL(execute("$PM=0"), STATUS_OK);
+  TEST_CHECK(report_metrics());
+  TEST_EQUAL(planner_fill_ms(), 0);
+  TEST_EQUAL(report.underruns, 0);
+  TEST_EQUAL(report.timer_max_us[METRICS_TIMER_PLANNER], 0);
+  TEST_EQUAL(report.timer_max_us[METRICS_TIMER_PREP], 0);
+  TEST_EQUAL(report.tx_flushes, 0);
+  TEST_EQUAL(report.tx_wait_avg, 0);
+  TEST_EQUAL(report.tx_wait_max, 0);
+}
+
+
+int main()
+{
+  test_boot();
+  test_format();
+  test_counters();
+  test_cycle_and_reset();
+  return(test_done("test_metrics"));
+}
@@ -0,0 +1,167 @@
+/*
+  test_profiler.cpp - section accounting of the cycle profiler, as reported by $PR
+  Part of Grbl
+
+  Grbl is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Grbl is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Grbl.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "test.hpp"
+
+#define HOST_CYCLES_US (F_CPU/1000000L)
+
+// A line of the $PR report, as documented in profiler.hpp.
+typedef struct {
+  char name[16];
+  uint32_t calls;
+  uint32_t total_us;
+  uint32_t self_us;
+  uint32_t average_cycles;
+  uint32_t max_cycles;
+} section_t;
+
+static section_t sections[PROFILE_COUNT];
+
+static const char *const section_names[PROFILE_COUNT] = {
+  "gcode", "planner", "arc", "prep", "report", "yield"
+};
+
+static uint8_t execute(const char *line)
+{
+  char buffer[LINE_BUFFER_SIZE];
+  strcpy(buffer, line);
+  return(system_execute_line(buffer, CLIENT_SERIAL));
+}
+
+// Sends $PR and parses its lines into sections.
+static void report_profile()
+{
+  test_capture_begin();
+  TEST_EQUAL(execute("$PR"), STATUS_OK);
+  std::string output = test_capture_end();
+
+  memset(sections, 0xFF, sizeof(sections));
+  const char *line = output.c_str();
+  for (uint8_t idx = 0; idx < PROFILE_COUNT; idx++) {
+    section_t *section = &sections[idx];
+    int length = 0;
+    if (!TEST_EQUAL(sscanf(line, "[PR:%15[a-z],%u,%u,%u,%u,%u]\r\n%n", section->name, &section->calls,
+                           &section->total_us, &section->self_us, &section->average_cycles,
+                           &section->max_cycles, &length), 6) || !length) {
+      fprintf(stderr, "report: %s\n", output.c_str());
+      return;
+    }
+    TEST_CHECK(strcmp(section->name, section_names[idx]) == 0);
+    line += length;
+  }
+  TEST_EQUAL(*line, 0);
+}
+
+static void spend_us(uint32_t us) { host_advance(us*HOST_CYCLES_US); }
+
+static void planner_call(uint32_t us)
+{
+  PROFILE_SCOPE(PROFILE_PLANNER);
+  if (us > 100) { spend_us(100); return; } // Left early. Still accounted.
+  spend_us(us);
+}
+
+static void report_call(uint8_t depth)
+{
+  PROFILE_SCOPE(PROFILE_REPORT);
+  spend_us(10);
+  if (depth) { report_call(depth-1); }
+}
+
+
+// Total time includes nested sections, self time doesn't.
+static void test_nesting()
+{
+  TEST_EQUAL(execute("$PR=0"), STATUS_OK);
+  {
+    PROFILE_SCOPE(PROFILE_GCODE);
+    spend_us(300);
+    planner_call(200); // Leaves early after 100us.
+    planner_call(40);
+    {
+      PROFILE_SCOPE(PROFILE_ARC);
+      spend_us(50);
+      planner_call(60);
+    }
+  }
+  report_profile();
+  TEST_EQUAL(sections[PROFILE_GCODE].calls, 1);
+  TEST_EQUAL(sections[PROFILE_GCODE].total_us, 300+100+40+50+60);
+  TEST_EQUAL(sections[PROFILE_GCODE].self_us, 300);
+  TEST_EQUAL(sections[PROFILE_GCODE].max_cycles, 550*HOST_CYCLES_US);
+  TEST_EQUAL(sections[PROFILE_PLANNER].calls, 3);
+  TEST_EQUAL(sections[PROFILE_PLANNER].total_us, 200);
+  TEST_EQUAL(sections[PROFILE_PLANNER].self_us, 200);
+  TEST_EQUAL(sections[PROFILE_PLANNER].average_cycles, 200*HOST_CYCLES_US/3);
+  TEST_EQUAL(sections[PROFILE_PLANNER].max_cycles, 100*HOST_CYCLES_US);
+  TEST_EQUAL(sections[PROFILE_ARC].calls, 1);
+  TEST_EQUAL(sections[PROFILE_ARC].total_us, 110);
+  TEST_EQUAL(sections[PROFILE_ARC].self_us, 50);
+  TEST_EQUAL(sections[PROFILE_PREP].calls, 0);
+  TEST_EQUAL(sections[PROFILE_PREP].average_cycles, 0);
+}
+
+
+// A section nested in itself counts once, for the outer call, with all of its time.
+static void test_recursion()
+{
+  TEST_EQUAL(execute("$PR=0"), STATUS_OK);
+  report_call(2);
+  report_profile();
+  TEST_EQUAL(sections[PROFILE_REPORT].calls, 1);
+  TEST_EQUAL(sections[PROFILE_REPORT].total_us, 30);
+  TEST_EQUAL(sections[PROFILE_REPORT].self_us, 30);
+  TEST_EQUAL(sections[PROFILE_REPORT].max_cycles, 30*HOST_CYCLES_US);
+}
+
+
+// The marks in the core account a move, and $PR=0 clears all sections.
+static void test_motion_and_reset()
+{
+  TEST_EQUAL(execute("$PR=0"), STATUS_OK);
+  char line[] = "G2X10Y0I5J0F1200";
+  TEST_EQUAL(gc_execute_line(line, CLIENT_SERIAL), STATUS_OK);
+  protocol_buffer_synchronize();
+  report_profile();
+  TEST_EQUAL(sections[PROFILE_GCODE].calls, 1);
+  TEST_EQUAL(sections[PROFILE_ARC].calls, 1);
+  TEST_CHECK(sections[PROFILE_PLANNER].calls > 10); // The arc segments.
+  TEST_CHECK(sections[PROFILE_PREP].calls > 0);
+  TEST_CHECK(sections[PROFILE_WIFI].calls > 0);
+  TEST_CHECK(sections[PROFILE_WIFI].total_us > 0); // The machine time waited in the yields.
+
+  TEST_EQUAL(execute("$PR=0"), STATUS_OK);
+  report_profile();
+  for (uint8_t idx = 0; idx < PROFILE_COUNT; idx++) {
+    TEST_EQUAL(sections[idx].calls, 0);
+    TEST_EQUAL(sections[idx].total_us, 0);
+    TEST_EQUAL(sections[idx].self_us, 0);
+    TEST_EQUAL(sections[idx].max_cycles, 0);
+  }
+  TEST_EQUAL(execute("$PR=1"), STATUS_INVALID_STATEMENT);
+}
+
+
+int main()
+{
+  test_boot();
+  test_nesting();
+  test_recursion();
+  test_motion_and_reset();
+  return(test_done("test_profiler"));
+}
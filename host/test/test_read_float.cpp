@@ -0,0 +1,183 @@
+/*
+  test_read_float.cpp - read_float() fuzzed against strtof() and the Grbl 1.1 parser
+  Part of Grbl
+
+  Grbl is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Grbl is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Grbl.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdlib.h>
+#include "test.hpp"
+
+#define FUZZ_CASES 1000000
+#define FUZZ_MAX_ULP 2 // Largest difference from the Grbl 1.1 parser.
+
+static uint32_t fuzz_state = 0x2545F491;
+
+// xorshift32. Fixed seed, so a failure repeats.
+static uint32_t fuzz_random(uint32_t range)
+{
+  fuzz_state ^= fuzz_state << 13;
+  fuzz_state ^= fuzz_state >> 17;
+  fuzz_state ^= fuzz_state << 5;
+  return(fuzz_state % range);
+}
+
+
+// read_float() of Grbl 1.1g. It applies the decimals by multiplying with 0.01 and 0.1 in double.
+static uint8_t read_float_legacy(char *line, uint8_t *char_counter, float *float_ptr)
+{
+  char *ptr = line + *char_counter;
+  unsigned char current_char = *ptr++;
+  bool is_negative = false;
+  if (current_char == '-') {
+    is_negative = true;
+    current_char = *ptr++;
+  } else if (current_char == '+') {
+    current_char = *ptr++;
+  }
+  uint32_t integer_value = 0;
+  int8_t exponent = 0;
+  uint8_t num_digits = 0;
+  bool is_decimal = false;
+  while(1) {
+    current_char -= '0';
+    if (current_char <= 9) {
+      num_digits++;
+      if (num_digits <= 8) {
+        if (is_decimal) { exponent--; }
+        integer_value = integer_value*10 + current_char;
+      } else {
+        if (!(is_decimal)) { exponent++; }
+      }
+    } else if (current_char == (('.'-'0') & 0xff)  &&  !(is_decimal)) {
+      is_decimal = true;
+    } else {
+      break;
+    }
+    current_char = *ptr++;
+  }
+  if (!num_digits) { return(false); };
+  float float_value = (float)integer_value;
+  if (float_value != 0) {
+    while (exponent <= -2) {
+      float_value *= 0.01;
+      exponent += 2;
+    }
+    if (exponent < 0) {
+      float_value *= 0.1;
+    } else if (exponent > 0) {
+      do {
+        float_value *= 10.0;
+      } while (--exponent > 0);
+    }
+  }
+  *float_ptr = (is_negative) ? -float_value : float_value;
+  *char_counter = ptr - line - 1;
+  return(true);
+}
+
+
+static uint32_t ulp_distance(float a, float b)
+{
+  if (a == b) { return(0); } // Also +0 and -0.
+  int32_t ia, ib;
+  memcpy(&ia, &a, sizeof(ia));
+  memcpy(&ib, &b, sizeof(ib));
+  if ((ia < 0) != (ib < 0)) { return(UINT32_MAX); }
+  return((ia > ib) ? ia-ib : ib-ia);
+}
+
+
+// A value as a CAM program writes it, with at most 7 significant digits, e.g. -12.345 or .5.
+static uint8_t fuzz_cam_value(char *text)
+{
+  uint8_t length = 0;
+  uint8_t digits = 1+fuzz_random(7);
+  uint8_t decimals = fuzz_random(digits+1);
+  uint8_t form = fuzz_random(8);
+  if (form == 0) { text[length++] = '-'; }
+  else if (form == 1) { text[length++] = '+'; }
+  for (uint8_t idx=0; idx<digits; idx++) {
+    if (idx == digits-decimals) {
+      if ((idx == 0) && (form == 2)) { text[length++] = '0'; } // 0.5 as well as .5
+      text[length++] = '.';
+    }
+    text[length++] = '0'+fuzz_random(10);
+  }
+  if ((decimals == 0) && (form == 3)) { text[length++] = '.'; } // 12.
+  text[length] = 0;
+  return(length);
+}
+
+// Anything made of number characters and some word letters, up to 14 characters long.
+static uint8_t fuzz_garbage_value(char *text)
+{
+  static const char characters[] = "0123456789000..--+XGE ";
+  uint8_t length = fuzz_random(15);
+  for (uint8_t idx=0; idx<length; idx++) { text[idx] = characters[fuzz_random(sizeof(characters)-1)]; }
+  text[length] = 0;
+  return(length);
+}
+
+
+// CAM values are correctly rounded, and read like the Grbl 1.1 parser did, up to its errors.
+static void test_cam_values()
+{
+  char line[32];
+  uint32_t failures = 0, legacy_rounding = 0;
+  for (uint32_t count=0; count<FUZZ_CASES; count++) {
+    uint8_t length = fuzz_cam_value(line);
+    strcat(line, "X"); // The next word.
+    uint8_t counter = 0, legacy_counter = 0;
+    float value, legacy;
+    bool ok = read_float(line, &counter, &value);
+    bool legacy_ok = read_float_legacy(line, &legacy_counter, &legacy);
+    float exact = strtof(line, NULL);
+    if (!ok || !legacy_ok || (counter != length) || (legacy_counter != length) ||
+        (ulp_distance(value, exact) != 0) || (ulp_distance(value, legacy) > FUZZ_MAX_ULP)) {
+      if (failures++ < 10) { fprintf(stderr, "%s read as %.9g, expected %.9g\n", line, value, exact); }
+    }
+    if (legacy != exact) { legacy_rounding++; }
+  }
+  TEST_EQUAL(failures, 0);
+  TEST_CHECK(legacy_rounding > 0); // The reference differs, so the comparison means something.
+}
+
+
+// Garbage is accepted or rejected like before, up to the same character, with values as close.
+static void test_garbage_values()
+{
+  char line[32];
+  uint32_t failures = 0;
+  for (uint32_t count=0; count<FUZZ_CASES; count++) {
+    fuzz_garbage_value(line);
+    uint8_t counter = 0, legacy_counter = 0;
+    float value = 0, legacy = 0;
+    bool ok = read_float(line, &counter, &value);
+    bool legacy_ok = read_float_legacy(line, &legacy_counter, &legacy);
+    if ((ok != legacy_ok) || (ok && ((counter != legacy_counter) ||
+        ((isinf(value) || isinf(legacy)) ? (value != legacy) : (ulp_distance(value, legacy) > FUZZ_MAX_ULP))))) {
+      if (failures++ < 10) { fprintf(stderr, "\"%s\" read as %d %.9g, was %d %.9g\n", line, ok, value, legacy_ok, legacy); }
+    }
+  }
+  TEST_EQUAL(failures, 0);
+}
+
+
+int main()
+{
+  test_cam_values();
+  test_garbage_values();
+  return(test_done("test_read_float"));
+}
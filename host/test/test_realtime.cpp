@@ -0,0 +1,119 @@
+/*
+  test_realtime.cpp - realtime commands taken by the serial receive interrupt
+  Part of Grbl
+
+  Grbl is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Grbl is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Grbl.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "test.hpp"
+
+#define HOST_CYCLES_MS (F_CPU/1000)
+
+// Delivers the byte to the receive interrupt.
+static void receive(uint8_t data)
+{
+  host_uart_receive(&data, 1);
+  host_advance(HOST_CYCLES_MS);
+}
+
+static void execute(const char *line)
+{
+  char buffer[LINE_BUFFER_SIZE];
+  strcpy(buffer, line);
+  TEST_EQUAL(gc_execute_line(buffer, CLIENT_SERIAL), STATUS_OK);
+}
+
+
+// The interrupt only sets flags. The main program acts on them.
+static void test_flags()
+{
+  receive(CMD_STATUS_REPORT);
+  TEST_CHECK(sys_rt_exec_state & EXEC_STATUS_REPORT);
+  TEST_EQUAL(system_take_exec_status_report_clients(), bit((CLIENT_SERIAL-1)));
+  TEST_EQUAL(sys_rt_exec_state, 0);
+
+  receive(CMD_FEED_OVR_COARSE_PLUS);
+  receive(CMD_SPINDLE_OVR_FINE_MINUS);
+  TEST_EQUAL(sys_rt_exec_motion_override, EXEC_FEED_OVR_COARSE_PLUS);
+  TEST_EQUAL(sys_rt_exec_accessory_override, EXEC_SPINDLE_OVR_FINE_MINUS);
+  protocol_execute_realtime();
+  TEST_EQUAL(sys.f_override, DEFAULT_FEED_OVERRIDE+FEED_OVERRIDE_COARSE_INCREMENT);
+  TEST_EQUAL(sys.spindle_speed_ovr, DEFAULT_SPINDLE_SPEED_OVERRIDE-SPINDLE_OVERRIDE_FINE_INCREMENT);
+  TEST_EQUAL(sys_rt_exec_motion_override, 0);
+  TEST_EQUAL(sys_rt_exec_accessory_override, 0);
+}
+
+
+// A reset during motion stops the steps in the interrupt, raises the alarm for the position lost,
+// and leaves the spindle and coolant to the main program.
+static void test_reset_in_motion()
+{
+  execute("M8");
+  execute("G1X50F600"); // As the protocol passes it on.
+  protocol_auto_cycle_start();
+  protocol_execute_realtime();
+  host_advance(200*HOST_CYCLES_MS);
+  TEST_EQUAL(sys.state, STATE_CYCLE);
+
+  receive(CMD_RESET);
+  TEST_CHECK(bit_istrue(sys_rt_exec_state, EXEC_RESET));
+  TEST_EQUAL(sys_rt_exec_alarm, EXEC_ALARM_ABORT_CYCLE);
+  int32_t position = sys_position[X_AXIS];
+  host_advance(200*HOST_CYCLES_MS); // The main program is busy elsewhere.
+  TEST_EQUAL(sys_position[X_AXIS], position); // Steppers stopped.
+  TEST_CHECK((position > 0) && (position < 50*DEFAULT_X_STEPS_PER_MM));
+  TEST_CHECK(coolant_get_state() != COOLANT_STATE_DISABLE); // Flash code, not run by the interrupt.
+
+  protocol_execute_realtime();
+  TEST_CHECK(sys.abort);
+  TEST_EQUAL(sys.state, STATE_ALARM);
+  TEST_EQUAL(coolant_get_state(), COOLANT_STATE_DISABLE);
+  TEST_EQUAL(sys_position[X_AXIS], position);
+}
+
+
+// The hard limit interrupt takes the same path as the reset.
+static void test_hard_limit_in_motion()
+{
+  execute("M8");
+  execute("G1X50F600");
+  protocol_auto_cycle_start();
+  protocol_execute_realtime();
+  host_advance(200*HOST_CYCLES_MS);
+  TEST_EQUAL(sys.state, STATE_CYCLE);
+
+  pin_limit_vect();
+  TEST_CHECK(bit_istrue(sys_rt_exec_state, EXEC_RESET));
+  TEST_EQUAL(sys_rt_exec_alarm, EXEC_ALARM_HARD_LIMIT);
+  int32_t position = sys_position[X_AXIS];
+  host_advance(200*HOST_CYCLES_MS);
+  TEST_EQUAL(sys_position[X_AXIS], position);
+
+  // The main program would now wait in the alarm for a reset.
+  TEST_CHECK(coolant_get_state() != COOLANT_STATE_DISABLE);
+  mc_exec_reset_request();
+  TEST_EQUAL(coolant_get_state(), COOLANT_STATE_DISABLE);
+  TEST_EQUAL(sys_position[X_AXIS], position);
+}
+
+
+int main()
+{
+  test_boot();
+  test_flags();
+  test_reset_in_motion();
+  test_boot();
+  test_hard_limit_in_motion();
+  return(test_done("test_realtime"));
+}
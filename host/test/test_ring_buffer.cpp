@@ -0,0 +1,173 @@
+/*
+  test_ring_buffer.cpp - single producer, single consumer ring buffer, stressed from two threads
+  Part of Grbl
+
+  Grbl is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Grbl is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Grbl.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <signal.h>
+#include <sys/time.h>
+#include <thread> // Before Grbl, which defines min() and max() macros.
+#include "test.hpp"
+
+#define STRESS_ITEMS 2000000UL
+#define STRESS_IRQ_ITEMS 8000000UL
+#define STRESS_BURST 7 // Items of a multi-item push. Not a divisor of the size, so it wraps around.
+
+#define ITEM_WORDS 32
+
+// Many words, so a slot read before the producer finished writing it shows up.
+typedef struct {
+  uint32_t sequence;
+  uint32_t words[ITEM_WORDS];
+} item_t;
+
+static void item_fill(item_t *item, uint32_t sequence)
+{
+  item->sequence = sequence;
+  for (int idx=0; idx<ITEM_WORDS; idx++) { item->words[idx] = sequence*2654435761UL + idx; }
+}
+
+static bool item_valid(const item_t *item, uint32_t sequence)
+{
+  if (item->sequence != sequence) { return(false); }
+  for (int idx=0; idx<ITEM_WORDS; idx++) {
+    if (item->words[idx] != (uint32_t)(sequence*2654435761UL + idx)) { return(false); }
+  }
+  return(true);
+}
+
+
+static void test_single_thread()
+{
+  static RingBuffer<uint8_t,8> buffer;
+  uint8_t data;
+  TEST_CHECK(buffer.empty());
+  TEST_EQUAL(buffer.available(), 7);
+  for (uint8_t idx=0; idx<7; idx++) { TEST_CHECK(buffer.push(idx)); }
+  TEST_CHECK(buffer.full());
+  TEST_CHECK(!buffer.push(7));
+  TEST_EQUAL(buffer.count(), 7);
+
+  // All items or none.
+  uint8_t items[5] = { 10, 11, 12, 13, 14 };
+  for (uint8_t idx=0; idx<3; idx++) { TEST_CHECK(buffer.pop(&data) && (data == idx)); }
+  TEST_CHECK(!buffer.push(items, 4));
+  TEST_EQUAL(buffer.count(), 4);
+  TEST_CHECK(buffer.push(items, 3)); // Wraps around the end of the storage.
+  for (uint8_t idx=3; idx<7; idx++) { TEST_CHECK(buffer.pop(&data) && (data == idx)); }
+  for (uint8_t idx=0; idx<3; idx++) { TEST_CHECK(buffer.pop(&data) && (data == items[idx])); }
+  TEST_CHECK(!buffer.pop(&data));
+
+  TEST_CHECK(buffer.push(items, 5));
+  buffer.flush();
+  TEST_CHECK(buffer.empty());
+}
+
+
+// The producer fills slots in place and pushes bursts. The consumer checks every item arrives
+// whole and in order.
+static void test_threads()
+{
+  static RingBuffer<item_t,16> buffer;
+  buffer.reset();
+
+  std::thread producer([] {
+    uint32_t sequence = 0;
+    item_t burst[STRESS_BURST];
+    while (sequence < STRESS_ITEMS) {
+      if ((sequence % 3) == 0) {
+        uint16_t count = STRESS_BURST;
+        if (count > STRESS_ITEMS-sequence) { count = STRESS_ITEMS-sequence; }
+        for (uint16_t idx=0; idx<count; idx++) { item_fill(&burst[idx], sequence+idx); }
+        while (!buffer.push(burst, count)) { std::this_thread::yield(); }
+        sequence += count;
+      } else {
+        while (buffer.full()) { std::this_thread::yield(); }
+        item_fill(buffer.write_slot(), sequence++);
+        buffer.commit();
+      }
+    }
+  });
+
+  uint32_t sequence = 0, invalid = 0;
+  item_t item;
+  while (sequence < STRESS_ITEMS) {
+    if (sequence & 1) {
+      if (!buffer.pop(&item)) { std::this_thread::yield(); continue; }
+      if (!item_valid(&item, sequence)) { invalid++; }
+    } else {
+      if (buffer.empty()) { std::this_thread::yield(); continue; }
+      if (!item_valid(buffer.read_slot(), sequence)) { invalid++; }
+      buffer.pop();
+    }
+    sequence++;
+  }
+  producer.join();
+  TEST_EQUAL(invalid, 0);
+  TEST_CHECK(buffer.empty());
+}
+
+
+// On the ESP8266 one side is an interrupt, which may cut into the other anywhere. A timer signal
+// does the same to the producer here, and consumes everything queued, as the stepper interrupt
+// does with the segment buffer. Also catches ordering errors on a host with a single CPU, where
+// the threads above only interleave when the scheduler switches them.
+static RingBuffer<item_t,256> irq_buffer; // Seldom full, so the producer is mostly pushing.
+static volatile uint32_t irq_sequence, irq_invalid;
+
+static void irq_consume(int)
+{
+  while (!irq_buffer.empty()) {
+    if (!item_valid(irq_buffer.read_slot(), irq_sequence)) { irq_invalid++; }
+    irq_buffer.pop();
+    irq_sequence++;
+  }
+}
+
+static void test_interrupt()
+{
+  struct itimerval timer = { { 0, 20 }, { 0, 20 } }; // Every 20us.
+  signal(SIGALRM, irq_consume);
+  setitimer(ITIMER_REAL, &timer, NULL);
+
+  uint32_t sequence = 0;
+  item_t burst[STRESS_BURST];
+  while (sequence < STRESS_IRQ_ITEMS) {
+    if ((sequence % 3) == 0) {
+      for (uint16_t idx=0; idx<STRESS_BURST; idx++) { item_fill(&burst[idx], sequence+idx); }
+      while (!irq_buffer.push(burst, STRESS_BURST)) {}
+      sequence += STRESS_BURST;
+    } else {
+      while (irq_buffer.full()) {}
+      item_fill(irq_buffer.write_slot(), sequence++);
+      irq_buffer.commit();
+    }
+  }
+  while (!irq_buffer.empty()) {}
+
+  timer = { { 0, 0 }, { 0, 0 } };
+  setitimer(ITIMER_REAL, &timer, NULL);
+  TEST_EQUAL(irq_invalid, 0);
+  TEST_EQUAL(irq_sequence, sequence);
+}
+
+
+int main()
+{
+  test_single_thread();
+  test_threads();
+  test_interrupt();
+  return(test_done("test_ring_buffer"));
+}
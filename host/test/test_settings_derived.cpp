@@ -0,0 +1,150 @@
+/*
+  test_settings_derived.cpp - values derived from the settings follow every way they change
+  Part of Grbl
+
+  Grbl is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Grbl is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Grbl.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "test.hpp"
+
+// Compares settings_derived with the values computed from the settings as Grbl 1.1 did, where
+// they were used.
+static void check_derived(const char *when)
+{
+  int failures = test_failures;
+  for (uint8_t idx=0; idx<N_AXIS; idx++) {
+    TEST_CHECK(settings_derived.mm_per_step[idx] == 1.0f/settings.steps_per_mm[idx]);
+    int32_t travel = lroundf(settings.max_travel[idx]*settings.steps_per_mm[idx]);
+    #ifdef HOMING_FORCE_SET_ORIGIN
+      if (bit_istrue(settings.homing_dir_mask,bit(idx))) {
+        TEST_EQUAL(settings_derived.travel_min[idx], 0);
+        TEST_EQUAL(settings_derived.travel_max[idx], -travel);
+      } else
+    #endif
+    {
+      TEST_EQUAL(settings_derived.travel_min[idx], travel);
+      TEST_EQUAL(settings_derived.travel_max[idx], 0);
+    }
+    TEST_EQUAL(settings_derived.step_pin_mask[idx], get_step_pin_mask(idx));
+    TEST_EQUAL(settings_derived.direction_pin_mask[idx], get_direction_pin_mask(idx));
+    TEST_EQUAL(settings_derived.limit_pin_mask[idx], get_limit_pin_mask(idx));
+  }
+  uint8_t invert = 0;
+  #ifdef INVERT_LIMIT_PIN_MASK
+    invert = INVERT_LIMIT_PIN_MASK;
+  #endif
+  if (bit_istrue(settings.flags,BITFLAG_INVERT_LIMIT_PINS)) { invert ^= LIMIT_MASK; }
+  TEST_EQUAL(settings_derived.limit_invert_mask, invert);
+  if (test_failures != failures) { fprintf(stderr, "  after %s\n", when); }
+}
+
+
+// Every axis setting, $100 to $13x, and the global ones the derived values depend on.
+static void test_store()
+{
+  char when[32];
+  const float values[] = { 80.0, 250.0, 1.5, 612.25 };
+  for (uint8_t group=0; group<AXIS_N_SETTINGS; group++) {
+    for (uint8_t idx=0; idx<N_AXIS; idx++) {
+      for (float value : values) {
+        uint8_t parameter = AXIS_SETTINGS_START_VAL + group*AXIS_SETTINGS_INCREMENT + idx;
+        TEST_EQUAL(settings_store_global_setting(parameter, value), STATUS_OK);
+        snprintf(when, sizeof(when), "$%u=%g", parameter, value);
+        check_derived(when);
+      }
+    }
+  }
+  TEST_EQUAL(settings_store_global_setting(5, 1), STATUS_OK);
+  check_derived("$5=1");
+  TEST_EQUAL(settings_store_global_setting(5, 0), STATUS_OK);
+  check_derived("$5=0");
+  TEST_EQUAL(settings_store_global_setting(23, 5), STATUS_OK);
+  check_derived("$23=5");
+
+  // A rejected value leaves them as they were.
+  settings_derived_t before = settings_derived;
+  TEST_CHECK(settings_store_global_setting(AXIS_SETTINGS_START_VAL + AXIS_N_SETTINGS*AXIS_SETTINGS_INCREMENT, 1.0) != STATUS_OK);
+  TEST_CHECK(memcmp(&before, &settings_derived, sizeof(settings_derived_t)) == 0);
+}
+
+
+// A restore and a start up with the saved settings rebuild them too.
+static void test_restore()
+{
+  settings_restore(SETTINGS_RESTORE_DEFAULTS);
+  check_derived("$RST=$");
+  TEST_EQUAL(settings_derived.travel_min[X_AXIS], lroundf(-DEFAULT_X_MAX_TRAVEL*DEFAULT_X_STEPS_PER_MM));
+
+  TEST_EQUAL(settings_store_global_setting(AXIS_SETTINGS_START_VAL + 3*AXIS_SETTINGS_INCREMENT + X_AXIS, 320.0), STATUS_OK);
+  memset(&settings_derived, 0, sizeof(settings_derived_t));
+  settings_init();
+  check_derived("settings_init()");
+  TEST_EQUAL(settings_derived.travel_min[X_AXIS], lroundf(-320.0f*DEFAULT_X_STEPS_PER_MM));
+}
+
+
+// The planner and the soft limit check take the new values right away.
+static void test_users()
+{
+  settings_restore(SETTINGS_RESTORE_DEFAULTS);
+  plan_reset();
+  plan_sync_position();
+
+  TEST_EQUAL(settings_store_global_setting(AXIS_SETTINGS_START_VAL + X_AXIS, 200.0), STATUS_OK);
+  plan_line_data_t pl_data;
+  memset(&pl_data, 0, sizeof(plan_line_data_t));
+  pl_data.feed_rate = 600.0;
+  float target[N_AXIS] = { 0.0 };
+  target[X_AXIS] = 10.0;
+  TEST_EQUAL(plan_buffer_line(target, &pl_data), PLAN_OK);
+  plan_block_t *block = plan_get_current_block();
+  TEST_CHECK(block != NULL);
+  if (block) {
+    TEST_EQUAL(block->steps[X_AXIS], 2000);
+    TEST_NEAR(block->millimeters, 10.0, 1e-5);
+  }
+  plan_reset();
+
+  // $130 is the X travel. Soft limits check machine coordinates against it.
+  target[X_AXIS] = -150.0;
+  TEST_EQUAL(settings_store_global_setting(AXIS_SETTINGS_START_VAL + 3*AXIS_SETTINGS_INCREMENT + X_AXIS, 200.0), STATUS_OK);
+  TEST_CHECK(!system_check_travel_limits(target));
+  TEST_EQUAL(settings_store_global_setting(AXIS_SETTINGS_START_VAL + 3*AXIS_SETTINGS_INCREMENT + X_AXIS, 100.0), STATUS_OK);
+  TEST_CHECK(system_check_travel_limits(target));
+
+  // The check is in steps, so a target past the limit by less than half a step, which the planner
+  // rounds onto the limit, still passes.
+  target[X_AXIS] = -100.0;
+  TEST_CHECK(!system_check_travel_limits(target));
+  target[X_AXIS] = -100.002;
+  TEST_CHECK(!system_check_travel_limits(target));
+  target[X_AXIS] = -100.01;
+  TEST_CHECK(system_check_travel_limits(target));
+
+  // Machine positions are reported with the new resolution.
+  int32_t steps[N_AXIS] = { 0 };
+  steps[X_AXIS] = 2001;
+  TEST_NEAR(system_convert_axis_steps_to_mpos(steps, X_AXIS), 10.005, 1e-5);
+}
+
+
+int main()
+{
+  test_boot();
+  check_derived("start up");
+  test_store();
+  test_restore();
+  test_users();
+  return(test_done("test_settings_derived"));
+}
@@ -0,0 +1,131 @@
+/*
+  test_status_report.cpp - status reports pushed to the clients subscribed with $RI
+  Part of Grbl
+
+  Grbl is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Grbl is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Grbl.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "test.hpp"
+
+#define HOST_CYCLES_MS (F_CPU/1000)
+#define CLIENT_MASK bit((CLIENT_SERIAL-1))
+
+static uint8_t execute(const char *line)
+{
+  char buffer[LINE_BUFFER_SIZE];
+  strcpy(buffer, line);
+  return(system_execute_line(buffer, CLIENT_SERIAL));
+}
+
+static std::string interval()
+{
+  test_capture_begin();
+  TEST_EQUAL(execute("$RI"), STATUS_OK);
+  return(test_capture_end());
+}
+
+// Runs the main program's realtime pass once a millisecond. Returns the status reports sent.
+static int run(uint32_t ms)
+{
+  test_capture_begin();
+  for (uint32_t idx = 0; idx < ms; idx++) {
+    host_advance(HOST_CYCLES_MS);
+    protocol_execute_realtime();
+  }
+  std::string output = test_capture_end();
+  int reports = 0;
+  for (size_t pos = 0; (pos = output.find("<Idle", pos)) != std::string::npos; pos++) { reports++; }
+  return(reports);
+}
+
+
+// A subscription gets a report right away, then one each interval on the virtual clock.
+static void test_interval()
+{
+  TEST_CHECK(interval() == "[RI:0]\r\n");
+  TEST_EQUAL(report_auto_status_clients(), 0);
+
+  TEST_EQUAL(execute("$RI=100"), STATUS_OK);
+  TEST_CHECK(interval() == "[RI:100]\r\n");
+  TEST_EQUAL(report_auto_status_clients(), CLIENT_MASK);
+  host_advance(99*HOST_CYCLES_MS);
+  TEST_EQUAL(report_auto_status_clients(), 0);
+  host_advance(HOST_CYCLES_MS);
+  TEST_EQUAL(report_auto_status_clients(), CLIENT_MASK);
+  host_advance(50*HOST_CYCLES_MS);
+  TEST_EQUAL(report_auto_status_clients(), 0);
+
+  // From the main program, the reports are sent to the client.
+  host_advance(50*HOST_CYCLES_MS);
+  TEST_EQUAL(run(1000), 10);
+}
+
+
+// A state change is reported at once and restarts the interval.
+static void test_state_change()
+{
+  TEST_EQUAL(execute("$RI=100"), STATUS_OK);
+  report_auto_status_clients(); // The first report.
+  host_advance(30*HOST_CYCLES_MS);
+  sys.state = STATE_HOLD;
+  TEST_EQUAL(report_auto_status_clients(), CLIENT_MASK);
+  host_advance(99*HOST_CYCLES_MS);
+  TEST_EQUAL(report_auto_status_clients(), 0);
+  sys.state = STATE_IDLE;
+  TEST_EQUAL(report_auto_status_clients(), CLIENT_MASK);
+
+  // $RI=C reports only the changes.
+  TEST_EQUAL(execute("$RI=C"), STATUS_OK);
+  TEST_CHECK(interval() == "[RI:C]\r\n");
+  TEST_EQUAL(report_auto_status_clients(), CLIENT_MASK); // The first report.
+  host_advance(1000*HOST_CYCLES_MS);
+  TEST_EQUAL(report_auto_status_clients(), 0);
+  sys.state = STATE_HOLD;
+  TEST_EQUAL(report_auto_status_clients(), CLIENT_MASK);
+  TEST_EQUAL(report_auto_status_clients(), 0);
+  sys.state = STATE_IDLE;
+}
+
+
+// Short intervals are raised to the minimum, and $RI=0 turns the reports off.
+static void test_limits()
+{
+  TEST_EQUAL(execute("$RI=5"), STATUS_OK);
+  char expected[16];
+  snprintf(expected, sizeof(expected), "[RI:%d]\r\n", AUTO_STATUS_REPORT_MIN_INTERVAL);
+  TEST_CHECK(interval() == expected);
+  TEST_EQUAL(run(1000), 1000/AUTO_STATUS_REPORT_MIN_INTERVAL);
+
+  TEST_EQUAL(execute("$RI=-1"), STATUS_NEGATIVE_VALUE);
+  TEST_EQUAL(execute("$RI=65535"), STATUS_INVALID_STATEMENT);
+  TEST_EQUAL(execute("$RI=1X"), STATUS_INVALID_STATEMENT);
+
+  TEST_EQUAL(execute("$RI=0"), STATUS_OK);
+  TEST_CHECK(interval() == "[RI:0]\r\n");
+  TEST_EQUAL(run(1000), 0);
+  sys.state = STATE_HOLD;
+  TEST_EQUAL(report_auto_status_clients(), 0);
+  sys.state = STATE_IDLE;
+  TEST_EQUAL(report_auto_status_clients(), 0);
+}
+
+
+int main()
+{
+  test_boot();
+  test_interval();
+  test_state_change();
+  test_limits();
+  return(test_done("test_status_report"));
+}
@@ -0,0 +1,236 @@
+/*
+  test_telemetry.cpp - delta encoded binary status telemetry
+  Part of Grbl
+
+  Grbl is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Grbl is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Grbl.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <vector>
+#include "test.hpp"
+
+#define HOST_CYCLES_MS (F_CPU/1000)
+
+typedef std::vector<uint8_t> bytes_t;
+
+static std::vector<bytes_t> frames; // Sent since cleared.
+
+static void websocket_receive(const uint8_t *message, size_t length)
+{
+  frames.push_back(bytes_t(message, message+length));
+}
+
+// The values as a dashboard decodes them from the frames.
+typedef struct {
+  uint8_t type;
+  uint8_t sequence;
+  uint8_t fields;
+  uint8_t state;
+  uint8_t suspend;
+  uint8_t overrides[3];
+  uint8_t planner_available;
+  uint32_t rx_available;
+  int32_t feed;
+  uint8_t axis_mask;
+  int32_t position[N_AXIS];
+} decoded_t;
+
+static decoded_t client;
+
+static uint32_t read_varint(const bytes_t &frame, size_t &pos)
+{
+  uint32_t value = 0;
+  for (uint8_t shift = 0; pos < frame.size(); shift += 7) {
+    uint8_t data = frame[pos++];
+    value |= (uint32_t)(data & 0x7F) << shift;
+    if (!(data & 0x80)) { break; }
+  }
+  return(value);
+}
+
+static int32_t read_zigzag(const bytes_t &frame, size_t &pos)
+{
+  uint32_t value = read_varint(frame, pos);
+  return((int32_t)(value >> 1) ^ -(int32_t)(value & 1));
+}
+
+// Applies the frame to the client's values, as documented in telemetry.hpp.
+static void decode(const bytes_t &frame)
+{
+  size_t pos = 0;
+  client.type = frame[pos++];
+  client.sequence = frame[pos++];
+  client.fields = frame[pos++];
+  if (client.type == TLM_FRAME_KEY) {
+    client.feed = 0;
+    memset(client.position, 0, sizeof(client.position));
+  }
+  if (client.fields & TLM_FIELD_STATE) {
+    client.state = frame[pos++];
+    client.suspend = frame[pos++];
+  }
+  if (client.fields & TLM_FIELD_OVERRIDES) {
+    for (uint8_t idx = 0; idx < 3; idx++) { client.overrides[idx] = frame[pos++]; }
+  }
+  if (client.fields & TLM_FIELD_BUFFER) {
+    client.planner_available = frame[pos++];
+    client.rx_available = read_varint(frame, pos);
+  }
+  if (client.fields & TLM_FIELD_FEED) { client.feed += read_zigzag(frame, pos); }
+  client.axis_mask = 0;
+  if (client.fields & TLM_FIELD_POSITION) {
+    client.axis_mask = frame[pos++];
+    for (uint8_t idx = 0; idx < N_AXIS; idx++) {
+      if (client.axis_mask & bit(idx)) { client.position[idx] += read_zigzag(frame, pos); }
+    }
+  }
+  TEST_EQUAL(pos, frame.size());
+}
+
+// Polls the telemetry once the interval is due, and decodes the frame sent, if any. Returns
+// whether one was.
+static bool poll()
+{
+  host_advance(TELEMETRY_INTERVAL*HOST_CYCLES_MS);
+  frames.clear();
+  telemetry_poll();
+  TEST_CHECK(frames.size() <= 1);
+  if (frames.empty()) { return(false); }
+  decode(frames[0]);
+  return(true);
+}
+
+
+// Nothing is sent without a client. A client gets a key frame with all fields first.
+static void test_key_frame()
+{
+  TEST_CHECK(!poll());
+
+  host_websocket_set_hook(websocket_receive);
+  sys_position[X_AXIS] = 1234;
+  sys_position[Y_AXIS] = -5;
+  TEST_CHECK(poll());
+  TEST_EQUAL(client.type, TLM_FRAME_KEY);
+  TEST_EQUAL(client.fields, TLM_FIELD_STATE | TLM_FIELD_OVERRIDES | TLM_FIELD_BUFFER | TLM_FIELD_FEED | TLM_FIELD_POSITION);
+  TEST_EQUAL(client.state, STATE_IDLE);
+  TEST_EQUAL(client.overrides[0], DEFAULT_FEED_OVERRIDE);
+  TEST_EQUAL(client.overrides[1], DEFAULT_RAPID_OVERRIDE);
+  TEST_EQUAL(client.overrides[2], DEFAULT_SPINDLE_SPEED_OVERRIDE);
+  TEST_EQUAL(client.planner_available, plan_get_block_buffer_available());
+  TEST_EQUAL(client.rx_available, serial_get_rx_buffer_available(CLIENT_WEBSOCKET));
+  TEST_EQUAL(client.feed, 0);
+  TEST_EQUAL(client.axis_mask, (1 << N_AXIS)-1);
+  TEST_EQUAL(client.position[X_AXIS], 1234);
+  TEST_EQUAL(client.position[Y_AXIS], -5);
+  TEST_EQUAL(client.position[Z_AXIS], 0);
+}
+
+
+// Delta frames hold only the changed fields, and none is sent without a change.
+static void test_delta_frames()
+{
+  uint8_t sequence = client.sequence;
+  TEST_CHECK(!poll());
+  frames.clear();
+  telemetry_poll(); // Before the interval.
+  TEST_CHECK(frames.empty());
+
+  sys.f_override = 120;
+  sys_position[X_AXIS] = 1000; // A delta of -234.
+  TEST_CHECK(poll());
+  TEST_EQUAL(client.type, TLM_FRAME_DELTA);
+  TEST_EQUAL(client.sequence, (uint8_t)(sequence+1));
+  TEST_EQUAL(client.fields, TLM_FIELD_OVERRIDES | TLM_FIELD_POSITION);
+  TEST_EQUAL(client.overrides[0], 120);
+  TEST_EQUAL(client.axis_mask, bit(X_AXIS));
+  TEST_EQUAL(client.position[X_AXIS], 1000);
+  TEST_EQUAL(frames[0].size(), 3 + 3 + 1 + 2); // Header, overrides, axis mask, 2 byte varint.
+
+  sys.state = STATE_HOLD;
+  sys.suspend = SUSPEND_HOLD_COMPLETE;
+  TEST_CHECK(poll());
+  TEST_EQUAL(client.fields, TLM_FIELD_STATE);
+  TEST_EQUAL(client.state, STATE_HOLD);
+  TEST_EQUAL(client.suspend, SUSPEND_HOLD_COMPLETE);
+  sys.state = STATE_IDLE;
+  sys.suspend = 0;
+  TEST_CHECK(poll());
+  sys.f_override = DEFAULT_FEED_OVERRIDE;
+  TEST_CHECK(poll());
+}
+
+
+// Every TELEMETRY_KEY_FRAME_INTERVAL frames, and after a reconnect, a key frame lets the client
+// sync up again.
+static void test_key_frame_interval()
+{
+  uint8_t key_frames = 0;
+  for (uint16_t idx = 0; idx < 2*TELEMETRY_KEY_FRAME_INTERVAL; idx++) {
+    sys_position[Z_AXIS]++;
+    TEST_CHECK(poll());
+    if (client.type == TLM_FRAME_KEY) { key_frames++; }
+    TEST_EQUAL(client.position[Z_AXIS], sys_position[Z_AXIS]);
+  }
+  TEST_EQUAL(key_frames, 2);
+
+  host_websocket_set_hook(NULL);
+  TEST_CHECK(!poll());
+  host_websocket_set_hook(websocket_receive);
+  memset(&client, 0, sizeof(client)); // A new client.
+  TEST_CHECK(poll());
+  TEST_EQUAL(client.type, TLM_FRAME_KEY);
+  TEST_EQUAL(client.position[X_AXIS], 1000);
+  TEST_EQUAL(client.position[Z_AXIS], sys_position[Z_AXIS]);
+}
+
+
+// During motion, the decoded values track the machine through the main program.
+static void test_motion()
+{
+  char line[] = "G1X10Y-4F600";
+  TEST_EQUAL(gc_execute_line(line, CLIENT_SERIAL), STATUS_OK);
+  protocol_auto_cycle_start();
+  int32_t fastest = 0;
+  uint32_t sent = 0;
+  uint32_t last_sent = 0;
+  for (uint32_t ms = 0; ms < 2000; ms++) {
+    frames.clear();
+    host_advance(HOST_CYCLES_MS);
+    protocol_execute_realtime();
+    if (frames.empty()) { continue; }
+    TEST_EQUAL(frames.size(), 1);
+    decode(frames[0]);
+    if (sent++) { TEST_CHECK(millis()-last_sent >= TELEMETRY_INTERVAL); } // Throttled.
+    last_sent = millis();
+    TEST_EQUAL(client.state, sys.state);
+    if (client.feed > fastest) { fastest = client.feed; }
+  }
+  TEST_EQUAL(sys.state, STATE_IDLE);
+  poll(); // Catches up on the last change, if any.
+  TEST_EQUAL(client.state, STATE_IDLE);
+  TEST_EQUAL(client.feed, 0);
+  for (uint8_t idx = 0; idx < N_AXIS; idx++) { TEST_EQUAL(client.position[idx], sys_position[idx]); }
+  TEST_NEAR(fastest, 6000, 60); // 600mm/min in 0.1mm/min.
+  TEST_CHECK(sent > 50); // Over a second of motion.
+}
+
+
+int main()
+{
+  test_boot();
+  test_key_frame();
+  test_delta_frames();
+  test_key_frame_interval();
+  test_motion();
+  return(test_done("test_telemetry"));
+}
@@ -0,0 +1,189 @@
+/*
+  test_trace.cpp - position trace capture, and its conversion by tools/trace_convert.py
+  Part of Grbl
+
+  Grbl is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Grbl is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Grbl.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <vector>
+#include "test.hpp"
+
+typedef struct {
+  uint32_t timestamp;
+  uint32_t n_step;
+  uint32_t cycles_per_tick;
+  uint32_t block;
+  int32_t position[N_AXIS];
+} segment_t;
+
+static std::vector<segment_t> segments; // Read out by the last read_out().
+static int capturing;
+static int dropped;
+
+static uint8_t execute(const char *line)
+{
+  char buffer[LINE_BUFFER_SIZE];
+  strcpy(buffer, line);
+  if (line[0] == '$') { return(system_execute_line(buffer, CLIENT_SERIAL)); }
+  uint8_t status = gc_execute_line(buffer, CLIENT_SERIAL);
+  protocol_buffer_synchronize(); // Runs the motion to the end.
+  return(status);
+}
+
+// Reads out the trace with $TR and parses its lines. Returns the output.
+static std::string read_out()
+{
+  test_capture_begin();
+  TEST_EQUAL(execute("$TR"), STATUS_OK);
+  std::string output = test_capture_end();
+
+  segments.clear();
+  capturing = dropped = -1;
+  const char *line = output.c_str();
+  while (strncmp(line, "[TR:", 4) == 0) {
+    segment_t segment;
+    int length;
+    TEST_EQUAL(sscanf(line, "[TR:%u,%u,%u,%u%n", &segment.timestamp, &segment.n_step, &segment.cycles_per_tick,
+                      &segment.block, &length), 4);
+    line += length;
+    for (uint8_t idx = 0; idx < N_AXIS; idx++) {
+      TEST_EQUAL(sscanf(line, ",%d%n", &segment.position[idx], &length), 1);
+      line += length;
+    }
+    TEST_CHECK(strncmp(line, "]\r\n", 3) == 0);
+    line += 3;
+    segments.push_back(segment);
+  }
+  TEST_EQUAL(sscanf(line, "[TRE:%d,%d]\r\n", &capturing, &dropped), 2);
+  TEST_CHECK(strchr(line, '\n')[1] == 0);
+  return(output);
+}
+
+
+// A capture records every segment of a move, with the position at its start, in order.
+static void test_capture()
+{
+  TEST_EQUAL(execute("$TR=1"), STATUS_OK);
+  TEST_EQUAL(execute("G1X3F300"), STATUS_OK);
+  read_out();
+  TEST_EQUAL(capturing, 1);
+  TEST_EQUAL(dropped, 0);
+  TEST_CHECK(segments.size() > 10);
+  for (size_t idx = 0; idx < segments.size(); idx++) {
+    int32_t end = (idx+1 < segments.size()) ? segments[idx+1].position[X_AXIS] : sys_position[X_AXIS];
+    // n_step counts the ISR ticks, which AMASS multiplies at low step rates.
+    TEST_CHECK((end > segments[idx].position[X_AXIS]) && (end-segments[idx].position[X_AXIS] <= (int32_t)segments[idx].n_step));
+    TEST_EQUAL(segments[idx].position[Y_AXIS], 0);
+    TEST_CHECK(segments[idx].cycles_per_tick > 0);
+    if (idx) { TEST_CHECK(segments[idx].timestamp > segments[idx-1].timestamp); }
+  }
+  TEST_EQUAL(segments[0].position[X_AXIS], 0);
+  TEST_EQUAL(sys_position[X_AXIS], 3*DEFAULT_X_STEPS_PER_MM);
+
+  // A read out removes the segments. $TR=0 stops the capture.
+  read_out();
+  TEST_EQUAL(segments.size(), 0);
+  TEST_EQUAL(capturing, 1);
+  TEST_EQUAL(execute("$TR=0"), STATUS_OK);
+  TEST_EQUAL(execute("G1X0"), STATUS_OK);
+  read_out();
+  TEST_EQUAL(segments.size(), 0);
+  TEST_EQUAL(capturing, 0);
+
+  TEST_EQUAL(execute("$TR=2"), STATUS_INVALID_STATEMENT);
+  TEST_EQUAL(execute("$TR1"), STATUS_INVALID_STATEMENT);
+}
+
+
+// Without a read out, a long capture fills the ring and counts the segments dropped.
+static void test_overflow()
+{
+  TEST_EQUAL(execute("$TR=1"), STATUS_OK);
+  TEST_EQUAL(execute("G1X50F3000"), STATUS_OK);
+  read_out();
+  TEST_EQUAL(segments.size(), TRACE_BUFFER_SIZE-1);
+  TEST_CHECK(dropped > 0);
+  TEST_EQUAL(segments[0].position[X_AXIS], 0);
+  read_out();
+  TEST_EQUAL(dropped, 0); // Counted since the previous read out.
+  TEST_EQUAL(execute("$TR=0"), STATUS_OK);
+  TEST_EQUAL(execute("G0X0"), STATUS_OK);
+}
+
+
+// trace_convert.py reads the console log back into the same segments.
+static void test_convert()
+{
+  const char *tools = getenv("TOOLS");
+  const char *python = getenv("PYTHON");
+  if (!TEST_CHECK(tools != NULL)) { return; } // Set by make -C host test.
+  if (!python) { python = "python3"; }
+
+  TEST_EQUAL(execute("$TR=1"), STATUS_OK);
+  TEST_EQUAL(execute("G1X2Y-1F400"), STATUS_OK);
+  std::string log = "ok\r\n" + read_out() + "ok\r\n"; // Other lines are ignored.
+  TEST_CHECK(segments.size() > 10);
+  FILE *file = fopen("trace.log", "w");
+  fputs(log.c_str(), file);
+  fclose(file);
+
+  char command[512];
+  snprintf(command, sizeof(command), "%s %s/trace_convert.py --cpu-mhz %g trace.log", python, tools, F_CPU/1e6);
+  FILE *csv = popen(command, "r");
+  if (!TEST_CHECK(csv != NULL)) { return; }
+  char line[256];
+  TEST_CHECK(fgets(line, sizeof(line), csv) != NULL);
+  TEST_CHECK(strncmp(line, "time_us,n_step,cycles_per_tick,block,X,Y,Z", 42) == 0);
+  size_t rows = 0;
+  while (fgets(line, sizeof(line), csv)) {
+    if (!TEST_CHECK(rows < segments.size())) { break; }
+    const segment_t &segment = segments[rows++];
+    double time_us;
+    uint32_t n_step, cycles_per_tick, block;
+    int length;
+    TEST_EQUAL(sscanf(line, "%lf,%u,%u,%u%n", &time_us, &n_step, &cycles_per_tick, &block, &length), 4);
+    TEST_NEAR(time_us, (segment.timestamp-segments[0].timestamp)/(F_CPU/1e6), 0.001);
+    TEST_EQUAL(n_step, segment.n_step);
+    TEST_EQUAL(cycles_per_tick, segment.cycles_per_tick);
+    TEST_EQUAL(block, segment.block);
+    const char *values = line+length;
+    for (uint8_t idx = 0; idx < N_AXIS; idx++) {
+      int32_t position;
+      TEST_EQUAL(sscanf(values, ",%d%n", &position, &length), 1);
+      TEST_EQUAL(position, segment.position[idx]);
+      values += length;
+    }
+  }
+  TEST_EQUAL(rows, segments.size());
+  TEST_EQUAL(pclose(csv), 0);
+
+  snprintf(command, sizeof(command), "%s %s/trace_convert.py --vcd trace.log > trace.vcd", python, tools);
+  TEST_EQUAL(system(command), 0);
+  file = fopen("trace.vcd", "r");
+  if (!TEST_CHECK(file != NULL)) { return; }
+  size_t times = 0;
+  while (fgets(line, sizeof(line), file)) { times += (line[0] == '#'); }
+  fclose(file);
+  TEST_EQUAL(times, segments.size());
+}
+
+
+int main()
+{
+  test_boot();
+  test_capture();
+  test_overflow();
+  test_convert();
+  return(test_done("test_trace"));
+}
@@ -0,0 +1,211 @@
+/*
+  binary_stream.cpp - compact binary framing for streamed g-code blocks
+  Part of Grbl
+
+  Grbl is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Grbl is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Grbl.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "grbl.hpp"
+
+#ifdef ENABLE_BINARY_STREAMING
+
+#define BS_RX_IDLE 0
+#define BS_RX_AWAIT_LENGTH 0xFF // Receive filter state. Otherwise, number of frame bytes still to come.
+#define BS_RX_TIMEOUT_CYCLES ((uint32_t)BS_FRAME_TIMEOUT*(F_CPU/1000L))
+
+#define BS_STATE_IDLE    0
+#define BS_STATE_LENGTH  1
+#define BS_STATE_PAYLOAD 2
+#define BS_STATE_CRC     3
+
+typedef struct {
+  uint8_t state;
+  uint8_t length;
+  uint8_t count;
+  uint8_t crc;
+  uint8_t payload[BS_FRAME_MAX_PAYLOAD];
+} bs_frame_t;
+
+// Receive filter state. Written by the serial receive path, and cleared by bs_reset().
+static volatile uint8_t bs_rx_remaining[CLIENT_COUNT];
+static uint8_t bs_rx_crc[CLIENT_COUNT];   // Of the frame bytes so far, as the decoder computes it.
+static uint32_t bs_rx_time[CLIENT_COUNT]; // Cycle count at the last frame byte.
+static bs_frame_t bs_frame[CLIENT_COUNT];
+static int32_t bs_history[CLIENT_COUNT][26]; // Last fixed-point value per word letter. Delta base.
+
+
+static uint8_t ICACHE_RAM_ATTR bs_crc8(uint8_t crc, uint8_t data)
+{
+  crc ^= data;
+  for (uint8_t i=0; i<8; i++) {
+    if (crc & 0x80) { crc = (crc << 1) ^ 0x07; }
+    else { crc <<= 1; }
+  }
+  return(crc);
+}
+
+
+uint8_t ICACHE_RAM_ATTR bs_rx_filter(uint8_t client, uint8_t data, uint8_t *pad)
+{
+  uint8_t client_idx = client - 1;
+  uint8_t remaining = bs_rx_remaining[client_idx];
+  uint32_t now = ESP.getCycleCount();
+  if (remaining == BS_RX_IDLE) {
+    if (data != BS_FRAME_START) { return(BS_RX_TEXT); }
+    bs_rx_remaining[client_idx] = BS_RX_AWAIT_LENGTH;
+  } else if ((now - bs_rx_time[client_idx]) > BS_RX_TIMEOUT_CYCLES) {
+    // The sender stopped mid-frame. Complete the frame for the decoder, with a zero length if it
+    // has none yet, or with the inverted CRC, so it reports an error and drops the frame.
+    if (remaining == BS_RX_AWAIT_LENGTH) { *pad = 0; remaining = BS_RX_IDLE; }
+    else if (remaining == 1) { *pad = ~bs_rx_crc[client_idx]; remaining = BS_RX_IDLE; }
+    else {
+      *pad = 0;
+      bs_rx_crc[client_idx] = bs_crc8(bs_rx_crc[client_idx], 0);
+      remaining--;
+    }
+    bs_rx_remaining[client_idx] = remaining;
+    return(BS_RX_PAD);
+  } else if (remaining == BS_RX_AWAIT_LENGTH) {
+    // An invalid length ends the frame here. The decoder sees the same byte and reports the error.
+    if ((data == 0) || (data > BS_FRAME_MAX_PAYLOAD)) { bs_rx_remaining[client_idx] = BS_RX_IDLE; }
+    else {
+      bs_rx_remaining[client_idx] = data+1; // Payload and CRC byte.
+      bs_rx_crc[client_idx] = bs_crc8(0, data);
+    }
+  } else {
+    if (remaining > 1) { bs_rx_crc[client_idx] = bs_crc8(bs_rx_crc[client_idx], data); }
+    bs_rx_remaining[client_idx] = remaining-1;
+  }
+  bs_rx_time[client_idx] = now;
+  return(BS_RX_FRAME);
+}
+
+
+uint8_t bs_frame_active(uint8_t client)
+{
+  return(bs_frame[client-1].state != BS_STATE_IDLE);
+}
+
+
+uint8_t bs_frame_read(uint8_t client, uint8_t data)
+{
+  bs_frame_t *frame = &bs_frame[client-1];
+  switch (frame->state) {
+    case BS_STATE_IDLE: // data == BS_FRAME_START
+      frame->state = BS_STATE_LENGTH;
+      break;
+    case BS_STATE_LENGTH:
+      if ((data == 0) || (data > BS_FRAME_MAX_PAYLOAD)) {
+        frame->state = BS_STATE_IDLE;
+        return(STATUS_BINARY_FRAME_INVALID);
+      }
+      frame->length = data;
+      frame->count = 0;
+      frame->crc = bs_crc8(0, data);
+      frame->state = BS_STATE_PAYLOAD;
+      break;
+    case BS_STATE_PAYLOAD:
+      frame->payload[frame->count++] = data;
+      frame->crc = bs_crc8(frame->crc, data);
+      if (frame->count == frame->length) { frame->state = BS_STATE_CRC; }
+      break;
+    default: // BS_STATE_CRC
+      frame->state = BS_STATE_IDLE;
+      if (frame->crc != data) { return(STATUS_BINARY_FRAME_CHECKSUM); }
+      return(STATUS_OK);
+  }
+  return(BS_FRAME_PENDING);
+}
+
+
+// Reads a zigzag encoded varint from the payload. Returns false, if it runs past the payload
+// end or exceeds 32 bits.
+static uint8_t bs_read_varint(bs_frame_t *frame, uint8_t *index, int32_t *value)
+{
+  uint32_t raw = 0;
+  uint8_t shift = 0;
+  uint8_t data;
+  do {
+    if ((*index >= frame->length) || (shift > 28)) { return(false); }
+    data = frame->payload[(*index)++];
+    if ((shift == 28) && (data & 0x70)) { return(false); } // Bits past 32 in the fifth byte.
+    raw |= (uint32_t)(data & 0x7F) << shift;
+    shift += 7;
+  } while (data & 0x80);
+  *value = (int32_t)(raw >> 1) ^ -(int32_t)(raw & 1);
+  return(true);
+}
+
+
+uint8_t bs_frame_execute(uint8_t client)
+{
+  bs_frame_t *frame = &bs_frame[client-1];
+  int32_t *history = bs_history[client-1];
+  gc_word_t words[BS_MAX_WORDS];
+  int32_t fixed[BS_MAX_WORDS];
+  uint8_t word_count = 0;
+  uint8_t index = 0;
+  uint8_t letter_idx;
+
+  // Validate and decode the whole frame before anything is committed to the delta history.
+  while (index < frame->length) {
+    if (word_count == BS_MAX_WORDS) { return(STATUS_BINARY_FRAME_INVALID); }
+    uint8_t token = frame->payload[index++];
+    letter_idx = token & 0x1F;
+    if (letter_idx > ('Z'-'A')) { return(STATUS_BINARY_FRAME_INVALID); }
+    words[word_count].letter = 'A'+letter_idx;
+    switch (token >> 5) {
+      case BS_TOKEN_COMMAND:
+        if ((index+2) > frame->length) { return(STATUS_BINARY_FRAME_INVALID); }
+        words[word_count].value = (frame->payload[index] | (frame->payload[index+1] << 8))*0.1f;
+        words[word_count].letter |= 0x80; // Flag as command. Cleared when committing the history.
+        index += 2;
+        break;
+      case BS_TOKEN_ABSOLUTE:
+        if (!bs_read_varint(frame, &index, &fixed[word_count])) { return(STATUS_BINARY_FRAME_INVALID); }
+        words[word_count].value = fixed[word_count]*(1.0f/BS_COORD_SCALE);
+        break;
+      case BS_TOKEN_DELTA:
+        if (!bs_read_varint(frame, &index, &fixed[word_count])) { return(STATUS_BINARY_FRAME_INVALID); }
+        fixed[word_count] += history[letter_idx];
+        words[word_count].value = fixed[word_count]*(1.0f/BS_COORD_SCALE);
+        break;
+      default: return(STATUS_BINARY_FRAME_INVALID);
+    }
+    word_count++;
+  }
+
+  // Frame is well-formed. Update the delta history regardless of the g-code execution result, so
+  // the sender can always track it from the frames it has sent.
+  for (index=0; index<word_count; index++) {
+    if (words[index].letter & 0x80) { words[index].letter &= 0x7F; }
+    else { history[words[index].letter-'A'] = fixed[index]; }
+  }
+
+  return(gc_execute_words(words, word_count, client));
+}
+
+
+void bs_reset(uint8_t client)
+{
+  for (uint8_t client_num = 1; client_num <= CLIENT_COUNT; client_num++) {
+    if (client == client_num || client == CLIENT_ALL) {
+      bs_rx_remaining[client_num-1] = BS_RX_IDLE; // Or the filter would still skip realtime commands.
+      bs_frame[client_num-1].state = BS_STATE_IDLE;
+      memset(bs_history[client_num-1], 0, sizeof(bs_history[0]));
+    }
+  }
+}
+
+#endif
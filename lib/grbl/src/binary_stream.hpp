@@ -0,0 +1,83 @@
+/*
+  binary_stream.hpp - compact binary framing for streamed g-code blocks
+  Part of Grbl
+
+  Grbl is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Grbl is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Grbl.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef binary_stream_h
+#define binary_stream_h
+
+/*
+  Frame layout on the wire:
+
+    [BS_FRAME_START] [length] [payload: length bytes] [crc8]
+
+  The CRC-8 (poly 0x07, init 0x00) is computed over the length byte and the payload. The payload
+  is a sequence of pre-tokenized g-code words. Each word starts with a token byte, where the upper
+  three bits select the encoding and the lower five bits hold the word letter as (letter - 'A').
+
+    BS_TOKEN_COMMAND  : 2 bytes, little-endian uint16 of the value times ten. G1 = 10, G38.2 = 382.
+    BS_TOKEN_ABSOLUTE : zigzag varint of the value in fixed-point units of 1/BS_COORD_SCALE.
+    BS_TOKEN_DELTA    : zigzag varint added to the last fixed-point value sent for the same letter.
+
+  Every block is answered with 'ok' or 'error:' exactly like a text line, so character-counting
+  senders simply count frame bytes. Bytes within a frame bypass the realtime command filter, which
+  means a realtime command is honored once the frame in flight has been received. A frame whose
+  bytes stop for BS_FRAME_TIMEOUT is abandoned with an error when the next byte arrives, which is
+  then filtered as usual.
+*/
+
+#define BS_FRAME_START 0x02 // ASCII STX. Never part of a g-code program.
+#ifndef BS_FRAME_MAX_PAYLOAD
+  #define BS_FRAME_MAX_PAYLOAD 64 // (1-250) Max payload bytes of a single frame.
+#endif
+#ifndef BS_COORD_SCALE
+  #define BS_COORD_SCALE 10000 // Fixed-point units per program unit. 0.1um or 0.00001in resolution.
+#endif
+#ifndef BS_FRAME_TIMEOUT
+  #define BS_FRAME_TIMEOUT 500 // (ms) Max gap between the bytes of a frame. Rides out Wi-Fi stalls.
+#endif
+#define BS_MAX_WORDS 24 // Max g-code words per frame.
+
+#define BS_TOKEN_COMMAND  0
+#define BS_TOKEN_ABSOLUTE 1
+#define BS_TOKEN_DELTA    2
+
+// Returned by bs_frame_read() while a frame is still being received.
+#define BS_FRAME_PENDING 0xFF
+
+// Returned by bs_rx_filter().
+#define BS_RX_TEXT  0 // Not part of a frame. Filter for realtime commands.
+#define BS_RX_FRAME 1 // Part of a frame. Buffer as is.
+#define BS_RX_PAD   2 // Buffer the pad byte and call again with the same byte.
+
+// Called from the serial receive interrupt for every incoming byte before realtime command
+// filtering. A timed out frame is first completed with pad bytes, which fail its CRC check.
+uint8_t bs_rx_filter(uint8_t client, uint8_t data, uint8_t *pad);
+
+// Returns true, if the protocol has started, but not yet completed reading a frame from client.
+uint8_t bs_frame_active(uint8_t client);
+
+// Feeds one byte read from the client receive buffer to the frame decoder. Returns
+// BS_FRAME_PENDING until the frame is complete, then STATUS_OK or a frame error status.
+uint8_t bs_frame_read(uint8_t client, uint8_t data);
+
+// Decodes the completed frame of client and executes it as a g-code block.
+uint8_t bs_frame_execute(uint8_t client);
+
+// Clears the frame decoder state and delta history. Used by reset.
+void bs_reset(uint8_t client);
+
+#endif
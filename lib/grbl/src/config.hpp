@@ -45,6 +45,14 @@
 
 #define ENABLE_SERIAL2SOCKET    // Enables socket serial communication
 
+// Receives UART data in the UART RX FIFO interrupt, instead of draining Serial from a 1msec Ticker.
+// Bytes are moved from the hardware FIFO directly into the client read buffer and realtime commands
+// are picked off right there, within microseconds of arriving. Without it, baud rates above 230400
+// risk overrunning the 128 byte hardware FIFO between two polls. Status reports requested by '?'
+// are flagged and sent by the main program, as in the original Grbl.
+// NOTE: The FIFO threshold and idle timeout of the interrupt can be tuned in serial.h.
+#define ENABLE_UART_RX_INTERRUPT // Default enabled. Comment to disable.
+
 // Define realtime command special characters. These characters are 'picked-off' directly from the
 // serial read data stream and are not passed to the grbl line execution parser. Select characters
 // that do not and must not exist in the streamed g-code program. ASCII control characters may be
@@ -172,6 +180,23 @@
 // NOTE: The M8 flood coolant control pin on analog pin 3 will still be functional regardless.
 // #define ENABLE_M7 // Disabled by default. Uncomment to enable.
 
+// Enables the canned drilling cycles G73, G81, G82 and G83, with the retract modes G98 and G99, as
+// LinuxCNC runs them. A drilling program then takes one short line per hole. The R, Z, Q and P words
+// carry over to the following holes of a cycle, and L repeats a hole in incremental mode. Each hole
+// is expanded into line motions by mc_canned_cycle(). Peck drilling stops short of the previous depth
+// by the peck clearance, when going back down into the hole, and G73 retracts that far to break the
+// chip. Rotary axis words and inverse time feed rates aren't supported in a cycle. A Q word that
+// takes more than CANNED_CYCLE_MAX_PECKS pecks to reach the bottom of the hole is rejected.
+#define ENABLE_CANNED_CYCLES // Enabled by default. Comment to disable.
+#define CANNED_CYCLE_PECK_CLEARANCE 0.25 // Float (mm)
+#define CANNED_CYCLE_MAX_PECKS 1000 // Integer (1-65535)
+
+// Executes blocks of only axis words, with an optional G0 or G1, F and N word, on a short path that
+// skips the parser's block setup, modal group bookkeeping and the error-checks these words can't fail.
+// Most lines of CAM output are such blocks. Applies only in G0 or G1 motion mode, in G94 and without
+// laser mode. Any other block, or one that would fail, goes through the full parser as usual.
+#define ENABLE_GCODE_FAST_PATH // Default enabled. Comment to disable.
+
 // This option causes the feed hold input to act as a safety door switch. A safety door, when triggered,
 // immediately forces a feed hold and then safely de-energizes the machine. Resuming is blocked until
 // the safety door is re-engaged. When it is, Grbl will re-energize the machine and then resume on the
@@ -291,6 +316,100 @@
 #define REPORT_WCO_REFRESH_BUSY_COUNT 30  // (2-255)
 #define REPORT_WCO_REFRESH_IDLE_COUNT 10  // (2-255) Must be less than or equal to the busy count
 
+// Enables push-based status reports. Instead of polling with '?' at 5-20Hz, a client may subscribe
+// with '$RI=<ms>' to receive a status report every <ms> milliseconds and immediately upon any state
+// change, or with '$RI=C' to only receive reports upon state changes. '$RI=0' unsubscribes and '$RI'
+// prints the current subscription. The report is built once and sent to all clients due at the time,
+// so the cost no longer grows with the number of polling clients. '?' keeps working as before.
+// NOTE: Subscriptions are kept through a soft-reset, but not through a power cycle.
+#define ENABLE_AUTO_STATUS_REPORT // Default enabled. Comment to disable.
+#define AUTO_STATUS_REPORT_MIN_INTERVAL 20 // (ms) Shorter subscribed intervals are raised to this.
+
+// Enables a binary telemetry stream to all websocket clients for dashboards, which only need the
+// position, feed rate, state, overrides and buffer fill, but at a high rate. Each frame holds only
+// the values changed since the previous frame, delta encoded, with positions in machine steps, and
+// no frame is sent when nothing changed. This is far cheaper to build and send than text status
+// reports. Frames go out as websocket binary messages, so text clients are not affected. See
+// telemetry.hpp for the frame layout.
+// #define ENABLE_BINARY_TELEMETRY // Default disabled. Uncomment to enable.
+// #define TELEMETRY_INTERVAL 20 // (ms) Uncomment to override default in telemetry.hpp
+
+// Enables capturing every step segment loaded by the stepper ISR into a RAM ring, with its CPU
+// cycle timestamp, step count, step rate, planner block and the machine position. Meant for tuning
+// acceleration and step rates against what the stepper actually executed. $TR=1 starts and $TR=0
+// stops a capture, $TR reads it out as text to the requesting client. Convert a captured console log
+// with tools/trace_convert.py to CSV or VCD. See trace.hpp for the line format.
+// NOTE: Costs a few microseconds per segment in the stepper ISR while capturing, and
+// TRACE_BUFFER_SIZE*44 bytes of RAM. Segments are dropped and counted when the ring is full, so
+// read out long captures while they run.
+// #define ENABLE_POSITION_TRACE // Default disabled. Uncomment to enable.
+// #define TRACE_BUFFER_SIZE 128 // Uncomment to override default in trace.hpp
+
+// Keeps counters to tell where a stuttering job loses time: lines executed per second, a planner
+// fill histogram, segment buffer underruns during a cycle, time spent in planner_recalculate() and
+// st_prep_buffer(), received bytes per client and the websocket send buffer wait. $PM sends them and
+// $PM=0 clears the histogram, counts and maximums. Also served at http://<host>/metrics. See
+// metrics.hpp for the report format. Costs a few counter increments per line, byte and segment.
+#define ENABLE_PIPELINE_METRICS // Default enabled. Comment to disable.
+
+// Enables a CPU cycle profiler for the main program. Accounts the time spent in g-code parsing,
+// plan_buffer_line(), mc_arc(), st_prep_buffer(), reports and the delay(0) yields to the WiFi stack,
+// with call counts, total and self time, and the average and longest call. $PR sends the numbers and
+// $PR=0 clears them. See profiler.hpp for the report format. Adds two cycle counter reads and some
+// bookkeeping to every marked call, so leave it disabled unless profiling. When disabled, the marks
+// compile to nothing.
+// #define ENABLE_PROFILER // Default disabled. Uncomment to enable.
+
+// Adds $CP, a check mode that also plans the motions and estimates the run time of a program from
+// the planned velocity profiles, without moving. Stream the program after $CP, and $C or $CP sends
+// the estimate when leaving check mode. See dryplan.hpp for the report format. Costs a few hundred
+// bytes of flash, and nothing outside of $CP.
+#define ENABLE_DRY_PLAN // Default enabled. Comment to disable.
+
+// Tallies the motion time the segment generator prepares in acceleration, cruise and deceleration
+// ramps, for the cycle time estimator of the host build, which defines it. See host/src/host_estimate.cpp.
+// Keeps double precision sums, so leave it disabled on the ESP8266.
+// #define ENABLE_CYCLE_ESTIMATE // Default disabled. Uncomment to enable.
+
+// Keeps g-code jobs in the LittleFS partition of the flash and runs them from there with $F=<name>,
+// so a stalled Wi-Fi connection can't starve the planner mid-cut. Jobs are uploaded with an HTTP
+// POST to /upload. See job.hpp for the commands and reports. Needs a flash layout with a file
+// system, as set in platformio.ini, and a read-ahead buffer of JOB_READ_AHEAD_SIZE bytes of RAM.
+#define ENABLE_JOB_STORAGE // Default enabled. Comment to disable.
+
+// Compiles stored jobs into a cache of tokenized g-code words in the flash, while the machine is
+// idle after an upload or the first run. Later runs replay the cache and skip scanning the text and
+// converting the numbers, though each block still goes through the parser's checks. Costs a second
+// copy of each job in the file system. Requires ENABLE_JOB_STORAGE.
+#define ENABLE_JOB_CACHE // Default enabled. Comment to disable.
+
+// O-word subroutines and loops in stored jobs, in the LinuxCNC syntax without parameters, so repeated
+// geometry is stored once. A subroutine runs from where its O<n> SUB line was, and from the cache when
+// compiled, without scanning its text again. See job.hpp. Requires ENABLE_JOB_STORAGE.
+#define ENABLE_JOB_OCODES // Default enabled. Comment to disable.
+#define JOB_OCODE_SUBS 16  // Subroutines defined per job. 12 bytes of RAM each.
+#define JOB_OCODE_DEPTH 8  // Calls and loops nested. 16 bytes of RAM each.
+
+// Keeps the settings, coordinate systems and startup lines in a RAM image of the EEPROM. Changes are
+// committed to the flash only once the machine is idle and EEPROM_COMMIT_DELAY has passed without
+// another, so G10 and G28.1/G30.1 don't sync the planner buffer mid-job and a burst of '$' commands
+// costs one flash write. Commits rotate over EEPROM_JOURNAL_SLOTS CRC-checked files in LittleFS,
+// spreading the wear, and a power loss during one leaves the previous slot to boot from. The first
+// boot imports the EEPROM sector. Without a file system, commits go to the EEPROM sector as before.
+// NOTE: A change made less than EEPROM_COMMIT_DELAY before a power loss is lost.
+#define ENABLE_EEPROM_JOURNAL // Default enabled. Comment to disable.
+#define EEPROM_JOURNAL_DIR "/eeprom"  // Directory of the slot files, outside the stored jobs.
+#define EEPROM_JOURNAL_SLOTS 4        // 2060 bytes of the file system each. At most 10.
+#define EEPROM_COMMIT_DELAY 1000      // Milliseconds without a change before a commit.
+
+// Approach of a stored job resumed at a line with $FR=<line>,<name>. The tool retracts to the safe
+// height first, unless above it already, travels over the resume position at the rapid rate, starts
+// the spindle and coolant the job had on at that line, and plunges at the plunge rate. The safe
+// height is a Z machine coordinate [-max_travel,0], as the parking target. See job.hpp.
+#define JOB_RESUME_SAFE_HEIGHT -5.0 // Float (mm)
+#define JOB_RESUME_PLUNGE_RATE 100.0 // Float (mm/min)
+#define JOB_RESUME_SPINDLE_DELAY 4.0 // Float (seconds). Spin-up time before the plunge.
+
 // The temporal resolution of the acceleration management subsystem. A higher number gives smoother
 // acceleration, particularly noticeable on machines that run at very high feedrates, but may negatively
 // impact performance. The correct value for this parameter is machine dependent, so it's advised to
@@ -433,6 +552,9 @@
 // available RAM, like when re-compiling for a Mega2560. Or decrease if the Arduino begins to
 // crash due to the lack of available RAM or if the CPU is having trouble keeping up with planning
 // new incoming motions as they are executed.
+// NOTE: Must be a power of two. One block is always kept free, so the planner holds one block less.
+// Grbl 1.1 used 15 with USE_LINE_NUMBERS to save RAM. That size is not a power of two, so it is now
+// 16 either way, which costs one more plan_block_t with line numbers on.
 // #define BLOCK_BUFFER_SIZE 16 // Uncomment to override default in planner.h.
 
 // Governs the size of the intermediary step segment buffer between the step execution algorithm
@@ -440,8 +562,11 @@
 // fixed time defined by ACCELERATION_TICKS_PER_SECOND. They are computed such that the planner
 // block velocity profile is traced exactly. The size of this buffer governs how much step
 // execution lead time there is for other Grbl processes have to compute and do their thing
-// before having to come back and refill this buffer, currently at ~50msec of step moves.
-// #define SEGMENT_BUFFER_SIZE 6 // Uncomment to override default in stepper.h.
+// before having to come back and refill this buffer, currently at ~70msec of step moves.
+// NOTE: Must be a power of two. Grbl 1.1 used 6. The default is now 8, the next power of two. That adds
+// two segments and two stepper blocks of RAM (about 56 bytes). It also adds 20msec of queued motion,
+// so a feed hold or override starts up to 20msec later.
+// #define SEGMENT_BUFFER_SIZE 8 // Uncomment to override default in stepper.h.
 
 // Line buffer size from the serial input stream to be executed. Also, governs the size of
 // each of the startup blocks, as they are each stored as a string of this size. Make sure
@@ -463,9 +588,28 @@
 // 115200 baud will take 5 msec to transmit a typical 55 character report. Worst case reports are
 // around 90-100 characters. As long as the serial TX buffer doesn't get continually maxed, Grbl
 // will continue operating efficiently. Size the TX buffer around the size of a worst-case report.
-// #define RX_BUFFER_SIZE 128 // (1-254) Uncomment to override defaults in serial.h
+// NOTE: The ESP8266 has plenty of RAM compared to the AVR, so RX_BUFFER_SIZE defaults to 1024 bytes
+// per client in serial.hpp, indexed with 16 bits. A deep receive buffer lets character-counting senders keep
+// far more blocks in flight, which rides out Wi-Fi latency spikes without starving the planner.
+// The buffers are static, one per client (CLIENT_COUNT), so 1KB costs 2KB of DRAM. That already
+// holds 15-25 typical CAM blocks on top of the planner buffer. 4KB per client would take 8KB from
+// the roughly 40KB heap the Wi-Fi stack, the web server and the job files share, so raise it only
+// on builds that leave those out. The available space is reported in the 'Bf:' status report field.
+// #define RX_BUFFER_SIZE 1024 // (Power of two, 2-32768) Uncomment to override defaults in serial.hpp
 // #define TX_BUFFER_SIZE 100 // (1-254)
 
+// Enables the compact binary streaming protocol. A sender may interleave binary frames, starting
+// with the ASCII STX character, with normal text lines. Each frame carries one g-code block as
+// pre-tokenized words with fixed-point values, optionally delta encoded against the previous
+// block, and is answered with 'ok' or 'error:' like a text line. This cuts the bytes sent per
+// motion by a third or more and skips the text scanning and float conversion in the g-code parser, which
+// helps most on the 115200 baud UART. See binary_stream.hpp for the frame layout.
+// NOTE: Realtime commands sent while a frame is being received are honored after the frame, or
+// after BS_FRAME_TIMEOUT, if the sender stops mid-frame.
+// #define ENABLE_BINARY_STREAMING // Default disabled. Uncomment to enable.
+// #define BS_COORD_SCALE 10000 // Fixed-point units per mm or inch. Uncomment to override default.
+// #define BS_FRAME_TIMEOUT 500 // (ms) Uncomment to override default.
+
 // A simple software debouncing feature for hard limit switches. When enabled, the interrupt
 // monitoring the hard limit switch pins will enable the Arduino's watchdog timer to re-check
 // the limit pin state after a delay of about 32msec. This can help with CNC machines with
@@ -535,6 +679,7 @@
 // NOTE: Most EEPROM write commands are implicitly blocked during a job (all '$' commands). However,
 // coordinate set g-code commands (G10,G28/30.1) are not, since they are part of an active streaming
 // job. At this time, this option only forces a planner buffer sync with these g-code commands.
+// Has no effect with ENABLE_EEPROM_JOURNAL, which doesn't write the flash during a job.
 #define FORCE_BUFFER_SYNC_DURING_EEPROM_WRITE // Default enabled. Comment to disable.
 
 // In Grbl v0.9 and prior, there is an old outstanding bug where the `WPos:` work position reported
@@ -55,8 +55,8 @@ uint8_t coolant_get_state()
 }
 
 
-// Directly called by coolant_init(), coolant_set_state(), and mc_reset(), which can be at
-// an interrupt-level. No report flag set, but only called by routines that don't need it.
+// Directly called by coolant_init(), coolant_set_state(), and mc_exec_reset_request(). No report
+// flag set, but only called by routines that don't need it.
 void coolant_stop()
 {
   #ifdef INVERT_COOLANT_FLOOD_PIN
@@ -0,0 +1,138 @@
+/*
+  dryplan.cpp - check mode with planning, estimating the run time of a program
+  Part of Grbl
+
+  Grbl is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Grbl is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Grbl.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "grbl.hpp"
+
+#ifdef ENABLE_DRY_PLAN
+
+#define DRYPLAN_WINDOW (BLOCK_BUFFER_SIZE-1) // Blocks the peak block rate is averaged over.
+#define DRYPLAN_CYCLES_PER_US (F_CPU/1000000L)
+
+typedef struct {
+  bool enabled;
+  double run_time;       // (min) Double, so long programs don't lose short blocks to round-off.
+  uint32_t blocks;
+  float window[DRYPLAN_WINDOW]; // Times of the last blocks (min)
+  double window_time;    // Sum of window[] (min)
+  float peak_rate;       // (blocks/min)
+  uint64_t plan_cycles;
+  uint32_t plan_max;     // (cycles)
+} dryplan_t;
+
+static dryplan_t dryplan;
+
+
+void dryplan_start(bool enable)
+{
+  memset(&dryplan, 0, sizeof(dryplan_t));
+  dryplan.enabled = enable;
+}
+
+
+bool dryplan_active() { return((sys.state == STATE_CHECK_MODE) && dryplan.enabled); }
+
+
+// Returns the time the first block takes in (min). Follows the trapezoid st_prep_buffer() traces
+// between the planned entry and exit speeds.
+// NOTE: The planner limits entry and exit speeds to the nominal speed, so there is no deceleration
+// override ramp to consider without overrides changing.
+static float dryplan_block_time(plan_block_t *block)
+{
+  float nominal_speed = plan_compute_profile_nominal_speed(block);
+  float exit_speed_sqr = plan_get_exec_block_exit_speed_sqr();
+  float inv_2_accel = 0.5/block->acceleration;
+
+  // Peak of the triangle profile, limited to the nominal speed for a trapezoid.
+  float peak_speed_sqr = 0.5*(block->entry_speed_sqr+exit_speed_sqr) + block->acceleration*block->millimeters;
+  if (peak_speed_sqr > nominal_speed*nominal_speed) { peak_speed_sqr = nominal_speed*nominal_speed; }
+  if (peak_speed_sqr <= 0.0) { return(0.0); }
+  float peak_speed = sqrt(peak_speed_sqr);
+
+  float entry_speed = sqrt(block->entry_speed_sqr);
+  float exit_speed = sqrt(exit_speed_sqr);
+  float cruise_mm = block->millimeters - (2.0*peak_speed_sqr-block->entry_speed_sqr-exit_speed_sqr)*inv_2_accel;
+  if (cruise_mm < 0.0) { cruise_mm = 0.0; }
+  return((2.0*peak_speed-entry_speed-exit_speed)/block->acceleration + cruise_mm/peak_speed);
+}
+
+
+// Executes the first block on paper. Discards it like the stepper does, once done.
+static void dryplan_execute_block()
+{
+  plan_block_t *block = plan_get_current_block();
+  float time = dryplan_block_time(block);
+  plan_discard_current_block();
+
+  dryplan.run_time += time;
+  uint8_t idx = dryplan.blocks % DRYPLAN_WINDOW;
+  if (dryplan.blocks >= DRYPLAN_WINDOW) { dryplan.window_time -= dryplan.window[idx]; }
+  dryplan.window[idx] = time;
+  dryplan.window_time += time;
+  dryplan.blocks++;
+  if (dryplan.window_time > 0.0) {
+    float rate = ((dryplan.blocks < DRYPLAN_WINDOW) ? dryplan.blocks : DRYPLAN_WINDOW)/dryplan.window_time;
+    if (rate > dryplan.peak_rate) { dryplan.peak_rate = rate; }
+  }
+}
+
+
+void dryplan_line(float *target, plan_line_data_t *pl_data)
+{
+  if (plan_check_full_buffer()) { dryplan_execute_block(); }
+  uint32_t start = ESP.getCycleCount();
+  plan_buffer_line(target, pl_data);
+  uint32_t cycles = ESP.getCycleCount() - start;
+  dryplan.plan_cycles += cycles;
+  if (cycles > dryplan.plan_max) { dryplan.plan_max = cycles; }
+}
+
+
+void dryplan_synchronize()
+{
+  while (plan_get_current_block()) { dryplan_execute_block(); }
+}
+
+
+void dryplan_dwell(float seconds)
+{
+  dryplan_synchronize();
+  dryplan.run_time += seconds/60.0;
+}
+
+
+void dryplan_report(uint8_t client)
+{
+  dryplan_synchronize();
+  char temp[80];
+  print_buffer_t report;
+  print_init(&report, temp, sizeof(temp));
+  printString(&report, "[CP:Rt:");
+  printFloat(&report, 60.0*dryplan.run_time, 3);
+  printString(&report, "|Bl:");
+  print_uint32_base10(&report, dryplan.blocks);
+  printString(&report, "|Pk:");
+  printFloat(&report, dryplan.peak_rate/60.0, 1);
+  printString(&report, "|Pl:");
+  print_uint32_base10(&report, (dryplan.blocks) ? (uint32_t)(dryplan.plan_cycles/dryplan.blocks/DRYPLAN_CYCLES_PER_US) : 0);
+  printChar(&report, ',');
+  print_uint32_base10(&report, dryplan.plan_max/DRYPLAN_CYCLES_PER_US);
+  printString(&report, "]\r\n");
+  grbl_write(client, report.data, report.length);
+}
+
+#endif
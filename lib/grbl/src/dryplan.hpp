@@ -0,0 +1,55 @@
+/*
+  dryplan.hpp - check mode with planning, estimating the run time of a program
+  Part of Grbl
+
+  Grbl is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Grbl is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Grbl.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef dryplan_h
+#define dryplan_h
+
+/*
+  $CP enters check mode like $C, but motions still go through plan_buffer_line(). Instead of
+  the stepper, the blocks are drained by computing the time their velocity profile takes, as
+  the segment generator would execute it, whenever the planner is full or synced. Leaving check
+  mode with $C or $CP completes the plan and sends:
+
+    [CP:Rt:<s>|Bl:<blocks>|Pk:<blocks/s>|Pl:<us>,<max us>]
+
+    Rt : Estimated run time of the motions and dwells, at 100% overrides.
+    Bl : Blocks planned.
+    Pk : Highest block rate over BLOCK_BUFFER_SIZE-1 consecutive blocks. The machine has to
+         parse and plan this fast to keep the planner from running dry.
+    Pl : Average and longest time spent in plan_buffer_line() per block.
+*/
+
+// Starts the estimate. Called when entering check mode, with dry planning on or off.
+void dryplan_start(bool enable);
+
+// Returns true, if motions are dry planned. Only while in check mode.
+bool dryplan_active();
+
+// Plans a motion, draining the first block if the planner is full. Called by mc_line() in check mode.
+void dryplan_line(float *target, plan_line_data_t *pl_data);
+
+// Drains all blocks. Replaces protocol_buffer_synchronize() in check mode.
+void dryplan_synchronize();
+
+// Adds a dwell to the estimate, after draining all blocks.
+void dryplan_dwell(float seconds);
+
+// Drains all blocks and sends the estimate to the client.
+void dryplan_report(uint8_t client);
+
+#endif
@@ -3,8 +3,133 @@
 * Taken from ArduinoESP examples
 ******************************************************************************/
 
+#include "grbl.hpp"
 #include <EEPROM.h>
 
+#ifdef ENABLE_EEPROM_JOURNAL
+  #include <LittleFS.h>
+
+  #define EEPROM_JOURNAL_MAGIC 0x4c4a5247UL // "GRJL"
+
+  // Header of a slot file, followed by the EEPROM_SIZE bytes of the image.
+  typedef struct {
+    uint32_t magic;
+    uint32_t sequence; // Counts the commits. The highest valid one is the newest slot.
+    uint32_t crc;      // CRC-32 of the image.
+  } eeprom_slot_header_t;
+
+  static uint8_t eeprom_image[EEPROM_SIZE];
+  static bool eeprom_mounted;         // Slot files in LittleFS. Otherwise, commits go to the EEPROM sector.
+  static bool eeprom_dirty;           // Image changed since the last commit.
+  static uint32_t eeprom_changed_time; // millis() at the last change.
+  static uint32_t eeprom_sequence;    // Of the newest slot written or loaded.
+
+
+  // CRC-32 (IEEE 802.3) with a nibble table, 64 bytes instead of 1kB.
+  static uint32_t eeprom_crc32(uint32_t crc, const uint8_t *data, uint16_t size)
+  {
+    static const uint32_t table[16] = {
+      0x00000000, 0x1db71064, 0x3b6e20c8, 0x26d930ac, 0x76dc4190, 0x6b6b51f4, 0x4db26158, 0x5005713c,
+      0xedb88320, 0xf00f9344, 0xd6d6a3e8, 0xcb61b38c, 0x9b64c2b0, 0x86d3d2d4, 0xa00ae278, 0xbdbdf21c
+    };
+    crc = ~crc;
+    while (size--) {
+      crc ^= *(data++);
+      crc = table[crc & 0x0f] ^ (crc >> 4);
+      crc = table[crc & 0x0f] ^ (crc >> 4);
+    }
+    return(~crc);
+  }
+
+
+  static void eeprom_slot_path(char *path, uint8_t slot)
+  {
+    strcpy(path, EEPROM_JOURNAL_DIR "/0");
+    path[strlen(path)-1] += slot;
+  }
+
+
+  // Reads the slot into the image, when load is set, or only checks it. Returns false if the slot is
+  // missing, incomplete or corrupt, as after a power loss during its commit.
+  static bool eeprom_slot_read(uint8_t slot, eeprom_slot_header_t *header, bool load)
+  {
+    char path[sizeof(EEPROM_JOURNAL_DIR)+2];
+    uint8_t buffer[64];
+    uint32_t crc = 0;
+    uint16_t offset;
+    eeprom_slot_path(path, slot);
+    File file = LittleFS.open(path, "r");
+    if (!file) { return(false); }
+    bool valid = (file.size() == sizeof(eeprom_slot_header_t)+EEPROM_SIZE) &&
+                 (file.read((uint8_t*)header, sizeof(eeprom_slot_header_t)) == sizeof(eeprom_slot_header_t)) &&
+                 (header->magic == EEPROM_JOURNAL_MAGIC);
+    for (offset = 0; valid && (offset < EEPROM_SIZE); offset += sizeof(buffer)) {
+      uint8_t *data = (load) ? &eeprom_image[offset] : buffer;
+      valid = (file.read(data, sizeof(buffer)) == sizeof(buffer));
+      crc = eeprom_crc32(crc, data, sizeof(buffer));
+    }
+    file.close();
+    return(valid && (crc == header->crc));
+  }
+
+
+  // Writes the image over the oldest slot, so the newest valid one survives an interrupted commit.
+  static bool eeprom_slot_write()
+  {
+    char path[sizeof(EEPROM_JOURNAL_DIR)+2];
+    eeprom_slot_header_t header;
+    header.magic = EEPROM_JOURNAL_MAGIC;
+    header.sequence = eeprom_sequence+1;
+    header.crc = eeprom_crc32(0, eeprom_image, EEPROM_SIZE);
+    eeprom_slot_path(path, header.sequence % EEPROM_JOURNAL_SLOTS);
+    File file = LittleFS.open(path, "w");
+    if (!file) { return(false); }
+    bool ok = (file.write((uint8_t*)&header, sizeof(header)) == sizeof(header)) &&
+              (file.write(eeprom_image, EEPROM_SIZE) == EEPROM_SIZE);
+    file.close();
+    if (ok) { eeprom_sequence = header.sequence; }
+    return(ok);
+  }
+
+
+  // Loads the image from the newest valid slot, or from the EEPROM sector the first time. A slot that
+  // fails when read again for the load, as on a flash read error, is passed over for the next newest.
+  static void eeprom_load()
+  {
+    eeprom_slot_header_t header;
+    uint32_t sequences[EEPROM_JOURNAL_SLOTS];
+    uint16_t valid = 0; // Bit mask of the slots checked out.
+    uint8_t slot, newest;
+    for (slot = 0; slot < EEPROM_JOURNAL_SLOTS; slot++) {
+      if (!eeprom_slot_read(slot, &header, false)) { continue; }
+      valid |= bit(slot);
+      sequences[slot] = header.sequence;
+    }
+    while (valid) {
+      newest = EEPROM_JOURNAL_SLOTS;
+      for (slot = 0; slot < EEPROM_JOURNAL_SLOTS; slot++) {
+        if (!(valid & bit(slot))) { continue; }
+        if ((newest == EEPROM_JOURNAL_SLOTS) || ((int32_t)(sequences[slot]-sequences[newest]) > 0)) { newest = slot; }
+      }
+      if (eeprom_slot_read(newest, &header, true)) {
+        eeprom_sequence = header.sequence; // The next commit goes over the slots passed over, if any.
+        return;
+      }
+      valid &= ~bit(newest);
+    }
+
+    // No journal yet, or no slot left to read. Import the settings of the EEPROM sector, which is left
+    // as it is.
+    uint16_t addr;
+    eeprom_sequence = 0;
+    EEPROM.begin(EEPROM_SIZE);
+    for (addr = 0; addr < EEPROM_SIZE; addr++) { eeprom_image[addr] = EEPROM.read(addr); }
+    EEPROM.end();
+    eeprom_dirty = true;
+  }
+#endif
+
+
 /*! \brief  Read byte from EEPROM.
  *
  *  This function Initializes the EEPROM buffer.
@@ -12,7 +137,19 @@
  */
 void eeprom_init()
 {
-	EEPROM.begin(2048);
+  #ifdef ENABLE_EEPROM_JOURNAL
+    eeprom_mounted = LittleFS.begin();
+    if (eeprom_mounted) {
+      eeprom_load();
+      return;
+    }
+    // No file system. Keep the image in the EEPROM sector.
+    uint16_t addr;
+    EEPROM.begin(EEPROM_SIZE);
+    for (addr = 0; addr < EEPROM_SIZE; addr++) { eeprom_image[addr] = EEPROM.read(addr); }
+  #else
+    EEPROM.begin(EEPROM_SIZE);
+  #endif
 }
 
 /*! \brief  Read byte from EEPROM.
@@ -26,7 +163,12 @@ void eeprom_init()
  */
 unsigned char eeprom_get_char( unsigned int addr )
 {
-	return EEPROM.read(addr); // Return the byte read from EEPROM.
+  #ifdef ENABLE_EEPROM_JOURNAL
+    if (addr >= EEPROM_SIZE) { return(0); }
+    return(eeprom_image[addr]);
+  #else
+    return EEPROM.read(addr); // Return the byte read from EEPROM.
+  #endif
 }
 
 /*! \brief  Write byte to EEPROM.
@@ -38,32 +180,97 @@ unsigned char eeprom_get_char( unsigned int addr )
  */
 void eeprom_put_char( unsigned int addr, unsigned char new_value )
 {
-	EEPROM.write(addr, new_value);
+  #ifdef ENABLE_EEPROM_JOURNAL
+    if (addr >= EEPROM_SIZE) { return; }
+    if (eeprom_image[addr] == new_value) { return; } // Rewriting a value doesn't cost a commit.
+    eeprom_image[addr] = new_value;
+    eeprom_dirty = true;
+    eeprom_changed_time = millis();
+  #else
+    EEPROM.write(addr, new_value);
+  #endif
 }
 
+
+#ifdef ENABLE_EEPROM_JOURNAL
+  // Commits the changed image once the machine is idle and the changes have settled for
+  // EEPROM_COMMIT_DELAY, so a burst of setting commands costs a single write. Called from the
+  // main loop.
+  void eeprom_commit_idle()
+  {
+    if (!eeprom_dirty) { return; }
+    if (sys.state & ~(STATE_ALARM | STATE_CHECK_MODE | STATE_SLEEP)) { return; }
+    if (plan_get_current_block() != NULL) { return; }
+    #ifdef ENABLE_JOB_STORAGE
+      if (job_active()) { return; }
+    #endif
+    if ((millis()-eeprom_changed_time) < EEPROM_COMMIT_DELAY) { return; }
+    eeprom_commit();
+  }
+
+
+  // Writes the image to the flash now. A failed commit is retried after the delay.
+  void eeprom_commit()
+  {
+    bool ok;
+    if (eeprom_mounted) { ok = eeprom_slot_write(); }
+    else {
+      uint16_t addr;
+      for (addr = 0; addr < EEPROM_SIZE; addr++) { EEPROM.write(addr, eeprom_image[addr]); }
+      ok = EEPROM.commit();
+    }
+    if (ok) { eeprom_dirty = false; }
+    else { eeprom_changed_time = millis(); }
+  }
+#endif
+
+
 // Extensions added as part of Grbl
 
+// Rotates left and adds. Grbl used a logical instead of a bitwise or here, which left the checksum
+// of a record hardly more than its last byte. See eeprom_upgrade_checksum().
+static unsigned char eeprom_checksum_add(unsigned char checksum, unsigned char data)
+{
+  checksum = (checksum << 1) | (checksum >> 7);
+  return(checksum + data);
+}
+
 
 void memcpy_to_eeprom_with_checksum(unsigned int destination, char *source, unsigned int size) {
   unsigned char checksum = 0;
   for(; size > 0; size--) {
-    checksum = (checksum << 1) || (checksum >> 7);
-    checksum += *source;
+    checksum = eeprom_checksum_add(checksum, *source);
     eeprom_put_char(destination++, *(source++));
   }
   eeprom_put_char(destination, checksum);
-	EEPROM.commit();
+  #ifndef ENABLE_EEPROM_JOURNAL
+    EEPROM.commit();
+  #endif
 }
 
 int memcpy_from_eeprom_with_checksum(char *destination, unsigned int source, unsigned int size) {
   unsigned char data, checksum = 0;
   for(; size > 0; size--) {
     data = eeprom_get_char(source++);
-    checksum = (checksum << 1) || (checksum >> 7);
-    checksum += data;
+    checksum = eeprom_checksum_add(checksum, data);
     *(destination++) = data;
   }
   return(checksum == eeprom_get_char(source));
 }
 
+// Replaces the checksum of a record written by an older version, if it was valid. Returns false
+// if not, and leaves the record for its reader to reset.
+int eeprom_upgrade_checksum(unsigned int addr, unsigned int size) {
+  unsigned char data, legacy = 0, checksum = 0;
+  for(; size > 0; size--) {
+    data = eeprom_get_char(addr++);
+    // The logical or of Grbl's checksum, kept on purpose so the records it wrote still check out.
+    legacy = (((legacy << 1) != 0) || ((legacy >> 7) != 0)) + data;
+    checksum = eeprom_checksum_add(checksum, data);
+  }
+  if (legacy != eeprom_get_char(addr)) { return(false); }
+  eeprom_put_char(addr, checksum);
+  return(true);
+}
+
 // end of file
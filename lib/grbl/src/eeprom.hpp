@@ -27,10 +27,23 @@
 //}
 #endif
 
+#define EEPROM_SIZE 2048 // Bytes of settings, parameters and lines. See the EEPROM_ADDR defines in settings.hpp.
+
 void eeprom_init();
 unsigned char eeprom_get_char(unsigned int addr);
 void eeprom_put_char(unsigned int addr, unsigned char new_value);
 void memcpy_to_eeprom_with_checksum(unsigned int destination, char *source, unsigned int size);
 int memcpy_from_eeprom_with_checksum(char *destination, unsigned int source, unsigned int size);
 
+// Re-checksums a record of a settings version before 11.
+int eeprom_upgrade_checksum(unsigned int addr, unsigned int size);
+
+#ifdef ENABLE_EEPROM_JOURNAL
+  // Commits the RAM image of the EEPROM to the flash, if it changed and the machine is idle.
+  void eeprom_commit_idle();
+
+  // Commits the RAM image of the EEPROM to the flash now.
+  void eeprom_commit();
+#endif
+
 #endif
@@ -38,6 +38,14 @@ parser_block_t gc_block;
 
 #define FAIL(status) return(status);
 
+#ifdef ENABLE_CANNED_CYCLES
+  // Returns true for the motion modes of the canned drilling cycles.
+  static bool gc_canned_cycle(uint8_t motion)
+  {
+    return((motion == MOTION_MODE_DRILL_CHIP_BREAK) || ((motion >= MOTION_MODE_DRILL) && (motion <= MOTION_MODE_DRILL_PECK)));
+  }
+#endif
+
 
 void gc_init()
 {
@@ -58,6 +66,124 @@ void gc_sync_position()
 }
 
 
+static uint8_t gc_execute_block(char *line, gc_word_t *words, uint8_t word_count, uint8_t client);
+
+
+#ifdef ENABLE_GCODE_FAST_PATH
+  // Executes a plain G0/G1 block of axis words, and the optional G0/G1, F and N words, the way
+  // gc_execute_block() does, with the same target conversions, state updates and planner data.
+  // Returns false without changing anything, if the block has any other word, a repeated word, or
+  // a value the full parser would reject, or if the modes need more than a line motion.
+  static bool gc_execute_fast(char *line, gc_word_t *words, uint8_t word_count)
+  {
+    if ((gc_state.modal.feed_rate != FEED_RATE_MODE_UNITS_PER_MIN) || bit_istrue(settings.flags,BITFLAG_LASER_MODE)) { return(false); }
+    if ((line != NULL) && (line[0] == '$')) { return(false); } // Jog motion.
+
+    float xyz[N_AXIS];
+    uint8_t axis_words = 0;
+    uint8_t motion = gc_state.modal.motion;
+    bool motion_word = false;
+    float feed_rate = 0.0;
+    bool feed_word = false;
+    int32_t line_number = 0;
+    bool line_word = false;
+    uint8_t char_counter = 0;
+    uint8_t word_counter = 0;
+    uint8_t idx;
+    for (;;) {
+      char letter;
+      float value;
+      if (words != NULL) {
+        if (word_counter == word_count) { break; }
+        letter = words[word_counter].letter;
+        value = words[word_counter].value;
+        word_counter++;
+      } else {
+        if (line[char_counter] == 0) { break; }
+        letter = line[char_counter++];
+        if (!read_float(line, &char_counter, &value)) { return(false); }
+      }
+      switch (letter) {
+        case 'G':
+          if (motion_word) { return(false); }
+          if (value == 0.0) { motion = MOTION_MODE_SEEK; }
+          else if (value == 1.0) { motion = MOTION_MODE_LINEAR; }
+          else { return(false); }
+          motion_word = true;
+          continue;
+        case 'F':
+          if (feed_word || (value < 0.0)) { return(false); }
+          feed_rate = value;
+          feed_word = true;
+          continue;
+        case 'N':
+          if (line_word || (value < 0.0)) { return(false); }
+          line_number = trunc(value);
+          if (line_number > MAX_LINE_NUMBER) { return(false); }
+          line_word = true;
+          continue;
+        case 'X': idx = X_AXIS; break;
+        case 'Y': idx = Y_AXIS; break;
+        case 'Z': idx = Z_AXIS; break;
+        case 'A': idx = A_AXIS; break;
+        case 'B': idx = B_AXIS; break;
+        case 'C': idx = C_AXIS; break;
+        case 'D': idx = D_AXIS; break;
+        case 'E': idx = E_AXIS; break;
+        default: return(false);
+      }
+      if (bit_istrue(axis_words,bit(idx))) { return(false); }
+      xyz[idx] = value;
+      axis_words |= bit(idx);
+    }
+    if (!axis_words || !((motion == MOTION_MODE_SEEK) || (motion == MOTION_MODE_LINEAR))) { return(false); }
+
+    // [3. Set feed rate ]: In mm/min. The last one, unless given.
+    if (!feed_word) { feed_rate = gc_state.feed_rate; }
+    else if (gc_state.modal.units == UNITS_MODE_INCHES) { feed_rate *= MM_PER_INCH; }
+    if ((motion == MOTION_MODE_LINEAR) && (feed_rate == 0.0)) { return(false); } // [Feed rate undefined]
+
+    // [12. Set length units ] and [19. Axis offsets ]: Target in absolute machine coordinates.
+    for (idx=0; idx<N_AXIS; idx++) {
+      if (bit_isfalse(axis_words,bit(idx))) {
+        xyz[idx] = gc_state.position[idx];
+      } else {
+        if (gc_state.modal.units == UNITS_MODE_INCHES) { xyz[idx] *= MM_PER_INCH; }
+        if (gc_state.modal.distance == DISTANCE_MODE_ABSOLUTE) {
+          xyz[idx] += gc_state.coord_system[idx] + gc_state.coord_offset[idx];
+          if (idx == TOOL_LENGTH_OFFSET_AXIS) { xyz[idx] += gc_state.tool_length_offset; }
+        } else {
+          xyz[idx] += gc_state.position[idx];
+        }
+      }
+    }
+
+    // STEP 4: Execute, as the full parser does for this block.
+    plan_line_data_t plan_data;
+    memset(&plan_data,0,sizeof(plan_line_data_t));
+    gc_state.line_number = line_number;
+    #ifdef USE_LINE_NUMBERS
+      plan_data.line_number = line_number;
+    #endif
+    gc_state.feed_rate = feed_rate;
+    plan_data.feed_rate = feed_rate;
+    plan_data.spindle_speed = gc_state.spindle_speed;
+    gc_state.tool = 0; // Not tracked over blocks without a T word.
+    plan_data.condition = (gc_state.modal.spindle | gc_state.modal.coolant);
+    gc_state.modal.motion = motion;
+    #ifdef ENABLE_JOB_STORAGE
+      if (!job_scanning()) // Resume scan of a job. Tracks the position only.
+    #endif
+    {
+      if (motion == MOTION_MODE_SEEK) { plan_data.condition |= PL_COND_FLAG_RAPID_MOTION; }
+      mc_line(xyz, &plan_data);
+    }
+    memcpy(gc_state.position, xyz, sizeof(xyz));
+    return(true);
+  }
+#endif
+
+
 // Executes one line of 0-terminated G-Code. The line is assumed to contain only uppercase
 // characters and signed floating point values (no whitespace). Comments and block delete
 // characters have been removed. In this function, all units and positions are converted and
@@ -65,6 +191,27 @@ void gc_sync_position()
 // coordinates, respectively.
 uint8_t gc_execute_line(char *line, uint8_t client)
 {
+  return(gc_execute_block(line, NULL, 0, client));
+}
+
+
+// Executes one block of already tokenized g-code words. Skips the text scanning and number
+// conversion of STEP 2, but shares all of the error-checking and execution with text lines.
+uint8_t gc_execute_words(gc_word_t *words, uint8_t word_count, uint8_t client)
+{
+  return(gc_execute_block(NULL, words, word_count, client));
+}
+
+
+// Parses and executes one block from either a text line or a word list. Exactly one is non-NULL.
+static uint8_t gc_execute_block(char *line, gc_word_t *words, uint8_t word_count, uint8_t client)
+{
+  PROFILE_SCOPE(PROFILE_GCODE);
+
+  #ifdef ENABLE_GCODE_FAST_PATH
+    if (gc_execute_fast(line, words, word_count)) { return(STATUS_OK); }
+  #endif
+
   /* -------------------------------------------------------------------------------------
      STEP 1: Initialize parser block struct and copy current g-code state modes. The parser
      updates these modes and commands as the block line is parser and will only be used and
@@ -85,11 +232,11 @@ uint8_t gc_execute_line(char *line, uint8_t client)
 
   // Initialize command and value words and parser flags variables.
   uint16_t command_words = 0; // Tracks G and M command words. Also used for modal group violations.
-  uint16_t value_words = 0; // Tracks value words.
+  uint32_t value_words = 0; // Tracks value words.
   uint8_t gc_parser_flags = GC_PARSER_NONE;
 
   // Determine if the line is a jogging motion or a normal g-code block.
-  if (line[0] == '$') { // NOTE: `$J=` already parsed when passed to this function.
+  if ((line != NULL) && (line[0] == '$')) { // NOTE: `$J=` already parsed when passed to this function.
     // Set G1 and G94 enforced modes to ensure accurate error checks.
     gc_parser_flags |= GC_PARSER_JOG_MOTION;
     gc_block.modal.motion = MOTION_MODE_LINEAR;
@@ -114,13 +261,23 @@ uint8_t gc_execute_line(char *line, uint8_t client)
   if (gc_parser_flags & GC_PARSER_JOG_MOTION) { char_counter = 3; } // Start parsing after `$J=`
   else { char_counter = 0; }
 
-  while (line[char_counter] != 0) { // Loop until no more g-code words in line.
-    delay(0);
+  uint8_t word_counter = 0;
+  for (;;) { // Loop until no more g-code words in line.
+    PROFILE_YIELD();
     // Import the next g-code word, expecting a letter followed by a value. Otherwise, error out.
-    letter = line[char_counter];
-    if((letter < 'A') || (letter > 'Z')) { FAIL(STATUS_EXPECTED_COMMAND_LETTER); } // [Expected word letter]
-    char_counter++;
-    if (!read_float(line, &char_counter, &value)) { FAIL(STATUS_BAD_NUMBER_FORMAT); } // [Expected word value]
+    if (words != NULL) {
+      if (word_counter == word_count) { break; }
+      letter = words[word_counter].letter;
+      value = words[word_counter].value;
+      word_counter++;
+      if((letter < 'A') || (letter > 'Z')) { FAIL(STATUS_EXPECTED_COMMAND_LETTER); } // [Expected word letter]
+    } else {
+      if (line[char_counter] == 0) { break; }
+      letter = line[char_counter];
+      if((letter < 'A') || (letter > 'Z')) { FAIL(STATUS_EXPECTED_COMMAND_LETTER); } // [Expected word letter]
+      char_counter++;
+      if (!read_float(line, &char_counter, &value)) { FAIL(STATUS_BAD_NUMBER_FORMAT); } // [Expected word value]
+    }
 
     // Convert values to smaller uint8 significand and mantissa values for parsing this word.
     // NOTE: Mantissa is multiplied by 100 to catch non-integer command values. This is more
@@ -160,6 +317,9 @@ uint8_t gc_execute_line(char *line, uint8_t client)
               mantissa = 0; // Set to zero to indicate valid non-integer G command.
             }
             break;
+          #ifdef ENABLE_CANNED_CYCLES
+            case 73: case 81: case 82: case 83:
+          #endif
           case 0: case 1: case 2: case 3: case 38:
             // Check for G0/1/2/3/38 being called with G10/28/30/92 on same block.
             // * G43.1 is also an axis command but is not explicitly defined this way.
@@ -225,6 +385,12 @@ uint8_t gc_execute_line(char *line, uint8_t client)
             word_bit = MODAL_GROUP_G12;
             gc_block.modal.coord_select = int_value - 54; // Shift to array indexing.
             break;
+          #ifdef ENABLE_CANNED_CYCLES
+            case 98: case 99:
+              word_bit = MODAL_GROUP_G10;
+              gc_block.modal.retract = int_value - 98;
+              break;
+          #endif
           case 61:
             word_bit = MODAL_GROUP_G13;
             if (mantissa != 0) { FAIL(STATUS_GCODE_UNSUPPORTED_COMMAND); } // [G61.1 not supported]
@@ -306,11 +472,16 @@ uint8_t gc_execute_line(char *line, uint8_t client)
           case 'I': word_bit = WORD_I; gc_block.values.ijk[X_AXIS] = value; ijk_words |= (1<<X_AXIS); break;
           case 'J': word_bit = WORD_J; gc_block.values.ijk[Y_AXIS] = value; ijk_words |= (1<<Y_AXIS); break;
           case 'K': word_bit = WORD_K; gc_block.values.ijk[Z_AXIS] = value; ijk_words |= (1<<Z_AXIS); break;
-          case 'L': word_bit = WORD_L; gc_block.values.l = int_value; break;
+          case 'L': word_bit = WORD_L;
+            if (value > 255) { FAIL(STATUS_GCODE_MAX_VALUE_EXCEEDED); } // [L doesn't fit its uint8_t]
+            gc_block.values.l = int_value;
+            break;
           case 'N': word_bit = WORD_N; gc_block.values.n = trunc(value); break;
           case 'P': word_bit = WORD_P; gc_block.values.p = value; break;
           // NOTE: For certain commands, P value must be an integer, but none of these commands are supported.
-          // case 'Q': // Not supported
+          #ifdef ENABLE_CANNED_CYCLES
+            case 'Q': word_bit = WORD_Q; gc_block.values.q = value; break;
+          #endif
           case 'R': word_bit = WORD_R; gc_block.values.r = value; break;
           case 'S': word_bit = WORD_S; gc_block.values.s = value; break;
           case 'T': word_bit = WORD_T;
@@ -325,9 +496,9 @@ uint8_t gc_execute_line(char *line, uint8_t client)
 
         // NOTE: Variable 'word_bit' is always assigned, if the non-command letter is valid.
         if (bit_istrue(value_words,bit(word_bit))) { FAIL(STATUS_GCODE_WORD_REPEATED); } // [Word repeated]
-        // Check for invalid negative values for words F, N, P, T, and S.
+        // Check for invalid negative values for words F, L, N, P, Q, T, and S.
         // NOTE: Negative value check is done here simply for code-efficiency.
-        if ( bit(word_bit) & (bit(WORD_F)|bit(WORD_N)|bit(WORD_P)|bit(WORD_T)|bit(WORD_S)) ) {
+        if ( bit(word_bit) & (bit(WORD_F)|bit(WORD_L)|bit(WORD_N)|bit(WORD_P)|bit(WORD_Q)|bit(WORD_T)|bit(WORD_S)) ) {
           if (value < 0.0) { FAIL(STATUS_NEGATIVE_VALUE); } // [Word value cannot be negative]
         }
         value_words |= bit(word_bit); // Flag to indicate parameter assigned.
@@ -498,10 +669,8 @@ uint8_t gc_execute_line(char *line, uint8_t client)
   }
 
   // [15. Coordinate system selection ]: *N/A. Error, if cutter radius comp is active.
-  // TODO: An EEPROM read of the coordinate data may require a buffer sync when the cycle
-  // is active. The read pauses the processor temporarily and may cause a rare crash. For
-  // future versions on processors with enough memory, all coordinate data should be stored
-  // in memory and written to EEPROM only when there is not a cycle active.
+  // NOTE: With ENABLE_EEPROM_JOURNAL, the coordinate data is read from the RAM image of the EEPROM
+  // and written to the flash only when there is not a cycle active. See eeprom_commit_idle().
   float block_coord_system[N_AXIS];
   memcpy(block_coord_system,gc_state.coord_system,sizeof(gc_state.coord_system));
   if ( bit_istrue(command_words,bit(MODAL_GROUP_G12)) ) { // Check if called in block
@@ -513,7 +682,12 @@ uint8_t gc_execute_line(char *line, uint8_t client)
 
   // [16. Set path control mode ]: N/A. Only G61. G61.1 and G64 NOT SUPPORTED.
   // [17. Set distance mode ]: N/A. Only G91.1. G90.1 NOT SUPPORTED.
-  // [18. Set retract mode ]: NOT SUPPORTED.
+  // [18. Set retract mode ]: N/A. Canned cycles keep the programmed depth word, which [19] converts
+  //   into a target like any axis word.
+  #ifdef ENABLE_CANNED_CYCLES
+    gc_canned_t canned;
+    float canned_depth = gc_block.values.xyz[axis_linear];
+  #endif
 
   // [19. Remaining non-modal actions ]: Check go to predefined position, set G10, or set axis offsets.
   // NOTE: We need to separate the non-modal commands that are axis word-using (G10/G28/G30/G92), as these
@@ -819,6 +993,79 @@ uint8_t gc_execute_line(char *line, uint8_t client)
           if (!axis_words) { FAIL(STATUS_GCODE_NO_AXIS_WORDS); } // [No axis words]
           if (isequal_position_vector(gc_state.position, gc_block.values.xyz)) { FAIL(STATUS_GCODE_INVALID_TARGET); } // [Invalid target]
           break;
+        #ifdef ENABLE_CANNED_CYCLES
+          case MOTION_MODE_DRILL_CHIP_BREAK: case MOTION_MODE_DRILL:
+          case MOTION_MODE_DRILL_DWELL: case MOTION_MODE_DRILL_PECK:
+            // [G73/G81/G82/G83 Errors]: Feed rate undefined. Inverse time mode. Axis words other than
+            //   those of the plane and the drilling axis. R or drilling axis word missing in the first
+            //   cycle. R level below the bottom of the hole. Q missing or zero for G73/G83. L is zero.
+            // NOTE: The words R, Q, P and the depth carry over from cycle to cycle. Depth and R are
+            //   incremental from the R level and the start position in G91. L repeats the hole at the
+            //   same plane increment in G91, and at the same position in G90.
+            if (gc_block.modal.feed_rate == FEED_RATE_MODE_INVERSE_TIME) { FAIL(STATUS_GCODE_UNSUPPORTED_COMMAND); }
+            if (axis_words & ~(bit(axis_0)|bit(axis_1)|bit(axis_linear))) { FAIL(STATUS_GCODE_UNSUPPORTED_COMMAND); }
+            if (!axis_words) { // Sets the motion mode only.
+              axis_command = AXIS_COMMAND_NONE;
+              break;
+            }
+            if (gc_canned_cycle(gc_state.modal.motion) && (gc_state.modal.plane_select == gc_block.modal.plane_select)) {
+              memcpy(&canned,&gc_state.canned,sizeof(gc_canned_t));
+            } else { // First cycle of a series.
+              if (bit_isfalse(value_words,bit(WORD_R)) || bit_isfalse(axis_words,bit(axis_linear))) { FAIL(STATUS_GCODE_VALUE_WORD_MISSING); } // [R or depth missing]
+              memset(&canned,0,sizeof(gc_canned_t));
+              canned.initial = gc_state.position[axis_linear];
+            }
+            if (gc_block.modal.units == UNITS_MODE_INCHES) {
+              gc_block.values.r *= MM_PER_INCH;
+              gc_block.values.q *= MM_PER_INCH;
+            }
+            if (bit_istrue(value_words,bit(WORD_R))) { canned.r = gc_block.values.r; }
+            if (bit_istrue(axis_words,bit(axis_linear))) { canned.depth = canned_depth; }
+            if (bit_istrue(value_words,bit(WORD_Q))) { canned.q = gc_block.values.q; }
+            if (bit_istrue(value_words,bit(WORD_P))) { canned.p = gc_block.values.p; }
+            if ((gc_block.modal.motion == MOTION_MODE_DRILL_CHIP_BREAK) || (gc_block.modal.motion == MOTION_MODE_DRILL_PECK)) {
+              if (canned.q == 0.0) { FAIL(STATUS_GCODE_VALUE_WORD_MISSING); } // [Q missing]
+              bit_false(value_words,bit(WORD_Q));
+            } else if (gc_block.modal.motion == MOTION_MODE_DRILL_DWELL) {
+              bit_false(value_words,bit(WORD_P));
+            }
+            if (bit_isfalse(value_words,bit(WORD_L))) { gc_block.values.l = 1; }
+            else if (gc_block.values.l == 0) { FAIL(STATUS_GCODE_UNSUPPORTED_COMMAND); } // [L0]
+            bit_false(value_words,(bit(WORD_R)|bit(WORD_L)));
+
+            // Compute the R level and the bottom of the hole, in machine coordinates. Store the hole
+            // increment and the bottom in the IJK values, which aren't in use with these commands.
+            if (gc_block.modal.distance == DISTANCE_MODE_ABSOLUTE) {
+              float offset = block_coord_system[axis_linear] + gc_state.coord_offset[axis_linear];
+              if (axis_linear == TOOL_LENGTH_OFFSET_AXIS) { offset += gc_state.tool_length_offset; }
+              gc_block.values.r = canned.r + offset;
+              gc_block.values.ijk[axis_linear] = canned.depth + offset;
+              gc_block.values.ijk[axis_0] = 0.0;
+              gc_block.values.ijk[axis_1] = 0.0;
+            } else {
+              gc_block.values.r = gc_state.position[axis_linear] + canned.r;
+              gc_block.values.ijk[axis_linear] = gc_block.values.r + canned.depth;
+              gc_block.values.ijk[axis_0] = gc_block.values.xyz[axis_0] - gc_state.position[axis_0];
+              gc_block.values.ijk[axis_1] = gc_block.values.xyz[axis_1] - gc_state.position[axis_1];
+              gc_block.values.xyz[axis_0] += (gc_block.values.l-1)*gc_block.values.ijk[axis_0]; // Last hole
+              gc_block.values.xyz[axis_1] += (gc_block.values.l-1)*gc_block.values.ijk[axis_1];
+            }
+            if (gc_block.values.ijk[axis_linear] > gc_block.values.r) { FAIL(STATUS_GCODE_INVALID_TARGET); } // [R below bottom]
+            if ((gc_block.modal.motion == MOTION_MODE_DRILL_CHIP_BREAK) || (gc_block.modal.motion == MOTION_MODE_DRILL_PECK)) {
+              if (gc_block.values.r-gc_block.values.ijk[axis_linear] > CANNED_CYCLE_MAX_PECKS*canned.q) {
+                FAIL(STATUS_GCODE_MAX_VALUE_EXCEEDED); // [Q too small for the depth]
+              }
+            }
+            gc_block.values.q = canned.q;
+            gc_block.values.p = canned.p;
+            // The drilling axis ends at the R level in G99, or the higher of the R level and the start in G98.
+            if ((gc_block.modal.retract == RETRACT_MODE_R) || (canned.initial < gc_block.values.r)) {
+              gc_block.values.xyz[axis_linear] = gc_block.values.r;
+            } else {
+              gc_block.values.xyz[axis_linear] = canned.initial;
+            }
+            break;
+        #endif
       }
     }
   }
@@ -1006,7 +1253,13 @@ uint8_t gc_execute_line(char *line, uint8_t client)
   // [17. Set distance mode ]:
   gc_state.modal.distance = gc_block.modal.distance;
 
-  // [18. Set retract mode ]: NOT SUPPORTED
+  // [18. Set retract mode ]:
+  #ifdef ENABLE_CANNED_CYCLES
+    gc_state.modal.retract = gc_block.modal.retract;
+    if ((axis_command == AXIS_COMMAND_MOTION_MODE) && gc_canned_cycle(gc_block.modal.motion)) {
+      memcpy(&gc_state.canned,&canned,sizeof(gc_canned_t));
+    }
+  #endif
 
   // [19. Go to predefined position, Set G10, or Set axis offsets ]:
   switch(gc_block.non_modal_command) {
@@ -1050,6 +1303,11 @@ uint8_t gc_execute_line(char *line, uint8_t client)
   if (gc_state.modal.motion != MOTION_MODE_NONE) {
     if (axis_command == AXIS_COMMAND_MOTION_MODE) {
       uint8_t gc_update_pos = GC_UPDATE_POS_TARGET;
+      #ifdef ENABLE_JOB_STORAGE
+        if (job_scanning()) { // Resume scan of a job. Tracks the position only. See job.hpp.
+          if (gc_state.modal.motion >= MOTION_MODE_PROBE_TOWARD) { FAIL(STATUS_JOB_RESUME); } // Probed position unknown.
+        } else
+      #endif
       if (gc_state.modal.motion == MOTION_MODE_LINEAR) {
         mc_line(gc_block.values.xyz, pl_data);
       } else if (gc_state.modal.motion == MOTION_MODE_SEEK) {
@@ -1058,6 +1316,23 @@ uint8_t gc_execute_line(char *line, uint8_t client)
       } else if ((gc_state.modal.motion == MOTION_MODE_CW_ARC) || (gc_state.modal.motion == MOTION_MODE_CCW_ARC)) {
         mc_arc(gc_block.values.xyz, pl_data, gc_state.position, gc_block.values.ijk, gc_block.values.r,
             axis_0, axis_1, axis_linear, bit_istrue(gc_parser_flags,GC_PARSER_ARC_IS_CLOCKWISE));
+      #ifdef ENABLE_CANNED_CYCLES
+        } else if (gc_canned_cycle(gc_state.modal.motion)) {
+          float hole[N_AXIS];
+          memcpy(hole,gc_block.values.xyz,sizeof(hole));
+          hole[axis_linear] = gc_block.values.ijk[axis_linear]; // Bottom
+          // Counts the holes left down to the last one at the block target. A count up to l would
+          // never end for L255.
+          for (idx=gc_block.values.l; idx>0; idx--) {
+            hole[axis_0] = gc_block.values.xyz[axis_0]-(idx-1)*gc_block.values.ijk[axis_0];
+            hole[axis_1] = gc_block.values.xyz[axis_1]-(idx-1)*gc_block.values.ijk[axis_1];
+            mc_canned_cycle(hole, pl_data, gc_state.position, gc_state.modal.motion, gc_block.values.r,
+                gc_block.values.xyz[axis_linear], gc_block.values.q, gc_block.values.p, axis_0, axis_1, axis_linear);
+            gc_state.position[axis_0] = hole[axis_0];
+            gc_state.position[axis_1] = hole[axis_1];
+            gc_state.position[axis_linear] = gc_block.values.xyz[axis_linear];
+          }
+      #endif
       } else {
         // NOTE: gc_block.values.xyz is returned from mc_probe_cycle with the updated position value. So
         // upon a successful probing cycle, the machine position and the returned value should be the same.
@@ -1137,7 +1412,6 @@ uint8_t gc_execute_line(char *line, uint8_t client)
 /*
   Not supported:
 
-  - Canned cycles
   - Tool radius compensation
   - A,B,C-axes
   - Evaluation of expressions
@@ -1148,13 +1422,12 @@ uint8_t gc_execute_line(char *line, uint8_t client)
 
    (*) Indicates optional parameter, enabled through config.h and re-compile
    group 0 = {G92.2, G92.3} (Non modal: Cancel and re-enable G92 offsets)
-   group 1 = {G81 - G89} (Motion modes: Canned cycles)
+   group 1 = {G84 - G89} (Motion modes: Canned cycles, except G73 and G81 - G83)
    group 4 = {M1} (Optional stop, ignored)
    group 6 = {M6} (Tool change)
    group 7 = {G41, G42} cutter radius compensation (G40 is supported)
    group 8 = {G43} tool length offset (G43.1/G49 are supported)
    group 8 = {M7*} enable mist coolant (* Compile-option)
    group 9 = {M48, M49, M56*} enable/disable override switches (* Compile-option)
-   group 10 = {G98, G99} return mode canned cycles
    group 13 = {G61.1, G64} path control mode (G61 is supported)
 */
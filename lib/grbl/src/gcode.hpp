@@ -30,7 +30,7 @@
 // and are similar/identical to other g-code interpreters by manufacturers (Haas,Fanuc,Mazak,etc).
 // NOTE: Modal group define values must be sequential and starting from zero.
 #define MODAL_GROUP_G0 0 // [G4,G10,G28,G28.1,G30,G30.1,G53,G92,G92.1] Non-modal
-#define MODAL_GROUP_G1 1 // [G0,G1,G2,G3,G38.2,G38.3,G38.4,G38.5,G80] Motion
+#define MODAL_GROUP_G1 1 // [G0,G1,G2,G3,G38.2,G38.3,G38.4,G38.5,G73,G80,G81,G82,G83] Motion
 #define MODAL_GROUP_G2 2 // [G17,G18,G19] Plane selection
 #define MODAL_GROUP_G3 3 // [G90,G91] Distance mode
 #define MODAL_GROUP_G4 4 // [G91.1] Arc IJK distance mode
@@ -45,6 +45,7 @@
 #define MODAL_GROUP_M7 12 // [M3,M4,M5] Spindle turning
 #define MODAL_GROUP_M8 13 // [M7,M8,M9] Coolant control
 #define MODAL_GROUP_M9 14 // [M56] Override control
+#define MODAL_GROUP_G10 15 // [G98,G99] Return mode in canned cycles
 
 // Define command actions for within execution-type modal groups (motion, stopping, non-modal). Used
 // internally by the parser to know which command to execute.
@@ -75,6 +76,10 @@
 #define MOTION_MODE_PROBE_AWAY 142 // G38.4 (Do not alter value)
 #define MOTION_MODE_PROBE_AWAY_NO_ERROR 143 // G38.5 (Do not alter value)
 #define MOTION_MODE_NONE 80 // G80 (Do not alter value)
+#define MOTION_MODE_DRILL_CHIP_BREAK 73 // G73 (Do not alter value)
+#define MOTION_MODE_DRILL 81 // G81 (Do not alter value)
+#define MOTION_MODE_DRILL_DWELL 82 // G82 (Do not alter value)
+#define MOTION_MODE_DRILL_PECK 83 // G83 (Do not alter value)
 
 // Modal Group G2: Plane select
 #define PLANE_SELECT_XY 0 // G17 (Default: Must be zero)
@@ -106,6 +111,10 @@
 // Modal Group G7: Cutter radius compensation mode
 #define CUTTER_COMP_DISABLE 0 // G40 (Default: Must be zero)
 
+// Modal Group G10: Canned cycle return mode
+#define RETRACT_MODE_INITIAL 0 // G98 (Default: Must be zero)
+#define RETRACT_MODE_R 1 // G99 (Do not alter value)
+
 // Modal Group G13: Control mode
 #define CONTROL_MODE_EXACT_PATH 0 // G61 (Default: Must be zero)
 
@@ -154,6 +163,7 @@
 #define WORD_C  15
 #define WORD_D  16
 #define WORD_E  17
+#define WORD_Q  18
 
 // Define g-code parser position updating flags
 #define GC_UPDATE_POS_TARGET   0 // Must be zero
@@ -199,6 +209,7 @@ typedef struct {
   uint8_t coolant;         // {M7,M8,M9}
   uint8_t spindle;         // {M3,M4,M5}
   uint8_t override;        // {M56}
+  uint8_t retract;         // {G98,G99}
 } gc_modal_t;
 
 typedef struct {
@@ -207,14 +218,23 @@ typedef struct {
   uint8_t l;       // G10 or canned cycles parameters
   int32_t n;       // Line number
   float p;         // G10 or dwell parameters
-  // float q;      // G82 peck drilling
-  float r;         // Arc radius
+  float q;         // G73/G83 peck increment
+  float r;         // Arc radius or canned cycle R level
   float s;         // Spindle speed
   uint8_t t;       // Tool selection
   float xyz[N_AXIS];    // X,Y,Z... Translational axes
 } gc_values_t;
 
 
+// Words carried over from hole to hole, while canned cycles follow each other. In mm, as programmed.
+typedef struct {
+  float initial;   // Position of the drilling axis before the first cycle. Machine coordinate.
+  float r;         // R level
+  float depth;     // Z word, or the word of the axis normal to the plane
+  float q;         // Peck increment
+  float p;         // Dwell
+} gc_canned_t;
+
 typedef struct {
   gc_modal_t modal;
 
@@ -230,6 +250,10 @@ typedef struct {
   float coord_offset[N_AXIS];    // Retains the G92 coordinate offset (work coordinates) relative to
                                  // machine zero in mm. Non-persistent. Cleared upon reset and boot.
   float tool_length_offset;      // Tracks tool length offset value when enabled.
+
+  #ifdef ENABLE_CANNED_CYCLES
+    gc_canned_t canned;          // Of the running series of canned cycles.
+  #endif
 } parser_state_t;
 extern parser_state_t gc_state;
 
@@ -241,12 +265,22 @@ typedef struct {
 } parser_block_t;
 
 
+// Pre-tokenized g-code word. Used by the binary stream protocol to bypass the text parsing.
+typedef struct {
+  char letter;
+  float value;
+} gc_word_t;
+
+
 // Initialize the parser
 void gc_init();
 
 // Execute one block of rs275/ngc/g-code
 uint8_t gc_execute_line(char *line, uint8_t client);
 
+// Execute one block of pre-tokenized g-code words. Same checks and execution as a text line.
+uint8_t gc_execute_words(gc_word_t *words, uint8_t word_count, uint8_t client);
+
 // Set g-code parser position. Input in steps.
 void gc_sync_position();
 
@@ -45,6 +45,7 @@
 #include "config.hpp"
 
 #include "nuts_bolts.hpp"
+#include "ring_buffer.hpp"
 #include "settings.hpp"
 #include "system.hpp"
 #include "defaults.hpp"
@@ -66,6 +67,13 @@
 #include "spindle_control.hpp"
 #include "stepper.hpp"
 #include "jog.hpp"
+#include "binary_stream.hpp"
+#include "telemetry.hpp"
+#include "trace.hpp"
+#include "metrics.hpp"
+#include "profiler.hpp"
+#include "dryplan.hpp"
+#include "job.hpp"
 
 // ---------------------------------------------------------------------------------------
 // COMPILE-TIME ERROR CHECKING OF DEFINE VALUES:
@@ -116,6 +124,9 @@
 #if (REPORT_OVR_REFRESH_IDLE_COUNT < 1)
   #error "Override refresh must be greater than zero."
 #endif
+#if defined(ENABLE_JOB_CACHE) && !defined(ENABLE_JOB_STORAGE)
+  #error "ENABLE_JOB_CACHE requires ENABLE_JOB_STORAGE."
+#endif
 
 // ---------------------------------------------------------------------------------------
 
@@ -0,0 +1,940 @@
+/*
+  job.cpp - g-code jobs stored in the flash file system and run from there
+  Part of Grbl
+
+  Grbl is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Grbl is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Grbl.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "grbl.hpp"
+
+#ifdef ENABLE_JOB_STORAGE
+
+#include <LittleFS.h>
+
+#define JOB_DIR "/jobs/"
+#define JOB_UPLOAD_PATH JOB_DIR ".upload" // Hidden from the list until complete.
+#define JOB_PATH_SIZE (sizeof(JOB_DIR)+JOB_NAME_SIZE)
+
+// Job states
+#define JOB_STATE_IDLE      0
+#define JOB_STATE_RUNNING   1
+#define JOB_STATE_FINISHING 2 // All lines executed. Waits for the motions to complete.
+#define JOB_STATE_SCANNING  3 // Runs the lines before the resume line in check mode.
+
+#define JOB_SCAN_LINES 64 // Lines scanned per pass of the main loop.
+
+// job_read_line() results
+#define JOB_READ_LINE     0
+#define JOB_READ_OVERFLOW 1
+#define JOB_READ_END      2
+
+// Job end reports
+#define JOB_END_DONE    0
+#define JOB_END_ERROR   1
+#define JOB_END_ABORTED 2
+
+#define JOB_STATUS_END 0xFF // Returned instead of a status code, once out of lines.
+
+#ifdef ENABLE_JOB_CACHE
+  #define JOB_CACHE_DIR "/cache/"
+  #define JOB_CACHE_BUILD_PATH JOB_CACHE_DIR ".build"
+  #define JOB_CACHE_PATH_SIZE (sizeof(JOB_CACHE_DIR)+JOB_NAME_SIZE)
+  #define JOB_CACHE_MAGIC 0x32434A47UL // "GJC2"
+  #define JOB_CACHE_MAX_WORDS (LINE_BUFFER_SIZE/2) // A word takes at least two characters.
+
+  // Record heads
+  #define JOB_CACHE_TEXT     bit(7)  // Text line follows. Length in the lower bits.
+  #define JOB_CACHE_OVERFLOW 0xFF    // Line too long. Fails like one.
+  #if LINE_BUFFER_SIZE > 127
+    #error "The job cache keeps text lines up to 126 characters. Reduce LINE_BUFFER_SIZE or disable ENABLE_JOB_CACHE."
+  #endif
+
+  typedef struct {
+    uint32_t magic;
+    uint32_t source_size;
+    uint32_t lines;        // Of the source, for the report at the end.
+  } job_cache_header_t;
+#endif
+
+#ifdef ENABLE_JOB_OCODES
+  // O-word keywords, in the order of job_ocode_keywords.
+  #define JOB_OCODE_SUB       0
+  #define JOB_OCODE_ENDSUB    1
+  #define JOB_OCODE_CALL      2
+  #define JOB_OCODE_REPEAT    3
+  #define JOB_OCODE_ENDREPEAT 4
+  #define JOB_OCODE_COUNT     5
+
+  static const char *const job_ocode_keywords[JOB_OCODE_COUNT] = { "SUB", "ENDSUB", "CALL", "REPEAT", "ENDREPEAT" };
+
+  // Place in the job just after an O-word line.
+  typedef struct {
+    uint32_t position;     // Of the reader.
+    uint32_t line_number;  // Of the O-word line.
+    uint16_t number;       // O-word.
+  } job_mark_t;
+
+  // Call or loop in progress.
+  typedef struct {
+    job_mark_t mark;       // Of the call, to return to, or of the loop, to repeat from.
+    uint16_t passes;       // Left of a loop, after this one. Unused by a call.
+    bool call;
+  } job_frame_t;
+#endif
+
+// Read-ahead of the file of the running or compiling job. These never overlap.
+typedef struct {
+  File file;
+  uint32_t position;  // Bytes consumed.
+  uint16_t head;
+  uint16_t count;
+  uint8_t data[JOB_READ_AHEAD_SIZE];
+} job_reader_t;
+static job_reader_t job_reader;
+
+typedef struct {
+  uint8_t state;
+  uint8_t client;
+  char name[JOB_NAME_SIZE];
+  uint32_t size;         // Of the file read.
+  uint32_t line_number;
+  uint32_t start_time;   // millis() at start.
+  uint32_t resume_line;  // First line to run, after the scan.
+  bool check_mode;       // Started in check mode. Stays in it after the scan.
+  #ifdef ENABLE_JOB_CACHE
+    bool replay;         // Reads the cache of the job, instead of its source.
+    uint32_t lines;      // Of the source, from the cache header.
+  #endif
+  #ifdef ENABLE_JOB_OCODES
+    job_mark_t subs[JOB_OCODE_SUBS]; // Subroutines defined so far.
+    uint8_t sub_count;
+    job_frame_t frames[JOB_OCODE_DEPTH];
+    uint8_t depth;       // Frames in use.
+  #endif
+} job_t;
+static job_t job;
+
+static bool job_mounted;
+static File job_upload_file;
+static char job_upload_name[JOB_NAME_SIZE];
+static uint8_t job_upload_status = STATUS_JOB_FILE; // Until an upload succeeds.
+
+#ifdef ENABLE_JOB_CACHE
+  static char job_compile_name[JOB_NAME_SIZE]; // Job to compile next or compiling. Empty if none.
+  static File job_compile_file;                // Cache being built.
+  static uint32_t job_compile_line;            // Source line of the last record.
+  static uint32_t job_compile_record_line;
+#endif
+
+
+// Builds the path of a job. Returns false, if the name is empty or too long.
+static bool job_path(char *path, const char *name)
+{
+  size_t length = strlen(name);
+  if ((length == 0) || (length >= JOB_NAME_SIZE) || strchr(name, '/')) { return(false); }
+  strcpy(path, JOB_DIR);
+  strcat(path, name);
+  return(true);
+}
+
+
+static void job_reader_open(File file, uint32_t position)
+{
+  job_reader.file = file;
+  job_reader.position = position;
+  job_reader.head = 0;
+  job_reader.count = 0;
+}
+
+
+// Returns the next byte of the file, or -1 at its end.
+static int16_t job_reader_get()
+{
+  if (job_reader.head == job_reader.count) {
+    job_reader.head = 0;
+    job_reader.count = job_reader.file.read(job_reader.data, JOB_READ_AHEAD_SIZE);
+    if (job_reader.count == 0) { return(-1); }
+  }
+  job_reader.position++;
+  return(job_reader.data[job_reader.head++]);
+}
+
+
+#ifdef ENABLE_JOB_OCODES
+  // Moves the reader to the position of the file. Keeps the read-ahead, if the position is in it,
+  // as the body of a short loop usually is.
+  static bool job_reader_seek(uint32_t position)
+  {
+    uint32_t start = job_reader.position-job_reader.head; // Of the read-ahead data.
+    if ((position >= start) && (position <= start+job_reader.count)) {
+      job_reader.head = position-start;
+    } else {
+      if (!job_reader.file.seek(position)) { return(false); }
+      job_reader.head = 0;
+      job_reader.count = 0;
+    }
+    job_reader.position = position;
+    return(true);
+  }
+#endif
+
+
+// Reads the next line of the job into line, filtered like serial input in protocol_main_loop().
+// '%' program start and end marks of CAM output are dropped too.
+static uint8_t job_read_line(char *line)
+{
+  uint8_t line_flags = 0;
+  uint8_t char_counter = 0;
+  bool read_any = false;
+  int16_t c;
+  while ((c = job_reader_get()) >= 0) {
+    read_any = true;
+    if ((c == '\n') || (c == '\r')) { break; }
+    if (line_flags) {
+      if ((c == ')') && (line_flags & LINE_FLAG_COMMENT_PARENTHESES)) { line_flags &= ~(LINE_FLAG_COMMENT_PARENTHESES); }
+    } else if ((c <= ' ') || (c == '/') || (c == '%')) {
+      // Dropped
+    } else if (c == '(') {
+      line_flags |= LINE_FLAG_COMMENT_PARENTHESES;
+    } else if (c == ';') {
+      line_flags |= LINE_FLAG_COMMENT_SEMICOLON;
+    } else if (char_counter >= (LINE_BUFFER_SIZE-1)) {
+      line_flags |= LINE_FLAG_OVERFLOW;
+    } else if (c >= 'a' && c <= 'z') {
+      line[char_counter++] = c-'a'+'A';
+    } else {
+      line[char_counter++] = c;
+    }
+  }
+  if (!read_any) { return(JOB_READ_END); } // The last line may lack its newline.
+  line[char_counter] = 0;
+  return((line_flags & LINE_FLAG_OVERFLOW) ? JOB_READ_OVERFLOW : JOB_READ_LINE);
+}
+
+
+#ifdef ENABLE_JOB_CACHE
+  /*
+    The cache of a job holds its lines tokenized into g-code words, the way STEP 2 of the g-code
+    parser does it, so a run skips the filtering, the scanning and read_float(). The parser still
+    checks and executes every block as a text line, through gc_execute_words(). Starting from
+    job_cache_header_t, each non-empty line of the source becomes one record:
+
+      [lines since the previous record, varint] [head] [words or text]
+
+    A head below JOB_CACHE_TEXT is the word count, followed by that many words of the letter and
+    the value as a little-endian float. '$' commands and lines not scanning as words are kept as
+    text of the length in the lower bits of the head, for the parser to handle or reject as usual.
+
+    Jobs compile when uploaded, or after their first run, in the main loop while the machine is
+    idle, a line per pass. A run replays the cache, if the size of the source matches its header.
+    Sources change only through uploads and deletes, and both drop the cache first, so the start
+    of a run doesn't read through the source to check it.
+  */
+
+  static bool job_cache_path(char *path, const char *name)
+  {
+    if (strlen(name) >= JOB_NAME_SIZE) { return(false); }
+    strcpy(path, JOB_CACHE_DIR);
+    strcat(path, name);
+    return(true);
+  }
+
+
+  // Splits a filtered line into words. Returns 0, if the line doesn't scan as words.
+  static uint8_t job_tokenize(char *line, gc_word_t *words)
+  {
+    uint8_t char_counter = 0;
+    uint8_t word_count = 0;
+    while (line[char_counter] != 0) {
+      char letter = line[char_counter++];
+      if ((letter < 'A') || (letter > 'Z')) { return(0); }
+      if (!read_float(line, &char_counter, &words[word_count].value)) { return(0); }
+      words[word_count++].letter = letter;
+    }
+    return(word_count);
+  }
+
+
+  // Stops a compile in progress. The job stays queued, if requeue is set.
+  static void job_compile_cancel(bool requeue)
+  {
+    if (job_compile_file) {
+      job_compile_file.close();
+      job_reader.file.close();
+      LittleFS.remove(JOB_CACHE_BUILD_PATH);
+    }
+    if (!requeue) { job_compile_name[0] = 0; }
+  }
+
+
+  // Drops the cache of a job, e.g. replaced by an upload, and queues the job to compile, if given.
+  static void job_cache_invalidate(const char *name, bool compile)
+  {
+    char path[JOB_CACHE_PATH_SIZE];
+    if (strcmp(job_compile_name, name) == 0) { job_compile_cancel(false); }
+    if (job_cache_path(path, name)) { LittleFS.remove(path); }
+    if (compile && (job_compile_name[0] == 0)) { strcpy(job_compile_name, name); }
+  }
+
+
+  // Appends the record of a line to the cache being built. Returns false on a write error.
+  static bool job_compile_record(char *line, uint8_t result)
+  {
+    uint8_t record[5+1+JOB_CACHE_MAX_WORDS*(1+sizeof(float))];
+    uint16_t length = 0;
+    uint32_t line_delta = job_compile_line-job_compile_record_line;
+    job_compile_record_line = job_compile_line;
+    do {
+      record[length++] = (line_delta & 0x7F) | ((line_delta > 0x7F) ? 0x80 : 0);
+      line_delta >>= 7;
+    } while (line_delta);
+
+    gc_word_t words[JOB_CACHE_MAX_WORDS];
+    uint8_t word_count = 0;
+    if (result == JOB_READ_OVERFLOW) {
+      record[length++] = JOB_CACHE_OVERFLOW;
+    } else if ((word_count = job_tokenize(line, words)) == 0) {
+      uint8_t text_length = strlen(line);
+      record[length++] = JOB_CACHE_TEXT | text_length;
+      memcpy(&record[length], line, text_length);
+      length += text_length;
+    } else {
+      record[length++] = word_count;
+      for (uint8_t idx=0; idx<word_count; idx++) {
+        record[length++] = words[idx].letter;
+        memcpy(&record[length], &words[idx].value, sizeof(float));
+        length += sizeof(float);
+      }
+    }
+    return(job_compile_file.write(record, length) == length);
+  }
+
+
+  // Queues the next job without a cache, if any. Jobs uploaded while another one compiled.
+  static void job_compile_next()
+  {
+    char path[JOB_CACHE_PATH_SIZE];
+    Dir dir = LittleFS.openDir(JOB_DIR);
+    while (dir.next()) {
+      String name = dir.fileName();
+      if (name.c_str()[0] == '.') { continue; } // Upload in progress.
+      if (job_cache_path(path, name.c_str()) && !LittleFS.exists(path)) {
+        strcpy(job_compile_name, name.c_str());
+        return;
+      }
+    }
+  }
+
+
+  // Compiles the next line of the queued job. Only while the machine is idle, as writing the
+  // flash would stall a running one.
+  static void job_compile_step()
+  {
+    if ((job_compile_name[0] == 0) || (sys.state & ~(STATE_ALARM | STATE_CHECK_MODE | STATE_SLEEP))) { return; }
+
+    if (!job_compile_file) { // Start
+      char path[JOB_PATH_SIZE];
+      job_cache_header_t header;
+      memset(&header, 0, sizeof(header)); // Completed at the end.
+      File source;
+      if (job_path(path, job_compile_name)) { source = LittleFS.open(path, "r"); }
+      if (source) { job_compile_file = LittleFS.open(JOB_CACHE_BUILD_PATH, "w"); }
+      if (!job_compile_file || (job_compile_file.write((uint8_t*)&header, sizeof(header)) != sizeof(header))) {
+        job_compile_cancel(false);
+        return;
+      }
+      job_reader_open(source, 0);
+      job_compile_line = 0;
+      job_compile_record_line = 0;
+      return;
+    }
+
+    char line[LINE_BUFFER_SIZE];
+    uint8_t result = job_read_line(line);
+    if (result == JOB_READ_END) { // Complete the header, and replace the cache.
+      char path[JOB_CACHE_PATH_SIZE];
+      job_cache_header_t header = { JOB_CACHE_MAGIC, job_reader.position, job_compile_line };
+      bool stored = job_compile_file.seek(0) &&
+        (job_compile_file.write((uint8_t*)&header, sizeof(header)) == sizeof(header));
+      job_compile_file.close();
+      job_reader.file.close();
+      if (!stored || !job_cache_path(path, job_compile_name) || !LittleFS.rename(JOB_CACHE_BUILD_PATH, path)) {
+        LittleFS.remove(JOB_CACHE_BUILD_PATH);
+        job_compile_name[0] = 0;
+        return;
+      }
+      job_compile_name[0] = 0;
+      job_compile_next();
+      return;
+    }
+    job_compile_line++;
+    if ((result == JOB_READ_LINE) && (line[0] == 0)) { return; } // Empty or comment line.
+    if (!job_compile_record(line, result)) { job_compile_cancel(false); } // Out of space.
+  }
+
+
+  // Switches the reader from the source of the job to its cache, if that matches the source.
+  static bool job_cache_open(const char *name)
+  {
+    char path[JOB_CACHE_PATH_SIZE];
+    job_cache_header_t header;
+    if (!job_cache_path(path, name)) { return(false); }
+    File cache = LittleFS.open(path, "r");
+    if (!cache || (cache.read((uint8_t*)&header, sizeof(header)) != sizeof(header)) ||
+        (header.magic != JOB_CACHE_MAGIC) || (header.source_size != job_reader.file.size())) { return(false); }
+    job_reader_open(cache, sizeof(header));
+    job.size = cache.size();
+    job.lines = header.lines;
+    return(true);
+  }
+
+
+  // Reads the next record of the cache into words or line. Returns the word count, 0 for a text
+  // line, or a status code on a failure.
+  static uint8_t job_replay_record(char *line, gc_word_t *words, uint8_t *word_count)
+  {
+    uint32_t line_delta = 0;
+    uint8_t shift = 0;
+    int16_t c;
+    do {
+      if ((c = job_reader_get()) < 0) {
+        if (shift) { return(STATUS_JOB_FILE); } // Cut short.
+        job.line_number = job.lines;
+        return(JOB_STATUS_END);
+      }
+      line_delta |= (uint32_t)(c & 0x7F) << shift;
+      shift += 7;
+    } while (c & 0x80);
+    job.line_number += line_delta;
+
+    if ((c = job_reader_get()) < 0) { return(STATUS_JOB_FILE); }
+    if (c == JOB_CACHE_OVERFLOW) { return(STATUS_OVERFLOW); }
+    uint8_t idx;
+    if (c & JOB_CACHE_TEXT) {
+      uint8_t length = c & ~JOB_CACHE_TEXT;
+      if (length >= LINE_BUFFER_SIZE) { return(STATUS_JOB_FILE); }
+      for (idx=0; idx<length; idx++) {
+        if ((c = job_reader_get()) < 0) { return(STATUS_JOB_FILE); }
+        line[idx] = c;
+      }
+      line[length] = 0;
+      *word_count = 0;
+      return(STATUS_OK);
+    }
+    *word_count = c;
+    if (*word_count > JOB_CACHE_MAX_WORDS) { return(STATUS_JOB_FILE); }
+    for (idx=0; idx<*word_count; idx++) {
+      uint8_t data[1+sizeof(float)];
+      for (uint8_t byte_idx=0; byte_idx<sizeof(data); byte_idx++) {
+        if ((c = job_reader_get()) < 0) { return(STATUS_JOB_FILE); }
+        data[byte_idx] = c;
+      }
+      words[idx].letter = data[0];
+      memcpy(&words[idx].value, &data[1], sizeof(float));
+    }
+    return(STATUS_OK);
+  }
+#endif
+
+
+void job_init()
+{
+  job_mounted = LittleFS.begin();
+}
+
+
+void job_list(uint8_t client)
+{
+  char temp[40+JOB_NAME_SIZE];
+  print_buffer_t report;
+  if (!job_mounted) { return; }
+  Dir dir = LittleFS.openDir(JOB_DIR);
+  while (dir.next()) {
+    String name = dir.fileName();
+    if (name.c_str()[0] == '.') { continue; } // Upload in progress.
+    print_init(&report, temp, sizeof(temp));
+    printString(&report, "[FILE:");
+    printString(&report, name.c_str());
+    printString(&report, "|SIZE:");
+    print_uint32_base10(&report, dir.fileSize());
+    #ifdef ENABLE_JOB_CACHE
+      char path[JOB_CACHE_PATH_SIZE];
+      if (job_cache_path(path, name.c_str()) && LittleFS.exists(path)) { printString(&report, "|CACHED"); }
+    #endif
+    printString(&report, "]\r\n");
+    grbl_write(client, report.data, report.length);
+  }
+}
+
+
+uint8_t job_start(const char *name, uint32_t line, uint8_t client)
+{
+  char path[JOB_PATH_SIZE];
+  if (job.state != JOB_STATE_IDLE) { return(STATUS_JOB_ACTIVE); }
+  if (!(sys.state == STATE_IDLE || sys.state == STATE_CHECK_MODE)) { return(STATUS_IDLE_ERROR); }
+  if (!job_mounted || !job_path(path, name)) { return(STATUS_JOB_FILE); }
+  #ifdef ENABLE_JOB_CACHE
+    job_compile_cancel(true); // Shares the reader. Continues after the run.
+  #endif
+  File source = LittleFS.open(path, "r");
+  if (!source) { return(STATUS_JOB_FILE); }
+  job_reader_open(source, 0);
+  job.size = source.size();
+  #ifdef ENABLE_JOB_CACHE
+    job.replay = job_cache_open(name);
+    if (!job.replay && (job_compile_name[0] == 0)) { strcpy(job_compile_name, name); } // For the next run.
+  #endif
+  strcpy(job.name, name);
+  job.client = client;
+  job.line_number = 0;
+  job.start_time = millis();
+  job.state = JOB_STATE_RUNNING;
+  job.resume_line = line;
+  job.check_mode = (sys.state == STATE_CHECK_MODE);
+  #ifdef ENABLE_JOB_OCODES
+    job.sub_count = 0;
+    job.depth = 0;
+  #endif
+  if (line > 1) {
+    job.state = JOB_STATE_SCANNING;
+    if (!job.check_mode) {
+      sys.state = STATE_CHECK_MODE;
+      #ifdef ENABLE_DRY_PLAN
+        dryplan_start(false); // Nothing may reach the planner.
+      #endif
+    }
+  }
+  return(STATUS_OK);
+}
+
+
+uint8_t job_delete(const char *name)
+{
+  char path[JOB_PATH_SIZE];
+  if (job.state != JOB_STATE_IDLE) { return(STATUS_JOB_ACTIVE); }
+  if (!job_mounted || !job_path(path, name) || !LittleFS.remove(path)) { return(STATUS_JOB_FILE); }
+  #ifdef ENABLE_JOB_CACHE
+    job_cache_invalidate(name, false);
+  #endif
+  return(STATUS_OK);
+}
+
+
+bool job_active() { return(job.state != JOB_STATE_IDLE); }
+
+
+bool job_scanning() { return(job.state == JOB_STATE_SCANNING); }
+
+
+bool job_allows_line(const char *line)
+{
+  if (line[0] != '$') { return(false); }
+  switch (line[1]) {
+    case 0: case '$': case 'G': case '#': case 'I': case 'N': case 'F':
+      return(line[2] == 0); // Reports. Not the commands storing or running something.
+    case 'T': case 'P': return(true); // Position trace, metrics and profiler.
+    case 'R': return(line[2] == 'I'); // Auto status report subscription.
+  }
+  return(false);
+}
+
+
+// Closes the job and tells all clients how it ended.
+static void job_end(uint8_t end, uint8_t status_code)
+{
+  char temp[48+JOB_NAME_SIZE];
+  print_buffer_t report;
+  job_reader.file.close();
+  if ((job.state == JOB_STATE_SCANNING) && !job.check_mode && (sys.state == STATE_CHECK_MODE)) {
+    // Leaves check mode with the parser state as after a reset, as if the scan never started.
+    sys.state = STATE_IDLE;
+    gc_init();
+    gc_sync_position();
+  }
+  job.state = JOB_STATE_IDLE;
+
+  print_init(&report, temp, sizeof(temp));
+  printString(&report, "[JOB:");
+  printString(&report, job.name);
+  switch (end) {
+    case JOB_END_DONE: printString(&report, "|Done"); break;
+    case JOB_END_ERROR:
+      printString(&report, "|Error:");
+      print_uint8_base10(&report, status_code);
+      break;
+    default: printString(&report, "|Aborted"); break;
+  }
+  printString(&report, "|Ln:");
+  print_uint32_base10(&report, job.line_number);
+  if (end == JOB_END_DONE) {
+    printString(&report, "|Rt:");
+    printFloat(&report, (millis()-job.start_time)/1000.0, 1);
+  }
+  printString(&report, "]\r\n");
+  grbl_write(CLIENT_ALL, report.data, report.length);
+}
+
+
+// Executes a text line of the job, like the main loop does for a client. The scan skips '$' lines,
+// as most system commands are refused in check mode, and settings must not be stored twice.
+static uint8_t job_execute_text(char *line)
+{
+  if (line[0] == '$') {
+    if (job.state == JOB_STATE_SCANNING) { return(STATUS_OK); }
+    return(system_execute_line(line, job.client));
+  }
+  if (sys.state & (STATE_ALARM | STATE_JOG)) { return(STATUS_SYSTEM_GC_LOCK); }
+  return(gc_execute_line(line, job.client));
+}
+
+
+// Reads the next non-empty line of the source, or the next record of the cache. Returns the words
+// of a record, or the text line with a word count of 0. Returns a status code, or JOB_STATUS_END.
+static uint8_t job_fetch(char *line, gc_word_t *words, uint8_t *word_count)
+{
+  *word_count = 0;
+  #ifdef ENABLE_JOB_CACHE
+    if (job.replay) { return(job_replay_record(line, words, word_count)); }
+  #endif
+  uint8_t result;
+  do { // Empty and comment lines in one go.
+    result = job_read_line(line);
+    if (result == JOB_READ_END) { return(JOB_STATUS_END); }
+    job.line_number++;
+  } while ((result == JOB_READ_LINE) && (line[0] == 0));
+  if (result == JOB_READ_OVERFLOW) { return(STATUS_OVERFLOW); }
+  return(STATUS_OK);
+}
+
+
+#ifdef ENABLE_JOB_OCODES
+  /*
+    O-word lines control the flow of the job, the way LinuxCNC runs them, though without parameters
+    or expressions. They must be lines of their own, with the number and the keyword:
+
+      O<n> SUB ... O<n> ENDSUB          Defines subroutine n. Skipped where it stands.
+      O<n> CALL                         Runs subroutine n, defined further up in the job.
+      O<n> REPEAT [<count>] ... O<n> ENDREPEAT  Runs the lines in between count times.
+
+    A definition records the place of its body, and a call or loop moves the reader back to it,
+    in the source or the cache alike. Lines keep the numbers of the source in the reports.
+  */
+
+  // Parses an O-word line into the number and keyword. Returns the keyword, or JOB_OCODE_COUNT if
+  // the line isn't one. The argument follows at the char_counter.
+  static uint8_t job_ocode_parse(char *line, uint16_t *number, uint8_t *char_counter)
+  {
+    float value;
+    *char_counter = 1;
+    if ((line[0] != 'O') || !read_float(line, char_counter, &value)) { return(JOB_OCODE_COUNT); }
+    if ((value < 0) || (value > 0xFFFF) || (value != truncf(value))) { return(JOB_OCODE_COUNT); }
+    *number = value;
+    for (uint8_t keyword=0; keyword<JOB_OCODE_COUNT; keyword++) {
+      uint8_t length = strlen(job_ocode_keywords[keyword]);
+      if (strncmp(&line[*char_counter], job_ocode_keywords[keyword], length) == 0) {
+        *char_counter += length;
+        // Only a loop takes an argument.
+        if ((line[*char_counter] == 0) || (keyword == JOB_OCODE_REPEAT)) { return(keyword); }
+      }
+    }
+    return(JOB_OCODE_COUNT);
+  }
+
+
+  static void job_ocode_mark(job_mark_t *mark, uint16_t number)
+  {
+    mark->position = job_reader.position;
+    mark->line_number = job.line_number;
+    mark->number = number;
+  }
+
+
+  static uint8_t job_ocode_jump(job_mark_t *mark)
+  {
+    if (!job_reader_seek(mark->position)) { return(STATUS_JOB_FILE); }
+    job.line_number = mark->line_number;
+    return(STATUS_OK);
+  }
+
+
+  // Skips the lines up to the O-word line ending a subroutine or loop, without running them.
+  static uint8_t job_ocode_skip(uint16_t number, uint8_t end, char *line, gc_word_t *words)
+  {
+    uint8_t status_code;
+    uint8_t word_count;
+    uint8_t char_counter;
+    uint16_t skip_number;
+    while (((status_code = job_fetch(line, words, &word_count)) == STATUS_OK) || (status_code == STATUS_OVERFLOW)) {
+      if ((status_code != STATUS_OK) || (word_count != 0)) { continue; }
+      uint8_t keyword = job_ocode_parse(line, &skip_number, &char_counter);
+      if ((keyword == end) && (skip_number == number)) { return(STATUS_OK); }
+      if (keyword == JOB_OCODE_SUB) { return(STATUS_JOB_OCODE); } // No nested definitions.
+    }
+    if (status_code == JOB_STATUS_END) { return(STATUS_JOB_OCODE); } // Never ended.
+    return(status_code);
+  }
+
+
+  // Runs an O-word line. The line and words are free to read more lines into.
+  static uint8_t job_ocode(char *line, gc_word_t *words)
+  {
+    uint16_t number;
+    uint8_t char_counter;
+    uint8_t keyword = job_ocode_parse(line, &number, &char_counter);
+    job_frame_t *frame = (job.depth) ? &job.frames[job.depth-1] : NULL;
+    uint8_t idx;
+    switch (keyword) {
+      case JOB_OCODE_SUB:
+        for (idx=0; idx<job.sub_count; idx++) {
+          if (job.subs[idx].number == number) { break; }
+        }
+        if (idx < job.sub_count) { // Passed again, in a loop. Not a second definition.
+          if (job.subs[idx].position != job_reader.position) { return(STATUS_JOB_OCODE); }
+        } else {
+          if (job.sub_count == JOB_OCODE_SUBS) { return(STATUS_JOB_OCODE); }
+          job_ocode_mark(&job.subs[job.sub_count++], number);
+        }
+        return(job_ocode_skip(number, JOB_OCODE_ENDSUB, line, words));
+      case JOB_OCODE_ENDSUB:
+        if (!frame || !frame->call || (frame->mark.number != number)) { return(STATUS_JOB_OCODE); }
+        job.depth--;
+        return(job_ocode_jump(&frame->mark)); // Back to the line after the call.
+      case JOB_OCODE_CALL:
+        for (idx=0; idx<job.sub_count; idx++) {
+          if (job.subs[idx].number == number) { break; }
+        }
+        if ((idx == job.sub_count) || (job.depth == JOB_OCODE_DEPTH)) { return(STATUS_JOB_OCODE); }
+        frame = &job.frames[job.depth++];
+        job_ocode_mark(&frame->mark, number);
+        frame->call = true;
+        return(job_ocode_jump(&job.subs[idx]));
+      case JOB_OCODE_REPEAT: {
+        float value;
+        bool bracket = (line[char_counter] == '[');
+        if (bracket) { char_counter++; }
+        if (!read_float(line, &char_counter, &value)) { return(STATUS_BAD_NUMBER_FORMAT); }
+        if (bracket && (line[char_counter++] != ']')) { return(STATUS_EXPECTED_COMMAND_LETTER); }
+        if (line[char_counter] != 0) { return(STATUS_GCODE_UNUSED_WORDS); }
+        if ((value < 0) || (value > 0xFFFF) || (value != truncf(value))) { return(STATUS_GCODE_MAX_VALUE_EXCEEDED); }
+        if (value == 0) { return(job_ocode_skip(number, JOB_OCODE_ENDREPEAT, line, words)); }
+        if (job.depth == JOB_OCODE_DEPTH) { return(STATUS_JOB_OCODE); }
+        frame = &job.frames[job.depth++];
+        job_ocode_mark(&frame->mark, number);
+        frame->passes = value-1;
+        frame->call = false;
+        return(STATUS_OK);
+      }
+      case JOB_OCODE_ENDREPEAT:
+        if (!frame || frame->call || (frame->mark.number != number)) { return(STATUS_JOB_OCODE); }
+        if (frame->passes == 0) {
+          job.depth--;
+          return(STATUS_OK);
+        }
+        frame->passes--;
+        return(job_ocode_jump(&frame->mark));
+    }
+    return(STATUS_GCODE_UNSUPPORTED_COMMAND);
+  }
+#endif
+
+
+// Executes a line read by job_fetch().
+static uint8_t job_execute_fetched(char *line, gc_word_t *words, uint8_t word_count)
+{
+  #ifdef ENABLE_JOB_OCODES
+    if ((word_count == 0) && (line[0] == 'O')) { return(job_ocode(line, words)); }
+  #endif
+  if (word_count == 0) { return(job_execute_text(line)); }
+  if (sys.state & (STATE_ALARM | STATE_JOG)) { return(STATUS_SYSTEM_GC_LOCK); }
+  return(gc_execute_words(words, word_count, job.client));
+}
+
+
+// Ends the scan at the resume line. Unless the job runs in check mode, the tool then approaches
+// the position the scan ended at, and the spindle and coolant come on as the job had them there.
+static uint8_t job_resume()
+{
+  char temp[32+JOB_NAME_SIZE];
+  print_buffer_t report;
+  print_init(&report, temp, sizeof(temp));
+  printString(&report, "[JOB:");
+  printString(&report, job.name);
+  printString(&report, "|Resume|Ln:");
+  print_uint32_base10(&report, job.line_number);
+  printString(&report, "]\r\n");
+  grbl_write(CLIENT_ALL, report.data, report.length);
+
+  job.state = JOB_STATE_RUNNING;
+  if (job.check_mode) { return(STATUS_OK); } // Nothing moves.
+  sys.state = STATE_IDLE;
+  // A program end in check mode leaves the work coordinate system as it was.
+  if (!(settings_read_coord_data(gc_state.modal.coord_select,gc_state.coord_system))) { return(STATUS_SETTING_READ_FAIL); }
+  system_flag_wco_change();
+
+  float target[N_AXIS];
+  plan_line_data_t plan_data;
+  plan_line_data_t *pl_data = &plan_data;
+  memset(pl_data,0,sizeof(plan_line_data_t));
+  pl_data->condition = PL_COND_FLAG_RAPID_MOTION;
+  system_convert_array_steps_to_mpos(target,sys_position);
+  float safe_height = max(max(target[Z_AXIS],gc_state.position[Z_AXIS]),JOB_RESUME_SAFE_HEIGHT);
+  target[Z_AXIS] = safe_height;
+  mc_line(target, pl_data); // Retract, if below the safe height.
+  memcpy(target,gc_state.position,sizeof(target));
+  target[Z_AXIS] = safe_height;
+  mc_line(target, pl_data); // Travel over the resume position.
+
+  // Waits for the motions to complete, before the spindle comes on.
+  spindle_sync(gc_state.modal.spindle, gc_state.spindle_speed);
+  coolant_sync(gc_state.modal.coolant);
+  if (gc_state.modal.spindle != SPINDLE_DISABLE) { delay_sec(JOB_RESUME_SPINDLE_DELAY, DELAY_MODE_DWELL); }
+  if (sys.abort) { return(STATUS_OK); }
+
+  pl_data->condition = (gc_state.modal.spindle | gc_state.modal.coolant);
+  pl_data->feed_rate = JOB_RESUME_PLUNGE_RATE;
+  pl_data->spindle_speed = gc_state.spindle_speed;
+  mc_line(gc_state.position, pl_data); // Plunge.
+  return(STATUS_OK);
+}
+
+
+void job_execute()
+{
+  if (job.state == JOB_STATE_IDLE) {
+    #ifdef ENABLE_JOB_CACHE
+      job_compile_step();
+    #endif
+    return;
+  }
+  if (job.state == JOB_STATE_FINISHING) {
+    // Check mode leaves the blocks in the planner, and nothing moves.
+    if ((sys.state == STATE_CHECK_MODE) || ((sys.state == STATE_IDLE) && !plan_get_current_block())) {
+      job_end(JOB_END_DONE, STATUS_OK);
+    }
+    return;
+  }
+  // Parses ahead only while the planner has room, instead of waiting on a full one in mc_line().
+  // The main loop serves the clients meanwhile, and runs the realtime commands between lines.
+  // Dry planning in check mode drains the planner only when the next line comes in.
+  if (plan_check_full_buffer() && (sys.state != STATE_CHECK_MODE)) { return; }
+
+  char line[LINE_BUFFER_SIZE];
+  uint8_t word_count;
+  #ifdef ENABLE_JOB_CACHE
+    gc_word_t words[JOB_CACHE_MAX_WORDS];
+  #else
+    gc_word_t *words = NULL; // Text lines only.
+  #endif
+  uint8_t status_code;
+  uint8_t scanned = 0;
+  do { // A line at a time, or a batch of them while scanning.
+    status_code = job_fetch(line, words, &word_count);
+    if (job.state == JOB_STATE_SCANNING) {
+      if (status_code == JOB_STATUS_END) { status_code = STATUS_JOB_RESUME; } // Past the last line.
+      else if ((status_code == STATUS_OK) && (job.line_number >= job.resume_line)) {
+        status_code = job_resume();
+        if (sys.abort) { return; } // Reported by job_reset().
+      }
+    }
+    #ifdef ENABLE_JOB_OCODES
+      if ((status_code == JOB_STATUS_END) && job.depth) { status_code = STATUS_JOB_OCODE; } // Unended call or loop.
+    #endif
+    if (status_code == JOB_STATUS_END) {
+      job.state = JOB_STATE_FINISHING;
+      return;
+    }
+    if (status_code == STATUS_OK) { status_code = job_execute_fetched(line, words, word_count); }
+    #ifdef ENABLE_PIPELINE_METRICS
+      if (job.state != JOB_STATE_SCANNING) { metrics_count_line(); }
+    #endif
+    if (sys.abort) { return; } // Reported by job_reset().
+  } while ((status_code == STATUS_OK) && (job.state == JOB_STATE_SCANNING) && (++scanned < JOB_SCAN_LINES));
+  if (status_code != STATUS_OK) { job_end(JOB_END_ERROR, status_code); }
+}
+
+
+void job_reset()
+{
+  if (job.state != JOB_STATE_IDLE) { job_end(JOB_END_ABORTED, STATUS_OK); }
+}
+
+
+void job_report_progress(print_buffer_t *report)
+{
+  if (job.state == JOB_STATE_IDLE) { return; }
+  printString(report, "|SD:");
+  printFloat(report, (job.size) ? (100.0*job_reader.position)/job.size : 100.0, 1);
+  printChar(report, ',');
+  printString(report, job.name);
+}
+
+
+void job_upload_begin(const char *filename)
+{
+  job_upload_file.close(); // Left open by an upload that broke off.
+  uint8_t length = 0;
+  for (; *filename; filename++) {
+    char c = *filename;
+    if (c <= ' ') { continue; } // Dropped by the protocol too.
+    if ((c == '(') || (c == ';') || (c == '/') || (length == JOB_NAME_SIZE-1)) { length = 0; break; }
+    if (c >= 'a' && c <= 'z') { c -= 'a'-'A'; }
+    job_upload_name[length++] = c;
+  }
+  job_upload_name[length] = 0;
+  if (job.state != JOB_STATE_IDLE) { job_upload_status = STATUS_JOB_ACTIVE; }
+  else if (sys.state & ~(STATE_ALARM | STATE_CHECK_MODE | STATE_SLEEP)) { job_upload_status = STATUS_IDLE_ERROR; }
+  else if (!job_mounted || (length == 0) || (job_upload_name[0] == '.')) { job_upload_status = STATUS_JOB_FILE; }
+  else {
+    job_upload_file = LittleFS.open(JOB_UPLOAD_PATH, "w");
+    job_upload_status = (job_upload_file) ? STATUS_OK : STATUS_JOB_FILE;
+  }
+}
+
+
+void job_upload_write(const uint8_t *data, size_t length)
+{
+  if (!job_upload_file) { return; }
+  if (job.state != JOB_STATE_IDLE) { // Keeps flash writes from stalling the job or the motion.
+    job_upload_status = STATUS_JOB_ACTIVE;
+  } else if (sys.state & ~(STATE_ALARM | STATE_CHECK_MODE | STATE_SLEEP)) {
+    job_upload_status = STATUS_IDLE_ERROR;
+  } else if (job_upload_file.write(data, length) != length) {
+    job_upload_status = STATUS_JOB_FILE;
+  }
+  if (job_upload_status != STATUS_OK) { job_upload_file.close(); }
+}
+
+
+void job_upload_end()
+{
+  char path[JOB_PATH_SIZE];
+  if (!job_upload_file) { return; }
+  job_upload_file.close();
+  #ifdef ENABLE_JOB_CACHE
+    job_cache_invalidate(job_upload_name, true); // First, so no power loss leaves a cache of the old source.
+  #endif
+  if (!job_path(path, job_upload_name) || !LittleFS.rename(JOB_UPLOAD_PATH, path)) {
+    job_upload_status = STATUS_JOB_FILE;
+  }
+}
+
+
+uint8_t job_upload_result()
+{
+  uint8_t status_code = job_upload_status;
+  job_upload_status = STATUS_JOB_FILE;
+  return(status_code);
+}
+
+#endif
@@ -0,0 +1,121 @@
+/*
+  job.hpp - g-code jobs stored in the flash file system and run from there
+  Part of Grbl
+
+  Grbl is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Grbl is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Grbl.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef job_h
+#define job_h
+
+/*
+  Jobs are kept in LittleFS under /jobs and uploaded as a multipart form with an HTTP POST to
+  /upload, which answers ok or error:<code> like a g-code line. Names are stored upper case and
+  without whitespace, the way they arrive in a '$' command.
+
+    $F          : Lists the stored jobs, one [FILE:<name>|SIZE:<bytes>] line each. Compiled jobs
+                  add |CACHED. See ENABLE_JOB_CACHE.
+    $F=<name>   : Runs the job. [IDLE/CHECK]
+    $FR=<line>,<name> : Runs the job from the line on, as numbered in the job reports. [IDLE/CHECK]
+    $FD=<name>  : Deletes the job.
+
+  A running job feeds its lines to the parser from the main loop, filtered like serial input, one
+  line per pass while the planner has room. Clients are served in between, as the job never waits
+  on a full planner. Only lines waiting for the motion, like dwells and spindle changes, and arcs
+  longer than the free planner blocks hold the main loop, as they do when streamed. Feed hold,
+  cycle start and soft reset act on a job like on a streamed program. A hold stops the feed until
+  resumed, and a reset or alarm aborts the job. Meanwhile, clients may only send realtime commands
+  and the reporting '$' commands, and the status report adds
+
+    |SD:<percent>,<name>
+
+  with the share of the file read so far. Once the job ends, all clients get one of
+
+    [JOB:<name>|Done|Ln:<lines>|Rt:<s>]   All lines executed and the motions complete.
+    [JOB:<name>|Error:<code>|Ln:<line>]   Stopped at the line failing with the status code.
+    [JOB:<name>|Aborted|Ln:<line>]        Stopped by a reset or alarm.
+
+  A resumed job first scans the lines before the resume line in check mode, a batch of them per
+  pass of the main loop, and the status report shows the Check state meanwhile. The parser tracks
+  the modal state and the position as usual, but skips the motions, dwells and '$' lines. Once at
+  the resume line, all clients get
+
+    [JOB:<name>|Resume|Ln:<line>]
+
+  and the tool approaches the position and restarts the spindle and coolant the job reached there.
+  See JOB_RESUME_SAFE_HEIGHT. The job then runs as usual. A probe cycle before the resume line,
+  or a resume line past the end, fails the job with error 44, as the position isn't known after
+  it. A failed or aborted scan leaves the parser state as after a reset. Started in check mode,
+  the job stays in it, and checks the remaining lines without any approach.
+
+  With ENABLE_JOB_OCODES, a job may define subroutines and loops with O-word lines:
+
+    O<n> SUB ... O<n> ENDSUB                 Subroutine n, defined before its first call.
+    O<n> CALL                                Runs subroutine n. No arguments.
+    O<n> REPEAT [<count>] ... O<n> ENDREPEAT Runs the lines in between count times.
+
+  Subroutines may call others and hold loops, up to JOB_OCODE_DEPTH levels, but not define them.
+  Lines run in a call or loop report their numbers in the file, so a resume line in a subroutine
+  or loop body resumes at its first pass. A call of an undefined subroutine, an unmatched end or
+  a job ending inside a call or loop fails with error 45.
+*/
+
+#define JOB_NAME_SIZE 32 // Including the terminating zero. LittleFS allows 31 characters.
+#ifndef JOB_READ_AHEAD_SIZE
+  #define JOB_READ_AHEAD_SIZE 512 // Bytes read from flash at once.
+#endif
+
+// Mounts the file system. Called once at power-up.
+void job_init();
+
+// Sends the list of stored jobs to the client.
+void job_list(uint8_t client);
+
+// Starts running the job, at the line if above 1. Messages of its lines go to the client. Returns
+// a status code.
+uint8_t job_start(const char *name, uint32_t line, uint8_t client);
+
+// Deletes the job. Returns a status code.
+uint8_t job_delete(const char *name);
+
+// Returns true, while a job runs.
+bool job_active();
+
+// Returns true, while a resumed job scans the lines before the resume line. Motions are skipped.
+bool job_scanning();
+
+// Returns true, if a client line may execute while a job runs, i.e. reports only.
+bool job_allows_line(const char *line);
+
+// Executes the next line of the running job. Otherwise compiles the next line of a job into its
+// cache, if enabled and the machine is idle. Called by the main loop.
+void job_execute();
+
+// Aborts the running job, if any. Called on a system reset.
+void job_reset();
+
+// Adds the progress of the running job to a status report.
+void job_report_progress(print_buffer_t *report);
+
+// Stores an upload under the file name in pieces, as it arrives. Uploads are refused while a job
+// runs or the machine moves, as flash writes stall the main loop. The job is replaced only once
+// completely written.
+void job_upload_begin(const char *filename);
+void job_upload_write(const uint8_t *data, size_t length);
+void job_upload_end();
+
+// Returns the status code of the last upload, and clears it for the next one.
+uint8_t job_upload_result();
+
+#endif
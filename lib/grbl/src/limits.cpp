@@ -55,15 +55,11 @@ uint8_t limits_get_state()
 {
   uint8_t limit_state = 0;
 
-  uint8_t pin = (LIMIT_PORT_INPUTS & LIMIT_MASK);
-  #ifdef INVERT_LIMIT_PIN_MASK
-    pin ^= INVERT_LIMIT_PIN_MASK;
-  #endif
-  if (bit_istrue(settings.flags,BITFLAG_INVERT_LIMIT_PINS)) { pin ^= LIMIT_MASK; }
+  uint8_t pin = (LIMIT_PORT_INPUTS & LIMIT_MASK) ^ settings_derived.limit_invert_mask;
   if (pin) {
     uint8_t idx;
     for (idx=0; idx<N_AXIS; idx++) {
-      if (pin & get_limit_pin_mask(idx)) { limit_state |= (1 << idx); }
+      if (pin & settings_derived.limit_pin_mask[idx]) { limit_state |= (1 << idx); }
     }
   }
   return(limit_state);
@@ -120,11 +116,11 @@ ICACHE_RAM_ATTR void pin_limit_vect() {
       #ifdef HARD_LIMIT_FORCE_STATE_CHECK
         // Check limit pin state.
         if (limits_get_state()) {
-          mc_reset(); // Initiate system kill.
+          mc_reset_request(); // Initiate system kill.
           system_set_exec_alarm(EXEC_ALARM_HARD_LIMIT); // Indicate hard limit critical event
         }
       #else
-        mc_reset(); // Initiate system kill.
+        mc_reset_request(); // Initiate system kill.
         system_set_exec_alarm(EXEC_ALARM_HARD_LIMIT); // Indicate hard limit critical event
       #endif
     }
@@ -159,9 +155,9 @@ void limits_go_home(uint8_t cycle_mask)
   uint8_t idx;
   for (idx=0; idx<N_AXIS; idx++) {
     // Initialize step pin masks
-    step_pin[idx] = get_step_pin_mask(idx);
+    step_pin[idx] = settings_derived.step_pin_mask[idx];
     #ifdef COREXY
-      if ((idx==A_MOTOR)||(idx==B_MOTOR)) { step_pin[idx] = (get_step_pin_mask(X_AXIS)|get_step_pin_mask(Y_AXIS)); }
+      if ((idx==A_MOTOR)||(idx==B_MOTOR)) { step_pin[idx] = (settings_derived.step_pin_mask[X_AXIS]|settings_derived.step_pin_mask[Y_AXIS]); }
     #endif
 
     if (bit_istrue(cycle_mask,bit(idx))) {
@@ -248,6 +244,7 @@ void limits_go_home(uint8_t cycle_mask)
       st_prep_buffer(); // Check and prep segment buffer. NOTE: Should take no longer than 200us.
 
       // Exit routines: No time to run protocol_execute_realtime() in this loop.
+      mc_exec_reset_request();
       if (sys_rt_exec_state & (EXEC_SAFETY_DOOR | EXEC_RESET | EXEC_CYCLE_STOP)) {
         uint8_t rt_exec = sys_rt_exec_state;
         // Homing failure condition: Reset issued during cycle.
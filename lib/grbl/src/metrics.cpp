@@ -0,0 +1,166 @@
+/*
+  metrics.cpp - pipeline health counters
+  Part of Grbl
+
+  Grbl is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Grbl is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Grbl.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "grbl.hpp"
+
+#ifdef ENABLE_PIPELINE_METRICS
+
+#define METRICS_CYCLES_PER_US (F_CPU/1000000L)
+
+// Free running counters. Rates are the difference between two samples a second apart, which also
+// works across a counter wrap.
+typedef struct {
+  uint32_t lines;
+  volatile uint32_t rx_bytes[CLIENT_COUNT];
+  uint32_t timer_cycles[METRICS_TIMER_COUNT];
+} metrics_counters_t;
+
+typedef struct {
+  metrics_counters_t total;
+  metrics_counters_t last;   // total at the start of the current second.
+  metrics_counters_t rate;   // Increase over the previous second.
+  uint32_t timer_max[METRICS_TIMER_COUNT]; // (cycles)
+  uint32_t planner_fill[BLOCK_BUFFER_SIZE]; // (ms)
+  volatile uint32_t underruns;
+  uint32_t tx_flushes;
+  uint32_t tx_wait_total; // (ms)
+  uint32_t tx_wait_max;   // (ms)
+  uint32_t next_second;
+  uint32_t last_sample;
+} metrics_t;
+
+static metrics_t metrics;
+
+
+void metrics_reset()
+{
+  memset(metrics.timer_max, 0, sizeof(metrics.timer_max));
+  memset(metrics.planner_fill, 0, sizeof(metrics.planner_fill));
+  metrics.underruns = 0;
+  metrics.tx_flushes = 0;
+  metrics.tx_wait_total = 0;
+  metrics.tx_wait_max = 0;
+}
+
+
+void metrics_count_line()
+{
+  metrics.total.lines++;
+}
+
+
+void ICACHE_RAM_ATTR metrics_count_rx(uint8_t client)
+{
+  metrics.total.rx_bytes[client-1]++;
+}
+
+
+void ICACHE_RAM_ATTR metrics_count_underrun()
+{
+  metrics.underruns++;
+}
+
+
+void metrics_timer_add(uint8_t timer, uint32_t start)
+{
+  uint32_t cycles = ESP.getCycleCount() - start;
+  metrics.total.timer_cycles[timer] += cycles;
+  if (cycles > metrics.timer_max[timer]) { metrics.timer_max[timer] = cycles; }
+}
+
+
+void metrics_tx_flush(uint32_t wait_ms)
+{
+  metrics.tx_flushes++;
+  metrics.tx_wait_total += wait_ms;
+  if (wait_ms > metrics.tx_wait_max) { metrics.tx_wait_max = wait_ms; }
+}
+
+
+void metrics_poll()
+{
+  uint32_t now = millis();
+
+  // Sample the planner fill once per millisecond, so the histogram is weighted by time.
+  if (now != metrics.last_sample) {
+    metrics.last_sample = now;
+    if (sys.state & (STATE_CYCLE | STATE_JOG)) {
+      metrics.planner_fill[plan_get_block_buffer_count()]++;
+    }
+  }
+
+  if ((int32_t)(now - metrics.next_second) < 0) { return; }
+  metrics.next_second = now + 1000;
+
+  uint8_t idx;
+  metrics_counters_t total = metrics.total;
+  metrics.rate.lines = total.lines - metrics.last.lines;
+  for (idx=0; idx<CLIENT_COUNT; idx++) {
+    metrics.rate.rx_bytes[idx] = total.rx_bytes[idx] - metrics.last.rx_bytes[idx];
+  }
+  for (idx=0; idx<METRICS_TIMER_COUNT; idx++) {
+    metrics.rate.timer_cycles[idx] = total.timer_cycles[idx] - metrics.last.timer_cycles[idx];
+  }
+  metrics.last = total;
+}
+
+
+void metrics_build(print_buffer_t *buffer)
+{
+  uint8_t idx;
+  printString(buffer, "[PM:Ln:");
+  print_uint32_base10(buffer, metrics.rate.lines);
+  printString(buffer, "|Pl:");
+  for (idx=0; idx<BLOCK_BUFFER_SIZE; idx++) {
+    if (idx > 0) { printChar(buffer, ','); }
+    print_uint32_base10(buffer, metrics.planner_fill[idx]);
+  }
+  printString(buffer, "|Ur:");
+  print_uint32_base10(buffer, metrics.underruns);
+  for (idx=0; idx<METRICS_TIMER_COUNT; idx++) {
+    printString(buffer, (idx == METRICS_TIMER_PLANNER) ? "|Pr:" : "|Sp:");
+    print_uint32_base10(buffer, metrics.rate.timer_cycles[idx]/METRICS_CYCLES_PER_US);
+    printChar(buffer, ',');
+    print_uint32_base10(buffer, metrics.timer_max[idx]/METRICS_CYCLES_PER_US);
+  }
+  printString(buffer, "|Rx:");
+  for (idx=0; idx<CLIENT_COUNT; idx++) {
+    if (idx > 0) { printChar(buffer, ','); }
+    print_uint32_base10(buffer, metrics.rate.rx_bytes[idx]);
+  }
+  printString(buffer, "|Tx:");
+  print_uint32_base10(buffer, metrics.tx_flushes);
+  printChar(buffer, ',');
+  print_uint32_base10(buffer, (metrics.tx_flushes) ? (metrics.tx_wait_total/metrics.tx_flushes) : 0);
+  printChar(buffer, ',');
+  print_uint32_base10(buffer, metrics.tx_wait_max);
+  printChar(buffer, ']');
+}
+
+
+void metrics_report(uint8_t client)
+{
+  char temp[METRICS_REPORT_SIZE];
+  print_buffer_t report;
+  print_init(&report, temp, sizeof(temp));
+  metrics_build(&report);
+  printString(&report, "\r\n");
+  grbl_write(client, report.data, report.length);
+}
+
+#endif
@@ -0,0 +1,75 @@
+/*
+  metrics.hpp - pipeline health counters
+  Part of Grbl
+
+  Grbl is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Grbl is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Grbl.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef metrics_h
+#define metrics_h
+
+/*
+  Counters to tell where a stuttering job loses time: parsing, planner depth, segment preparation
+  or the link. Sent by $PM and served as text/plain at http://<host>/metrics:
+
+    [PM:Ln:<lines>|Pl:<fill 0>,...,<fill n>|Ur:<underruns>|Pr:<us>,<max us>|Sp:<us>,<max us>|Rx:<serial>,<websocket>|Tx:<flushes>,<avg ms>,<max ms>]
+
+    Ln : Lines executed in the last second, g-code, '$' and binary frames alike.
+    Pl : Planner fill histogram. Milliseconds spent in a cycle with 0 to BLOCK_BUFFER_SIZE-1
+         blocks queued. Low fills mean the planner is starved by parsing or the link.
+    Ur : Times the segment buffer ran dry during a cycle, with planner blocks left to execute.
+    Pr : Time spent in planner_recalculate() in the last second, and the longest single call.
+    Sp : Time spent in st_prep_buffer() in the last second, and the longest single call. This
+         includes its yields to the WiFi stack.
+    Rx : Bytes received from each client in the last second.
+    Tx : Websocket flushes, and the average and longest time output waited in the send buffer.
+
+  Maximums, counts and the histogram accumulate until cleared with $PM=0 or a power cycle.
+*/
+
+#define METRICS_TIMER_PLANNER 0 // planner_recalculate()
+#define METRICS_TIMER_PREP    1 // st_prep_buffer()
+#define METRICS_TIMER_COUNT   2
+
+// Size of the buffer metrics_build() needs for the worst case report.
+#define METRICS_REPORT_SIZE (128 + 11*BLOCK_BUFFER_SIZE)
+
+// Updates the per second rates and samples the planner fill. Called by the main program.
+void metrics_poll();
+
+// Clears all counters.
+void metrics_reset();
+
+// Counts a line executed by the protocol.
+void metrics_count_line();
+
+// Counts a byte received from a client. Called from the receive interrupt.
+void metrics_count_rx(uint8_t client);
+
+// Counts a segment buffer underrun. Called by the stepper ISR, when it runs out of segments.
+void metrics_count_underrun();
+
+// Adds the CPU cycles since start, from ESP.getCycleCount(), to a timer.
+void metrics_timer_add(uint8_t timer, uint32_t start);
+
+// Records how long output waited in the websocket send buffer before it was flushed.
+void metrics_tx_flush(uint32_t wait_ms);
+
+// Writes the report line, without line ending.
+void metrics_build(print_buffer_t *buffer);
+
+// Sends the report line to the client.
+void metrics_report(uint8_t client);
+
+#endif
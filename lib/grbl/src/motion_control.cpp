@@ -39,7 +39,12 @@ void mc_line(float *target, plan_line_data_t *pl_data)
   }
 
   // If in check gcode mode, prevent motion by blocking planner. Soft limits still work.
-  if (sys.state == STATE_CHECK_MODE) { return; }
+  if (sys.state == STATE_CHECK_MODE) {
+    #ifdef ENABLE_DRY_PLAN
+      if (dryplan_active()) { dryplan_line(target, pl_data); } // Planned, but never executed.
+    #endif
+    return;
+  }
 
   // NOTE: Backlash compensation may be installed here. It will need direction info to track when
   // to insert a backlash line motion(s) before the intended line motion and will require its own
@@ -59,7 +64,7 @@ void mc_line(float *target, plan_line_data_t *pl_data)
   // Remain in this loop until there is room in the buffer.
   do {
     ESP.wdtFeed();
-    delay(0);
+    PROFILE_YIELD();
     protocol_execute_realtime(); // Check for any run-time commands
     if (sys.abort) { return; } // Bail, if system abort.
     if ( plan_check_full_buffer() ) { protocol_auto_cycle_start(); } // Auto-cycle start when buffer is full.
@@ -89,6 +94,8 @@ void mc_line(float *target, plan_line_data_t *pl_data)
 void mc_arc(float *target, plan_line_data_t *pl_data, float *position, float *offset, float radius,
   uint8_t axis_0, uint8_t axis_1, uint8_t axis_linear, uint8_t is_clockwise_arc)
 {
+  PROFILE_SCOPE(PROFILE_ARC);
+
   float center_axis0 = position[axis_0] + offset[axis_0];
   float center_axis1 = position[axis_1] + offset[axis_1];
   float radius_axis0 = -offset[axis_0];  // Radius vector from center to current location
@@ -160,7 +167,7 @@ void mc_arc(float *target, plan_line_data_t *pl_data, float *position, float *of
     uint8_t count = 0;
 
     for (i = 1; i<segments; i++) { // Increment (segments-1).
-      delay(0);
+      PROFILE_YIELD();
       if (count < N_ARC_CORRECTION) {
         // Apply vector rotation matrix. ~40 usec
         radius_axisi = radius_axis0*sin_T + radius_axis1*cos_T;
@@ -196,12 +203,76 @@ void mc_arc(float *target, plan_line_data_t *pl_data, float *position, float *of
 // Execute dwell in seconds.
 void mc_dwell(float seconds)
 {
-  if (sys.state == STATE_CHECK_MODE) { return; }
+  if (sys.state == STATE_CHECK_MODE) {
+    #ifdef ENABLE_DRY_PLAN
+      if (dryplan_active()) { dryplan_dwell(seconds); }
+    #endif
+    return;
+  }
   protocol_buffer_synchronize();
   delay_sec(seconds, DELAY_MODE_DWELL);
 }
 
 
+#ifdef ENABLE_CANNED_CYCLES
+  // Execute a canned drilling cycle at the hole target, from the position. The drilling axis value
+  // of the target is the bottom of the hole. As in LinuxCNC, the tool rapids up to the R level,
+  // if below it, over the hole, and down to the R level. It feeds to the bottom, in pecks for G73
+  // and G83, dwells for G82 and rapids out to the clear level.
+  void mc_canned_cycle(float *target, plan_line_data_t *pl_data, float *position, uint8_t cycle_mode,
+    float r_level, float clear_level, float peck, float dwell, uint8_t axis_0, uint8_t axis_1, uint8_t axis_linear)
+  {
+    float point[N_AXIS];
+    plan_line_data_t rapid_data;
+    memcpy(point,position,sizeof(point));
+    memcpy(&rapid_data,pl_data,sizeof(plan_line_data_t));
+    rapid_data.condition |= PL_COND_FLAG_RAPID_MOTION;
+
+    if (point[axis_linear] < r_level) {
+      point[axis_linear] = r_level;
+      mc_line(point, &rapid_data);
+    }
+    point[axis_0] = target[axis_0];
+    point[axis_1] = target[axis_1];
+    mc_line(point, &rapid_data);
+    point[axis_linear] = r_level;
+    mc_line(point, &rapid_data);
+
+    float bottom = target[axis_linear];
+    if ((cycle_mode == MOTION_MODE_DRILL_PECK) || (cycle_mode == MOTION_MODE_DRILL_CHIP_BREAK)) {
+      // Counts the pecks, as a float depth stepped by a tiny Q may never reach the bottom. The parser
+      // limits them to CANNED_CYCLE_MAX_PECKS.
+      uint16_t pecks = ceilf((r_level-bottom)/peck);
+      float depth = r_level;
+      for (uint16_t idx=1; idx<=pecks; idx++) {
+        protocol_execute_realtime(); // Check mode queues nothing, so mc_line() never gets there.
+        if (sys.abort) { return; } // Bail, if system abort.
+        if (idx > 1) { // After the first peck.
+          if (cycle_mode == MOTION_MODE_DRILL_PECK) { // Clear the chips out of the hole, and go back down.
+            point[axis_linear] = r_level;
+            mc_line(point, &rapid_data);
+            point[axis_linear] = min(depth+CANNED_CYCLE_PECK_CLEARANCE, r_level);
+          } else { // Break the chip.
+            point[axis_linear] = depth+CANNED_CYCLE_PECK_CLEARANCE;
+          }
+          mc_line(point, &rapid_data);
+        }
+        depth = (idx == pecks) ? bottom : r_level-idx*peck;
+        point[axis_linear] = depth;
+        mc_line(point, pl_data);
+      }
+    } else {
+      point[axis_linear] = bottom;
+      mc_line(point, pl_data);
+      if (cycle_mode == MOTION_MODE_DRILL_DWELL) { mc_dwell(dwell); }
+    }
+
+    point[axis_linear] = clear_level;
+    mc_line(point, &rapid_data);
+  }
+#endif
+
+
 // Perform homing cycle to locate and set machine zero. Only '$H' executes this command.
 // NOTE: There should be no motions in the buffer and Grbl must be in an idle state before
 // executing the homing cycle. This prevents incorrect buffered plans after homing.
@@ -289,7 +360,7 @@ uint8_t mc_probe_cycle(float *target, plan_line_data_t *pl_data, uint8_t parser_
   system_set_exec_state_flag(EXEC_CYCLE_START);
   do {
     ESP.wdtFeed();
-    delay(0);
+    PROFILE_YIELD();
     protocol_execute_realtime();
     if (sys.abort) { return(GC_PROBE_ABORT); } // Check for system abort
   } while (sys.state != STATE_IDLE);
@@ -339,7 +410,7 @@ uint8_t mc_probe_cycle(float *target, plan_line_data_t *pl_data, uint8_t parser_
       st_wake_up();
       do {
         ESP.wdt_reset();
-        delay(0);
+        PROFILE_YIELD();
         protocol_exec_rt_system();
         if (sys.abort) { return; }
       } while (sys.step_control & STEP_CONTROL_EXECUTE_SYS_MOTION);
@@ -364,20 +435,24 @@ uint8_t mc_probe_cycle(float *target, plan_line_data_t *pl_data, uint8_t parser_
 #endif
 
 
+// The parts of a reset left to the main program by mc_reset_request().
+#define MC_RESET_SHUTDOWN bit(0) // Kill spindle and coolant.
+#define MC_RESET_IDLE     bit(1) // Complete the stepper stop with st_go_idle().
+static volatile uint8_t mc_reset_pending;
+
 // Method to ready the system to reset by setting the realtime reset command and killing any
 // active processes in the system. This also checks if a system reset is issued while Grbl
-// is in a motion state. If so, kills the steppers and sets the system alarm to flag position
-// lost, since there was an abrupt uncontrolled deceleration. Called at an interrupt level by
-// realtime abort command and hard limits. So, keep to a minimum.
-void mc_reset()
+// is in a motion state. If so, kills the step output and sets the system alarm to flag position
+// lost, since there was an abrupt uncontrolled deceleration. Called at an interrupt level by the
+// realtime abort command, the reset control pin and hard limits, so in IRAM and kept to a minimum.
+// The spindle, coolant and stepper driver code runs from flash, and st_go_idle() waits out the
+// step idle delay, so that part is left to mc_exec_reset_request() in the main program.
+void ICACHE_RAM_ATTR mc_reset_request()
 {
   // Only this function can set the system reset. Helps prevent multiple kill calls.
   if (bit_isfalse(sys_rt_exec_state, EXEC_RESET)) {
     system_set_exec_state_flag(EXEC_RESET);
-
-    // Kill spindle and coolant.
-    spindle_stop();
-    coolant_stop();
+    uint8_t pending = MC_RESET_SHUTDOWN;
 
     // Kill steppers only if in any motion state, i.e. cycle, actively holding, or homing.
     // NOTE: If steppers are kept enabled via the step idle delay setting, this also keeps
@@ -389,7 +464,31 @@ void mc_reset()
       if (sys.state == STATE_HOMING) {
         if (!sys_rt_exec_alarm) {system_set_exec_alarm(EXEC_ALARM_HOMING_FAIL_RESET); }
       } else { system_set_exec_alarm(EXEC_ALARM_ABORT_CYCLE); }
-      st_go_idle(); // Force kill steppers. Position has likely been lost.
+      st_halt(); // Force kill steppers. Position has likely been lost.
+      pending |= MC_RESET_IDLE;
     }
+    mc_reset_pending |= pending;
+  }
+}
+
+// Runs the part of a reset that mc_reset_request() leaves to the main program, if any. Called
+// each time the main program executes the realtime commands.
+void mc_exec_reset_request()
+{
+  uint8_t pending = mc_reset_pending;
+  if (!pending) { return; }
+  mc_reset_pending = 0;
+  if (pending & MC_RESET_SHUTDOWN) {
+    // Kill spindle and coolant.
+    spindle_stop();
+    coolant_stop();
   }
+  if (pending & MC_RESET_IDLE) { st_go_idle(); }
+}
+
+// Performs a reset from the main program, completely and at once.
+void mc_reset()
+{
+  mc_reset_request();
+  mc_exec_reset_request();
 }
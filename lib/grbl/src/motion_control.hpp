@@ -48,6 +48,11 @@ void mc_arc(float *target, plan_line_data_t *pl_data, float *position, float *of
 // Dwell for a specific number of seconds
 void mc_dwell(float seconds);
 
+// Execute a canned drilling cycle G73/G81/G82/G83 at the target. target[axis_linear] is the bottom
+// of the hole, and clear_level the drilling axis position to retract to. In absolute mm.
+void mc_canned_cycle(float *target, plan_line_data_t *pl_data, float *position, uint8_t cycle_mode,
+  float r_level, float clear_level, float peck, float dwell, uint8_t axis_0, uint8_t axis_1, uint8_t axis_linear);
+
 // Perform homing cycle to locate machine zero. Requires limit switches.
 void mc_homing_cycle(uint8_t cycle_mask);
 
@@ -63,4 +68,9 @@ void mc_parking_motion(float *parking_target, plan_line_data_t *pl_data);
 // Performs system reset. If in motion state, kills all motion and sets system alarm.
 void mc_reset();
 
+// Performs system reset from an interrupt. Sets the reset and stops the step output at once, and
+// leaves the spindle, coolant and stepper idle shutdown to mc_exec_reset_request().
+void mc_reset_request();
+void mc_exec_reset_request();
+
 #endif
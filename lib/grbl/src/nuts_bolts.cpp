@@ -24,73 +24,96 @@
 #define MAX_INT_DIGITS 8 // Maximum number of digits in int32 (and float)
 
 
-// Extracts a floating point value from a string. The following code is based loosely on
-// the avr-libc strtod() function by Michael Stumpf and Dmitry Xmelkov and many freely
-// available conversion method examples, but has been highly optimized for Grbl. For known
-// CNC applications, the typical decimal value is expected to be in the range of E0 to E-4.
-// Scientific notation is officially not supported by g-code, and the 'E' character may
-// be a g-code word on some CNC systems. So, 'E' notation will not be recognized.
-// NOTE: Thanks to Radu-Eosif Mihailescu for identifying the issues with using strtod().
-uint8_t read_float(char *line, uint8_t *char_counter, float *float_ptr)
-{
-  char *ptr = line + *char_counter;
-  unsigned char current_char;
+// Powers of ten, all exact in a float up to 1e10.
+static const float pow10_table[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10 };
+#define POW10_TABLE_MAX 10
 
-  // Grab first character and increment pointer. No spaces assumed in line.
-  current_char = *ptr++;
+
+// Scans a signed decimal number at ptr into an integer of at most MAX_INT_DIGITS digits and a
+// power of ten exponent. Digits are taken in pairs where possible, which halves the loop passes
+// for the usual coordinate values. Returns the number of digits read, 0 if none, and sets ptr to
+// the first character after the number.
+static uint8_t read_decimal(char **ptr_ref, bool *is_negative, uint32_t *integer_ptr, int8_t *exponent_ptr)
+{
+  char *ptr = *ptr_ref;
 
   // Capture initial positive/minus character
-  bool is_negative = false;
-  if (current_char == '-') {
-    is_negative = true;
-    current_char = *ptr++;
-  } else if (current_char == '+') {
-    current_char = *ptr++;
+  *is_negative = false;
+  if (*ptr == '-') {
+    *is_negative = true;
+    ptr++;
+  } else if (*ptr == '+') {
+    ptr++;
   }
 
   // Extract number into fast integer. Track decimal in terms of exponent value.
   uint32_t integer_value = 0;
-  int88_t exponent = 0;
+  int8_t exponent = 0;
   uint8_t num_digits = 0;
   bool is_decimal = false;
-  while(1) {
-    current_char -= '0';
-    if (current_char <= 9) {
+  for (;;) {
+    uint8_t digit = (uint8_t)(ptr[0] - '0');
+    if (digit <= 9) {
+      uint8_t next_digit = (uint8_t)(ptr[1] - '0');
+      if ((next_digit <= 9) && (num_digits+2 <= MAX_INT_DIGITS)) {
+        integer_value = integer_value*100 + digit*10 + next_digit;
+        num_digits += 2;
+        if (is_decimal) { exponent -= 2; }
+        ptr += 2;
+        continue;
+      }
       num_digits++;
       if (num_digits <= MAX_INT_DIGITS) {
         if (is_decimal) { exponent--; }
-        integer_value = (((integer_value << 2) + integer_value) << 1) + current_char; // integer_value*10 + current_char
+        integer_value = integer_value*10 + digit;
       } else {
         if (!(is_decimal)) { exponent++; }  // Drop overflow digits
       }
-    } else if (current_char == (('.'-'0') & 0xff)  &&  !(is_decimal)) {
+    } else if ((*ptr == '.') && !(is_decimal)) {
       is_decimal = true;
     } else {
       break;
     }
-    current_char = *ptr++;
+    ptr++;
   }
 
-  // Return if no digits have been read.
-  if (!num_digits) { return(false); };
+  *ptr_ref = ptr;
+  *integer_ptr = integer_value;
+  *exponent_ptr = exponent;
+  return(num_digits);
+}
 
-  // Convert integer into floating point.
-  float float_value;
-  float_value = (float)integer_value;
 
-  // Apply decimal. Should perform no more than two floating point multiplications for the
-  // expected range of E0 to E-4.
+// Extracts a floating point value from a string. The following code is based loosely on
+// the avr-libc strtod() function by Michael Stumpf and Dmitry Xmelkov and many freely
+// available conversion method examples, but has been highly optimized for Grbl. For known
+// CNC applications, the typical decimal value is expected to be in the range of E0 to E-4.
+// Scientific notation is officially not supported by g-code, and the 'E' character may
+// be a g-code word on some CNC systems. So, 'E' notation will not be recognized.
+// NOTE: Thanks to Radu-Eosif Mihailescu for identifying the issues with using strtod().
+// The decimal is applied with a single float division by an exact power of ten, which is
+// correctly rounded for up to 7 significant digits.
+uint8_t read_float(char *line, uint8_t *char_counter, float *float_ptr)
+{
+  char *ptr = line + *char_counter;
+  bool is_negative;
+  uint32_t integer_value;
+  int8_t exponent;
+
+  // Return if no digits have been read.
+  if (!read_decimal(&ptr, &is_negative, &integer_value, &exponent)) { return(false); }
+
+  // Convert integer into floating point, and apply the decimal.
+  float float_value = (float)integer_value;
   if (float_value != 0) {
-    while (exponent <= -2) {
-      float_value *= 0.01;
-      exponent += 2;
-    }
     if (exponent < 0) {
-      float_value *= 0.1;
-    } else if (exponent > 0) {
-      do {
-        float_value *= 10.0;
-      } while (--exponent > 0);
+      float_value /= pow10_table[-exponent]; // At most MAX_INT_DIGITS decimals.
+    } else {
+      while (exponent > 0) { // Integer part longer than MAX_INT_DIGITS.
+        uint8_t step = min(exponent, POW10_TABLE_MAX);
+        float_value *= pow10_table[step];
+        exponent -= step;
+      }
     }
   }
 
@@ -101,7 +124,7 @@ uint8_t read_float(char *line, uint8_t *char_counter, float *float_ptr)
     *float_ptr = float_value;
   }
 
-  *char_counter = ptr - line - 1; // Set char_counter to next statement
+  *char_counter = ptr - line; // Set char_counter to next statement
 
   return(true);
 }
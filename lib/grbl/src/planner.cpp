@@ -23,10 +23,7 @@
 #include "grbl.hpp"
 
 
-static plan_block_t block_buffer[BLOCK_BUFFER_SIZE];  // A ring buffer for motion instructions
-static uint8_t block_buffer_tail;     // Index of the block to process now
-static uint8_t block_buffer_head;     // Index of the next block to be pushed
-static uint8_t next_buffer_head;      // Index of the next buffer head
+static RingBuffer<plan_block_t,BLOCK_BUFFER_SIZE> block_buffer; // A ring buffer for motion instructions
 static uint8_t block_buffer_planned;  // Index of the optimally planned block
 
 // Define planner variables
@@ -43,18 +40,14 @@ static planner_t planner;
 // Returns the index of the next block in the ring buffer. Also called by stepper segment buffer.
 uint8_t plan_next_block_index(uint8_t block_index)
 {
-  block_index++;
-  if (block_index == BLOCK_BUFFER_SIZE) { block_index = 0; }
-  return(block_index);
+  return(block_buffer.next(block_index));
 }
 
 
 // Returns the index of the previous block in the ring buffer
 static uint8_t plan_prev_block_index(uint8_t block_index)
 {
-  if (block_index == 0) { block_index = BLOCK_BUFFER_SIZE; }
-  block_index--;
-  return(block_index);
+  return(block_buffer.prev(block_index));
 }
 
 
@@ -99,15 +92,13 @@ static uint8_t plan_prev_block_index(uint8_t block_index)
   recomputed as stated in the general guidelines.
 
   Planner buffer index mapping:
-  - block_buffer_tail: Points to the beginning of the planner buffer. First to be executed or being executed.
-  - block_buffer_head: Points to the buffer block after the last block in the buffer. Used to indicate whether
+  - block_buffer.tail(): Points to the beginning of the planner buffer. First to be executed or being executed.
+  - block_buffer.head(): Points to the buffer block after the last block in the buffer. Used to indicate whether
       the buffer is full or empty. As described for standard ring buffers, this block is always empty.
-  - next_buffer_head: Points to next planner buffer block after the buffer head block. When equal to the
-      buffer tail, this indicates the buffer is full.
   - block_buffer_planned: Points to the first buffer block after the last optimally planned block for normal
       streaming operating conditions. Use for planning optimizations by avoiding recomputing parts of the
       planner buffer that don't change with the addition of a new block, as describe above. In addition,
-      this block can never be less than block_buffer_tail and will always be pushed forward and maintain
+      this block can never be less than block_buffer.tail() and will always be pushed forward and maintain
       this requirement when encountered by the plan_discard_current_block() routine during a cycle.
 
   NOTE: Since the planner only computes on what's in the planner buffer, some motions with lots of short
@@ -123,10 +114,10 @@ static uint8_t plan_prev_block_index(uint8_t block_index)
   ARM versions should have enough memory and speed for look-ahead blocks numbering up to a hundred or more.
 
 */
-static void planner_recalculate()
+static void planner_recalculate_plan()
 {
   // Initialize block index to the last block in the planner buffer.
-  uint8_t block_index = plan_prev_block_index(block_buffer_head);
+  uint8_t block_index = plan_prev_block_index(block_buffer.head());
 
   // Bail. Can't do anything with one only one plan-able block.
   if (block_index == block_buffer_planned) { return; }
@@ -144,7 +135,7 @@ static void planner_recalculate()
   block_index = plan_prev_block_index(block_index);
   if (block_index == block_buffer_planned) { // Only two plannable blocks in buffer. Reverse pass complete.
     // Check if the first block is the tail. If so, notify stepper to update its current parameters.
-    if (block_index == block_buffer_tail) { st_update_plan_block_parameters(); }
+    if (block_index == block_buffer.tail()) { st_update_plan_block_parameters(); }
   } else { // Three or more plan-able blocks
     while (block_index != block_buffer_planned) {
       next = current;
@@ -152,7 +143,7 @@ static void planner_recalculate()
       block_index = plan_prev_block_index(block_index);
 
       // Check if next block is the tail block(=planned block). If so, update current stepper parameters.
-      if (block_index == block_buffer_tail) { st_update_plan_block_parameters(); }
+      if (block_index == block_buffer.tail()) { st_update_plan_block_parameters(); }
 
       // Compute maximum entry speed decelerating over the current block from its exit speed.
       if (current->entry_speed_sqr != current->max_entry_speed_sqr) {
@@ -170,7 +161,7 @@ static void planner_recalculate()
   // Also scans for optimal plan breakpoints and appropriately updates the planned pointer.
   next = &block_buffer[block_buffer_planned]; // Begin at buffer planned pointer
   block_index = plan_next_block_index(block_buffer_planned);
-  while (block_index != block_buffer_head) {
+  while (block_index != block_buffer.head()) {
     current = next;
     next = &block_buffer[block_index];
 
@@ -196,6 +187,18 @@ static void planner_recalculate()
 }
 
 
+static void planner_recalculate()
+{
+  #ifdef ENABLE_PIPELINE_METRICS
+    uint32_t start = ESP.getCycleCount();
+    planner_recalculate_plan();
+    metrics_timer_add(METRICS_TIMER_PLANNER, start);
+  #else
+    planner_recalculate_plan();
+  #endif
+}
+
+
 void plan_reset()
 {
   memset(&planner, 0, sizeof(planner_t)); // Clear planner struct
@@ -205,20 +208,17 @@ void plan_reset()
 
 void plan_reset_buffer()
 {
-  block_buffer_tail = 0;
-  block_buffer_head = 0; // Empty = tail
-  next_buffer_head = 1; // plan_next_block_index(block_buffer_head)
-  block_buffer_planned = 0; // = block_buffer_tail;
+  block_buffer.reset();
+  block_buffer_planned = 0; // = block_buffer.tail()
 }
 
 
 void plan_discard_current_block()
 {
-  if (block_buffer_head != block_buffer_tail) { // Discard non-empty buffer.
-    uint8_t block_index = plan_next_block_index( block_buffer_tail );
+  if (!block_buffer.empty()) { // Discard non-empty buffer.
     // Push block_buffer_planned pointer, if encountered.
-    if (block_buffer_tail == block_buffer_planned) { block_buffer_planned = block_index; }
-    block_buffer_tail = block_index;
+    if (block_buffer.tail() == block_buffer_planned) { block_buffer_planned = plan_next_block_index(block_buffer_planned); }
+    block_buffer.pop();
   }
 }
 
@@ -226,22 +226,22 @@ void plan_discard_current_block()
 // Returns address of planner buffer block used by system motions. Called by segment generator.
 plan_block_t *plan_get_system_motion_block()
 {
-  return(&block_buffer[block_buffer_head]);
+  return(block_buffer.write_slot());
 }
 
 
 // Returns address of first planner block, if available. Called by various main program functions.
 plan_block_t *plan_get_current_block()
 {
-  if (block_buffer_head == block_buffer_tail) { return(NULL); } // Buffer empty
-  return(&block_buffer[block_buffer_tail]);
+  if (block_buffer.empty()) { return(NULL); }
+  return(block_buffer.read_slot());
 }
 
 
 float plan_get_exec_block_exit_speed_sqr()
 {
-  uint8_t block_index = plan_next_block_index(block_buffer_tail);
-  if (block_index == block_buffer_head) { return( 0.0 ); }
+  uint8_t block_index = plan_next_block_index(block_buffer.tail());
+  if (block_index == block_buffer.head()) { return( 0.0 ); }
   return( block_buffer[block_index].entry_speed_sqr );
 }
 
@@ -249,8 +249,7 @@ float plan_get_exec_block_exit_speed_sqr()
 // Returns the availability status of the block ring buffer. True, if full.
 uint8_t plan_check_full_buffer()
 {
-  if (block_buffer_tail == next_buffer_head) { return(true); }
-  return(false);
+  return(block_buffer.full());
 }
 
 
@@ -283,11 +282,11 @@ static void plan_compute_profile_parameters(plan_block_t *block, float nominal_s
 // Re-calculates buffered motions profile parameters upon a motion-based override change.
 void plan_update_velocity_profile_parameters()
 {
-  uint8_t block_index = block_buffer_tail;
+  uint8_t block_index = block_buffer.tail();
   plan_block_t *block;
   float nominal_speed;
   float prev_nominal_speed = SOME_LARGE_VALUE; // Set high for first block nominal speed calculation.
-  while (block_index != block_buffer_head) {
+  while (block_index != block_buffer.head()) {
     block = &block_buffer[block_index];
     nominal_speed = plan_compute_profile_nominal_speed(block);
     plan_compute_profile_parameters(block, nominal_speed, prev_nominal_speed);
@@ -314,8 +313,10 @@ void plan_update_velocity_profile_parameters()
    to execute the special system motion. */
 uint8_t plan_buffer_line(float *target, plan_line_data_t *pl_data)
 {
+  PROFILE_SCOPE(PROFILE_PLANNER);
+
   // Prepare and initialize new block. Copy relevant pl_data for block execution.
-  plan_block_t *block = &block_buffer[block_buffer_head];
+  plan_block_t *block = block_buffer.write_slot();
   memset(block,0,sizeof(plan_block_t)); // Zero all block values.
   block->condition = pl_data->condition;
   #ifdef VARIABLE_SPINDLE
@@ -374,7 +375,7 @@ uint8_t plan_buffer_line(float *target, plan_line_data_t *pl_data)
     unit_vec[idx] = delta_mm; // Store unit vector numerator
 
     // Set direction bits. Bit enabled always means direction is negative.
-    if (delta_mm < 0.0 ) { block->direction_bits |= get_direction_pin_mask(idx); }
+    if (delta_mm < 0.0 ) { block->direction_bits |= settings_derived.direction_pin_mask[idx]; }
   }
 
   // Bail if this is a zero-length block. Highly unlikely to occur.
@@ -396,7 +397,7 @@ uint8_t plan_buffer_line(float *target, plan_line_data_t *pl_data)
   }
 
   // TODO: Need to check this method handling zero junction speeds when starting from rest.
-  if ((block_buffer_head == block_buffer_tail) || (block->condition & PL_COND_FLAG_SYSTEM_MOTION)) {
+  if (block_buffer.empty() || (block->condition & PL_COND_FLAG_SYSTEM_MOTION)) {
 
     // Initialize block entry speed as zero. Assume it will be starting from rest. Planner will correct this later.
     // If system motion, the system motion block always is assumed to start from rest and end at a complete stop.
@@ -461,9 +462,8 @@ uint8_t plan_buffer_line(float *target, plan_line_data_t *pl_data)
     memcpy(planner.previous_unit_vec, unit_vec, sizeof(unit_vec)); // planner.previous_unit_vec[] = unit_vec[]
     memcpy(planner.position, target_steps, sizeof(target_steps)); // planner.position[] = target_steps[]
 
-    // New block is all set. Update buffer head and next buffer head indices.
-    block_buffer_head = next_buffer_head;
-    next_buffer_head = plan_next_block_index(block_buffer_head);
+    // New block is all set. Publish it by advancing the buffer head.
+    block_buffer.commit();
 
     // Finish up by recalculating the plan with the new block.
     planner_recalculate();
@@ -497,8 +497,7 @@ void plan_sync_position()
 // Returns the number of available blocks are in the planner buffer.
 uint8_t plan_get_block_buffer_available()
 {
-  if (block_buffer_head >= block_buffer_tail) { return((BLOCK_BUFFER_SIZE-1)-(block_buffer_head-block_buffer_tail)); }
-  return((block_buffer_tail-block_buffer_head-1));
+  return(block_buffer.available());
 }
 
 
@@ -506,8 +505,7 @@ uint8_t plan_get_block_buffer_available()
 // NOTE: Deprecated. Not used unless classic status reports are enabled in config.h
 uint8_t plan_get_block_buffer_count()
 {
-  if (block_buffer_head >= block_buffer_tail) { return(block_buffer_head-block_buffer_tail); }
-  return(BLOCK_BUFFER_SIZE - (block_buffer_tail-block_buffer_head));
+  return(block_buffer.count());
 }
 
 
@@ -517,6 +515,6 @@ void plan_cycle_reinitialize()
 {
   // Re-plan from a complete stop. Reset planner entry speeds and buffer planned pointer.
   st_update_plan_block_parameters();
-  block_buffer_planned = block_buffer_tail;
+  block_buffer_planned = block_buffer.tail();
   planner_recalculate();
 }
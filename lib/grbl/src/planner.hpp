@@ -23,13 +23,9 @@
 #define planner_h
 
 
-// The number of linear motions that can be in the plan at any give time
+// The number of linear motions that can be in the plan at any give time, plus one. Must be a power of two.
 #ifndef BLOCK_BUFFER_SIZE
-  #ifdef USE_LINE_NUMBERS
-    #define BLOCK_BUFFER_SIZE 15
-  #else
-    #define BLOCK_BUFFER_SIZE 16
-  #endif
+  #define BLOCK_BUFFER_SIZE 16
 #endif
 
 // Returned status message from planner.
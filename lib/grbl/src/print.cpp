@@ -22,46 +22,45 @@
 #include "grbl.hpp"
 
 
-/*void printString(const char *s)
+void print_init(print_buffer_t *buffer, char *data, uint16_t size)
 {
-  while (*s)
-    serial_write(*s++);
-}*/
+  buffer->data = data;
+  buffer->size = size;
+  buffer->length = 0;
+  data[0] = '\0';
+}
 
 
-// Print a string stored in PGM-memory
-/*void printPgmString(const char *s)
+void print_truncate(print_buffer_t *buffer, uint16_t length)
 {
-  char c;
-  while ((c = pgm_read_byte_near(s++)))
-    serial_write(c);
-}*/
-
-
-// void printIntegerInBase(unsigned long n, unsigned long base)
-// {
-// 	unsigned char buf[8 * sizeof(long)]; // Assumes 8-bit chars.
-// 	unsigned long i = 0;
-//
-// 	if (n == 0) {
-// 		serial_write('0');
-// 		return;
-// 	}
-//
-// 	while (n > 0) {
-// 		buf[i++] = n % base;
-// 		n /= base;
-// 	}
-//
-// 	for (; i > 0; i--)
-// 		serial_write(buf[i - 1] < 10 ?
-// 			'0' + buf[i - 1] :
-// 			'A' + buf[i - 1] - 10);
-// }
+  if (length < buffer->length) {
+    buffer->length = length;
+    buffer->data[length] = '\0';
+  }
+}
+
+
+void printChar(print_buffer_t *buffer, char c)
+{
+  if (buffer->length+1 < buffer->size) {
+    buffer->data[buffer->length++] = c;
+    buffer->data[buffer->length] = '\0';
+  }
+}
+
+
+void printString(print_buffer_t *buffer, const char *s)
+{
+  char *p = &buffer->data[buffer->length];
+  char *end = &buffer->data[buffer->size-1]; // Keep room for the null terminator.
+  while (*s && (p < end)) { *p++ = *s++; }
+  *p = '\0';
+  buffer->length = p - buffer->data;
+}
 
 
 // Prints an uint8 variable in base 10.
-void print_uint8_base10(uint8_t n)
+void print_uint8_base10(print_buffer_t *buffer, uint8_t n)
 {
   uint8_t digit_a = 0;
   uint8_t digit_b = 0;
@@ -73,54 +72,37 @@ void print_uint8_base10(uint8_t n)
     digit_b = '0' + n % 10;
     n /= 10;
   }
-  serial_write('0' + n);
-  if (digit_b) { serial_write(digit_b); }
-  if (digit_a) { serial_write(digit_a); }
+  printChar(buffer, '0' + n);
+  if (digit_b) { printChar(buffer, digit_b); }
+  if (digit_a) { printChar(buffer, digit_a); }
 }
 
 
-// Prints an uint8 variable in base 2 with desired number of desired digits.
-void print_uint8_base2_ndigit(uint8_t n, uint8_t digits) {
-  unsigned char buf[digits];
-  uint8_t i = 0;
-
-  for (; i < digits; i++) {
-      buf[i] = n % 2 ;
-      n /= 2;
-  }
-
-  for (; i > 0; i--)
-      serial_write('0' + buf[i - 1]);
-}
-
-
-void print_uint32_base10(uint32_t n)
+void print_uint32_base10(print_buffer_t *buffer, uint32_t n)
 {
   if (n == 0) {
-    serial_write('0');
+    printChar(buffer, '0');
     return;
   }
 
-  unsigned char buf[10];
-  uint8_t i = 0;
-
+  char buf[11];
+  uint8_t i = sizeof(buf)-1;
+  buf[i] = '\0';
   while (n > 0) {
-    buf[i++] = n % 10;
+    buf[--i] = '0' + n % 10;
     n /= 10;
   }
-
-  for (; i > 0; i--)
-    serial_write('0' + buf[i-1]);
+  printString(buffer, &buf[i]);
 }
 
 
-void printInteger(long n)
+void printInteger(print_buffer_t *buffer, long n)
 {
   if (n < 0) {
-    serial_write('-');
-    print_uint32_base10(-n);
+    printChar(buffer, '-');
+    print_uint32_base10(buffer, -(uint32_t)n);
   } else {
-    print_uint32_base10(n);
+    print_uint32_base10(buffer, n);
   }
 }
 
@@ -128,14 +110,10 @@ void printInteger(long n)
 // Convert float to string by immediately converting to a long integer, which contains
 // more digits than a float. Number of decimal places, which are tracked by a counter,
 // may be set by the user. The integer is then efficiently converted to a string.
-// NOTE: AVR '%' and '/' integer operations are very efficient. Bitshifting speed-up
-// techniques are actually just slightly slower. Found this out the hard way.
-void printFloat(float n, uint8_t decimal_places)
+void printFloat(print_buffer_t *buffer, float n, uint8_t decimal_places)
 {
-  if (n < 0) {
-    serial_write('-');
-    n = -n;
-  }
+  uint8_t negative = (n < 0);
+  if (negative) { n = -n; }
 
   uint8_t decimals = decimal_places;
   while (decimals >= 2) { // Quickly convert values expected to be E0 to E-4.
@@ -146,25 +124,24 @@ void printFloat(float n, uint8_t decimal_places)
   n += 0.5; // Add rounding factor. Ensures carryover through entire value.
 
   // Generate digits backwards and store in string.
-  unsigned char buf[13];
-  uint8_t i = 0;
-  uint32_t a = (long)n;
-  while(a > 0) {
-    buf[i++] = (a % 10) + '0'; // Get digit
+  char buf[14];
+  uint8_t i = sizeof(buf)-1;
+  buf[i] = '\0';
+  uint32_t a = (uint32_t)n;
+  if (negative && a) { printChar(buffer, '-'); } // No sign for values rounding to zero.
+  while (a > 0) {
+    if (decimal_places && ((sizeof(buf)-1-i) == decimal_places)) { buf[--i] = '.'; } // Insert decimal point.
+    buf[--i] = (a % 10) + '0'; // Get digit
     a /= 10;
   }
-  while (i < decimal_places) {
-     buf[i++] = '0'; // Fill in zeros to decimal point for (n < 1)
+  while ((sizeof(buf)-1-i) < decimal_places) {
+     buf[--i] = '0'; // Fill in zeros to decimal point for (n < 1)
   }
-  if (i == decimal_places) { // Fill in leading zero, if needed.
-    buf[i++] = '0';
-  }
-
-  // Print the generated string.
-  for (; i > 0; i--) {
-    if (i == decimal_places) { serial_write('.'); } // Insert decimal point in right place.
-    serial_write(buf[i-1]);
+  if ((sizeof(buf)-1-i) == decimal_places) { // Fill in leading zero, if needed.
+    if (decimal_places) { buf[--i] = '.'; }
+    buf[--i] = '0';
   }
+  printString(buffer, &buf[i]);
 }
 
 
@@ -172,29 +149,18 @@ void printFloat(float n, uint8_t decimal_places)
 // in the config.h.
 //  - CoordValue: Handles all position or coordinate values in inches or mm reporting.
 //  - RateValue: Handles feed rate and current velocity in inches or mm reporting.
-void printFloat_CoordValue(float n) {
+void printFloat_CoordValue(print_buffer_t *buffer, float n) {
   if (bit_istrue(settings.flags,BITFLAG_REPORT_INCHES)) {
-    printFloat(n*INCH_PER_MM,N_DECIMAL_COORDVALUE_INCH);
+    printFloat(buffer, n*INCH_PER_MM, N_DECIMAL_COORDVALUE_INCH);
   } else {
-    printFloat(n,N_DECIMAL_COORDVALUE_MM);
+    printFloat(buffer, n, N_DECIMAL_COORDVALUE_MM);
   }
 }
 
-void printFloat_RateValue(float n) {
+void printFloat_RateValue(print_buffer_t *buffer, float n) {
   if (bit_istrue(settings.flags,BITFLAG_REPORT_INCHES)) {
-    printFloat(n*INCH_PER_MM,N_DECIMAL_RATEVALUE_INCH);
+    printFloat(buffer, n*INCH_PER_MM, N_DECIMAL_RATEVALUE_INCH);
   } else {
-    printFloat(n,N_DECIMAL_RATEVALUE_MM);
+    printFloat(buffer, n, N_DECIMAL_RATEVALUE_MM);
   }
 }
-
-// Debug tool to print free memory in bytes at the called point.
-// NOTE: Keep commented unless using. Part of this function always gets compiled in.
-// void printFreeMemory()
-// {
-//   extern int __heap_start, *__brkval;
-//   uint16_t free;  // Up to 64k values.
-//   free = (int) &free - (__brkval == 0 ? (int) &__heap_start : (int) __brkval);
-//   printInteger((int32_t)free);
-//   printString(" ");
-// }
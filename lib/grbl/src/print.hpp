@@ -23,29 +23,40 @@
 #define print_h
 
 
-//void printString(const char *s);
+// Bounded, append-only text buffer for building reports on the stack. Appends only touch the new
+// characters, instead of rescanning the string like strcat, and never allocate. Text that does not
+// fit is dropped. The buffer always holds a null-terminated string.
+typedef struct {
+  char *data;
+  uint16_t size;    // Size of data, including the null terminator.
+  uint16_t length;  // Current string length. May be reduced to drop the text after it.
+} print_buffer_t;
 
-//void printPgmString(const char *s);
+// Starts an empty string in data.
+void print_init(print_buffer_t *buffer, char *data, uint16_t size);
 
-//void printInteger(long n);
+// Drops all text after the first length characters.
+void print_truncate(print_buffer_t *buffer, uint16_t length);
 
-//void print_uint32_base10(uint32_t n);
+void printChar(print_buffer_t *buffer, char c);
 
-// Prints an uint8 variable in base 10.
-//void print_uint8_base10(uint8_t n);
+void printString(print_buffer_t *buffer, const char *s);
+
+void printInteger(print_buffer_t *buffer, long n);
 
-// Prints an uint8 variable in base 2 with desired number of desired digits.
-//void print_uint8_base2_ndigit(uint8_t n, uint8_t digits);
+void print_uint32_base10(print_buffer_t *buffer, uint32_t n);
 
-//void printFloat(float n, uint8_t decimal_places);
+// Prints an uint8 variable in base 10.
+void print_uint8_base10(print_buffer_t *buffer, uint8_t n);
+
+// Prints a float with a fixed number of decimal places. Uses integer math only after scaling, so
+// the scaled magnitude must fit in 32 bits. Plenty for any position, rate or setting value.
+void printFloat(print_buffer_t *buffer, float n, uint8_t decimal_places);
 
 // Floating value printing handlers for special variables types used in Grbl.
 //  - CoordValue: Handles all position or coordinate values in inches or mm reporting.
 //  - RateValue: Handles feed rate and current velocity in inches or mm reporting.
-//void printFloat_CoordValue(float n);
-//void printFloat_RateValue(float n);
-
-// Debug tool to print free memory in bytes at the called point. Not used otherwise.
-//void printFreeMemory();
+void printFloat_CoordValue(print_buffer_t *buffer, float n);
+void printFloat_RateValue(print_buffer_t *buffer, float n);
 
 #endif
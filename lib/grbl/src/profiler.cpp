@@ -0,0 +1,97 @@
+/*
+  profiler.cpp - scoped CPU cycle profiler for the main program
+  Part of Grbl
+
+  Grbl is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Grbl is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Grbl.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "grbl.hpp"
+
+#ifdef ENABLE_PROFILER
+
+#define PROFILER_CYCLES_PER_US (F_CPU/1000000L)
+
+typedef struct {
+  uint32_t calls;
+  uint64_t total_cycles; // 64 bit, since 32 bit wraps after less than a minute.
+  uint64_t self_cycles;
+  uint32_t max_cycles;
+} profiler_section_t;
+
+static profiler_section_t profiler_sections[PROFILE_COUNT];
+static ProfileScope *profiler_current; // Innermost open scope.
+
+static const char *const profiler_section_names[PROFILE_COUNT] = {
+  "gcode", "planner", "arc", "prep", "report", "yield"
+};
+
+
+ProfileScope::ProfileScope(uint8_t section)
+{
+  nested_cycles = 0;
+  _section = section;
+  _parent = profiler_current;
+  profiler_current = this;
+  _start = ESP.getCycleCount(); // Last, to leave out the bookkeeping.
+}
+
+
+ProfileScope::~ProfileScope()
+{
+  uint32_t cycles = ESP.getCycleCount() - _start;
+  profiler_section_t *section = &profiler_sections[_section];
+  section->self_cycles += cycles - nested_cycles;
+  // A section nested in itself is already counted in full by the outer scope.
+  if ((_parent == NULL) || (_parent->_section != _section)) {
+    section->calls++;
+    section->total_cycles += cycles;
+    if (cycles > section->max_cycles) { section->max_cycles = cycles; }
+  }
+  if (_parent != NULL) { _parent->nested_cycles += cycles; }
+  profiler_current = _parent;
+}
+
+
+void profiler_reset()
+{
+  memset(profiler_sections, 0, sizeof(profiler_sections));
+}
+
+
+void profiler_report(uint8_t client)
+{
+  char temp[80];
+  print_buffer_t report;
+  uint8_t idx;
+  for (idx=0; idx<PROFILE_COUNT; idx++) {
+    profiler_section_t section = profiler_sections[idx];
+    print_init(&report, temp, sizeof(temp));
+    printString(&report, "[PR:");
+    printString(&report, profiler_section_names[idx]);
+    printChar(&report, ',');
+    print_uint32_base10(&report, section.calls);
+    printChar(&report, ',');
+    print_uint32_base10(&report, (uint32_t)(section.total_cycles/PROFILER_CYCLES_PER_US));
+    printChar(&report, ',');
+    print_uint32_base10(&report, (uint32_t)(section.self_cycles/PROFILER_CYCLES_PER_US));
+    printChar(&report, ',');
+    print_uint32_base10(&report, (section.calls) ? (uint32_t)(section.total_cycles/section.calls) : 0);
+    printChar(&report, ',');
+    print_uint32_base10(&report, section.max_cycles);
+    printString(&report, "]\r\n");
+    grbl_write(client, report.data, report.length);
+  }
+}
+
+#endif
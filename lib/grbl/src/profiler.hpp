@@ -0,0 +1,74 @@
+/*
+  profiler.hpp - scoped CPU cycle profiler for the main program
+  Part of Grbl
+
+  Grbl is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Grbl is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Grbl.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef profiler_h
+#define profiler_h
+
+/*
+  PROFILE_SCOPE(section) accounts the CPU cycles from the mark to the end of the enclosing block to
+  the section, however the block is left. PROFILE_YIELD() replaces delay(0) in the main program and
+  accounts the time given to the WiFi stack. Sections nest. Each section keeps its total time,
+  which includes nested sections, and its self time, which doesn't. A section nested in itself,
+  e.g. a report calling another report, is only counted once. $PR sends one line per section:
+
+    [PR:<section>,<calls>,<total us>,<self us>,<average cycles>,<max cycles>]
+
+  average and max are per call and include nested sections. $PR=0 clears all sections. Only for
+  use in the main program. Not interrupt safe. With ENABLE_PROFILER undefined, the marks compile
+  to nothing and PROFILE_YIELD() to delay(0).
+*/
+
+#define PROFILE_GCODE   0 // gc_execute_line()
+#define PROFILE_PLANNER 1 // plan_buffer_line()
+#define PROFILE_ARC     2 // mc_arc()
+#define PROFILE_PREP    3 // st_prep_buffer()
+#define PROFILE_REPORT  4 // report_*()
+#define PROFILE_WIFI    5 // PROFILE_YIELD(). Time given to the WiFi stack.
+#define PROFILE_COUNT   6
+
+#ifdef ENABLE_PROFILER
+
+  class ProfileScope {
+    public:
+    ProfileScope(uint8_t section);
+    ~ProfileScope();
+    uint32_t nested_cycles; // Spent in nested sections. Not part of the self time.
+
+    private:
+    ProfileScope *_parent;
+    uint32_t _start;
+    uint8_t _section;
+  };
+
+  #define PROFILE_SCOPE(section) ProfileScope profile_scope(section)
+  #define PROFILE_YIELD() do { ProfileScope profile_scope(PROFILE_WIFI); delay(0); } while (0)
+
+  // Clears all sections.
+  void profiler_reset();
+
+  // Sends one line per section to the client.
+  void profiler_report(uint8_t client);
+
+#else
+
+  #define PROFILE_SCOPE(section)
+  #define PROFILE_YIELD() delay(0)
+
+#endif
+
+#endif
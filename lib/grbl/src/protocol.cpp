@@ -20,12 +20,6 @@
 */
 #include "grbl.hpp"
 
-// Define line flags. Includes comment type tracking and line overflow detection.
-#define LINE_FLAG_OVERFLOW bit(0)
-#define LINE_FLAG_COMMENT_PARENTHESES bit(1)
-#define LINE_FLAG_COMMENT_SEMICOLON bit(2)
-
-
 static char line[LINE_BUFFER_SIZE]; // Line to be executed. Zero-terminated.
 
 static void protocol_exec_rt_suspend();
@@ -69,9 +63,9 @@ void protocol_main_loop()
 
   uint8_t line_flags = 0;
   uint8_t char_counter = 0;
-  uint8_t c;
+  int16_t c;
   for (;;) {
-    delay(0);
+    PROFILE_YIELD();
     // Process one line of incoming serial data, as the data becomes available. Performs an
     // initial filtering by removing spaces and comments and capitalizing all letters.
     uint8_t client = CLIENT_SERIAL;
@@ -79,7 +73,29 @@ void protocol_main_loop()
     {
       while((c = serial_read(client)) != SERIAL_NO_DATA) {
         ESP.wdtFeed();
-        delay(0);
+        PROFILE_YIELD();
+        #ifdef ENABLE_BINARY_STREAMING
+          // Binary frames are collected separately from the text line and executed as one block,
+          // once complete and validated. Text line state is left untouched.
+          if ((c == BS_FRAME_START) || bs_frame_active(client)) {
+            uint8_t status = bs_frame_read(client, c);
+            if (status == BS_FRAME_PENDING) { continue; }
+            protocol_execute_realtime(); // Runtime command check point.
+            if (sys.abort) { return; } // Bail to calling function upon system abort
+            if (status == STATUS_OK) {
+              if (sys.state & (STATE_ALARM | STATE_JOG)) { status = STATUS_SYSTEM_GC_LOCK; }
+              #ifdef ENABLE_JOB_STORAGE
+                else if (job_active()) { status = STATUS_JOB_ACTIVE; }
+              #endif
+              else { status = bs_frame_execute(client); }
+            }
+            report_status_message(status, client);
+            #ifdef ENABLE_PIPELINE_METRICS
+              metrics_count_line();
+            #endif
+            continue;
+          }
+        #endif
         if ((c == '\n') || (c == '\r')) { // End of line reached
           protocol_execute_realtime(); // Runtime command check point.
           if (sys.abort) { return; } // Bail to calling function upon system abort
@@ -96,6 +112,11 @@ void protocol_main_loop()
           } else if (line[0] == 0) {
             // Empty or comment line. For syncing purposes.
             report_status_message(STATUS_OK, client);
+          #ifdef ENABLE_JOB_STORAGE
+            } else if (job_active() && !job_allows_line(line)) {
+              // Lines of a client would mix with those of the job. Reports only.
+              report_status_message(STATUS_JOB_ACTIVE, client);
+          #endif
           } else if (line[0] == '$') {
             // Grbl '$' system command
             report_status_message(system_execute_line(line, client), client);
@@ -106,6 +127,9 @@ void protocol_main_loop()
             // Parse and execute g-code block.
             report_status_message(gc_execute_line(line, client), client);
           }
+          #ifdef ENABLE_PIPELINE_METRICS
+            metrics_count_line();
+          #endif
 
           // Reset tracking data for next line.
           line_flags = 0;
@@ -154,6 +178,17 @@ void protocol_main_loop()
       }
     }
 
+    #ifdef ENABLE_JOB_STORAGE
+      // Feeds the next line of a job stored in flash, or compiles one while idle. Not reached
+      // during a feed hold, as the suspend loop holds the main program.
+      job_execute();
+      if (sys.abort) { return; } // Bail to main() program loop to reset system.
+    #endif
+
+    #ifdef ENABLE_EEPROM_JOURNAL
+      eeprom_commit_idle(); // Writes changed settings to the flash, once idle.
+    #endif
+
     // If there are no more characters in the serial read buffer to be processed and executed,
     // this indicates that g-code streaming has either filled the planner buffer or has
     // completed. In either case, auto-cycle start, if enabled, any queued moves.
@@ -171,11 +206,15 @@ void protocol_main_loop()
 // during a synchronize call, if it should happen. Also, waits for clean cycle end.
 void protocol_buffer_synchronize()
 {
+  #ifdef ENABLE_DRY_PLAN
+    // Nothing executes the dry planned blocks. Drain them here instead of waiting.
+    if (dryplan_active()) { dryplan_synchronize(); return; }
+  #endif
   // If system is queued, ensure cycle resumes if the auto start flag is present.
   protocol_auto_cycle_start();
   do {
     ESP.wdtFeed();
-    delay(0);
+    PROFILE_YIELD();
     protocol_execute_realtime();   // Check and execute run-time commands
     if (sys.abort) { return; } // Check for system abort
   } while (plan_get_current_block() || (sys.state == STATE_CYCLE));
@@ -219,6 +258,7 @@ void protocol_execute_realtime()
 void protocol_exec_rt_system()
 {
   uint8_t rt_exec; // Temp variable to avoid calling volatile multiple times.
+  mc_exec_reset_request(); // Spindle and coolant shutdown of a reset from an interrupt.
   rt_exec = sys_rt_exec_alarm; // Copy volatile sys_rt_exec_alarm.
   if (rt_exec) { // Enter only if any bit flag is true
     // System alarm. Everything has shutdown by something that has gone severely wrong. Report
@@ -232,7 +272,8 @@ void protocol_exec_rt_system()
       system_clear_exec_state_flag(EXEC_RESET); // Disable any existing reset
       do {
         ESP.wdtFeed();
-        delay(0);
+        PROFILE_YIELD();
+        mc_exec_reset_request();
         // Block everything, except reset and status reports, until user issues reset or power
         // cycles. Hard limits typically occur while unattended or not paying attention. Gives
         // the user and a GUI time to do what is needed before resetting, like killing the
@@ -254,8 +295,7 @@ void protocol_exec_rt_system()
 
     // Execute and serial print status
     if (rt_exec & EXEC_STATUS_REPORT) {
-      report_realtime_status(CLIENT_ALL);
-      system_clear_exec_state_flag(EXEC_STATUS_REPORT);
+      report_realtime_status_clients(system_take_exec_status_report_clients());
     }
 
     // NOTE: Once hold is initiated, the system immediately enters a suspend state to block all
@@ -489,6 +529,20 @@ void protocol_exec_rt_system()
     }
   }
 
+  #ifdef ENABLE_AUTO_STATUS_REPORT
+    // Push status reports to subscribed clients, when their interval is due or the state changed.
+    rt_exec = report_auto_status_clients();
+    if (rt_exec) { report_realtime_status_clients(rt_exec); }
+  #endif
+
+  #ifdef ENABLE_BINARY_TELEMETRY
+    telemetry_poll();
+  #endif
+
+  #ifdef ENABLE_PIPELINE_METRICS
+    metrics_poll();
+  #endif
+
   #ifdef DEBUG
     if (sys_rt_exec_debug) {
       report_realtime_debug();
@@ -547,7 +601,7 @@ static void protocol_exec_rt_suspend()
   #endif
 
   while (sys.suspend) {
-    delay(0);
+    PROFILE_YIELD();
     if (sys.abort) { return; }
 
     // Block until initial hold is complete and the machine has stopped motion.
@@ -633,7 +687,7 @@ static void protocol_exec_rt_suspend()
             coolant_set_state(COOLANT_DISABLE); // De-energize
             st_go_idle(); // Disable steppers
             while (!(sys.abort)) {
-              delay(0);
+              PROFILE_YIELD();
               protocol_exec_rt_system();
               } // Do nothing until reset.
             return; // Abort received. Return to re-initialize.
@@ -31,91 +31,102 @@
 // Taken from Grbl_Esp32
 // this is a generic send function that everything should use, so interfaces could be added (Bluetooth, etc)
 void grbl_send(uint8_t client, const char *text)
+{
+  grbl_write(client, text, strlen(text));
+}
+
+// Sends length characters of text. Used with report buffers, which already know their length.
+void grbl_write(uint8_t client, const char *text, size_t length)
 {
 	if ( client == CLIENT_WEBSOCKET || client == CLIENT_ALL )
-		Serial2Socket.write((const uint8_t*)text, strlen(text));
+		Serial2Socket.write((const uint8_t*)text, length);
 
 	if ( client == CLIENT_SERIAL || client == CLIENT_ALL )
-		Serial.print(text);
+		Serial.write((const uint8_t*)text, length);
 }
 
 // Taken from Grbl_Esp32
 // This is a formating version of the grbl_send(CLIENT_ALL,...) function that work like printf
+// NOTE: Formats into a fixed size stack buffer. Longer messages are truncated.
 void grbl_sendf(uint8_t client, const char *format, ...)
 {
-  char local_buffer[64];
-  char * temp = local_buffer;
+  char temp[GRBL_SENDF_BUFFER_SIZE];
   va_list argument_list;
-  va_list argument_copy;
   va_start(argument_list, format);
-  va_copy(argument_copy, argument_list);
-  size_t length = vsnprintf(NULL, 0, format, argument_list);
-  va_end(argument_copy);
-  if(length >= sizeof(local_buffer)){
-    temp = new char[length+1];
-    if(temp == NULL) {
-      return;
-    }
-  }
-  length = vsnprintf(temp, length+1, format, argument_list);
-  grbl_send(client, temp);
+  int length = vsnprintf(temp, sizeof(temp), format, argument_list);
   va_end(argument_list);
-  if(length > 64){
-    delete[] temp;
-  }
+  if (length < 0) { return; }
+  if (length >= (int)sizeof(temp)) { length = sizeof(temp)-1; }
+  grbl_write(client, temp, length);
 }
 
 // Use to send [MSG:xxxx] Type messages. The level allows messages to be easily suppressed
-void grbl_msg_sendf(uint8_t client, uint8_t level, const char *format, ...) {
-	if (level > GRBL_MSG_LEVEL) return;
-
-    char local_buffer[64];
-    char * temp = local_buffer;
-    va_list argument_list;
-    va_list argument_copy;
-    va_start(argument_list, format);
-    va_copy(argument_copy, argument_list);
-    size_t length = vsnprintf(NULL, 0, format, argument_list);
-    va_end(argument_copy);
-    if(length >= sizeof(local_buffer)){
-        temp = new char[length+1];
-        if(temp == NULL) {
-            return;
-        }
-    }
-    length = vsnprintf(temp, length+1, format, argument_list);
-    grbl_sendf(client, "[MSG:%s]\r\n", temp);
-    va_end(argument_list);
-    if(length > 64){
-        delete[] temp;
-    }
+void grbl_msg_sendf(uint8_t client, uint8_t level, const char *format, ...)
+{
+  if (level > GRBL_MSG_LEVEL) { return; }
+
+  char temp[GRBL_SENDF_BUFFER_SIZE];
+  print_buffer_t message;
+  print_init(&message, temp, sizeof(temp));
+  printString(&message, "[MSG:");
+  va_list argument_list;
+  va_start(argument_list, format);
+  int length = vsnprintf(&temp[message.length], message.size-message.length-3, format, argument_list); // Room for "]\r\n"
+  va_end(argument_list);
+  if (length < 0) { return; }
+  message.length = strlen(temp);
+  printString(&message, "]\r\n");
+  grbl_write(client, message.data, message.length);
 }
 
 // Internal report utilities to reduce flash with repetitive tasks turned into functions.
 
-// formats axis values into a string and returns that string in rpt
-static void report_util_axis_values(float *axis_value, char *report) {
-  uint8_t index;
-  char axis_value_string[10];
-  float unit_conversion = 1.0; // unit conversion multiplier..default is mm
+static void report_util_send(uint8_t client, print_buffer_t *buffer)
+{
+  grbl_write(client, buffer->data, buffer->length);
+}
 
-  report[0] = '\0';
+// Sends a [MSG:] feedback message.
+static void report_util_feedback_line(uint8_t client, const char *message)
+{
+  char temp[48];
+  print_buffer_t report;
+  print_init(&report, temp, sizeof(temp));
+  printString(&report, "[MSG:");
+  printString(&report, message);
+  printString(&report, "]\r\n");
+  report_util_send(client, &report);
+}
 
-  if (bit_istrue(settings.flags,BITFLAG_REPORT_INCHES)) {
-    unit_conversion = 1.0 / MM_PER_INCH;
-  }
+static void report_util_line_feed(print_buffer_t *buffer) { printString(buffer, "\r\n"); }
 
-  for (index=0; index<N_AXIS; index++) {
-    if (bit_istrue(settings.flags,BITFLAG_REPORT_INCHES)) {
-      sprintf(axis_value_string, "%4.4f", axis_value[index] * unit_conversion);  // Report inches to 4 decimals
-    } else {
-      sprintf(axis_value_string, "%4.3f", axis_value[index] * unit_conversion);  // Report mm to 3 decimals
-    }
-    strcat(report, axis_value_string);
+static void report_util_setting_prefix(print_buffer_t *buffer, uint8_t n)
+{
+  printChar(buffer, '$');
+  print_uint8_base10(buffer, n);
+  printChar(buffer, '=');
+}
 
-    if (index < (N_AXIS-1)) {
-      strcat(report, ",");
-    }
+static void report_util_integer_setting(print_buffer_t *buffer, uint8_t n, uint32_t val)
+{
+  report_util_setting_prefix(buffer, n);
+  print_uint32_base10(buffer, val);
+  report_util_line_feed(buffer);
+}
+
+static void report_util_float_setting(print_buffer_t *buffer, uint8_t n, float val)
+{
+  report_util_setting_prefix(buffer, n);
+  printFloat(buffer, val, N_DECIMAL_SETTINGVALUE);
+  report_util_line_feed(buffer);
+}
+
+// Prints the axis values as a comma separated list in the reporting units.
+static void report_util_axis_values(print_buffer_t *buffer, float *axis_value) {
+  uint8_t index;
+  for (index=0; index<N_AXIS; index++) {
+    printFloat_CoordValue(buffer, axis_value[index]);
+    if (index < (N_AXIS-1)) { printChar(buffer, ','); }
   }
 }
 
@@ -127,18 +138,33 @@ static void report_util_axis_values(float *axis_value, char *report) {
 // responses.
 void report_status_message(uint8_t status_code, uint8_t client)
 {
+  PROFILE_SCOPE(PROFILE_REPORT);
   switch(status_code) {
     case STATUS_OK: // STATUS_OK
       grbl_send(client,"ok\r\n"); break;
-    default:
-      grbl_sendf(client, "error:%d\r\n", status_code);
+    default: {
+      char temp[16];
+      print_buffer_t report;
+      print_init(&report, temp, sizeof(temp));
+      printString(&report, "error:");
+      print_uint8_base10(&report, status_code);
+      report_util_line_feed(&report);
+      report_util_send(client, &report);
+    }
   }
 }
 
 // Prints alarm messages.
 void report_alarm_message(uint8_t alarm_code)
 {
-  grbl_sendf(CLIENT_ALL, "ALARM:%d\r\n", alarm_code);		// OK to send to all clients
+  PROFILE_SCOPE(PROFILE_REPORT);
+  char temp[16];
+  print_buffer_t report;
+  print_init(&report, temp, sizeof(temp));
+  printString(&report, "ALARM:");
+  print_uint8_base10(&report, alarm_code);
+  report_util_line_feed(&report);
+  report_util_send(CLIENT_ALL, &report); // OK to send to all clients
   delay_ms(500); // Force delay to ensure message clears serial write buffer.
 }
 
@@ -150,29 +176,31 @@ void report_alarm_message(uint8_t alarm_code)
 // is installed, the message number codes are less than zero.
 void report_feedback_message(uint8_t message_code)
 {
+  PROFILE_SCOPE(PROFILE_REPORT);
+  if (MSG_LEVEL_INFO > GRBL_MSG_LEVEL) { return; }
   switch(message_code) {
     case MESSAGE_CRITICAL_EVENT:
-      grbl_msg_sendf(CLIENT_SERIAL, MSG_LEVEL_INFO, "Reset to continue"); break;
+      report_util_feedback_line(CLIENT_SERIAL, "Reset to continue"); break;
     case MESSAGE_ALARM_LOCK:
-      grbl_msg_sendf(CLIENT_SERIAL, MSG_LEVEL_INFO, "'$H'|'$X' to unlock"); break;
+      report_util_feedback_line(CLIENT_SERIAL, "'$H'|'$X' to unlock"); break;
     case MESSAGE_ALARM_UNLOCK:
-      grbl_msg_sendf(CLIENT_SERIAL, MSG_LEVEL_INFO, "Caution: Unlocked"); break;
+      report_util_feedback_line(CLIENT_SERIAL, "Caution: Unlocked"); break;
     case MESSAGE_ENABLED:
-      grbl_msg_sendf(CLIENT_SERIAL, MSG_LEVEL_INFO, "Enabled"); break;
+      report_util_feedback_line(CLIENT_SERIAL, "Enabled"); break;
     case MESSAGE_DISABLED:
-      grbl_msg_sendf(CLIENT_SERIAL, MSG_LEVEL_INFO, "Disabled"); break;
+      report_util_feedback_line(CLIENT_SERIAL, "Disabled"); break;
     case MESSAGE_SAFETY_DOOR_AJAR:
-      grbl_msg_sendf(CLIENT_SERIAL, MSG_LEVEL_INFO, "Check door"); break;
+      report_util_feedback_line(CLIENT_SERIAL, "Check door"); break;
     case MESSAGE_CHECK_LIMITS:
-      grbl_msg_sendf(CLIENT_SERIAL, MSG_LEVEL_INFO, "Check limits"); break;
+      report_util_feedback_line(CLIENT_SERIAL, "Check limits"); break;
     case MESSAGE_PROGRAM_END:
-      grbl_msg_sendf(CLIENT_SERIAL, MSG_LEVEL_INFO, "Program End"); break;
+      report_util_feedback_line(CLIENT_SERIAL, "Program End"); break;
     case MESSAGE_RESTORE_DEFAULTS:
-      grbl_msg_sendf(CLIENT_SERIAL, MSG_LEVEL_INFO, "Restoring defaults"); break;
+      report_util_feedback_line(CLIENT_SERIAL, "Restoring defaults"); break;
     case MESSAGE_SPINDLE_RESTORE:
-      grbl_msg_sendf(CLIENT_SERIAL, MSG_LEVEL_INFO, "Restoring spindle");; break;
+      report_util_feedback_line(CLIENT_SERIAL, "Restoring spindle"); break;
     case MESSAGE_SLEEP_MODE:
-      grbl_msg_sendf(CLIENT_SERIAL, MSG_LEVEL_INFO, "Sleeping"); break;
+      report_util_feedback_line(CLIENT_SERIAL, "Sleeping"); break;
   }
 }
 
@@ -190,41 +218,42 @@ void report_grbl_help(uint8_t client) {
 // Grbl global settings print out.
 // NOTE: The numbering scheme here must correlate to storing in settings.c
 void report_grbl_settings(uint8_t client) {
+  PROFILE_SCOPE(PROFILE_REPORT);
   // Print Grbl settings.
-  char setting[20];
-  char report[1000];
-
-  report[0] = '\0';
-  sprintf(setting, "$0=%d\r\n", settings.pulse_microseconds); strcat(report, setting);
-  sprintf(setting, "$1=%d\r\n", settings.stepper_idle_lock_time);  strcat(report, setting);
-  sprintf(setting, "$2=%d\r\n", settings.step_invert_mask);  strcat(report, setting);
-  sprintf(setting, "$3=%d\r\n", settings.dir_invert_mask);  strcat(report, setting);
-  sprintf(setting, "$4=%d\r\n", bit_istrue(settings.flags,BITFLAG_INVERT_ST_ENABLE));  strcat(report, setting);
-  sprintf(setting, "$5=%d\r\n", bit_istrue(settings.flags,BITFLAG_INVERT_LIMIT_PINS));  strcat(report, setting);
-  sprintf(setting, "$6=%d\r\n", bit_istrue(settings.flags,BITFLAG_INVERT_PROBE_PIN));  strcat(report, setting);
-  sprintf(setting, "$10=%d\r\n", settings.status_report_mask);  strcat(report, setting);
-
-  sprintf(setting, "$11=%4.3f\r\n", settings.junction_deviation);   strcat(report, setting);
-  sprintf(setting, "$12=%4.3f\r\n", settings.arc_tolerance);   strcat(report, setting);
-
-  sprintf(setting, "$13=%d\r\n", bit_istrue(settings.flags,BITFLAG_REPORT_INCHES));   strcat(report, setting);
-  sprintf(setting, "$20=%d\r\n", bit_istrue(settings.flags,BITFLAG_SOFT_LIMIT_ENABLE));   strcat(report, setting);
-  sprintf(setting, "$21=%d\r\n", bit_istrue(settings.flags,BITFLAG_HARD_LIMIT_ENABLE));   strcat(report, setting);
-  sprintf(setting, "$22=%d\r\n", bit_istrue(settings.flags,BITFLAG_HOMING_ENABLE));   strcat(report, setting);
-  sprintf(setting, "$23=%d\r\n", settings.homing_dir_mask);   strcat(report, setting);
-
-  sprintf(setting, "$24=%4.3f\r\n", settings.homing_feed_rate);   strcat(report, setting);
-  sprintf(setting, "$25=%4.3f\r\n", settings.homing_seek_rate);   strcat(report, setting);
-  sprintf(setting, "$26=%d\r\n", settings.homing_debounce_delay);   strcat(report, setting);
-
-  sprintf(setting, "$27=%4.3f\r\n", settings.homing_pulloff);   strcat(report, setting);
-  sprintf(setting, "$30=%4.3f\r\n", settings.rpm_max);   strcat(report, setting);
-  sprintf(setting, "$31=%4.3f\r\n", settings.rpm_min);   strcat(report, setting);
+  char temp[1000];
+  print_buffer_t report;
+  print_init(&report, temp, sizeof(temp));
+
+  report_util_integer_setting(&report, 0, settings.pulse_microseconds);
+  report_util_integer_setting(&report, 1, settings.stepper_idle_lock_time);
+  report_util_integer_setting(&report, 2, settings.step_invert_mask);
+  report_util_integer_setting(&report, 3, settings.dir_invert_mask);
+  report_util_integer_setting(&report, 4, bit_istrue(settings.flags,BITFLAG_INVERT_ST_ENABLE));
+  report_util_integer_setting(&report, 5, bit_istrue(settings.flags,BITFLAG_INVERT_LIMIT_PINS));
+  report_util_integer_setting(&report, 6, bit_istrue(settings.flags,BITFLAG_INVERT_PROBE_PIN));
+  report_util_integer_setting(&report, 10, settings.status_report_mask);
+
+  report_util_float_setting(&report, 11, settings.junction_deviation);
+  report_util_float_setting(&report, 12, settings.arc_tolerance);
+
+  report_util_integer_setting(&report, 13, bit_istrue(settings.flags,BITFLAG_REPORT_INCHES));
+  report_util_integer_setting(&report, 20, bit_istrue(settings.flags,BITFLAG_SOFT_LIMIT_ENABLE));
+  report_util_integer_setting(&report, 21, bit_istrue(settings.flags,BITFLAG_HARD_LIMIT_ENABLE));
+  report_util_integer_setting(&report, 22, bit_istrue(settings.flags,BITFLAG_HOMING_ENABLE));
+  report_util_integer_setting(&report, 23, settings.homing_dir_mask);
+
+  report_util_float_setting(&report, 24, settings.homing_feed_rate);
+  report_util_float_setting(&report, 25, settings.homing_seek_rate);
+  report_util_integer_setting(&report, 26, settings.homing_debounce_delay);
+
+  report_util_float_setting(&report, 27, settings.homing_pulloff);
+  report_util_float_setting(&report, 30, settings.rpm_max);
+  report_util_float_setting(&report, 31, settings.rpm_min);
 
 #ifdef VARIABLE_SPINDLE
-  sprintf(setting, "$32=%d\r\n", bit_istrue(settings.flags,BITFLAG_LASER_MODE));  strcat(report, setting);
+  report_util_integer_setting(&report, 32, bit_istrue(settings.flags,BITFLAG_LASER_MODE));
 #else
-  strcat(report, "$32=0\r\n");
+  report_util_integer_setting(&report, 32, 0);
 #endif
 
   // Print axis settings
@@ -233,15 +262,15 @@ void report_grbl_settings(uint8_t client) {
   for (setting_index=0; setting_index<AXIS_N_SETTINGS; setting_index++) {
     for (index=0; index<N_AXIS; index++) {
       switch (setting_index) {
-        case 0: sprintf(setting, "$%d=%4.3f\r\n", value+index, settings.steps_per_mm[index]);   strcat(report, setting);	 break;
-        case 1: sprintf(setting, "$%d=%4.3f\r\n", value+index, settings.max_rate[index]);   strcat(report, setting);	 break;
-        case 2: sprintf(setting, "$%d=%4.3f\r\n", value+index, settings.acceleration[index]/(60*60));   strcat(report, setting);	 break;
-        case 3: sprintf(setting, "$%d=%4.3f\r\n", value+index, -settings.max_travel[index]);   strcat(report, setting);	 break;
+        case 0: report_util_float_setting(&report, value+index, settings.steps_per_mm[index]); break;
+        case 1: report_util_float_setting(&report, value+index, settings.max_rate[index]); break;
+        case 2: report_util_float_setting(&report, value+index, settings.acceleration[index]/(60*60)); break;
+        case 3: report_util_float_setting(&report, value+index, -settings.max_travel[index]); break;
       }
     }
     value += AXIS_SETTINGS_INCREMENT;
   }
-  grbl_send(client,report);
+  report_util_send(client, &report);
 }
 
 
@@ -250,69 +279,61 @@ void report_grbl_settings(uint8_t client) {
 // These values are retained until Grbl is power-cycled, whereby they will be re-zeroed.
 void report_probe_parameters(uint8_t client)
 {
+  PROFILE_SCOPE(PROFILE_REPORT);
   // Report in terms of machine position.
   float print_position[N_AXIS];
-  char probe_report[120];	// the probe report we are building here
-  char temp[60];
-
-  strcpy(probe_report, "[PRB:"); // initialize the string with the first characters
+  char temp[128];
+  print_buffer_t probe_report; // the probe report we are building here
+  print_init(&probe_report, temp, sizeof(temp));
 
-  // get the machine position and put them into a string and append to the probe report
+  printString(&probe_report, "[PRB:");
   system_convert_array_steps_to_mpos(print_position,sys_probe_position);
-  report_util_axis_values(print_position, temp);
-  strcat(probe_report, temp);
+  report_util_axis_values(&probe_report, print_position);
 
   // add the success indicator and add closing characters
-  sprintf(temp, ":%d]\r\n", sys.probe_succeeded);
-  strcat(probe_report, temp);
+  printChar(&probe_report, ':');
+  print_uint8_base10(&probe_report, sys.probe_succeeded);
+  printString(&probe_report, "]\r\n");
 
-  grbl_send(client, probe_report); // send the report
+  report_util_send(client, &probe_report); // send the report
 }
 
 // Prints Grbl NGC parameters (coordinate offsets, probing)
+// NOTE: Sent line by line, which keeps the report buffer small.
 void report_ngc_parameters(uint8_t client)
 {
+  PROFILE_SCOPE(PROFILE_REPORT);
   float coordinate_data[N_AXIS];
   uint8_t coordinate_select;
-  char temp[60];
-  char ngc_report[500];
-
-  ngc_report[0] = '\0';
+  char temp[128];
+  print_buffer_t ngc_report;
 
   for (coordinate_select = 0; coordinate_select <= SETTING_INDEX_NCOORD; coordinate_select++) {
     if (!(settings_read_coord_data(coordinate_select,coordinate_data))) {
       report_status_message(STATUS_SETTING_READ_FAIL, client);
       return;
     }
-	strcat(ngc_report, "[G");
+    print_init(&ngc_report, temp, sizeof(temp));
+    printString(&ngc_report, "[G");
     switch (coordinate_select) {
-      case 6: strcat(ngc_report, "28"); break;
-      case 7: strcat(ngc_report, "30"); break;
-      default:
-        sprintf(temp, "%d", coordinate_select+54);
-        strcat(ngc_report, temp);
-        break; // G54-G59
+      case 6: printString(&ngc_report, "28"); break;
+      case 7: printString(&ngc_report, "30"); break;
+      default: print_uint8_base10(&ngc_report, coordinate_select+54); break; // G54-G59
     }
-    strcat(ngc_report, ":");
-    report_util_axis_values(coordinate_data, temp);
-    strcat(ngc_report, temp);
-    strcat(ngc_report, "]\r\n");
-  }
-
-  strcat(ngc_report, "[G92:"); // Print G92,G92.1 which are not persistent in memory
-  report_util_axis_values(gc_state.coord_offset, temp);
-  strcat(ngc_report, temp);
-  strcat(ngc_report, "]\r\n");
-  strcat(ngc_report, "[TLO:"); // Print tool length offset value
-
-  if (bit_istrue(settings.flags,BITFLAG_REPORT_INCHES)) {
-    sprintf(temp, "%4.3f]\r\n", gc_state.tool_length_offset * INCH_PER_MM);
-  } else {
-    sprintf(temp, "%4.3f]\r\n", gc_state.tool_length_offset);
+    printChar(&ngc_report, ':');
+    report_util_axis_values(&ngc_report, coordinate_data);
+    printString(&ngc_report, "]\r\n");
+    report_util_send(client, &ngc_report);
   }
-  strcat(ngc_report, temp);
 
-  grbl_send(client, ngc_report);
+  print_init(&ngc_report, temp, sizeof(temp));
+  printString(&ngc_report, "[G92:"); // Print G92,G92.1 which are not persistent in memory
+  report_util_axis_values(&ngc_report, gc_state.coord_offset);
+  printString(&ngc_report, "]\r\n");
+  printString(&ngc_report, "[TLO:"); // Print tool length offset value
+  printFloat_CoordValue(&ngc_report, gc_state.tool_length_offset);
+  printString(&ngc_report, "]\r\n");
+  report_util_send(client, &ngc_report);
 
   report_probe_parameters(client);
 }
@@ -321,173 +342,190 @@ void report_ngc_parameters(uint8_t client)
 // Print current gcode parser mode state
 void report_gcode_modes(uint8_t client)
 {
-  char temp[20];
-  char modes_report[75];
-
-  strcpy(modes_report, "[GC:G");
+  PROFILE_SCOPE(PROFILE_REPORT);
+  char temp[96];
+  print_buffer_t modes_report;
+  print_init(&modes_report, temp, sizeof(temp));
 
+  printString(&modes_report, "[GC:G");
   if (gc_state.modal.motion >= MOTION_MODE_PROBE_TOWARD) {
-    sprintf(temp, "38.%d", gc_state.modal.motion - (MOTION_MODE_PROBE_TOWARD-2));
+    printString(&modes_report, "38.");
+    print_uint8_base10(&modes_report, gc_state.modal.motion - (MOTION_MODE_PROBE_TOWARD-2));
   } else {
-    sprintf(temp, "%d", gc_state.modal.motion);
+    print_uint8_base10(&modes_report, gc_state.modal.motion);
   }
-  strcat(modes_report, temp);
 
-  sprintf(temp, " G%d", gc_state.modal.coord_select+54);
-  strcat(modes_report, temp);
+  printString(&modes_report, " G");
+  print_uint8_base10(&modes_report, gc_state.modal.coord_select+54);
+
+  printString(&modes_report, " G");
+  print_uint8_base10(&modes_report, gc_state.modal.plane_select+17);
 
-  sprintf(temp, " G%d", gc_state.modal.plane_select+17);
-  strcat(modes_report, temp);
+  printString(&modes_report, " G");
+  print_uint8_base10(&modes_report, 21-gc_state.modal.units);
 
-  sprintf(temp, " G%d", 21-gc_state.modal.units);
-  strcat(modes_report, temp);
+  printString(&modes_report, " G");
+  print_uint8_base10(&modes_report, gc_state.modal.distance+90);
 
-  sprintf(temp, " G%d", gc_state.modal.distance+90);
-  strcat(modes_report, temp);
+  printString(&modes_report, " G");
+  print_uint8_base10(&modes_report, 94-gc_state.modal.feed_rate);
 
-  sprintf(temp, " G%d", 94-gc_state.modal.feed_rate);
-  strcat(modes_report, temp);
+  #ifdef ENABLE_CANNED_CYCLES
+    printString(&modes_report, " G");
+    print_uint8_base10(&modes_report, gc_state.modal.retract+98);
+  #endif
 
   if (gc_state.modal.program_flow) {
     switch (gc_state.modal.program_flow) {
-      case PROGRAM_FLOW_PAUSED: strcat(modes_report, " M0"); break;
+      case PROGRAM_FLOW_PAUSED: printString(&modes_report, " M0"); break;
       // case PROGRAM_FLOW_OPTIONAL_STOP: serial_write('1'); break; // M1 is ignored and not supported.
       case PROGRAM_FLOW_COMPLETED_M2:
       case PROGRAM_FLOW_COMPLETED_M30:
-        sprintf(temp, " M%d", gc_state.modal.program_flow);
-        strcat(modes_report, temp);
+        printString(&modes_report, " M");
+        print_uint8_base10(&modes_report, gc_state.modal.program_flow);
         break;
     }
   }
 
   switch (gc_state.modal.spindle) {
-    case SPINDLE_ENABLE_CW : strcat(modes_report, " M3"); break;
-    case SPINDLE_ENABLE_CCW : strcat(modes_report, " M4"); break;
-    case SPINDLE_DISABLE : strcat(modes_report, " M5"); break;
+    case SPINDLE_ENABLE_CW : printString(&modes_report, " M3"); break;
+    case SPINDLE_ENABLE_CCW : printString(&modes_report, " M4"); break;
+    case SPINDLE_DISABLE : printString(&modes_report, " M5"); break;
   }
 
 #ifdef ENABLE_M7
   //report_util_gcode_modes_M();  // optional M7 and M8 should have been dealt with by here
   if (gc_state.modal.coolant) { // Note: Multiple coolant states may be active at the same time.
-    if (gc_state.modal.coolant & PL_COND_FLAG_COOLANT_MIST) { strcat(modes_report, " M7"); }
-    if (gc_state.modal.coolant & PL_COND_FLAG_COOLANT_FLOOD) { strcat(modes_report, " M8"); }
-  } else { strcat(modes_report, " M9"); }
+    if (gc_state.modal.coolant & PL_COND_FLAG_COOLANT_MIST) { printString(&modes_report, " M7"); }
+    if (gc_state.modal.coolant & PL_COND_FLAG_COOLANT_FLOOD) { printString(&modes_report, " M8"); }
+  } else { printString(&modes_report, " M9"); }
 #else
   if (gc_state.modal.coolant) {
-    strcat(modes_report, " M8");
+    printString(&modes_report, " M8");
   } else {
-    strcat(modes_report, " M9");
+    printString(&modes_report, " M9");
   }
 #endif
 
   #ifdef ENABLE_PARKING_OVERRIDE_CONTROL
     if (sys.override_ctrl == OVERRIDE_PARKING_MOTION) {
-      strcat(modes_report, " M56");
+      printString(&modes_report, " M56");
     }
   #endif
 
-  sprintf(temp, " T%d", gc_state.tool);
-  strcat(modes_report, temp);
+  printString(&modes_report, " T");
+  print_uint8_base10(&modes_report, gc_state.tool);
 
-  if (bit_istrue(settings.flags,BITFLAG_REPORT_INCHES)) {
-    sprintf(temp, " F%.1f", gc_state.feed_rate);
-  } else {
-    sprintf(temp, " F%.0f", gc_state.feed_rate);
-  }
-  strcat(modes_report, temp);
+  printString(&modes_report, " F");
+  printFloat_RateValue(&modes_report, gc_state.feed_rate);
 
 #ifdef VARIABLE_SPINDLE
-  sprintf(temp, " S%4.3f", gc_state.spindle_speed);
-  strcat(modes_report, temp);
+  printString(&modes_report, " S");
+  printFloat(&modes_report, gc_state.spindle_speed, N_DECIMAL_SETTINGVALUE);
 #endif
 
-  strcat(modes_report, "]\r\n");
+  printString(&modes_report, "]\r\n");
 
-  grbl_send(client, modes_report);
+  report_util_send(client, &modes_report);
 }
 
 
 // Prints specified startup line
 void report_startup_line(uint8_t n, char *line, uint8_t client)
 {
-	grbl_sendf(client, "$N%d=%s\r\n", n, line);	// OK to send to all
+  PROFILE_SCOPE(PROFILE_REPORT);
+  char temp[LINE_BUFFER_SIZE+16];
+  print_buffer_t report;
+  print_init(&report, temp, sizeof(temp));
+  printString(&report, "$N");
+  print_uint8_base10(&report, n);
+  printChar(&report, '=');
+  printString(&report, line);
+  report_util_line_feed(&report);
+  report_util_send(client, &report); // OK to send to all
 }
 
 void report_execute_startup_message(char *line, uint8_t status_code, uint8_t client)
 {
-  grbl_sendf(client, ">%s:", line);  // OK to send to all
+  PROFILE_SCOPE(PROFILE_REPORT);
+  char temp[LINE_BUFFER_SIZE+8];
+  print_buffer_t report;
+  print_init(&report, temp, sizeof(temp));
+  printChar(&report, '>');
+  printString(&report, line);
+  printChar(&report, ':');
+  report_util_send(client, &report); // OK to send to all
   report_status_message(status_code, client);
 }
 
 // Prints build info line
 void report_build_info(char *line, uint8 client)
 {
-  char build_info[50];
+  PROFILE_SCOPE(PROFILE_REPORT);
+  char temp[LINE_BUFFER_SIZE+64];
+  print_buffer_t build_info;
+  print_init(&build_info, temp, sizeof(temp));
 
-  strcpy(build_info, "[VER:" GRBL_VERSION "." GRBL_VERSION_BUILD ":");
-  strcat(build_info, line);
-  strcat(build_info, "]\r\n[OPT:");
+  printString(&build_info, "[VER:" GRBL_VERSION "." GRBL_VERSION_BUILD ":");
+  printString(&build_info, line);
+  printString(&build_info, "]\r\n[OPT:");
 
   #ifdef VARIABLE_SPINDLE
-    strcat(build_info,"V");
+    printChar(&build_info,'V');
   #endif
   #ifdef USE_LINE_NUMBERS
-    strcat(build_info,"N");
+    printChar(&build_info,'N');
   #endif
   #ifdef COOLANT_MIST_PIN
-    strcat(build_info,"M"); // TODO Need to deal with M8...it could be disabled
+    printChar(&build_info,'M'); // TODO Need to deal with M8...it could be disabled
   #endif
   #ifdef COREXY
-    strcat(build_info,"C");
+    printChar(&build_info,'C');
   #endif
   #ifdef PARKING_ENABLE
-    strcat(build_info,"P");
+    printChar(&build_info,'P');
   #endif
   #if (defined(HOMING_FORCE_SET_ORIGIN) || defined(HOMING_FORCE_POSITIVE_SPACE))
-    strcat(build_info,"Z"); // homing MPOS bahavior is not the default behavior
+    printChar(&build_info,'Z'); // homing MPOS bahavior is not the default behavior
   #endif
   #ifdef HOMING_SINGLE_AXIS_COMMANDS
-    strcat(build_info,"H");
+    printChar(&build_info,'H');
   #endif
   #ifdef LIMITS_TWO_SWITCHES_ON_AXES
-    strcat(build_info,"L");
+    printChar(&build_info,'L');
   #endif
   #ifdef ALLOW_FEED_OVERRIDE_DURING_PROBE_CYCLES
-    strcat(build_info,"A");
+    printChar(&build_info,'A');
   #endif
   #if defined (ENABLE_WIFI)
-    strcat(build_info,"W");
+    printChar(&build_info,'W');
   #endif
   #ifndef ENABLE_RESTORE_EEPROM_WIPE_ALL // NOTE: Shown when disabled.
-    strcat(build_info,"*");
+    printChar(&build_info,'*');
   #endif
   #ifndef ENABLE_RESTORE_EEPROM_DEFAULT_SETTINGS // NOTE: Shown when disabled.
-    strcat(build_info,"$");
+    printChar(&build_info,'$');
   #endif
   #ifndef ENABLE_RESTORE_EEPROM_CLEAR_PARAMETERS // NOTE: Shown when disabled.
-    strcat(build_info,"#");
+    printChar(&build_info,'#');
   #endif
   #ifndef ENABLE_BUILD_INFO_WRITE_COMMAND // NOTE: Shown when disabled.
-    strcat(build_info,"I");
+    printChar(&build_info,'I');
   #endif
   #ifndef FORCE_BUFFER_SYNC_DURING_EEPROM_WRITE // NOTE: Shown when disabled.
-    strcat(build_info,"E");
+    printChar(&build_info,'E');
   #endif
   #ifndef FORCE_BUFFER_SYNC_DURING_WCO_CHANGE // NOTE: Shown when disabled.
-    strcat(build_info,"W");
+    printChar(&build_info,'W');
   #endif
   // NOTE: Compiled values, like override increments/max/min values, may be added at some point later.
   // These will likely have a comma delimiter to separate them.
 
-  strcat(build_info,"]\r\n");
-  grbl_send(client, build_info); // ok to send to all
+  printString(&build_info,"]\r\n");
+  report_util_send(client, &build_info); // ok to send to all
   #if defined (ENABLE_WIFI)
     grbl_send(client, (char *)wifi_config.info());
   #endif
-
-  #ifdef LIMITS_TWO_SWITCHES_ON_AXES
-    strcat(build_info,"L");
-  #endif
 }
 
 
@@ -495,7 +533,14 @@ void report_build_info(char *line, uint8 client)
 // and has been sent into protocol_execute_line() routine to be executed by Grbl.
 void report_echo_line_received(char *line, uint8_t client)
 {
-	grbl_sendf(client, "[echo: %s]\r\n", line);
+  PROFILE_SCOPE(PROFILE_REPORT);
+  char temp[LINE_BUFFER_SIZE+16];
+  print_buffer_t report;
+  print_init(&report, temp, sizeof(temp));
+  printString(&report, "[echo: ");
+  printString(&report, line);
+  printString(&report, "]\r\n");
+  report_util_send(client, &report);
 }
 
 
@@ -506,48 +551,60 @@ void report_echo_line_received(char *line, uint8_t client)
  // especially during g-code programs with fast, short line segments and high frequency reports (5-20Hz).
 void report_realtime_status(uint8_t client)
 {
+  report_realtime_status_clients(bit((client-1)));
+}
+
+
+// Builds the status report once for all requesting clients. Only the serial read buffer state
+// differs per client, so it is spliced into the report for each client on sending.
+void report_realtime_status_clients(uint8_t client_mask)
+{
+  PROFILE_SCOPE(PROFILE_REPORT);
   uint8_t index;
   int32_t current_position[N_AXIS]; // Copy current state of the system position variable
   memcpy(current_position,sys_position,sizeof(sys_position));
   float print_position[N_AXIS];
-  char status[200];
-  char temp[80];
+  char status_data[320];
+  char fields_data[240];
+  print_buffer_t status;
+  print_buffer_t fields; // Fields following the per-client buffer state.
 
   system_convert_array_steps_to_mpos(print_position,current_position);
 
   // Report current machine state and sub-states
-  strcpy(status, "<");
+  print_init(&status, status_data, sizeof(status_data));
+  printChar(&status, '<');
   switch (sys.state) {
-    case STATE_IDLE: strcat(status, "Idle"); break;
-    case STATE_CYCLE: strcat(status, "Run"); break;
+    case STATE_IDLE: printString(&status, "Idle"); break;
+    case STATE_CYCLE: printString(&status, "Run"); break;
     case STATE_HOLD:
       if (!(sys.suspend & SUSPEND_JOG_CANCEL)) {
-        strcat(status, "Hold:");
-        if (sys.suspend & SUSPEND_HOLD_COMPLETE) { strcat(status, "0"); } // Ready to resume
-        else { strcat(status, "1"); } // Actively holding
+        printString(&status, "Hold:");
+        if (sys.suspend & SUSPEND_HOLD_COMPLETE) { printChar(&status, '0'); } // Ready to resume
+        else { printChar(&status, '1'); } // Actively holding
         break;
       } // Continues to print jog state during jog cancel.
-    case STATE_JOG: strcat(status, "Jog"); break;
-    case STATE_HOMING: strcat(status, "Home"); break;
-    case STATE_ALARM: strcat(status, "Alarm"); break;
-    case STATE_CHECK_MODE: strcat(status, "Check"); break;
+    case STATE_JOG: printString(&status, "Jog"); break;
+    case STATE_HOMING: printString(&status, "Home"); break;
+    case STATE_ALARM: printString(&status, "Alarm"); break;
+    case STATE_CHECK_MODE: printString(&status, "Check"); break;
     case STATE_SAFETY_DOOR:
-      strcat(status, "Door:");
+      printString(&status, "Door:");
       if (sys.suspend & SUSPEND_INITIATE_RESTORE) {
-        strcat(status, "3"); // Restoring
+        printChar(&status, '3'); // Restoring
       } else {
         if (sys.suspend & SUSPEND_RETRACT_COMPLETE) {
           if (sys.suspend & SUSPEND_SAFETY_DOOR_AJAR) {
-            strcat(status, "1"); // Door ajar
+            printChar(&status, '1'); // Door ajar
           } else {
-            strcat(status, "0");
+            printChar(&status, '0');
           } // Door closed and ready to resume
         } else {
-          strcat(status, "2"); // Retracting
+          printChar(&status, '2'); // Retracting
         }
       }
       break;
-    case STATE_SLEEP: strcat(status, "Sleep"); break;
+    case STATE_SLEEP: printString(&status, "Sleep"); break;
   }
 
   float work_coordinate_offsets[N_AXIS];
@@ -564,34 +621,27 @@ void report_realtime_status(uint8_t client)
   }
   // Report machine position
   if (bit_istrue(settings.status_report_mask,BITFLAG_RT_STATUS_POSITION_TYPE)) {
-    strcat(status, "|MPos:");
+    printString(&status, "|MPos:");
   } else {
 	#ifdef FWD_KINEMATICS_REPORTING
 		forward_kinematics(print_position);
 	#endif
-    strcat(status, "|WPos:");
-  }
-  report_util_axis_values(print_position, temp);
-  strcat(status, temp);
-
-  // Returns planner and serial read buffer states.
-  #ifdef REPORT_FIELD_BUFFER_STATE
-  if (bit_istrue(settings.status_report_mask,BITFLAG_RT_STATUS_BUFFER_STATE)) {
-    int buffer_size = serial_get_rx_buffer_available(client);
-    sprintf(temp, "|Bf:%d,%d", plan_get_block_buffer_available(), buffer_size);
-    strcat(status, temp);
+    printString(&status, "|WPos:");
   }
-  #endif
+  report_util_axis_values(&status, print_position);
+
+  // Planner and serial read buffer states are inserted here for each client below.
+  print_init(&fields, fields_data, sizeof(fields_data));
 
   #ifdef USE_LINE_NUMBERS
     #ifdef REPORT_FIELD_LINE_NUMBERS
       // Report current line number
       plan_block_t * current_block = plan_get_current_block();
       if (current_block != NULL) {
-        uint32_t line_number = current_block->line_number;
+        int32_t line_number = current_block->line_number;
         if (line_number > 0) {
-					sprintf(temp, "|Ln:%d", line_number);
-					strcat(status, temp);
+          printString(&fields, "|Ln:");
+          printInteger(&fields, line_number);
         }
       }
     #endif
@@ -600,19 +650,13 @@ void report_realtime_status(uint8_t client)
   // Report realtime feed speed
   #ifdef REPORT_FIELD_CURRENT_FEED_SPEED
     #ifdef VARIABLE_SPINDLE
-      if (bit_istrue(settings.flags,BITFLAG_REPORT_INCHES)) {
-        sprintf(temp, "|FS:%.1f,%.0f", st_get_realtime_rate(), sys.spindle_speed / MM_PER_INCH);
-      } else {
-        sprintf(temp, "|FS:%.0f,%.0f", st_get_realtime_rate(), sys.spindle_speed);
-      }
-      strcat(status, temp);
+      printString(&fields, "|FS:");
+      printFloat_RateValue(&fields, st_get_realtime_rate());
+      printChar(&fields, ',');
+      printFloat(&fields, sys.spindle_speed, N_DECIMAL_RPMVALUE);
     #else
-      if (bit_istrue(settings.flags,BITFLAG_REPORT_INCHES)) {
-        sprintf(temp, "|F:%.1f", st_get_realtime_rate() / MM_PER_INCH);
-      } else {
-        sprintf(temp, "|F:%.0f", st_get_realtime_rate());
-      }
-      strcat(status, temp);
+      printString(&fields, "|F:");
+      printFloat_RateValue(&fields, st_get_realtime_rate());
     #endif
   #endif
 
@@ -621,25 +665,25 @@ void report_realtime_status(uint8_t client)
     uint8_t control_pin_state = system_control_get_state();
     uint8_t probe_pin_state = probe_get_state();
     if (limit_pin_state | control_pin_state | probe_pin_state) {
-      strcat(status, "|Pn:");
-      if (probe_pin_state) { strcat(status, "P"); }
+      printString(&fields, "|Pn:");
+      if (probe_pin_state) { printChar(&fields, 'P'); }
       if (limit_pin_state) {
-        if (bit_istrue(limit_pin_state,bit(X_AXIS))) { strcat(status, "X"); }
-        if (bit_istrue(limit_pin_state,bit(Y_AXIS))) { strcat(status, "Y"); }
-        if (bit_istrue(limit_pin_state,bit(Z_AXIS))) { strcat(status, "Z"); }
-        if (bit_istrue(limit_pin_state,bit(A_AXIS))) { strcat(status, "A"); }
-        if (bit_istrue(limit_pin_state,bit(B_AXIS))) { strcat(status, "B"); }
-        if (bit_istrue(limit_pin_state,bit(C_AXIS))) { strcat(status, "C"); }
-        if (bit_istrue(limit_pin_state,bit(D_AXIS))) { strcat(status, "D"); }
-        if (bit_istrue(limit_pin_state,bit(E_AXIS))) { strcat(status, "E"); }
+        if (bit_istrue(limit_pin_state,bit(X_AXIS))) { printChar(&fields, 'X'); }
+        if (bit_istrue(limit_pin_state,bit(Y_AXIS))) { printChar(&fields, 'Y'); }
+        if (bit_istrue(limit_pin_state,bit(Z_AXIS))) { printChar(&fields, 'Z'); }
+        if (bit_istrue(limit_pin_state,bit(A_AXIS))) { printChar(&fields, 'A'); }
+        if (bit_istrue(limit_pin_state,bit(B_AXIS))) { printChar(&fields, 'B'); }
+        if (bit_istrue(limit_pin_state,bit(C_AXIS))) { printChar(&fields, 'C'); }
+        if (bit_istrue(limit_pin_state,bit(D_AXIS))) { printChar(&fields, 'D'); }
+        if (bit_istrue(limit_pin_state,bit(E_AXIS))) { printChar(&fields, 'E'); }
       }
       if (control_pin_state) {
         #ifdef ENABLE_SAFETY_DOOR_INPUT_PIN
-          if (bit_istrue(control_pin_state,CONTROL_PIN_INDEX_SAFETY_DOOR)) { strcat(status, "D"); }
+          if (bit_istrue(control_pin_state,CONTROL_PIN_INDEX_SAFETY_DOOR)) { printChar(&fields, 'D'); }
         #endif
-        if (bit_istrue(control_pin_state,CONTROL_PIN_INDEX_RESET)) { strcat(status, "R"); }
-        if (bit_istrue(control_pin_state,CONTROL_PIN_INDEX_FEED_HOLD)) { strcat(status, "H"); }
-        if (bit_istrue(control_pin_state,CONTROL_PIN_INDEX_CYCLE_START)) { strcat(status, "S"); }
+        if (bit_istrue(control_pin_state,CONTROL_PIN_INDEX_RESET)) { printChar(&fields, 'R'); }
+        if (bit_istrue(control_pin_state,CONTROL_PIN_INDEX_FEED_HOLD)) { printChar(&fields, 'H'); }
+        if (bit_istrue(control_pin_state,CONTROL_PIN_INDEX_CYCLE_START)) { printChar(&fields, 'S'); }
       }
     }
   #endif
@@ -651,9 +695,8 @@ void report_realtime_status(uint8_t client)
         sys.report_wco_counter = (REPORT_WCO_REFRESH_BUSY_COUNT-1); // Reset counter for slow refresh
       } else { sys.report_wco_counter = (REPORT_WCO_REFRESH_IDLE_COUNT-1); }
       if (sys.report_ovr_counter == 0) { sys.report_ovr_counter = 1; } // Set override on next report.
-      strcat(status, "|WCO:");
-      report_util_axis_values(work_coordinate_offsets, temp);
-	  strcat(status, temp);
+      printString(&fields, "|WCO:");
+      report_util_axis_values(&fields, work_coordinate_offsets);
     }
   #endif
 
@@ -663,29 +706,109 @@ void report_realtime_status(uint8_t client)
       if (sys.state & (STATE_HOMING | STATE_CYCLE | STATE_HOLD | STATE_JOG | STATE_SAFETY_DOOR)) {
         sys.report_ovr_counter = (REPORT_OVR_REFRESH_BUSY_COUNT-1); // Reset counter for slow refresh
       } else { sys.report_ovr_counter = (REPORT_OVR_REFRESH_IDLE_COUNT-1); }
-      sprintf(temp, "|Ov:%d,%d,%d", sys.f_override, sys.r_override, sys.spindle_speed_ovr);
-      strcat(status, temp);
+      printString(&fields, "|Ov:");
+      print_uint8_base10(&fields, sys.f_override);
+      printChar(&fields, ',');
+      print_uint8_base10(&fields, sys.r_override);
+      printChar(&fields, ',');
+      print_uint8_base10(&fields, sys.spindle_speed_ovr);
 
       uint8_t spindle_state = spindle_get_state();
       uint8_t coolant_state = coolant_get_state();
       if (spindle_state || coolant_state) {
-        strcat(status, "|A:");
+        printString(&fields, "|A:");
         if (spindle_state) { // != SPINDLE_STATE_DISABLE
-          if (spindle_state == SPINDLE_STATE_CW) { strcat(status, "S"); } // CW
-          else { strcat(status, "C"); } // CCW
+          if (spindle_state == SPINDLE_STATE_CW) { printChar(&fields, 'S'); } // CW
+          else { printChar(&fields, 'C'); } // CCW
         }
-        if (coolant_state & COOLANT_STATE_FLOOD) { strcat(status, "F"); }
+        if (coolant_state & COOLANT_STATE_FLOOD) { printChar(&fields, 'F'); }
         #ifdef COOLANT_MIST_PIN // TODO Deal with M8 - Flood
-          if (coolant_state & COOLANT_STATE_MIST) { strcat(status, "M"); }
+          if (coolant_state & COOLANT_STATE_MIST) { printChar(&fields, 'M'); }
         #endif
       }
     }
   #endif
 
-  strcat(status, ">\r\n");
-  grbl_send(client, status);
+  #ifdef ENABLE_JOB_STORAGE
+    job_report_progress(&fields);
+  #endif
+
+  printString(&fields, ">\r\n");
+
+  uint16_t buffer_state_index = status.length;
+  for (uint8_t client = 1; client <= CLIENT_COUNT; client++) {
+    if (!(client_mask & bit((client-1)))) { continue; }
+    print_truncate(&status, buffer_state_index);
+    // Returns planner and serial read buffer states.
+    #ifdef REPORT_FIELD_BUFFER_STATE
+      if (bit_istrue(settings.status_report_mask,BITFLAG_RT_STATUS_BUFFER_STATE)) {
+        printString(&status, "|Bf:");
+        print_uint8_base10(&status, plan_get_block_buffer_available());
+        printChar(&status, ',');
+        print_uint32_base10(&status, serial_get_rx_buffer_available(client));
+      }
+    #endif
+    printString(&status, fields.data);
+    report_util_send(client, &status);
+  }
 }
 
+
+#ifdef ENABLE_AUTO_STATUS_REPORT
+  static uint16_t report_auto_interval[CLIENT_COUNT]; // In ms, or an AUTO_STATUS_REPORT_ define.
+  static uint32_t report_auto_next[CLIENT_COUNT];     // millis() time of the next periodic report.
+  static uint8_t report_auto_subscribed;              // Bitmask of subscribed clients.
+  static uint8_t report_auto_last_state;
+  static uint8_t report_auto_last_suspend;
+
+  void report_auto_status_subscribe(uint8_t client, uint16_t interval)
+  {
+    uint8_t client_idx = client-1;
+    if (interval == AUTO_STATUS_REPORT_OFF) {
+      report_auto_subscribed &= ~bit(client_idx);
+    } else {
+      if (interval < AUTO_STATUS_REPORT_MIN_INTERVAL) { interval = AUTO_STATUS_REPORT_MIN_INTERVAL; }
+      report_auto_subscribed |= bit(client_idx);
+      report_auto_last_state = 0xFF; // Not a valid state. Forces a first report right away.
+    }
+    report_auto_interval[client_idx] = interval;
+  }
+
+
+  void report_auto_status_interval(uint8_t client)
+  {
+    char temp[16];
+    print_buffer_t report;
+    print_init(&report, temp, sizeof(temp));
+    printString(&report, "[RI:");
+    if (report_auto_interval[client-1] == AUTO_STATUS_REPORT_ON_CHANGE) { printChar(&report, 'C'); }
+    else { print_uint32_base10(&report, report_auto_interval[client-1]); }
+    printString(&report, "]\r\n");
+    report_util_send(client, &report);
+  }
+
+
+  uint8_t report_auto_status_clients()
+  {
+    if (!report_auto_subscribed) { return(0); }
+    uint8_t client_mask = 0;
+    uint8_t state_changed = (sys.state != report_auto_last_state) || (sys.suspend != report_auto_last_suspend);
+    report_auto_last_state = sys.state;
+    report_auto_last_suspend = sys.suspend;
+    uint32_t now = millis();
+    for (uint8_t idx = 0; idx < CLIENT_COUNT; idx++) {
+      if (!(report_auto_subscribed & bit(idx))) { continue; }
+      if (report_auto_interval[idx] == AUTO_STATUS_REPORT_ON_CHANGE) {
+        if (state_changed) { client_mask |= bit(idx); }
+      } else if (state_changed || ((int32_t)(now - report_auto_next[idx]) >= 0)) {
+        report_auto_next[idx] = now + report_auto_interval[idx]; // Also restarts the interval upon a change.
+        client_mask |= bit(idx);
+      }
+    }
+    return(client_mask);
+  }
+#endif
+
 #ifdef DEBUG
   void report_realtime_debug()
   {
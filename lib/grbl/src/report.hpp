@@ -60,6 +60,14 @@
 #define STATUS_GCODE_G43_DYNAMIC_AXIS_ERROR 37
 #define STATUS_GCODE_MAX_VALUE_EXCEEDED 38
 
+#define STATUS_BINARY_FRAME_CHECKSUM 40
+#define STATUS_BINARY_FRAME_INVALID 41
+
+#define STATUS_JOB_FILE 42
+#define STATUS_JOB_ACTIVE 43
+#define STATUS_JOB_RESUME 44
+#define STATUS_JOB_OCODE 45
+
 // Define Grbl alarm codes. Valid values (1-255). 0 is reserved.
 #define ALARM_HARD_LIMIT_ERROR      EXEC_ALARM_HARD_LIMIT
 #define ALARM_SOFT_LIMIT_ERROR      EXEC_ALARM_SOFT_LIMIT
@@ -98,7 +106,12 @@
 
 // functions to send data to the user (from Grbl_Esp32)
 void grbl_send(uint8_t client, const char *text);
+void grbl_write(uint8_t client, const char *text, size_t length);
 void grbl_sendf(uint8_t client, const char *format, ...);
+void grbl_msg_sendf(uint8_t client, uint8_t level, const char *format, ...);
+
+// Size of the stack buffer used to format grbl_sendf() messages. Longer messages are truncated.
+#define GRBL_SENDF_BUFFER_SIZE 128
 
 // Prints system status messages.
 void report_status_message(uint8_t status_code, uint8_t client);
@@ -124,6 +137,24 @@ void report_echo_line_received(char *line, uint8_t client);
 // Prints realtime status report
 void report_realtime_status(uint8_t client);
 
+// Builds one realtime status report and sends it to every client set in the client_mask bitmask,
+// where client n is bit(n-1).
+void report_realtime_status_clients(uint8_t client_mask);
+
+#ifdef ENABLE_AUTO_STATUS_REPORT
+  #define AUTO_STATUS_REPORT_OFF       0
+  #define AUTO_STATUS_REPORT_ON_CHANGE 0xFFFF // Interval value for state change reports only.
+
+  // Sets the auto status report interval of a client in milliseconds. Also takes the defines above.
+  void report_auto_status_subscribe(uint8_t client, uint16_t interval);
+
+  // Prints the auto status report interval of a client.
+  void report_auto_status_interval(uint8_t client);
+
+  // Returns the bitmask of subscribed clients, which are due for a status report.
+  uint8_t report_auto_status_clients();
+#endif
+
 // Prints recorded probe position
 void report_probe_parameters(uint8_t client);
 
@@ -0,0 +1,138 @@
+/*
+  ring_buffer.hpp - lock-free single producer, single consumer ring buffer
+  Part of Grbl
+
+  Grbl is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Grbl is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Grbl.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef ring_buffer_h
+#define ring_buffer_h
+
+#include <stdint.h>
+#include <string.h>
+
+// Orders memory accesses around the publishing of a buffer index. On the single core ESP8266 the
+// producer and consumer are an interrupt and the main program, so the memw instruction, which
+// also stops the compiler from reordering, is enough. Elsewhere, fall back to a full fence.
+#ifdef __XTENSA__
+  #define RING_BUFFER_BARRIER() __asm__ __volatile__ ("memw" ::: "memory")
+#else
+  #define RING_BUFFER_BARRIER() __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#endif
+
+// Keeps the methods inlined into interrupt handlers placed in IRAM.
+#define RING_BUFFER_INLINE inline __attribute__((always_inline))
+
+/*
+  Fixed size ring buffer shared by exactly one producer and one consumer, which may run in
+  different contexts, e.g. an interrupt and the main program. No locking is needed, since the
+  head index is only written by the producer and the tail index only by the consumer.
+
+  - head: Slot the producer fills next. Empty, if equal to tail.
+  - tail: Slot the consumer reads next.
+  - One slot always stays unused to tell a full buffer from an empty one, so the buffer holds
+    at most SIZE-1 items. SIZE must be a power of two, which turns index wrapping into a mask.
+
+  Items may be accessed in place. The producer fills write_slot() and then publishes it with
+  commit(). The consumer uses read_slot() for as long as it needs to, then releases it with pop().
+  The planner also walks its queued blocks by index with next(), prev() and operator[]. This is
+  only safe in the context owning the buffer, or for items already published and not yet popped.
+*/
+template <typename T, uint16_t SIZE>
+class RingBuffer {
+  static_assert((SIZE >= 2) && ((SIZE & (SIZE-1)) == 0), "Ring buffer size must be a power of two.");
+
+  public:
+  static const uint16_t CAPACITY = SIZE-1;
+
+  // Empties the buffer. Not safe while the producer or consumer is active.
+  RING_BUFFER_INLINE void reset() { _head = 0; _tail = 0; }
+
+  static RING_BUFFER_INLINE uint16_t next(uint16_t index) { return((index+1) & (SIZE-1)); }
+  static RING_BUFFER_INLINE uint16_t prev(uint16_t index) { return((index-1) & (SIZE-1)); }
+
+  RING_BUFFER_INLINE uint16_t head() const { return(_head); }
+  RING_BUFFER_INLINE uint16_t tail() const { return(_tail); }
+  RING_BUFFER_INLINE T &operator[](uint16_t index) { return(_buffer[index]); }
+
+  RING_BUFFER_INLINE bool empty() const { return(_head == _tail); }
+  RING_BUFFER_INLINE bool full() const { return(next(_head) == _tail); }
+  RING_BUFFER_INLINE uint16_t count() const { return((_head-_tail) & (SIZE-1)); }
+  RING_BUFFER_INLINE uint16_t available() const { return(CAPACITY-count()); }
+
+  // Producer side.
+  RING_BUFFER_INLINE T *write_slot()
+  {
+    RING_BUFFER_BARRIER(); // Slot must be released by the consumer before it is overwritten.
+    return(&_buffer[_head]);
+  }
+  RING_BUFFER_INLINE void commit()
+  {
+    RING_BUFFER_BARRIER(); // Slot contents must be visible before the new head.
+    _head = next(_head);
+  }
+  RING_BUFFER_INLINE bool push(const T &item)
+  {
+    if (full()) { return(false); }
+    *write_slot() = item;
+    commit();
+    return(true);
+  }
+  // Pushes all items or none of them, so a consumer never sees a partial message.
+  RING_BUFFER_INLINE bool push(const T *items, uint16_t item_count)
+  {
+    if (item_count > available()) { return(false); }
+    RING_BUFFER_BARRIER();
+    uint16_t head = _head;
+    uint16_t first = SIZE-head; // Items until the end of the storage array.
+    if (first > item_count) { first = item_count; }
+    memcpy(&_buffer[head], items, first*sizeof(T));
+    memcpy(&_buffer[0], items+first, (item_count-first)*sizeof(T));
+    RING_BUFFER_BARRIER();
+    _head = (head+item_count) & (SIZE-1);
+    return(true);
+  }
+
+  // Consumer side.
+  RING_BUFFER_INLINE T *read_slot()
+  {
+    RING_BUFFER_BARRIER(); // Read the slot contents only after seeing the new head.
+    return(&_buffer[_tail]);
+  }
+  RING_BUFFER_INLINE void pop()
+  {
+    RING_BUFFER_BARRIER(); // Done with the slot contents before handing it back to the producer.
+    _tail = next(_tail);
+  }
+  RING_BUFFER_INLINE bool pop(T *item)
+  {
+    if (empty()) { return(false); }
+    *item = *read_slot();
+    pop();
+    return(true);
+  }
+  // Drops everything queued at the time of the call.
+  RING_BUFFER_INLINE void flush()
+  {
+    RING_BUFFER_BARRIER();
+    _tail = _head;
+  }
+
+  private:
+  T _buffer[SIZE];
+  volatile uint16_t _head;
+  volatile uint16_t _tail;
+};
+
+#endif
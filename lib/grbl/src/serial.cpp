@@ -22,123 +22,133 @@
 #include "grbl.hpp"
 #include <Ticker.h>
 
-#define RX_RING_BUFFER (RX_BUFFER_SIZE+1)
 #define TX_RING_BUFFER (TX_BUFFER_SIZE+1)
 
-uint8_t serial_rx_buffer[CLIENT_COUNT][RX_RING_BUFFER];
-uint8_t serial_rx_buffer_head[CLIENT_COUNT] = {0};
-volatile uint8_t serial_rx_buffer_tail[CLIENT_COUNT] = {0};
+// Filled by the receive interrupt or poll task. Drained by the protocol in the main program.
+static RingBuffer<uint8_t,RX_BUFFER_SIZE> serial_rx_buffer[CLIENT_COUNT];
 
 Ticker serial_poll_task;
 
 // Returns the number of bytes available in the RX serial buffer.
-uint8_t serial_get_rx_buffer_available(uint8_t client)
+uint16_t serial_get_rx_buffer_available(uint8_t client)
 {
-  uint8_t client_idx = client - 1;
+  return(serial_rx_buffer[client-1].available());
+}
+
+// Writes a received byte to the client's read buffer, unless it is full.
+static void ICACHE_RAM_ATTR serial_rx_buffer_store(uint8_t client_idx, uint8_t data)
+{
+  serial_rx_buffer[client_idx].push(data); // Dropped, if full.
+}
+
+// Handles one received byte. Picks off realtime commands and buffers everything else for the
+// protocol. Called from the UART RX interrupt, so only sets flags for the main program to act on.
+static void ICACHE_RAM_ATTR serial_rx_dispatch(uint8_t client, uint8_t data)
+{
+  #ifdef ENABLE_PIPELINE_METRICS
+    metrics_count_rx(client);
+  #endif
 
-  uint8_t rtail = serial_rx_buffer_tail[client_idx]; // Copy to limit multiple calls to volatile
-  if (serial_rx_buffer_head[client_idx] >= rtail) { return(RX_BUFFER_SIZE - (serial_rx_buffer_head[client_idx]-rtail)); }
-  return((rtail-serial_rx_buffer_head[client_idx]-1));
+  #ifdef ENABLE_BINARY_STREAMING
+    // Binary frame bytes are raw data. Buffer them without any realtime command filtering.
+    uint8_t frame, pad;
+    while ((frame = bs_rx_filter(client, data, &pad)) == BS_RX_PAD) { serial_rx_buffer_store(client-1, pad); }
+    if (frame == BS_RX_FRAME) {
+      serial_rx_buffer_store(client-1, data);
+      return;
+    }
+  #endif
+
+  // Pick off realtime command characters directly from the serial stream. These characters are
+  // not passed into the main buffer, but these set system state flag bits for realtime execution.
+  switch (data) {
+  case CMD_RESET:         mc_reset_request(); break; // Call motion control reset routine.
+  case CMD_STATUS_REPORT: system_set_exec_status_report_flag(client); break; // Report sent by main program
+  case CMD_CYCLE_START:   system_set_exec_state_flag(EXEC_CYCLE_START); break; // Set as true
+  case CMD_FEED_HOLD:     system_set_exec_state_flag(EXEC_FEED_HOLD); break; // Set as true
+  default :
+    if (data > 0x7F) { // Real-time control characters are extended ACSII only.
+      switch(data) {
+        case CMD_SAFETY_DOOR:   system_set_exec_state_flag(EXEC_SAFETY_DOOR); break; // Set as true
+        case CMD_JOG_CANCEL:
+          if (sys.state & STATE_JOG) { // Block all other states from invoking motion cancel.
+            system_set_exec_state_flag(EXEC_MOTION_CANCEL);
+          }
+          break;
+        #ifdef DEBUG
+          case CMD_DEBUG_REPORT: {uint8_t sreg = SREG; cli(); bit_true(sys_rt_exec_debug,EXEC_DEBUG_REPORT); SREG = sreg;} break;
+        #endif
+        case CMD_FEED_OVR_RESET: system_set_exec_motion_override_flag(EXEC_FEED_OVR_RESET); break;
+        case CMD_FEED_OVR_COARSE_PLUS: system_set_exec_motion_override_flag(EXEC_FEED_OVR_COARSE_PLUS); break;
+        case CMD_FEED_OVR_COARSE_MINUS: system_set_exec_motion_override_flag(EXEC_FEED_OVR_COARSE_MINUS); break;
+        case CMD_FEED_OVR_FINE_PLUS: system_set_exec_motion_override_flag(EXEC_FEED_OVR_FINE_PLUS); break;
+        case CMD_FEED_OVR_FINE_MINUS: system_set_exec_motion_override_flag(EXEC_FEED_OVR_FINE_MINUS); break;
+        case CMD_RAPID_OVR_RESET: system_set_exec_motion_override_flag(EXEC_RAPID_OVR_RESET); break;
+        case CMD_RAPID_OVR_MEDIUM: system_set_exec_motion_override_flag(EXEC_RAPID_OVR_MEDIUM); break;
+        case CMD_RAPID_OVR_LOW: system_set_exec_motion_override_flag(EXEC_RAPID_OVR_LOW); break;
+        case CMD_SPINDLE_OVR_RESET: system_set_exec_accessory_override_flag(EXEC_SPINDLE_OVR_RESET); break;
+        case CMD_SPINDLE_OVR_COARSE_PLUS: system_set_exec_accessory_override_flag(EXEC_SPINDLE_OVR_COARSE_PLUS); break;
+        case CMD_SPINDLE_OVR_COARSE_MINUS: system_set_exec_accessory_override_flag(EXEC_SPINDLE_OVR_COARSE_MINUS); break;
+        case CMD_SPINDLE_OVR_FINE_PLUS: system_set_exec_accessory_override_flag(EXEC_SPINDLE_OVR_FINE_PLUS); break;
+        case CMD_SPINDLE_OVR_FINE_MINUS: system_set_exec_accessory_override_flag(EXEC_SPINDLE_OVR_FINE_MINUS); break;
+        case CMD_SPINDLE_OVR_STOP: system_set_exec_accessory_override_flag(EXEC_SPINDLE_OVR_STOP); break;
+        case CMD_COOLANT_FLOOD_OVR_TOGGLE: system_set_exec_accessory_override_flag(EXEC_COOLANT_FLOOD_OVR_TOGGLE); break;
+        #ifdef ENABLE_M7
+          case CMD_COOLANT_MIST_OVR_TOGGLE: system_set_exec_accessory_override_flag(EXEC_COOLANT_MIST_OVR_TOGGLE); break;
+        #endif
+      }
+      // Throw away any unfound extended-ASCII character by not passing it to the serial buffer.
+    } else { // Write character to buffer
+      serial_rx_buffer_store(client-1, data);
+    }
+  }
 }
 
+#ifdef ENABLE_UART_RX_INTERRUPT
+  // UART0 receive interrupt. Moves all bytes from the hardware RX FIFO straight into the client
+  // buffer, when the FIFO fill threshold is reached or the line has been idle for a few characters.
+  static void ICACHE_RAM_ATTR serial_uart_rx_isr(void *)
+  {
+    uint32_t status = USIS(0);
+    while ((USS(0) >> USRXC) & 0xFF) { serial_rx_dispatch(CLIENT_SERIAL, USF(0)); }
+    USIC(0) = status; // Clear serviced interrupts
+  }
+#endif
+
 void serial_init()
 {
   Serial.begin(BAUD_RATE);
 
   Serial.setDebugOutput(false);
+  #ifdef ENABLE_UART_RX_INTERRUPT
+    // Take over the UART interrupt from the Arduino core. Serial is still used for sending, which
+    // does not depend on the interrupt, but Serial.available() and Serial.read() are now unused.
+    ETS_UART_INTR_DISABLE();
+    ETS_UART_INTR_ATTACH(serial_uart_rx_isr, NULL);
+    USC1(0) = (UART_RX_FIFO_THRESHOLD << UCFFT) | (UART_RX_TIMEOUT << UCTOT) | (1 << UCTOE);
+    USIC(0) = 0xFFFF;
+    USIE(0) = (1 << UIFF) | (1 << UIOF) | (1 << UITO);
+    ETS_UART_INTR_ENABLE();
+  #endif
   serial_poll_task.attach_ms(1, serial_poll_rx);
 }
 
 void serial_poll_rx()
 {
-  uint8_t data = 0;
-  uint8_t next_head;
-  uint8_t client;  // who sent the data
-  uint8_t client_idx = 0;  // index of data buffer
-
-  while (Serial.available()
-  #ifdef ENABLE_SERIAL2SOCKET
-    || Serial2Socket.available()
+  #ifndef ENABLE_UART_RX_INTERRUPT
+    while (Serial.available()) { serial_rx_dispatch(CLIENT_SERIAL, Serial.read()); }
   #endif
-    ) {
-    if (Serial.available()) {
-      client = CLIENT_SERIAL;
-      data = Serial.read();
-    }
-    #ifdef ENABLE_SERIAL2SOCKET
-      else {
-        if (Serial2Socket.available()) {
-          client = CLIENT_WEBSOCKET;
-          data = Serial2Socket.read();
-        }
-      }
-    #endif
-
-    client_idx = client - 1;  // for zero based array
-
-    // Pick off realtime command characters directly from the serial stream. These characters are
-    // not passed into the main buffer, but these set system state flag bits for realtime execution.
-    switch (data) {
-    case CMD_RESET:         mc_reset(); break; // Call motion control reset routine.
-    case CMD_STATUS_REPORT: report_realtime_status(client); break;
-    case CMD_CYCLE_START:   system_set_exec_state_flag(EXEC_CYCLE_START); break; // Set as true
-    case CMD_FEED_HOLD:     system_set_exec_state_flag(EXEC_FEED_HOLD); break; // Set as true
-    default :
-      if (data > 0x7F) { // Real-time control characters are extended ACSII only.
-        switch(data) {
-          case CMD_SAFETY_DOOR:   system_set_exec_state_flag(EXEC_SAFETY_DOOR); break; // Set as true
-          case CMD_JOG_CANCEL:
-            if (sys.state & STATE_JOG) { // Block all other states from invoking motion cancel.
-              system_set_exec_state_flag(EXEC_MOTION_CANCEL);
-            }
-            break;
-          #ifdef DEBUG
-            case CMD_DEBUG_REPORT: {uint8_t sreg = SREG; cli(); bit_true(sys_rt_exec_debug,EXEC_DEBUG_REPORT); SREG = sreg;} break;
-          #endif
-          case CMD_FEED_OVR_RESET: system_set_exec_motion_override_flag(EXEC_FEED_OVR_RESET); break;
-          case CMD_FEED_OVR_COARSE_PLUS: system_set_exec_motion_override_flag(EXEC_FEED_OVR_COARSE_PLUS); break;
-          case CMD_FEED_OVR_COARSE_MINUS: system_set_exec_motion_override_flag(EXEC_FEED_OVR_COARSE_MINUS); break;
-          case CMD_FEED_OVR_FINE_PLUS: system_set_exec_motion_override_flag(EXEC_FEED_OVR_FINE_PLUS); break;
-          case CMD_FEED_OVR_FINE_MINUS: system_set_exec_motion_override_flag(EXEC_FEED_OVR_FINE_MINUS); break;
-          case CMD_RAPID_OVR_RESET: system_set_exec_motion_override_flag(EXEC_RAPID_OVR_RESET); break;
-          case CMD_RAPID_OVR_MEDIUM: system_set_exec_motion_override_flag(EXEC_RAPID_OVR_MEDIUM); break;
-          case CMD_RAPID_OVR_LOW: system_set_exec_motion_override_flag(EXEC_RAPID_OVR_LOW); break;
-          case CMD_SPINDLE_OVR_RESET: system_set_exec_accessory_override_flag(EXEC_SPINDLE_OVR_RESET); break;
-          case CMD_SPINDLE_OVR_COARSE_PLUS: system_set_exec_accessory_override_flag(EXEC_SPINDLE_OVR_COARSE_PLUS); break;
-          case CMD_SPINDLE_OVR_COARSE_MINUS: system_set_exec_accessory_override_flag(EXEC_SPINDLE_OVR_COARSE_MINUS); break;
-          case CMD_SPINDLE_OVR_FINE_PLUS: system_set_exec_accessory_override_flag(EXEC_SPINDLE_OVR_FINE_PLUS); break;
-          case CMD_SPINDLE_OVR_FINE_MINUS: system_set_exec_accessory_override_flag(EXEC_SPINDLE_OVR_FINE_MINUS); break;
-          case CMD_SPINDLE_OVR_STOP: system_set_exec_accessory_override_flag(EXEC_SPINDLE_OVR_STOP); break;
-          case CMD_COOLANT_FLOOD_OVR_TOGGLE: system_set_exec_accessory_override_flag(EXEC_COOLANT_FLOOD_OVR_TOGGLE); break;
-          #ifdef ENABLE_M7
-            case CMD_COOLANT_MIST_OVR_TOGGLE: system_set_exec_accessory_override_flag(EXEC_COOLANT_MIST_OVR_TOGGLE); break;
-          #endif
-        }
-        // Throw away any unfound extended-ASCII character by not passing it to the serial buffer.
-      } else { // Write character to buffer
-        // enter mutex
-        next_head = serial_rx_buffer_head[client_idx] + 1;
-        if (next_head == RX_RING_BUFFER) { next_head = 0; }
-
-        // Write data to buffer unless it is full.
-        if (next_head != serial_rx_buffer_tail[client_idx]) {
-          serial_rx_buffer[client_idx][serial_rx_buffer_head[client_idx]] = data;
-          serial_rx_buffer_head[client_idx] = next_head;
-        }
-        // exit mutex
-      }
-    }
-#if defined(ENABLE_SERIAL2SOCKET)
+  #ifdef ENABLE_SERIAL2SOCKET
+    while (Serial2Socket.available()) { serial_rx_dispatch(CLIENT_WEBSOCKET, Serial2Socket.read()); }
     Serial2Socket.handle_flush();
-#endif
-  }
+  #endif
 }
 
 void serial_reset_read_buffer(uint8_t client)
 {
   for (uint8_t client_num = 1; client_num <= CLIENT_COUNT; client_num++) {
     if (client == client_num || client == CLIENT_ALL) {
-      serial_rx_buffer_tail[client_num-1] = serial_rx_buffer_head[client_num-1];
+      serial_rx_buffer[client_num-1].flush();
     }
   }
 }
@@ -148,22 +158,10 @@ void serial_write(uint8_t data) {
   Serial.write((char)data);
 }
 
-// Fetches the first byte in the serial read buffer. Called by main program.
-uint8_t serial_read(uint8_t client)
+// Fetches the first byte in the serial read buffer, or SERIAL_NO_DATA. Called by main program.
+int16_t serial_read(uint8_t client)
 {
-  uint8_t client_idx = client - 1;
-
-  uint8_t tail = serial_rx_buffer_tail[client_idx]; // Temporary serial_rx_buffer_tail (to optimize for volatile)
-  if (serial_rx_buffer_head[client_idx] == tail) {
-    return SERIAL_NO_DATA;
-  } else {
-    // enter mutex
-    uint8_t data = serial_rx_buffer[client_idx][tail];
-
-    tail++;
-    if (tail == RX_RING_BUFFER) { tail = 0; }
-    serial_rx_buffer_tail[client_idx] = tail;
-    // exit mutex
-    return data;
-  }
+  uint8_t data;
+  if (!serial_rx_buffer[client-1].pop(&data)) { return SERIAL_NO_DATA; }
+  return data;
 }
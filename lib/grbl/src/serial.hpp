@@ -23,7 +23,7 @@
 #define serial_h
 
 #ifndef RX_BUFFER_SIZE
-  #define RX_BUFFER_SIZE 128
+  #define RX_BUFFER_SIZE 1024
 #endif
 #ifndef TX_BUFFER_SIZE
   #ifdef USE_LINE_NUMBERS
@@ -33,23 +33,30 @@
   #endif
 #endif
 
-#define SERIAL_NO_DATA 0xff
+#ifndef UART_RX_FIFO_THRESHOLD
+  #define UART_RX_FIFO_THRESHOLD 96 // (1-127) RX FIFO bytes that trigger the receive interrupt.
+#endif
+#ifndef UART_RX_TIMEOUT
+  #define UART_RX_TIMEOUT 2 // (1-127) Idle character times before the receive interrupt fires anyway.
+#endif
+
+#define SERIAL_NO_DATA -1 // Outside the byte range, as binary frames carry all byte values.
 
 void serial_init();
 
 // Writes one byte to the TX serial buffer. Called by main program.
 void serial_write(uint8_t data);
 
-// Fetches the first byte in the serial read buffer. Called by main program.
-uint8_t serial_read(uint8_t client);
+// Fetches the first byte in the serial read buffer, or SERIAL_NO_DATA. Called by main program.
+int16_t serial_read(uint8_t client);
 
 // Reset and empty data in read buffer. Used by e-stop and reset.
 void serial_reset_read_buffer(uint8_t client);
 
 // Returns the number of bytes available in the RX serial buffer.
-uint8_t serial_get_rx_buffer_available(uint8_t client);
+uint16_t serial_get_rx_buffer_available(uint8_t client);
 
-// Serial rx "interrupt"
+// Serial rx "interrupt". Polls the websocket client, and the UART, if its interrupt is disabled.
 void serial_poll_rx();
 
 #endif
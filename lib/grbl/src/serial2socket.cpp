@@ -27,25 +27,21 @@ Serial_2_Socket Serial2Socket;
 Serial_2_Socket::Serial_2_Socket(){
   _web_socket = NULL;
   _TXbufferSize = 0;
-  _RXbufferSize = 0;
-  _RXbufferpos = 0;
+  _RXbuffer.reset();
 }
 Serial_2_Socket::~Serial_2_Socket(){
   if (_web_socket) detachWS();
   _TXbufferSize = 0;
-  _RXbufferSize = 0;
-  _RXbufferpos = 0;
+  _RXbuffer.reset();
 }
 void Serial_2_Socket::begin(long speed){
   _TXbufferSize = 0;
-  _RXbufferSize = 0;
-  _RXbufferpos = 0;
+  _RXbuffer.reset();
 }
 
 void Serial_2_Socket::end(){
   _TXbufferSize = 0;
-  _RXbufferSize = 0;
-  _RXbufferpos = 0;
+  _RXbuffer.reset();
 }
 
 long Serial_2_Socket::baudRate(){
@@ -72,7 +68,7 @@ Serial_2_Socket::operator bool() const
 }
 
 int Serial_2_Socket::available(){
-  return _RXbufferSize;
+  return _RXbuffer.count();
 }
 
 size_t Serial_2_Socket::write(uint8_t c)
@@ -103,34 +99,20 @@ size_t Serial_2_Socket::write(const uint8_t *buffer, size_t size)
 }
 
 int Serial_2_Socket::peek(void){
-  if (_RXbufferSize > 0)return _RXbuffer[_RXbufferpos];
+  if (!_RXbuffer.empty()) return *_RXbuffer.read_slot();
   else return -1;
 }
 
 bool Serial_2_Socket::push(const char * data){
-  int data_size = strlen(data);
-  if ((data_size + _RXbufferSize) <= RXBUFFERSIZE){
-    int current = _RXbufferpos + _RXbufferSize;
-    if (current > RXBUFFERSIZE) current = current - RXBUFFERSIZE;
-    for (int i = 0; i < data_size; i++){
-      if (current > (RXBUFFERSIZE-1)) current = 0;
-      _RXbuffer[current] = data[i];
-      current ++;
-    }
-    _RXbufferSize+=strlen(data);
-    return true;
-  }
-  return false;
+  size_t data_size = strlen(data);
+  if (data_size > _RXbuffer.CAPACITY) return false;
+  return _RXbuffer.push((const uint8_t *)data, data_size);
 }
 
 int Serial_2_Socket::read(void){
-  if (_RXbufferSize > 0) {
-    int v = _RXbuffer[_RXbufferpos];
-    _RXbufferpos++;
-    if (_RXbufferpos > (RXBUFFERSIZE-1))_RXbufferpos = 0;
-    _RXbufferSize--;
-    return v;
-  } else return -1;
+  uint8_t v;
+  if (_RXbuffer.pop(&v)) return v;
+  else return -1;
 }
 
 void Serial_2_Socket::handle_flush() {
@@ -147,6 +129,9 @@ void Serial_2_Socket::flush(void){
     if (((AsyncWebSocket *)_web_socket)->count() > 0) {
       //Serial.printf("[SOCKET]flush data, buffer size %d",_TXbufferSize);
       ((AsyncWebSocket *)_web_socket)->textAll(_TXbuffer,_TXbufferSize);
+      #ifdef ENABLE_PIPELINE_METRICS
+        metrics_tx_flush(millis() - _lastflush); // Set when the first byte was buffered.
+      #endif
     } else {
       //Serial.printf("[SOCKET]Cannot flush, buffer size %d",_TXbufferSize);
     }
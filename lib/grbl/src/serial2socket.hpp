@@ -24,8 +24,9 @@
 #define _SERIAL_2_SOCKET_H_
 
 #include <Print.h>
+#include "ring_buffer.hpp"
 #define TXBUFFERSIZE 1200
-#define RXBUFFERSIZE 128
+#define RXBUFFERSIZE 1024 // Staging for websocket messages. Sized to match the Grbl receive buffer. Power of two.
 #define FLUSHTIMEOUT 300
 class Serial_2_Socket: public Print{
   public:
@@ -71,9 +72,7 @@ class Serial_2_Socket: public Print{
   void * _web_socket;
   uint8_t _TXbuffer[TXBUFFERSIZE];
   uint16_t _TXbufferSize;
-  uint8_t _RXbuffer[RXBUFFERSIZE];
-  uint16_t _RXbufferSize;
-  uint16_t _RXbufferpos;
+  RingBuffer<uint8_t,RXBUFFERSIZE> _RXbuffer; // Filled by the websocket event handler, drained by the serial poll task.
 };
 
 extern Serial_2_Socket Serial2Socket;
@@ -22,11 +22,12 @@
 #include "grbl.hpp"
 
 settings_t settings;
+settings_derived_t settings_derived;
 
 // Method to store startup lines into EEPROM
 void settings_store_startup_line(uint8_t line_number, char *line)
 {
-  #ifdef FORCE_BUFFER_SYNC_DURING_EEPROM_WRITE
+  #if defined(FORCE_BUFFER_SYNC_DURING_EEPROM_WRITE) && !defined(ENABLE_EEPROM_JOURNAL)
     protocol_buffer_synchronize(); // A startup line may contain a motion and be executing.
   #endif
   uint32_t address = line_number*(LINE_BUFFER_SIZE+1)+EEPROM_ADDR_STARTUP_BLOCK;
@@ -46,7 +47,7 @@ void settings_store_build_info(char *line)
 // Method to store coord data parameters into EEPROM
 void settings_write_coord_data(uint8_t coord_select, float *coord_data)
 {
-  #ifdef FORCE_BUFFER_SYNC_DURING_EEPROM_WRITE
+  #if defined(FORCE_BUFFER_SYNC_DURING_EEPROM_WRITE) && !defined(ENABLE_EEPROM_JOURNAL)
     protocol_buffer_synchronize();
   #endif
   uint32_t address = coord_select*(sizeof(float)*N_AXIS+1) + EEPROM_ADDR_PARAMETERS;
@@ -126,7 +127,7 @@ void settings_restore(uint8_t restore_flag) {
     settings.max_travel[D_AXIS] = (-DEFAULT_D_MAX_TRAVEL);
     settings.max_travel[E_AXIS] = (-DEFAULT_E_MAX_TRAVEL);
 
-
+    settings_update_derived();
     write_global_settings();
   }
 
@@ -137,20 +138,14 @@ void settings_restore(uint8_t restore_flag) {
     for (index=0; index <= SETTING_INDEX_NCOORD; index++) { settings_write_coord_data(index, coord_data); }
   }
 
-  if (restore_flag & SETTINGS_RESTORE_STARTUP_LINES) {
-    #if N_STARTUP_LINE > 0
-      eeprom_put_char(EEPROM_ADDR_STARTUP_BLOCK, 0);
-      eeprom_put_char(EEPROM_ADDR_STARTUP_BLOCK+1, 0); // Checksum
-    #endif
-    #if N_STARTUP_LINE > 1
-      eeprom_put_char(EEPROM_ADDR_STARTUP_BLOCK+(LINE_BUFFER_SIZE+1), 0);
-      eeprom_put_char(EEPROM_ADDR_STARTUP_BLOCK+(LINE_BUFFER_SIZE+2), 0); // Checksum
-    #endif
-  }
-
-  if (restore_flag & SETTINGS_RESTORE_BUILD_INFO) {
-    eeprom_put_char(EEPROM_ADDR_BUILD_INFO , 0);
-    eeprom_put_char(EEPROM_ADDR_BUILD_INFO+1 , 0); // Checksum
+  if (restore_flag & (SETTINGS_RESTORE_STARTUP_LINES | SETTINGS_RESTORE_BUILD_INFO)) {
+    char line[LINE_BUFFER_SIZE];
+    memset(line, 0, sizeof(line));
+    if (restore_flag & SETTINGS_RESTORE_STARTUP_LINES) {
+      uint8_t index;
+      for (index=0; index < N_STARTUP_LINE; index++) { settings_store_startup_line(index, line); }
+    }
+    if (restore_flag & SETTINGS_RESTORE_BUILD_INFO) { settings_store_build_info(line); }
   }
 }
 
@@ -205,6 +200,19 @@ uint8_t read_global_settings() {
     if (!(memcpy_from_eeprom_with_checksum((char*)&settings, EEPROM_ADDR_GLOBAL, sizeof(settings_t)))) {
       return(false);
     }
+  } else if (version == 10) {
+    // Same layout with the old checksums. Keep what they validate.
+    if (!eeprom_upgrade_checksum(EEPROM_ADDR_GLOBAL, sizeof(settings_t))) { return(false); }
+    uint8_t index;
+    for (index=0; index <= SETTING_INDEX_NCOORD; index++) {
+      eeprom_upgrade_checksum(index*(sizeof(float)*N_AXIS+1) + EEPROM_ADDR_PARAMETERS, sizeof(float)*N_AXIS);
+    }
+    for (index=0; index < N_STARTUP_LINE; index++) {
+      eeprom_upgrade_checksum(index*(LINE_BUFFER_SIZE+1)+EEPROM_ADDR_STARTUP_BLOCK, LINE_BUFFER_SIZE);
+    }
+    eeprom_upgrade_checksum(EEPROM_ADDR_BUILD_INFO, LINE_BUFFER_SIZE);
+    memcpy_from_eeprom_with_checksum((char*)&settings, EEPROM_ADDR_GLOBAL, sizeof(settings_t));
+    write_global_settings();
   } else {
     return(false);
   }
@@ -321,6 +329,7 @@ uint8_t settings_store_global_setting(uint8_t parameter, float value) {
         return(STATUS_INVALID_STATEMENT);
     }
   }
+  settings_update_derived();
   write_global_settings();
   return(STATUS_OK);
 }
@@ -332,6 +341,39 @@ void settings_init()
     settings_restore(SETTINGS_RESTORE_ALL); // Force restore all EEPROM data.
     report_grbl_settings(CLIENT_SERIAL); // only the serial could be working at this point
   }
+  settings_update_derived();
+}
+
+
+void settings_update_derived()
+{
+  uint8_t idx;
+  for (idx=0; idx<N_AXIS; idx++) {
+    settings_derived.mm_per_step[idx] = 1.0f/settings.steps_per_mm[idx];
+    // NOTE: max_travel is stored as negative
+    int32_t travel = lroundf(settings.max_travel[idx]*settings.steps_per_mm[idx]);
+    #ifdef HOMING_FORCE_SET_ORIGIN
+      // When homing forced set origin is enabled, the volume lies on the homing direction side of zero.
+      if (bit_istrue(settings.homing_dir_mask,bit(idx))) {
+        settings_derived.travel_min[idx] = 0;
+        settings_derived.travel_max[idx] = -travel;
+      } else {
+        settings_derived.travel_min[idx] = travel;
+        settings_derived.travel_max[idx] = 0;
+      }
+    #else
+      settings_derived.travel_min[idx] = travel;
+      settings_derived.travel_max[idx] = 0;
+    #endif
+    settings_derived.step_pin_mask[idx] = get_step_pin_mask(idx);
+    settings_derived.direction_pin_mask[idx] = get_direction_pin_mask(idx);
+    settings_derived.limit_pin_mask[idx] = get_limit_pin_mask(idx);
+  }
+  settings_derived.limit_invert_mask = 0;
+  #ifdef INVERT_LIMIT_PIN_MASK
+    settings_derived.limit_invert_mask = INVERT_LIMIT_PIN_MASK;
+  #endif
+  if (bit_istrue(settings.flags,BITFLAG_INVERT_LIMIT_PINS)) { settings_derived.limit_invert_mask ^= LIMIT_MASK; }
 }
 
 // Returns step pin mask according to Grbl internal axis indexing.
@@ -27,7 +27,7 @@
 
 // Version of the EEPROM data. Will be used to migrate existing data from older versions of Grbl
 // when firmware is upgraded. Always stored in byte 0 of eeprom
-#define SETTINGS_VERSION 10  // NOTE: Check settings_reset() when moving to next version.
+#define SETTINGS_VERSION 11  // NOTE: Check settings_reset() when moving to next version.
 
 // Define bit flag masks for the boolean settings in settings.flag.
 #define BIT_REPORT_INCHES      0
@@ -113,6 +113,19 @@ typedef struct {
 } settings_t;
 extern settings_t settings;
 
+// Values derived from the settings and the pin map, kept for the code paths that would otherwise
+// recompute them for every block or status poll. Rebuilt by settings_update_derived().
+typedef struct {
+  float mm_per_step[N_AXIS];        // 1/steps_per_mm, for the position reports.
+  int32_t travel_min[N_AXIS];       // Soft limit volume in machine steps.
+  int32_t travel_max[N_AXIS];
+  uint8_t step_pin_mask[N_AXIS];
+  uint8_t direction_pin_mask[N_AXIS];
+  uint8_t limit_pin_mask[N_AXIS];
+  uint8_t limit_invert_mask;        // INVERT_LIMIT_PIN_MASK combined with the $5 setting.
+} settings_derived_t;
+extern settings_derived_t settings_derived;
+
 // Initialize the configuration subsystem (load settings from EEPROM)
 void settings_init();
 
@@ -122,6 +135,9 @@ void settings_restore(uint8_t restore_flag);
 // A helper method to set new settings from command line
 uint8_t settings_store_global_setting(uint8_t parameter, float value);
 
+// Rebuilds settings_derived. Called whenever the settings change.
+void settings_update_derived();
+
 // Stores the protocol line variable as a startup line in EEPROM
 void settings_store_startup_line(uint8_t n, char *line);
 
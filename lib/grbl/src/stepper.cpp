@@ -90,7 +90,7 @@ typedef struct {
     uint8_t spindle_pwm;
   #endif
 } segment_t;
-static segment_t segment_buffer[SEGMENT_BUFFER_SIZE];
+static RingBuffer<segment_t,SEGMENT_BUFFER_SIZE> segment_buffer; // Filled by main program. Drained by stepper ISR.
 
 // Stepper ISR data struct. Contains the running data for the main stepper ISR.
 typedef struct {
@@ -122,11 +122,6 @@ typedef struct {
 } stepper_t;
 static stepper_t st;
 
-// Step segment ring buffer indices
-static volatile uint8_t segment_buffer_tail;
-static uint8_t segment_buffer_head;
-static uint8_t segment_next_head;
-
 // Step and direction port invert masks.
 static uint8_t step_port_invert_mask;
 static uint8_t dir_port_invert_mask;
@@ -173,6 +168,10 @@ typedef struct {
 } st_prep_t;
 static st_prep_t prep;
 
+#ifdef ENABLE_CYCLE_ESTIMATE
+  static double ramp_time[RAMP_DECEL_OVERRIDE+1]; // Prepped time per ramp type (min). Kept over resets.
+#endif
+
 
 /*    BLOCK VELOCITY PROFILE DEFINITION
           __________________________
@@ -242,8 +241,8 @@ void st_wake_up()
 }
 
 
-// Stepper shutdown
-void st_go_idle()
+// Stops the step output at once. Called from interrupts by mc_reset_request(), so in IRAM.
+void ICACHE_RAM_ATTR st_halt()
 {
   // Disable Stepper Driver Interrupt. Allow Stepper Port Reset Interrupt to finish, if active.
   /*TIMSK1 &= ~(1<<OCIE1A); // Disable Timer1 interrupt
@@ -251,6 +250,13 @@ void st_go_idle()
   */
 	timer1_disable();
 	busy = false;
+}
+
+
+// Stepper shutdown
+void st_go_idle()
+{
+  st_halt();
 
   // Set stepper driver idle state, disabled or enabled, depending on settings and circumstances.
   bool pin_state = false; // Keep enabled.
@@ -350,9 +356,9 @@ void TIMER1_COMPA_vect(void)
   // If there is no step segment, attempt to pop one from the stepper buffer
   if (st.exec_segment == NULL) {
     // Anything in the buffer? If so, load and initialize next step segment.
-    if (segment_buffer_head != segment_buffer_tail) {
+    if (!segment_buffer.empty()) {
       // Initialize new step segment and load number of steps to execute
-      st.exec_segment = &segment_buffer[segment_buffer_tail];
+      st.exec_segment = segment_buffer.read_slot();
 
       #ifndef ADAPTIVE_MULTI_AXIS_STEP_SMOOTHING
         // With AMASS is disabled, set timer prescaler for segments with slow step frequencies (< 250Hz).
@@ -365,6 +371,9 @@ void TIMER1_COMPA_vect(void)
 	    timer1_write(st.exec_segment->cycles_per_tick<<2);
 
       st.step_count = st.exec_segment->n_step; // NOTE: Can sometimes be zero when moving slow.
+      #ifdef ENABLE_POSITION_TRACE
+        trace_record(st.exec_segment->n_step, st.exec_segment->cycles_per_tick, st.exec_segment->st_block_index);
+      #endif
       // If the new segment starts a new planner block, initialize stepper variables and counters.
       // NOTE: When the segment data index changes, this indicates a new planner block.
       if ( st.exec_block_index != st.exec_segment->st_block_index ) {
@@ -395,6 +404,11 @@ void TIMER1_COMPA_vect(void)
 
     } else {
       // Segment buffer empty. Shutdown.
+      #ifdef ENABLE_PIPELINE_METRICS
+        // Ran dry before the planner did. Segment preparation did not keep up.
+        if ((sys.state & (STATE_CYCLE | STATE_JOG)) && bit_isfalse(sys.step_control,STEP_CONTROL_END_MOTION) &&
+            (plan_get_current_block() != NULL)) { metrics_count_underrun(); }
+      #endif
       st_go_idle();
       #ifdef VARIABLE_SPINDLE
         // Ensure pwm is set properly upon completion of rate-controlled motion.
@@ -509,7 +523,7 @@ void TIMER1_COMPA_vect(void)
   if (st.step_count == 0) {
     // Segment is complete. Discard current segment and advance segment indexing.
     st.exec_segment = NULL;
-    if ( ++segment_buffer_tail == SEGMENT_BUFFER_SIZE) { segment_buffer_tail = 0; }
+    segment_buffer.pop();
   }
 
   st.step_outbits ^= step_port_invert_mask;  // Apply step port invert mask
@@ -577,9 +591,7 @@ void st_reset()
   memset(&st, 0, sizeof(stepper_t));
   st.exec_segment = NULL;
   pl_block = NULL;  // Planner block pointer used by segment buffer
-  segment_buffer_tail = 0;
-  segment_buffer_head = 0; // empty = tail
-  segment_next_head = 1;
+  segment_buffer.reset();
   busy = false;
 
   st_generate_step_dir_invert_masks();
@@ -699,13 +711,13 @@ static uint8_t st_next_block_index(uint8_t block_index)
    Currently, the segment buffer conservatively holds roughly up to 40-50 msec of steps.
    NOTE: Computation units are in steps, millimeters, and minutes.
 */
-void st_prep_buffer()
+static void st_prep_segments()
 {
   // Block step prep buffer, while in a suspend state and there is no suspend motion to execute.
   if (bit_istrue(sys.step_control,STEP_CONTROL_END_MOTION)) { return; }
 
-  while (segment_buffer_tail != segment_next_head) { // Check if we need to fill the buffer.
-	delay(0);
+  while (!segment_buffer.full()) { // Check if we need to fill the buffer.
+	PROFILE_YIELD();
 
     // Determine if we need to load a new planner block or if the block needs to be recomputed.
     if (pl_block == NULL) {
@@ -873,7 +885,7 @@ void st_prep_buffer()
     }
 
     // Initialize new segment
-    segment_t *prep_segment = &segment_buffer[segment_buffer_head];
+    segment_t *prep_segment = segment_buffer.write_slot();
 
     // Set new segment to point to the current segment data block.
     prep_segment->st_block_index = prep.st_block_index;
@@ -903,7 +915,10 @@ void st_prep_buffer()
 
     do {
       ESP.wdtFeed();
-      delay(0);
+      PROFILE_YIELD();
+      #ifdef ENABLE_CYCLE_ESTIMATE
+        uint8_t ramp_type = prep.ramp_type; // The ramp the time computed below belongs to.
+      #endif
       switch (prep.ramp_type) {
         case RAMP_DECEL_OVERRIDE:
           speed_var = pl_block->acceleration*time_var;
@@ -965,6 +980,9 @@ void st_prep_buffer()
           prep.current_speed = prep.exit_speed;
       }
       dt += time_var; // Add computed ramp time to total segment time.
+      #ifdef ENABLE_CYCLE_ESTIMATE
+        ramp_time[ramp_type] += time_var;
+      #endif
       if (dt < dt_max) { time_var = dt_max - dt; } // **Incomplete** At ramp junction.
       else {
         if (mm_remaining > minimum_mm) { // Check for very slow segments with zero steps.
@@ -1075,8 +1093,7 @@ void st_prep_buffer()
     #endif
 
     // Segment complete! Increment segment buffer indices, so stepper ISR can immediately execute it.
-    segment_buffer_head = segment_next_head;
-    if ( ++segment_next_head == SEGMENT_BUFFER_SIZE ) { segment_next_head = 0; }
+    segment_buffer.commit();
 
     // Update the appropriate planner and segment data.
     pl_block->millimeters = mm_remaining;
@@ -1110,6 +1127,19 @@ void st_prep_buffer()
 }
 
 
+void st_prep_buffer()
+{
+  PROFILE_SCOPE(PROFILE_PREP);
+  #ifdef ENABLE_PIPELINE_METRICS
+    uint32_t start = ESP.getCycleCount();
+    st_prep_segments();
+    metrics_timer_add(METRICS_TIMER_PREP, start);
+  #else
+    st_prep_segments();
+  #endif
+}
+
+
 // Called by realtime status reporting to fetch the current speed being executed. This value
 // however is not exactly the current speed, but the speed computed in the last step segment
 // in the segment buffer. It will always be behind by up to the number of segment blocks (-1)
@@ -1121,3 +1151,13 @@ float st_get_realtime_rate()
   }
   return 0.0f;
 }
+
+
+#ifdef ENABLE_CYCLE_ESTIMATE
+  void st_get_ramp_time(double *accel, double *cruise, double *decel)
+  {
+    *accel = ramp_time[RAMP_ACCEL];
+    *cruise = ramp_time[RAMP_CRUISE];
+    *decel = ramp_time[RAMP_DECEL] + ramp_time[RAMP_DECEL_OVERRIDE];
+  }
+#endif
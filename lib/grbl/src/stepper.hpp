@@ -23,7 +23,7 @@
 #define stepper_h
 
 #ifndef SEGMENT_BUFFER_SIZE
-  #define SEGMENT_BUFFER_SIZE 6
+  #define SEGMENT_BUFFER_SIZE 8 // Must be a power of two.
 #endif
 
 // Initialize and setup the stepper motor subsystem
@@ -35,6 +35,9 @@ void st_wake_up();
 // Immediately disables steppers
 void st_go_idle();
 
+// Stops the step output without the step idle delay. Safe to call from interrupts.
+void st_halt();
+
 // Generate the step and direction port invert masks.
 void st_generate_step_dir_invert_masks();
 
@@ -56,4 +59,10 @@ void st_update_plan_block_parameters();
 // Called by realtime status reporting if realtime rate reporting is enabled in config.h.
 float st_get_realtime_rate();
 
+#ifdef ENABLE_CYCLE_ESTIMATE
+  // Returns the motion time prepped since power-up in (min), split into acceleration, cruise and
+  // deceleration ramps. Cruise time is feed limited, the rest acceleration limited.
+  void st_get_ramp_time(double *accel, double *cruise, double *decel);
+#endif
+
 #endif
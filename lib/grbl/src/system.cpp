@@ -94,7 +94,7 @@ ICACHE_RAM_ATTR void pin_control_vect() {
   uint8_t pin = system_control_get_state();
   if (pin) {
     if (bit_istrue(pin,CONTROL_PIN_INDEX_RESET)) {
-      mc_reset();
+      mc_reset_request(); // Spindle and coolant shutdown follows in the main program.
     } else if (bit_istrue(pin,CONTROL_PIN_INDEX_CYCLE_START)) {
       bit_true(sys_rt_exec_state, EXEC_CYCLE_START);
     #ifndef ENABLE_SAFETY_DOOR_INPUT_PIN
@@ -161,7 +161,14 @@ uint8_t system_execute_line(char *line, uint8_t client)
       return(gc_execute_line(line, client)); // NOTE: $J= is ignored inside g-code parser and used to detect jog motions.
       break;
     case '$': case 'G': case 'C': case 'X':
-      if ( line[2] != 0 ) { return(STATUS_INVALID_STATEMENT); }
+      if ( line[2] != 0 ) {
+        #ifdef ENABLE_DRY_PLAN
+          // $CP is check mode with dry planning.
+          if ((line[1] != 'C') || (line[2] != 'P') || (line[3] != 0)) { return(STATUS_INVALID_STATEMENT); }
+        #else
+          return(STATUS_INVALID_STATEMENT);
+        #endif
+      }
       switch( line[1] ) {
         case '$' : // Prints Grbl settings
           if ( sys.state & (STATE_CYCLE | STATE_HOLD) ) { return(STATUS_IDLE_ERROR); } // Block during cycle. Takes too long to print.
@@ -176,11 +183,17 @@ uint8_t system_execute_line(char *line, uint8_t client)
           // is idle and ready, regardless of alarm locks. This is mainly to keep things
           // simple and consistent.
           if ( sys.state == STATE_CHECK_MODE ) {
+            #ifdef ENABLE_DRY_PLAN
+              if (dryplan_active()) { dryplan_report(client); }
+            #endif
             mc_reset();
             report_feedback_message(MESSAGE_DISABLED);
           } else {
             if (sys.state) { return(STATUS_IDLE_ERROR); } // Requires no alarm mode.
             sys.state = STATE_CHECK_MODE;
+            #ifdef ENABLE_DRY_PLAN
+              dryplan_start(line[2] == 'P');
+            #endif
             report_feedback_message(MESSAGE_ENABLED);
           }
           break;
@@ -195,6 +208,71 @@ uint8_t system_execute_line(char *line, uint8_t client)
           break;
       }
       break;
+    #ifdef ENABLE_POSITION_TRACE
+      case 'T' : // Position trace capture. Allowed in all states.
+        if (line[2] != 'R') { return(STATUS_INVALID_STATEMENT); }
+        if (line[3] == 0) { trace_report(client); break; }
+        if ((line[3] != '=') || (line[5] != 0)) { return(STATUS_INVALID_STATEMENT); }
+        switch (line[4]) {
+          case '0': trace_enable(false); break;
+          case '1': trace_enable(true); break;
+          default: return(STATUS_INVALID_STATEMENT);
+        }
+        break;
+    #endif
+    #ifdef ENABLE_JOB_STORAGE
+      case 'F' : // Stored jobs. Listing allowed in all states. See job.hpp.
+        if (line[2] == 0) { job_list(client); break; }
+        if (line[2] == '=') { return(job_start(&line[3], 0, client)); }
+        if ((line[2] == 'R') && (line[3] == '=')) { // $FR=<line>,<name>
+          char_counter = 4;
+          if (!read_float(line, &char_counter, &value)) { return(STATUS_BAD_NUMBER_FORMAT); }
+          if (line[char_counter] != ',') { return(STATUS_INVALID_STATEMENT); }
+          if (value < 1.0) { return(STATUS_INVALID_STATEMENT); }
+          return(job_start(&line[char_counter+1], trunc(value), client));
+        }
+        if ((line[2] == 'D') && (line[3] == '=')) { return(job_delete(&line[4])); }
+        return(STATUS_INVALID_STATEMENT);
+    #endif
+    #if defined(ENABLE_PIPELINE_METRICS) || defined(ENABLE_PROFILER)
+      case 'P' : // Pipeline metrics and profiler. $Px reports, $Px=0 clears. Allowed in all states.
+        if ((line[3] != 0) && ((line[3] != '=') || (line[4] != '0') || (line[5] != 0))) { return(STATUS_INVALID_STATEMENT); }
+        switch (line[2]) {
+          #ifdef ENABLE_PIPELINE_METRICS
+            case 'M':
+              if (line[3] == 0) { metrics_report(client); }
+              else { metrics_reset(); }
+              break;
+          #endif
+          #ifdef ENABLE_PROFILER
+            case 'R':
+              if (line[3] == 0) { profiler_report(client); }
+              else { profiler_reset(); }
+              break;
+          #endif
+          default: return(STATUS_INVALID_STATEMENT);
+        }
+        break;
+    #endif
+    #ifdef ENABLE_AUTO_STATUS_REPORT
+      case 'R' : // Auto status report subscription. Allowed in all states.
+        if (line[2] == 'I') {
+          if (line[3] == 0) { report_auto_status_interval(client); break; }
+          if (line[3] != '=') { return(STATUS_INVALID_STATEMENT); }
+          if ((line[4] == 'C') && (line[5] == 0)) {
+            report_auto_status_subscribe(client, AUTO_STATUS_REPORT_ON_CHANGE);
+            break;
+          }
+          char_counter = 4;
+          if (!read_float(line, &char_counter, &value)) { return(STATUS_BAD_NUMBER_FORMAT); }
+          if (line[char_counter] != 0) { return(STATUS_INVALID_STATEMENT); }
+          if (value < 0.0) { return(STATUS_NEGATIVE_VALUE); }
+          if (value >= AUTO_STATUS_REPORT_ON_CHANGE) { return(STATUS_INVALID_STATEMENT); }
+          report_auto_status_subscribe(client, trunc(value));
+          break;
+        }
+        // No break. Continues into default: for the remaining '$R' commands.
+    #endif
     default :
       // Block any system command that requires the state as IDLE/ALARM. (i.e. EEPROM, homing)
       if ( !(sys.state == STATE_IDLE || sys.state == STATE_ALARM) ) { return(STATUS_IDLE_ERROR); }
@@ -324,14 +402,14 @@ float system_convert_axis_steps_to_mpos(int32_t *steps, uint8_t idx)
   float pos;
   #ifdef COREXY
     if (idx==X_AXIS) {
-      pos = (float)system_convert_corexy_to_x_axis_steps(steps) / settings.steps_per_mm[idx];
+      pos = (float)system_convert_corexy_to_x_axis_steps(steps) * settings_derived.mm_per_step[idx];
     } else if (idx==Y_AXIS) {
-      pos = (float)system_convert_corexy_to_y_axis_steps(steps) / settings.steps_per_mm[idx];
+      pos = (float)system_convert_corexy_to_y_axis_steps(steps) * settings_derived.mm_per_step[idx];
     } else {
-      pos = steps[idx]/settings.steps_per_mm[idx];
+      pos = steps[idx]*settings_derived.mm_per_step[idx];
     }
   #else
-    pos = steps[idx]/settings.steps_per_mm[idx];
+    pos = steps[idx]*settings_derived.mm_per_step[idx];
   #endif
   return(pos);
 }
@@ -360,85 +438,79 @@ void system_convert_array_steps_to_mpos(float *position, int32_t *steps)
 #endif
 
 
-// Checks and reports if target array exceeds machine travel limits.
+// Checks and reports if target array exceeds machine travel limits. Compares in steps, rounded as the
+// planner rounds the target.
 uint8_t system_check_travel_limits(float *target)
 {
   uint8_t idx;
   for (idx=0; idx<N_AXIS; idx++) {
-    #ifdef HOMING_FORCE_SET_ORIGIN
-      // When homing forced set origin is enabled, soft limits checks need to account for directionality.
-      // NOTE: max_travel is stored as negative
-      if (bit_istrue(settings.homing_dir_mask,bit(idx))) {
-        if (target[idx] < 0 || target[idx] > -settings.max_travel[idx]) { return(true); }
-      } else {
-        if (target[idx] > 0 || target[idx] < settings.max_travel[idx]) { return(true); }
-      }
-    #else
-      // NOTE: max_travel is stored as negative
-      if (target[idx] > 0 || target[idx] < settings.max_travel[idx]) { return(true); }
-    #endif
+    int32_t target_steps = lroundf(target[idx]*settings.steps_per_mm[idx]);
+    // NOTE: The volume accounts for the homing direction with homing forced set origin enabled.
+    if (target_steps > settings_derived.travel_max[idx] || target_steps < settings_derived.travel_min[idx]) { return(true); }
   }
   return(false);
 }
 
 
-// Special handlers for setting and clearing Grbl's real-time execution flags.
-void system_set_exec_state_flag(uint8_t mask) {
-  //uint8_t sreg = save_SREG();
-  //cli();
+// Special handlers for setting and clearing Grbl's real-time execution flags. The setters are
+// called from the serial receive, control pin and limit pin interrupts, so are in IRAM. Each
+// read-modify-write holds off the interrupts, which restores the interrupt level of an interrupt
+// caller, too.
+void ICACHE_RAM_ATTR system_set_exec_state_flag(uint8_t mask) {
+  uint32_t ps = xt_rsil(15);
   sys_rt_exec_state |= (mask);
-  //restore_SREG(sreg);
+  xt_wsr_ps(ps);
 }
 
 void system_clear_exec_state_flag(uint8_t mask) {
-  //uint8_t sreg = save_SREG();
-  //cli();
+  uint32_t ps = xt_rsil(15);
   sys_rt_exec_state &= ~(mask);
-  //restore_SREG(sreg);
-  //sei();
+  xt_wsr_ps(ps);
 }
 
-void system_set_exec_alarm(uint8_t code) {
-  //uint8_t sreg = save_SREG();
-  //cli();
+void ICACHE_RAM_ATTR system_set_exec_alarm(uint8_t code) {
   sys_rt_exec_alarm = code;
-  //restore_SREG(sreg);
 }
 
 void system_clear_exec_alarm() {
-  //uint8_t sreg = save_SREG();
-  //cli();
   sys_rt_exec_alarm = 0;
-  //restore_SREG(sreg);
-  //  sei();
 }
 
-void system_set_exec_motion_override_flag(uint8_t mask) {
-  //uint8_t sreg = save_SREG();
-  //cli();
+void ICACHE_RAM_ATTR system_set_exec_motion_override_flag(uint8_t mask) {
+  uint32_t ps = xt_rsil(15);
   sys_rt_exec_motion_override |= (mask);
-  //restore_SREG(sreg);
+  xt_wsr_ps(ps);
 }
 
-void system_set_exec_accessory_override_flag(uint8_t mask) {
-  //uint8_t sreg = save_SREG();
-  //cli();
+void ICACHE_RAM_ATTR system_set_exec_accessory_override_flag(uint8_t mask) {
+  uint32_t ps = xt_rsil(15);
   sys_rt_exec_accessory_override |= (mask);
-  //restore_SREG(sreg);
+  xt_wsr_ps(ps);
 }
 
 void system_clear_exec_motion_overrides() {
-  //uint8_t sreg = save_SREG();
-  //cli();
   sys_rt_exec_motion_override = 0;
-  //restore_SREG(sreg);
-  //  sei();
 }
 
 void system_clear_exec_accessory_overrides() {
-  //uint8_t sreg = save_SREG();
-  //cli();
   sys_rt_exec_accessory_override = 0;
-  //restore_SREG(sreg);
-  //  sei();
+}
+
+// Flags a status report request from a client. Called from the serial receive interrupt. The
+// report itself is built and sent by the main program.
+void ICACHE_RAM_ATTR system_set_exec_status_report_flag(uint8_t client) {
+  uint32_t ps = xt_rsil(15);
+  sys_rt_exec_status_report |= bit((client-1));
+  sys_rt_exec_state |= EXEC_STATUS_REPORT;
+  xt_wsr_ps(ps);
+}
+
+// Returns and clears the set of clients that requested a status report.
+uint8_t system_take_exec_status_report_clients() {
+  noInterrupts();
+  uint8_t clients = sys_rt_exec_status_report;
+  sys_rt_exec_status_report = 0;
+  sys_rt_exec_state &= ~(EXEC_STATUS_REPORT);
+  interrupts();
+  return(clients);
 }
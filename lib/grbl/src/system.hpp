@@ -155,6 +155,7 @@ extern volatile uint8_t sys_rt_exec_state;   // Global realtime executor bitflag
 extern volatile uint8_t sys_rt_exec_alarm;   // Global realtime executor bitflag variable for setting various alarms.
 extern volatile uint8_t sys_rt_exec_motion_override; // Global realtime executor bitflag variable for motion-based overrides.
 extern volatile uint8_t sys_rt_exec_accessory_override; // Global realtime executor bitflag variable for spindle/coolant overrides.
+extern volatile uint8_t sys_rt_exec_status_report; // Clients with a pending status report request. Bit (client-1).
 
 #ifdef DEBUG
   #define EXEC_DEBUG_REPORT  bit(0)
@@ -203,6 +204,8 @@ void system_set_exec_motion_override_flag(uint8_t mask);
 void system_set_exec_accessory_override_flag(uint8_t mask);
 void system_clear_exec_motion_overrides();
 void system_clear_exec_accessory_overrides();
+void system_set_exec_status_report_flag(uint8_t client);
+uint8_t system_take_exec_status_report_clients();
 
 void pin_control_vect();
 
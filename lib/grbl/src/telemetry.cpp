@@ -0,0 +1,140 @@
+/*
+  telemetry.cpp - delta encoded binary status telemetry over websocket binary frames
+  Part of Grbl
+
+  Grbl is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Grbl is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Grbl.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "grbl.hpp"
+
+#ifdef ENABLE_BINARY_TELEMETRY
+
+// Worst case frame: header, all fields and 5 byte varints for every value.
+#define TLM_FRAME_MAX_SIZE (3 + 2 + 3 + (1+3) + 5 + (1+5*N_AXIS))
+
+typedef struct {
+  uint8_t state;
+  uint8_t suspend;
+  uint8_t overrides[3];
+  uint8_t planner_available;
+  uint16_t rx_available;
+  int32_t feed;
+  int32_t position[N_AXIS];
+} telemetry_t;
+
+static telemetry_t tlm_last; // Values of the previous frame. The delta base.
+static uint32_t tlm_next_time;
+static uint8_t tlm_sequence;
+static uint8_t tlm_frames_to_key; // Frames until the next key frame. Zero sends one now.
+
+
+static uint8_t *tlm_write_varint(uint8_t *p, uint32_t value)
+{
+  while (value > 0x7F) {
+    *p++ = (value & 0x7F) | 0x80;
+    value >>= 7;
+  }
+  *p++ = value;
+  return(p);
+}
+
+
+static uint8_t *tlm_write_zigzag(uint8_t *p, int32_t value)
+{
+  return(tlm_write_varint(p, ((uint32_t)value << 1) ^ (uint32_t)(value >> 31)));
+}
+
+
+void telemetry_request_key_frame()
+{
+  tlm_frames_to_key = 0;
+}
+
+
+void telemetry_poll()
+{
+  uint32_t now = millis();
+  if ((int32_t)(now - tlm_next_time) < 0) { return; }
+  tlm_next_time = now + TELEMETRY_INTERVAL;
+  if (!websocket_has_clients()) {
+    tlm_frames_to_key = 0; // Start with a key frame, once a client is connected.
+    return;
+  }
+
+  // Snapshot of the current values.
+  telemetry_t tlm;
+  tlm.state = sys.state;
+  tlm.suspend = sys.suspend;
+  tlm.overrides[0] = sys.f_override;
+  tlm.overrides[1] = sys.r_override;
+  tlm.overrides[2] = sys.spindle_speed_ovr;
+  tlm.planner_available = plan_get_block_buffer_available();
+  tlm.rx_available = serial_get_rx_buffer_available(CLIENT_WEBSOCKET);
+  tlm.feed = lroundf(st_get_realtime_rate()*10.0f);
+  memcpy(tlm.position, sys_position, sizeof(sys_position));
+
+  uint8_t key_frame = (tlm_frames_to_key == 0);
+  uint8_t fields = 0;
+  uint8_t axis_mask = 0;
+  uint8_t idx;
+  if (key_frame) {
+    fields = TLM_FIELD_STATE | TLM_FIELD_OVERRIDES | TLM_FIELD_BUFFER | TLM_FIELD_FEED | TLM_FIELD_POSITION;
+    axis_mask = (1 << N_AXIS)-1;
+    memset(&tlm_last, 0, sizeof(telemetry_t)); // Absolute values are deltas to zero.
+  } else {
+    if ((tlm.state != tlm_last.state) || (tlm.suspend != tlm_last.suspend)) { fields |= TLM_FIELD_STATE; }
+    if (memcmp(tlm.overrides, tlm_last.overrides, sizeof(tlm.overrides))) { fields |= TLM_FIELD_OVERRIDES; }
+    if ((tlm.planner_available != tlm_last.planner_available) || (tlm.rx_available != tlm_last.rx_available)) {
+      fields |= TLM_FIELD_BUFFER;
+    }
+    if (tlm.feed != tlm_last.feed) { fields |= TLM_FIELD_FEED; }
+    for (idx=0; idx<N_AXIS; idx++) {
+      if (tlm.position[idx] != tlm_last.position[idx]) { axis_mask |= bit(idx); }
+    }
+    if (axis_mask) { fields |= TLM_FIELD_POSITION; }
+    if (!fields) { return; } // Nothing changed. Nothing to send.
+  }
+
+  uint8_t frame[TLM_FRAME_MAX_SIZE];
+  uint8_t *p = frame;
+  *p++ = key_frame ? TLM_FRAME_KEY : TLM_FRAME_DELTA;
+  *p++ = tlm_sequence++;
+  *p++ = fields;
+  if (fields & TLM_FIELD_STATE) {
+    *p++ = tlm.state;
+    *p++ = tlm.suspend;
+  }
+  if (fields & TLM_FIELD_OVERRIDES) {
+    memcpy(p, tlm.overrides, sizeof(tlm.overrides));
+    p += sizeof(tlm.overrides);
+  }
+  if (fields & TLM_FIELD_BUFFER) {
+    *p++ = tlm.planner_available;
+    p = tlm_write_varint(p, tlm.rx_available);
+  }
+  if (fields & TLM_FIELD_FEED) { p = tlm_write_zigzag(p, tlm.feed-tlm_last.feed); }
+  if (fields & TLM_FIELD_POSITION) {
+    *p++ = axis_mask;
+    for (idx=0; idx<N_AXIS; idx++) {
+      if (axis_mask & bit(idx)) { p = tlm_write_zigzag(p, tlm.position[idx]-tlm_last.position[idx]); }
+    }
+  }
+  websocket_send_binary(frame, p-frame);
+
+  memcpy(&tlm_last, &tlm, sizeof(telemetry_t));
+  if (key_frame) { tlm_frames_to_key = TELEMETRY_KEY_FRAME_INTERVAL; }
+  else { tlm_frames_to_key--; }
+}
+
+#endif
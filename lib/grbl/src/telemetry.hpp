@@ -0,0 +1,65 @@
+/*
+  telemetry.hpp - delta encoded binary status telemetry over websocket binary frames
+  Part of Grbl
+
+  Grbl is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Grbl is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Grbl.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef telemetry_h
+#define telemetry_h
+
+/*
+  Frame layout, one websocket binary message per frame:
+
+    [type] [sequence] [field mask] [fields...]
+
+  type is TLM_FRAME_KEY for a frame with absolute values of all fields, or TLM_FRAME_DELTA for a
+  frame with only the fields changed since the previous frame. The uint8 sequence number counts
+  every frame sent, so a client detects a lost frame and waits for the next key frame. Fields
+  follow in the order of their TLM_FIELD_ bits, each only if its bit is set in the field mask.
+
+    TLM_FIELD_STATE     : sys.state, sys.suspend.
+    TLM_FIELD_OVERRIDES : feed, rapid and spindle override in percent.
+    TLM_FIELD_BUFFER    : free planner blocks, then a varint of the free websocket receive bytes.
+    TLM_FIELD_FEED      : zigzag varint of the realtime feed rate in 0.1mm/min.
+    TLM_FIELD_POSITION  : axis mask, then a zigzag varint of the position in machine steps for each
+                          axis set in the mask.
+
+  Varints are 7 bits per byte, least significant first, with the top bit set on all but the last
+  byte. In delta frames, the feed rate and positions are the difference to the previous frame.
+*/
+
+#define TLM_FRAME_KEY   0x01
+#define TLM_FRAME_DELTA 0x02
+
+#define TLM_FIELD_STATE     bit(0)
+#define TLM_FIELD_OVERRIDES bit(1)
+#define TLM_FIELD_BUFFER    bit(2)
+#define TLM_FIELD_FEED      bit(3)
+#define TLM_FIELD_POSITION  bit(4)
+
+#ifndef TELEMETRY_INTERVAL
+  #define TELEMETRY_INTERVAL 20 // (ms) Minimum time between frames. 50Hz.
+#endif
+#ifndef TELEMETRY_KEY_FRAME_INTERVAL
+  #define TELEMETRY_KEY_FRAME_INTERVAL 50 // Frames between key frames. Lets new clients sync up.
+#endif
+
+// Sends a frame, if the interval is due and anything changed. Called by the main program.
+void telemetry_poll();
+
+// Makes the next frame a key frame. Used when a websocket client connects.
+void telemetry_request_key_frame();
+
+#endif
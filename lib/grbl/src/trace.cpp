@@ -0,0 +1,103 @@
+/*
+  trace.cpp - realtime position trace capture for motion tuning
+  Part of Grbl
+
+  Grbl is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Grbl is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Grbl.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "grbl.hpp"
+
+#ifdef ENABLE_POSITION_TRACE
+
+typedef struct {
+  uint32_t timestamp;        // CPU cycle count at segment load.
+  uint16_t n_step;
+  uint16_t cycles_per_tick;
+  uint8_t st_block_index;
+  int32_t position[N_AXIS];  // sys_position at segment load.
+} trace_entry_t;
+
+static RingBuffer<trace_entry_t,TRACE_BUFFER_SIZE> trace_buffer; // Filled by stepper ISR. Drained by $TR.
+static volatile bool trace_capturing;
+static volatile uint16_t trace_dropped;
+
+
+void ICACHE_RAM_ATTR trace_record(uint16_t n_step, uint16_t cycles_per_tick, uint8_t st_block_index)
+{
+  if (!trace_capturing) { return; }
+  if (trace_buffer.full()) {
+    if (trace_dropped < 0xFFFF) { trace_dropped++; }
+    return;
+  }
+  trace_entry_t *entry = trace_buffer.write_slot();
+  entry->timestamp = ESP.getCycleCount();
+  entry->n_step = n_step;
+  entry->cycles_per_tick = cycles_per_tick;
+  entry->st_block_index = st_block_index;
+  memcpy(entry->position, sys_position, sizeof(sys_position));
+  trace_buffer.commit();
+}
+
+
+void trace_enable(bool enable)
+{
+  trace_capturing = false; // Stop the producer before touching the ring.
+  if (enable) {
+    trace_buffer.flush();
+    trace_dropped = 0;
+    trace_capturing = true;
+  }
+}
+
+
+void trace_report(uint8_t client)
+{
+  char temp[40 + 12*N_AXIS]; // Fits a line with the largest values.
+  print_buffer_t report;
+  uint8_t idx;
+
+  // Only what is recorded now, so an ongoing capture can't keep the read out going forever.
+  uint16_t count = trace_buffer.count();
+  while (count--) {
+    trace_entry_t *entry = trace_buffer.read_slot();
+    print_init(&report, temp, sizeof(temp));
+    printString(&report, "[TR:");
+    print_uint32_base10(&report, entry->timestamp);
+    printChar(&report, ',');
+    print_uint32_base10(&report, entry->n_step);
+    printChar(&report, ',');
+    print_uint32_base10(&report, entry->cycles_per_tick);
+    printChar(&report, ',');
+    print_uint8_base10(&report, entry->st_block_index);
+    for (idx=0; idx<N_AXIS; idx++) {
+      printChar(&report, ',');
+      printInteger(&report, entry->position[idx]);
+    }
+    trace_buffer.pop();
+    printString(&report, "]\r\n");
+    grbl_write(client, report.data, report.length);
+    delay(0); // Long read outs. Keep the WiFi stack alive.
+  }
+
+  print_init(&report, temp, sizeof(temp));
+  printString(&report, "[TRE:");
+  print_uint8_base10(&report, trace_capturing);
+  printChar(&report, ',');
+  print_uint32_base10(&report, trace_dropped);
+  printString(&report, "]\r\n");
+  grbl_write(client, report.data, report.length);
+  trace_dropped = 0;
+}
+
+#endif
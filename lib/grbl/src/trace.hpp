@@ -0,0 +1,51 @@
+/*
+  trace.hpp - realtime position trace capture for motion tuning
+  Part of Grbl
+
+  Grbl is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Grbl is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Grbl.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef trace_h
+#define trace_h
+
+/*
+  While capturing, the stepper ISR records every step segment it loads into a RAM ring. The
+  ring is read out by the $TR command, one line per segment:
+
+    [TR:<timestamp>,<n_step>,<cycles_per_tick>,<st_block_index>,<position of each axis>]
+
+  followed by [TRE:<capturing>,<dropped>]. The timestamp is the CPU cycle counter when the
+  segment was loaded, which wraps about every 53 seconds at 80MHz. Positions are sys_position
+  in machine steps at the start of the segment. dropped counts segments lost to a full ring since
+  the previous read out. tools/trace_convert.py turns a captured console log into CSV or VCD.
+
+    $TR=1 : Clears the ring and starts capturing.
+    $TR=0 : Stops capturing. Recorded segments stay in the ring.
+    $TR   : Sends and removes all recorded segments. Capturing continues, if enabled.
+*/
+
+#ifndef TRACE_BUFFER_SIZE
+  #define TRACE_BUFFER_SIZE 128 // Segments. Must be a power of two. 44 bytes each.
+#endif
+
+// Records a segment loaded by the stepper ISR, if capturing.
+void trace_record(uint16_t n_step, uint16_t cycles_per_tick, uint8_t st_block_index);
+
+// Clears the ring and starts capturing, or stops capturing.
+void trace_enable(bool enable);
+
+// Sends and removes all recorded segments to the client.
+void trace_report(uint8_t client);
+
+#endif
@@ -12,6 +12,43 @@ AsyncWebServer webSocketServer(WEBSERVER_PORT);
 AsyncWebSocket ws("/ws");
 //AsyncEventSource events("/events");
 
+#ifdef ENABLE_PIPELINE_METRICS
+  // Serves the pipeline metrics report line to HTTP clients, e.g. for scraping by a dashboard.
+  static void websocket_metrics_request(AsyncWebServerRequest *request)
+  {
+    char temp[METRICS_REPORT_SIZE];
+    print_buffer_t report;
+    print_init(&report, temp, sizeof(temp));
+    metrics_build(&report);
+    request->send(200, "text/plain", report.data);
+  }
+#endif
+
+#ifdef ENABLE_JOB_STORAGE
+  // Stores the file of a multipart form POST as a job, piece by piece. See job.hpp.
+  static void websocket_upload_data(AsyncWebServerRequest *request, const String &filename, size_t index, uint8_t *data, size_t len, bool final)
+  {
+    if (index == 0) { job_upload_begin(filename.c_str()); }
+    job_upload_write(data, len);
+    if (final) { job_upload_end(); }
+  }
+
+  // Answers the upload, once all of it arrived, like a g-code line.
+  static void websocket_upload_request(AsyncWebServerRequest *request)
+  {
+    char temp[16];
+    print_buffer_t reply;
+    print_init(&reply, temp, sizeof(temp));
+    uint8_t status_code = job_upload_result();
+    if (status_code == STATUS_OK) { printString(&reply, "ok"); }
+    else {
+      printString(&reply, "error:");
+      print_uint8_base10(&reply, status_code);
+    }
+    request->send((status_code == STATUS_OK) ? 200 : 400, "text/plain", reply.data);
+  }
+#endif
+
 void websocket_init()
 {
   WiFi.hostname(WIFI_HOSTNAME);
@@ -23,12 +60,33 @@ void websocket_init()
   MDNS.addService("http", "tcp", WEBSERVER_PORT);
   ws.onEvent(onWsEvent);
   webSocketServer.addHandler(&ws);
+  #ifdef ENABLE_PIPELINE_METRICS
+    webSocketServer.on("/metrics", HTTP_GET, websocket_metrics_request);
+  #endif
+  #ifdef ENABLE_JOB_STORAGE
+    webSocketServer.on("/upload", HTTP_POST, websocket_upload_request, websocket_upload_data);
+  #endif
   webSocketServer.begin();
   Serial2Socket.attachWS(&ws);
 }
 
+// Returns true, if any websocket client is connected.
+bool websocket_has_clients()
+{
+  return(ws.count() > 0);
+}
+
+// Sends a binary message to all websocket clients.
+void websocket_send_binary(const uint8_t *data, size_t length)
+{
+  ws.binaryAll(data, length);
+}
+
 void onWsEvent(AsyncWebSocket * server, AsyncWebSocketClient * client, AwsEventType type, void * arg, uint8_t *data, size_t len){
   if(type == WS_EVT_CONNECT){
+    #ifdef ENABLE_BINARY_TELEMETRY
+      telemetry_request_key_frame(); // Get the new client in sync right away.
+    #endif
     //Serial.printf("ws[%s][%u] connect\n", server->url(), client->id());
     //client->printf("Hello Client %u :)", client->id());
     //client->ping();
@@ -13,6 +13,12 @@
 
 void websocket_init();
 
+// Returns true, if any websocket client is connected.
+bool websocket_has_clients();
+
+// Sends a binary message to all websocket clients.
+void websocket_send_binary(const uint8_t *data, size_t length);
+
 // Called on every event received by websocket
 void onWsEvent(AsyncWebSocket * server, AsyncWebSocketClient * client, AwsEventType type, void * arg, uint8_t *data, size_t len);
 
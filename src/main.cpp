@@ -31,6 +31,7 @@ volatile uint8_t sys_rt_exec_state;   // Global realtime executor bitflag variab
 volatile uint8_t sys_rt_exec_alarm;   // Global realtime executor bitflag variable for setting various alarms.
 volatile uint8_t sys_rt_exec_motion_override; // Global realtime executor bitflag variable for motion-based overrides.
 volatile uint8_t sys_rt_exec_accessory_override; // Global realtime executor bitflag variable for spindle/coolant overrides.
+volatile uint8_t sys_rt_exec_status_report; // Clients with a pending status report request.
 #ifdef DEBUG
   volatile uint8_t sys_rt_exec_debug;
 #endif
@@ -39,6 +40,9 @@ void setup(void){
     // Initialize system upon power-up.
     serial_init();    // Setup serial connection
     eeprom_init();		// Initialize EEPROM
+    #ifdef ENABLE_JOB_STORAGE
+      job_init();     // Mount the file system of stored jobs
+    #endif
     websocket_init(); // Setup websocket server
     settings_init();  // Load Grbl settings from EEPROM
     stepper_init();   // Configure stepper pins and interrupt timers
@@ -67,11 +71,10 @@ void setup(void){
     #endif
 }
 
-void loop(void)
+// Resets the system variables and Grbl's primary systems, upon power-up or a system abort. The
+// host build boots its tests and benchmarks with it, too.
+void grbl_reinit(void)
 {
-  // Grbl initialization loop upon power-up or a system abort. For the latter, all processes
-  // will return to this loop to be cleanly re-initialized.
-
   // Reset system variables.
   uint8_t prior_state = sys.state;
   memset(&sys, 0, sizeof(system_t)); // Clear system struct variable.
@@ -85,9 +88,16 @@ void loop(void)
   sys_rt_exec_alarm = 0;
   sys_rt_exec_motion_override = 0;
   sys_rt_exec_accessory_override = 0;
+  sys_rt_exec_status_report = 0;
 
   // Reset Grbl primary systems.
   serial_reset_read_buffer(CLIENT_ALL); // Clear serial read buffer
+  #ifdef ENABLE_BINARY_STREAMING
+    bs_reset(CLIENT_ALL); // Drop partial frames and delta history
+  #endif
+  #ifdef ENABLE_JOB_STORAGE
+    job_reset(); // Abort a running job
+  #endif
   gc_init(); // Set g-code parser to default state
   spindle_init();
   coolant_init();
@@ -99,6 +109,13 @@ void loop(void)
   // Sync cleared gcode and planner positions to current system position.
   plan_sync_position();
   gc_sync_position();
+}
+
+void loop(void)
+{
+  // Grbl initialization loop upon power-up or a system abort. For the latter, all processes
+  // will return to this loop to be cleanly re-initialized.
+  grbl_reinit();
 
   // Print welcome message. Indicates an initialization has occured at power-up or with a reset.
   report_init_message(CLIENT_ALL);
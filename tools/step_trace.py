@@ -0,0 +1,333 @@
+#!/usr/bin/env python3
+"""Inspects and compares shift register captures of the host build.
+
+The native build records every frame latched into the shift register chain
+with --capture FILE. A capture holds a 9 byte header, "GSTC", format version
+1 and the CPU clock as uint32, followed by one record per frame: the cycles
+since the previous frame, LEB128 coded, and the 32 bit frame, little endian.
+
+  step_trace.py summary job.gstc
+  step_trace.py vcd job.gstc > job.vcd
+  step_trace.py diff golden.json job.gstc
+  step_trace.py check corpus/ [--update]
+
+A golden is the summary of a capture as JSON: positions, step counts,
+minimum step intervals, pulse widths, duration and the step rate envelope.
+That is all a diff looks at, so the raw frames are not kept. diff takes a
+capture as the golden, too.
+
+check runs every corpus/*.nc through the host build, starting from the
+default settings, and diffs the capture against corpus/*.json next to it.
+--update records those golden summaries instead. host/test/golden is the
+corpus of the repository, run by make -C host test. Final positions and
+step counts must match exactly unless a tolerance is given. Durations, minimum step intervals and pulse widths are
+compared relative to the golden value, and the step rate envelope window by
+window.
+"""
+
+import argparse
+import glob
+import json
+import os
+import subprocess
+import sys
+import tempfile
+
+AXIS_NAMES = "XYZABCDE"
+N_AXIS = 8
+MAGIC = b"GSTC"
+
+
+def read_capture(path):
+    """Returns the CPU clock and a list of (cycles, frame) tuples."""
+    with open(path, "rb") as source:
+        data = source.read()
+    if len(data) < 9 or data[:4] != MAGIC or data[4] != 1:
+        raise ValueError("%s: not a version 1 capture" % path)
+    clock = int.from_bytes(data[5:9], "little")
+    frames = []
+    cycles = 0
+    index = 9
+    while index < len(data):
+        delta = 0
+        shift = 0
+        while True:
+            byte = data[index]
+            index += 1
+            delta |= (byte & 0x7F) << shift
+            shift += 7
+            if not byte & 0x80:
+                break
+        cycles += delta
+        frames.append((cycles, int.from_bytes(data[index:index + 4], "little")))
+        index += 4
+    return clock, frames
+
+
+def analyze(clock, frames, step_invert=0, dir_invert=0, window_us=10000):
+    """Reduces a capture to the figures compared against the golden one."""
+    window = int(clock * window_us / 1000000)
+    position = [0] * N_AXIS
+    steps = [0] * N_AXIS
+    last_step = [None] * N_AXIS
+    min_interval = [None] * N_AXIS
+    rise = [None] * N_AXIS
+    pulse = [None, None]
+    envelope = {}
+    first = None
+    last = None
+    previous = 0
+    for cycles, frame in frames:
+        step_bits = (frame & 0xFF) ^ step_invert
+        dir_bits = ((frame >> 8) & 0xFF) ^ dir_invert
+        rising = step_bits & ~previous
+        falling = previous & ~step_bits
+        previous = step_bits
+        for axis in range(N_AXIS):
+            bit = 1 << axis
+            if falling & bit and rise[axis] is not None:
+                width = cycles - rise[axis]
+                pulse[0] = width if pulse[0] is None else min(pulse[0], width)
+                pulse[1] = width if pulse[1] is None else max(pulse[1], width)
+                rise[axis] = None
+            if not rising & bit:
+                continue
+            # A set direction bit moves the axis in the negative direction, as in Grbl.
+            position[axis] += -1 if dir_bits & bit else 1
+            steps[axis] += 1
+            rise[axis] = cycles
+            if last_step[axis] is not None:
+                interval = cycles - last_step[axis]
+                if min_interval[axis] is None or interval < min_interval[axis]:
+                    min_interval[axis] = interval
+            last_step[axis] = cycles
+            if first is None:
+                first = cycles
+            last = cycles
+            counts = envelope.setdefault((cycles - first) // window, [0] * N_AXIS)
+            counts[axis] += 1
+    windows = (max(envelope) + 1) if envelope else 0
+    return {
+        "clock": clock,
+        "frames": len(frames),
+        "position": position,
+        "steps": steps,
+        "duration": (last - first) if first is not None else 0,
+        "min_interval": min_interval,
+        "pulse": pulse,
+        "envelope": [envelope.get(i, [0] * N_AXIS) for i in range(windows)],
+        "window_us": window_us,
+    }
+
+
+def us(summary, cycles):
+    return cycles * 1000000.0 / summary["clock"]
+
+
+def print_summary(summary, out):
+    axes = [a for a in range(N_AXIS) if summary["steps"][a]]
+    out.write("frames %d, steps over %.3f ms\n" % (summary["frames"], us(summary, summary["duration"]) / 1000))
+    if summary["pulse"][0] is not None:
+        out.write("pulse width %.2f to %.2f us\n" % (us(summary, summary["pulse"][0]),
+                                                   us(summary, summary["pulse"][1])))
+    for axis in axes:
+        interval = summary["min_interval"][axis]
+        out.write("%s: position %d, %d steps, min interval %s\n" % (
+            AXIS_NAMES[axis], summary["position"][axis], summary["steps"][axis],
+            "%.2f us" % us(summary, interval) if interval is not None else "-"))
+    if not axes:
+        out.write("no steps\n")
+
+
+def relative_error(golden, value):
+    if golden == value:
+        return 0.0
+    if not golden:
+        return float("inf")
+    return abs(value - golden) / float(golden)
+
+
+def compare(golden, result, args):
+    """Returns a list of differences beyond the tolerances."""
+    problems = []
+    for axis in range(N_AXIS):
+        name = AXIS_NAMES[axis]
+        if abs(result["position"][axis] - golden["position"][axis]) > args.position_tolerance:
+            problems.append("%s position %d, golden %d" % (name, result["position"][axis],
+                                                           golden["position"][axis]))
+        if abs(result["steps"][axis] - golden["steps"][axis]) > args.position_tolerance:
+            problems.append("%s steps %d, golden %d" % (name, result["steps"][axis], golden["steps"][axis]))
+        expected = golden["min_interval"][axis]
+        actual = result["min_interval"][axis]
+        if (expected is None) != (actual is None) or (
+                expected is not None and relative_error(expected, actual) > args.timing_tolerance):
+            problems.append("%s min step interval %s, golden %s cycles" % (name, actual, expected))
+    if relative_error(golden["duration"], result["duration"]) > args.timing_tolerance:
+        problems.append("duration %.3f ms, golden %.3f ms" % (us(result, result["duration"]) / 1000,
+                                                              us(golden, golden["duration"]) / 1000))
+    for bound in (0, 1):
+        expected = golden["pulse"][bound]
+        actual = result["pulse"][bound]
+        if (expected is None) != (actual is None) or (
+                expected is not None and relative_error(expected, actual) > args.timing_tolerance):
+            problems.append("%s pulse width %s, golden %s cycles" % (("min", "max")[bound], actual, expected))
+
+    # Step rate envelope. Reports the first window off by more than the tolerance only, as a
+    # timing shift tends to push all following windows off too.
+    windows = max(len(golden["envelope"]), len(result["envelope"]))
+    empty = [0] * N_AXIS
+    for index in range(windows):
+        expected = golden["envelope"][index] if index < len(golden["envelope"]) else empty
+        actual = result["envelope"][index] if index < len(result["envelope"]) else empty
+        for axis in range(N_AXIS):
+            allowed = max(args.envelope_steps, expected[axis] * args.timing_tolerance)
+            if abs(actual[axis] - expected[axis]) > allowed:
+                problems.append("%s steps in window %d (%d ms) %d, golden %d" % (
+                    AXIS_NAMES[axis], index, index * golden["window_us"] // 1000, actual[axis], expected[axis]))
+                return problems
+    return problems
+
+
+def load(path, args):
+    """Returns the summary of a capture, or a golden summary as written by save()."""
+    if path.endswith(".json"):
+        with open(path) as source:
+            return json.load(source)
+    clock, frames = read_capture(path)
+    return analyze(clock, frames, args.step_invert, args.dir_invert, args.window)
+
+
+def save(summary, path):
+    """Writes a summary as a golden. One envelope window per line keeps diffs of it readable."""
+    fields = ["  %s: %s" % (json.dumps(key), json.dumps(summary[key]))
+              for key in summary if key != "envelope"]
+    windows = [json.dumps(counts) for counts in summary["envelope"]]
+    fields.append('  "envelope": [%s]' % ",\n    ".join(windows) if windows else '  "envelope": []')
+    with open(path, "w") as out:
+        out.write("{\n%s\n}\n" % ",\n".join(fields))
+
+
+def write_vcd(clock, frames, out):
+    signals = [("step_%s" % AXIS_NAMES[a], 1, a) for a in range(N_AXIS)]
+    signals += [("dir_%s" % AXIS_NAMES[a], 1, 8 + a) for a in range(N_AXIS)]
+    signals += [("misc", 8, 16), ("limit", 8, 24)]
+    ids = [chr(33 + i) for i in range(len(signals))]
+
+    out.write("$timescale 1ns $end\n$scope module grbl $end\n")
+    for (name, width, _), ident in zip(signals, ids):
+        out.write("$var wire %d %s %s $end\n" % (width, ident, name))
+    out.write("$upscope $end\n$enddefinitions $end\n")
+
+    previous = [None] * len(signals)
+    last_time = -1
+    for cycles, frame in frames:
+        time = cycles * 1000000000 // clock
+        changes = []
+        for i, (_, width, shift) in enumerate(signals):
+            value = (frame >> shift) & ((1 << width) - 1)
+            if value == previous[i]:
+                continue
+            previous[i] = value
+            if width == 1:
+                changes.append("%d%s\n" % (value, ids[i]))
+            else:
+                changes.append("b%s %s\n" % (format(value, "b"), ids[i]))
+        if not changes:
+            continue
+        if time <= last_time:
+            time = last_time + 1  # VCD times must increase.
+        last_time = time
+        out.write("#%d\n" % time)
+        out.writelines(changes)
+
+
+def run_program(program, job, capture):
+    # A new file system each time, so every program starts from the default settings.
+    with tempfile.TemporaryDirectory() as files:
+        result = subprocess.run([program, "--stream", job, "--fast", "--capture", capture, "--fs", files],
+                                stdout=subprocess.DEVNULL, stderr=subprocess.PIPE, timeout=600)
+    if result.returncode != 0:
+        raise RuntimeError("%s failed: %s" % (job, result.stderr.decode().strip()))
+
+
+def check(args):
+    jobs = sorted(glob.glob(os.path.join(args.corpus, "*.nc")))
+    if not jobs:
+        sys.stderr.write("no *.nc programs in %s\n" % args.corpus)
+        return 2
+    failed = 0
+    with tempfile.TemporaryDirectory() as scratch:
+        for job in jobs:
+            golden_path = os.path.splitext(job)[0] + ".json"
+            capture = os.path.join(scratch, "capture.gstc")
+            name = os.path.basename(job)
+            try:
+                run_program(args.program, job, capture)
+            except (RuntimeError, subprocess.TimeoutExpired) as error:
+                print("FAIL %s: %s" % (name, error))
+                failed += 1
+                continue
+            if args.update:
+                save(load(capture, args), golden_path)
+                print("recorded %s" % golden_path)
+                continue
+            if not os.path.exists(golden_path):
+                print("FAIL %s: no golden summary, record it with --update" % name)
+                failed += 1
+                continue
+            problems = compare(load(golden_path, args), load(capture, args), args)
+            print("%s %s" % ("FAIL" if problems else "ok  ", name))
+            for problem in problems:
+                print("     " + problem)
+            failed += bool(problems)
+    if not args.update:
+        print("%d of %d programs differ" % (failed, len(jobs)))
+    return 1 if failed else 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--step-invert", type=lambda v: int(v, 0), default=0,
+                        help="step pulse invert mask, as $2")
+    parser.add_argument("--dir-invert", type=lambda v: int(v, 0), default=0,
+                        help="direction invert mask, as $3")
+    parser.add_argument("--window", type=int, default=10000,
+                        help="step rate envelope window in us, default 10000")
+    parser.add_argument("--position-tolerance", type=int, default=0,
+                        help="steps an axis may be off, default 0")
+    parser.add_argument("--timing-tolerance", type=float, default=0.01,
+                        help="relative timing difference allowed, default 0.01")
+    parser.add_argument("--envelope-steps", type=int, default=2,
+                        help="steps a window may be off at least, default 2")
+    commands = parser.add_subparsers(dest="command", required=True)
+    command = commands.add_parser("summary", help="print positions, step counts and timing")
+    command.add_argument("capture")
+    command = commands.add_parser("vcd", help="convert to VCD on stdout")
+    command.add_argument("capture")
+    command = commands.add_parser("diff", help="compare a capture with a golden capture or summary")
+    command.add_argument("golden")
+    command.add_argument("capture")
+    command = commands.add_parser("check", help="run a corpus against its golden summaries")
+    command.add_argument("corpus")
+    command.add_argument("--program", default=".pio/build/native/program",
+                         help="host build, default .pio/build/native/program")
+    command.add_argument("--update", action="store_true", help="record the golden summaries")
+    args = parser.parse_args()
+
+    if args.command == "summary":
+        print_summary(load(args.capture, args), sys.stdout)
+    elif args.command == "vcd":
+        write_vcd(*read_capture(args.capture), sys.stdout)
+    elif args.command == "diff":
+        problems = compare(load(args.golden, args), load(args.capture, args), args)
+        for problem in problems:
+            print(problem)
+        return 1 if problems else 0
+    elif args.command == "check":
+        return check(args)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,106 @@
+#!/usr/bin/env python3
+"""Converts a Grbl position trace read out with $TR to CSV or VCD.
+
+The input is a console log holding the [TR:...] lines. All other lines are
+ignored, so several read outs of one capture may be logged back to back.
+The 32 bit cycle counter timestamps are unwrapped and converted to
+microseconds since the first segment.
+
+  trace_convert.py capture.log > trace.csv
+  trace_convert.py --vcd capture.log > trace.vcd
+"""
+
+import argparse
+import re
+import sys
+
+AXIS_NAMES = "XYZABCDE"
+TRACE_LINE = re.compile(r"\[TR:([-0-9,]+)\]")
+TRACE_END = re.compile(r"\[TRE:(\d+),(\d+)\]")
+
+
+def read_trace(lines):
+    """Returns (cycles, n_step, cycles_per_tick, block, positions) tuples and the drop count."""
+    entries = []
+    dropped = 0
+    last = None
+    offset = 0
+    for line in lines:
+        match = TRACE_END.search(line)
+        if match:
+            dropped += int(match.group(2))
+            continue
+        match = TRACE_LINE.search(line)
+        if not match:
+            continue
+        values = [int(v) for v in match.group(1).split(",")]
+        if len(values) < 5:
+            continue
+        timestamp = values[0]
+        if last is not None and timestamp < last:
+            offset += 1 << 32  # Cycle counter wrapped.
+        last = timestamp
+        entries.append((timestamp + offset, values[1], values[2], values[3], values[4:]))
+    return entries, dropped
+
+
+def write_csv(entries, cpu_mhz, out):
+    n_axis = len(entries[0][4]) if entries else 0
+    out.write("time_us,n_step,cycles_per_tick,block,"
+              + ",".join(AXIS_NAMES[i] for i in range(n_axis)) + "\n")
+    start = entries[0][0] if entries else 0
+    for cycles, n_step, cpt, block, position in entries:
+        out.write("%.3f,%d,%d,%d,%s\n" % ((cycles - start) / cpu_mhz, n_step, cpt, block,
+                                          ",".join(str(p) for p in position)))
+
+
+def write_vcd(entries, cpu_mhz, out):
+    n_axis = len(entries[0][4]) if entries else 0
+    signals = [("n_step", 16), ("cycles_per_tick", 16), ("block", 8)]
+    signals += [(AXIS_NAMES[i], 32) for i in range(n_axis)]
+    ids = [chr(33 + i) for i in range(len(signals))]
+
+    out.write("$timescale 1ns $end\n$scope module grbl $end\n")
+    for (name, width), ident in zip(signals, ids):
+        out.write("$var wire %d %s %s $end\n" % (width, ident, name))
+    out.write("$upscope $end\n$enddefinitions $end\n")
+
+    start = entries[0][0] if entries else 0
+    previous = [None] * len(signals)
+    last_time = -1
+    for cycles, n_step, cpt, block, position in entries:
+        time = int((cycles - start) * 1000 / cpu_mhz)
+        if time <= last_time:
+            time = last_time + 1  # VCD times must increase.
+        last_time = time
+        out.write("#%d\n" % time)
+        for i, value in enumerate([n_step, cpt, block] + list(position)):
+            if value != previous[i]:
+                width = signals[i][1]
+                out.write("b%s %s\n" % (format(value & ((1 << width) - 1), "b"), ids[i]))
+                previous[i] = value
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("log", nargs="?", help="console log, default stdin")
+    parser.add_argument("--vcd", action="store_true", help="write VCD instead of CSV")
+    parser.add_argument("--cpu-mhz", type=float, default=80.0,
+                        help="CPU clock of the timestamps, default 80")
+    args = parser.parse_args()
+
+    source = open(args.log) if args.log else sys.stdin
+    with source:
+        entries, dropped = read_trace(source)
+    if dropped:
+        sys.stderr.write("warning: %d segments dropped during capture\n" % dropped)
+
+    if args.vcd:
+        write_vcd(entries, args.cpu_mhz, sys.stdout)
+    else:
+        write_csv(entries, args.cpu_mhz, sys.stdout)
+
+
+if __name__ == "__main__":
+    main()